@@ -27,6 +27,7 @@
 #include "modify.h"
 #include "asciimap.h"
 #include "race.h"
+#include "slab.h"
 
 /* prototypes of local functions */
 /* do_diagnose utility functions */
@@ -1744,7 +1745,7 @@ static void perform_mortal_where(struct char_data *ch, char *arg)
 	continue;
       if (!CAN_SEE(ch, i) || world[IN_ROOM(i)].zone != world[IN_ROOM(ch)].zone)
 	continue;
-      if (!isname(arg, i->player.name))
+      if (!char_isname(arg, i))
 	continue;
       send_to_char(ch, "%-25s%s - %s%s\r\n", GET_NAME(i), QNRM, world[IN_ROOM(i)].name, QNRM);
       return;
@@ -1809,7 +1810,7 @@ static void perform_immort_where(struct char_data *ch, char *arg)
       }
   } else {
     for (i = character_list; i; i = i->next)
-      if (CAN_SEE(ch, i) && IN_ROOM(i) != NOWHERE && isname(arg, i->player.name)) {
+      if (CAN_SEE(ch, i) && IN_ROOM(i) != NOWHERE && char_isname(arg, i)) {
         found = 1;
         send_to_char(ch, "M%3d. %-25s%s - [%5d] %-25s%s", ++num, GET_NAME(i), QNRM,
                GET_ROOM_VNUM(IN_ROOM(i)), world[IN_ROOM(i)].name, QNRM);
@@ -1822,7 +1823,7 @@ static void perform_immort_where(struct char_data *ch, char *arg)
       send_to_char(ch, "%s\r\n", QNRM);
       }
     for (num = 0, k = object_list; k; k = k->next)
-      if (CAN_SEE_OBJ(ch, k) && isname(arg, k->name)) {
+      if (CAN_SEE_OBJ(ch, k) && obj_isname(arg, k)) {
         found = 1;
         print_object_location(++num, k, ch, TRUE);
       }
@@ -2348,18 +2349,21 @@ ACMD(do_toggle)
       send_to_char(ch, "Sorry, automap is currently disabled.\r\n");
       break;
   default:
+    if (*arg2 && strcmp(arg2, "on") && strcmp(arg2, "off")) {
+        send_to_char(ch, "Value for %s must either be 'on' or 'off'.\r\n", tog_messages[toggle].command);
+      return;
+    }
+    /* Nohassle decides whether the zone counts ch, see zone_presence_to(). */
+    zone_presence_from(ch);
     if (!*arg2) {
       TOGGLE_BIT_AR(PRF_FLAGS(ch), tog_messages[toggle].toggle);
       result = (PRF_FLAGGED(ch, tog_messages[toggle].toggle));
     } else if (!strcmp(arg2, "on")) {
       SET_BIT_AR(PRF_FLAGS(ch), tog_messages[toggle].toggle);
       result = 1;
-    } else if (!strcmp(arg2, "off")) {
+    } else
       REMOVE_BIT_AR(PRF_FLAGS(ch), tog_messages[toggle].toggle);
-    } else {
-        send_to_char(ch, "Value for %s must either be 'on' or 'off'.\r\n", tog_messages[toggle].command);
-      return;
-    }
+    zone_presence_to(ch);
   }
   if (result)
     send_to_char(ch, "%s", tog_messages[toggle].enable_msg);
@@ -2535,7 +2539,7 @@ ACMD(do_whois)
 
   if (!(victim=get_player_vis(ch, buf, NULL, FIND_CHAR_WORLD)))
   {
-     CREATE(victim, struct char_data, 1);
+     SLAB_CREATE(victim, struct char_data, char_slab);
      clear_char(victim);
      
      new_mobile_data(victim);
@@ -22,6 +22,8 @@
 #include "oasis.h"
 #include "act.h"
 #include "quest.h"
+#include "nameindex.h"
+#include "strpool.h"
 
 
 /* local function prototypes */
@@ -143,7 +145,7 @@ ACMD(do_put)
 	for (obj = ch->carrying; obj; obj = next_obj) {
 	  next_obj = obj->next_content;
 	  if (obj != cont && CAN_SEE_OBJ(ch, obj) &&
-	      (obj_dotmode == FIND_ALL || isname(theobj, obj->name))) {
+	      (obj_dotmode == FIND_ALL || obj_isname(theobj, obj))) {
 	    found = 1;
 	    perform_put(ch, obj, cont);
 	  }
@@ -249,7 +251,7 @@ void get_from_container(struct char_data *ch, struct obj_data *cont,
     for (obj = cont->contains; obj; obj = next_obj) {
       next_obj = obj->next_content;
       if (CAN_SEE_OBJ(ch, obj) &&
-	  (obj_dotmode == FIND_ALL || isname(arg, obj->name))) {
+	  (obj_dotmode == FIND_ALL || obj_isname(arg, obj))) {
 	found = 1;
 	perform_get_from_container(ch, obj, cont, mode);
       }
@@ -306,7 +308,7 @@ static void get_from_room(struct char_data *ch, char *arg, int howmany)
     for (obj = world[IN_ROOM(ch)].contents; obj; obj = next_obj) {
       next_obj = obj->next_content;
       if (CAN_SEE_OBJ(ch, obj) &&
-	  (dotmode == FIND_ALL || isname(arg, obj->name))) {
+	  (dotmode == FIND_ALL || obj_isname(arg, obj))) {
 	found = 1;
 	perform_get_from_room(ch, obj);
       }
@@ -361,7 +363,7 @@ ACMD(do_get)
       }
       for (cont = ch->carrying; cont; cont = cont->next_content)
 	if (CAN_SEE_OBJ(ch, cont) &&
-	    (cont_dotmode == FIND_ALL || isname(arg2, cont->name))) {
+	    (cont_dotmode == FIND_ALL || obj_isname(arg2, cont))) {
 	  if (GET_OBJ_TYPE(cont) == ITEM_CONTAINER) {
 	    found = 1;
 	    get_from_container(ch, cont, arg1, FIND_OBJ_INV, amount);
@@ -372,7 +374,7 @@ ACMD(do_get)
 	}
       for (cont = world[IN_ROOM(ch)].contents; cont; cont = cont->next_content)
 	if (CAN_SEE_OBJ(ch, cont) &&
-	    (cont_dotmode == FIND_ALL || isname(arg2, cont->name))) {
+	    (cont_dotmode == FIND_ALL || obj_isname(arg2, cont))) {
 	  if (GET_OBJ_TYPE(cont) == ITEM_CONTAINER) {
 	    get_from_container(ch, cont, arg1, FIND_OBJ_ROOM, amount);
 	    found = 1;
@@ -731,7 +733,7 @@ ACMD(do_give)
 	for (obj = ch->carrying; obj; obj = next_obj) {
 	  next_obj = obj->next_content;
 	  if (CAN_SEE_OBJ(ch, obj) &&
-	      ((dotmode == FIND_ALL || isname(arg, obj->name))))
+	      ((dotmode == FIND_ALL || obj_isname(arg, obj))))
 	    perform_give(ch, vict, obj);
 	}
     }
@@ -771,7 +773,7 @@ void name_from_drinkcon(struct obj_data *obj)
     return;
 
   liqname = drinknames[GET_OBJ_VAL(obj, 2)];
-  if (!isname(liqname, obj->name)) {
+  if (!obj_isname(liqname, obj)) {
     log("SYSERR: Can't remove liquid '%s' from '%s' (%d) item.", liqname, obj->name, obj->item_number);
     /* SYSERR_DESC: From name_from_drinkcon(), this error comes about if the
      * object noted (by keywords and item vnum) does not contain the liquid
@@ -799,9 +801,9 @@ void name_from_drinkcon(struct obj_data *obj)
     strncat(new_name, cur_name, cpylen); /* strncat: OK (size precalculated) */
   }
 
-  if (GET_OBJ_RNUM(obj) == NOTHING || obj->name != obj_proto[GET_OBJ_RNUM(obj)].name)
-    free(obj->name);
+  str_release(obj->name);
   obj->name = new_name;
+  obj_to_unshared(obj);
 }
 
 void name_to_drinkcon(struct obj_data *obj, int type)
@@ -814,10 +816,10 @@ void name_to_drinkcon(struct obj_data *obj, int type)
   CREATE(new_name, char, strlen(obj->name) + strlen(drinknames[type]) + 2);
   sprintf(new_name, "%s %s", obj->name, drinknames[type]); /* sprintf: OK */
 
-  if (GET_OBJ_RNUM(obj) == NOTHING || obj->name != obj_proto[GET_OBJ_RNUM(obj)].name)
-    free(obj->name);
+  str_release(obj->name);
 
   obj->name = new_name;
+  obj_to_unshared(obj);
 }
 
 ACMD(do_drink)
@@ -1498,7 +1500,7 @@ ACMD(do_remove)
       found = 0;
       for (i = 0; i < NUM_WEARS; i++)
 	if (GET_EQ(ch, i) && CAN_SEE_OBJ(ch, GET_EQ(ch, i)) &&
-	    isname(arg, GET_EQ(ch, i)->name)) {
+	    obj_isname(arg, GET_EQ(ch, i))) {
 	  perform_remove(ch, i);
 	  found = 1;
 	}
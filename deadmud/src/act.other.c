@@ -194,7 +194,7 @@ ACMD(do_steal)
 
       for (eq_pos = 0; eq_pos < NUM_WEARS; eq_pos++)
 	if (GET_EQ(vict, eq_pos) &&
-	    (isname(obj_name, GET_EQ(vict, eq_pos)->name)) &&
+	    (obj_isname(obj_name, GET_EQ(vict, eq_pos))) &&
 	    CAN_SEE_OBJ(ch, GET_EQ(vict, eq_pos))) {
 	  obj = GET_EQ(vict, eq_pos);
 	  break;
@@ -556,7 +556,7 @@ ACMD(do_use)
   }
   mag_item = GET_EQ(ch, WEAR_HOLD);
 
-  if (!mag_item || !isname(arg, mag_item->name)) {
+  if (!mag_item || !obj_isname(arg, mag_item)) {
     switch (subcmd) {
     case SCMD_RECITE:
     case SCMD_QUAFF:
@@ -730,7 +730,9 @@ ACMD(do_gen_tog)
     result = PRF_TOG_CHK(ch, PRF_SUMMONABLE);
     break;
   case SCMD_NOHASSLE:
+    zone_presence_from(ch);
     result = PRF_TOG_CHK(ch, PRF_NOHASSLE);
+    zone_presence_to(ch);
     break;
   case SCMD_BRIEF:
     result = PRF_TOG_CHK(ch, PRF_BRIEF);
@@ -19,6 +19,9 @@
 #include "spells.h"
 #include "house.h"
 #include "screen.h"
+#include "slab.h"
+#include "strpool.h"
+#include "descstore.h"
 #include "constants.h"
 #include "oasis.h"
 #include "dg_scripts.h"
@@ -628,7 +631,7 @@ static void do_stat_object(struct char_data *ch, struct obj_data *j)
   send_to_char(ch, "Extra flags   : %s\r\n", buf);
 
   send_to_char(ch, "Weight: %d, Value: %d, Cost/day: %d, Timer: %d, Min level: %d\r\n",
-     GET_OBJ_WEIGHT(j), GET_OBJ_COST(j), GET_OBJ_RENT(j), GET_OBJ_TIMER(j), GET_OBJ_LEVEL(j));
+     GET_OBJ_WEIGHT(j), GET_OBJ_COST(j), GET_OBJ_RENT(j), obj_timer(j), GET_OBJ_LEVEL(j));
 
   send_to_char(ch, "In room: %d (%s), ", GET_ROOM_VNUM(IN_ROOM(j)),
 	IN_ROOM(j) == NOWHERE ? "Nowhere" : world[IN_ROOM(j)].name);
@@ -890,7 +893,7 @@ static void do_stat_character(struct char_data *ch, struct char_data *k)
   /* Routine to show what spells a char is affected by */
   if (k->affected) {
     for (aff = k->affected; aff; aff = aff->next) {
-      send_to_char(ch, "SPL: (%3dhr) %s%-21s%s ", aff->duration + 1, CCCYN(ch, C_NRM), skill_name(aff->spell), CCNRM(ch, C_NRM));
+      send_to_char(ch, "SPL: (%3dhr) %s%-21s%s ", affect_duration(aff) + 1, CCCYN(ch, C_NRM), skill_name(aff->spell), CCNRM(ch, C_NRM));
 
       if (aff->modifier)
 	send_to_char(ch, "%+d to %s", aff->modifier, apply_types[(int) aff->location]);
@@ -1007,7 +1010,7 @@ ACMD(do_stat)
     else if ((victim = get_player_vis(ch, buf2, NULL, FIND_CHAR_WORLD)) != NULL)
 	do_stat_character(ch, victim);
     else {
-      CREATE(victim, struct char_data, 1);
+      SLAB_CREATE(victim, struct char_data, char_slab);
       clear_char(victim);
       CREATE(victim->player_specials, struct player_special_data, 1);
       new_mobile_data(victim);
@@ -1524,7 +1527,9 @@ ACMD(do_advance)
     /* If they are no longer an immortal, remove the immortal only flags. */
     REMOVE_BIT_AR(PRF_FLAGS(victim), PRF_LOG1);
     REMOVE_BIT_AR(PRF_FLAGS(victim), PRF_LOG2);
+    zone_presence_from(victim);
     REMOVE_BIT_AR(PRF_FLAGS(victim), PRF_NOHASSLE);
+    zone_presence_to(victim);
     REMOVE_BIT_AR(PRF_FLAGS(victim), PRF_HOLYLIGHT);
     REMOVE_BIT_AR(PRF_FLAGS(victim), PRF_SHOWVNUMS);
     if (!PLR_FLAGGED(victim, PLR_NOWIZLIST))
@@ -2036,7 +2041,7 @@ ACMD(do_last)
   }
 
   if (*name && !num) {
-    CREATE(vict, struct char_data, 1);
+    SLAB_CREATE(vict, struct char_data, char_slab);
     clear_char(vict);
     CREATE(vict->player_specials, struct player_special_data, 1);
     new_mobile_data(vict);
@@ -2428,9 +2433,10 @@ static size_t print_zone_to_buf(char *bufptr, size_t left, zone_rnum zone, int l
                         "         Mobiles:  %2d\r\n"
                         "         Shops:    %2d\r\n"
                         "         Triggers: %2d\r\n"
-                        "         Quests:   %2d\r\n",
+                        "         Quests:   %2d\r\n"
+                        "         Players:  %2d\r\n",
 			buf, zone_table[zone].min_level, zone_table[zone].max_level,
-                        j, k, l, m, n, o);
+                        j, k, l, m, n, o, zone_table[zone].players);
 
     return tmp;
   }
@@ -2474,6 +2480,11 @@ ACMD(do_show)
     { "thaco",      LVL_IMMORT },
     { "exp",        LVL_IMMORT },
     { "colour",     LVL_IMMORT },
+    { "lookups",    LVL_IMPL },
+    { "strings",    LVL_IMMORT },			/* 15 */
+    { "resets",     LVL_IMMORT },
+    { "reading",    LVL_IMPL },
+    { "ticks",      LVL_IMPL },
     { "\n", 0 }
   };
 
@@ -2554,7 +2565,7 @@ ACMD(do_show)
       return;
     }
 
-    CREATE(vict, struct char_data, 1);
+    SLAB_CREATE(vict, struct char_data, char_slab);
     clear_char(vict);
     CREATE(vict->player_specials, struct player_special_data, 1);
     new_mobile_data(vict);
@@ -2630,7 +2641,7 @@ ACMD(do_show)
   /* show errors */
   case 5:
     len = strlcpy(buf, "Errant Rooms\r\n------------\r\n", sizeof(buf));
-    for (i = 0, k = 0; i <= top_of_world; i++)
+    for (i = next_room_by_vnum(NOWHERE), k = 0; i != NOWHERE; i = next_room_by_vnum(i))
       for (j = 0; j < DIR_COUNT; j++) {
       	if (!W_EXIT(i,j))
       	  continue;
@@ -2653,7 +2664,7 @@ ACMD(do_show)
   /* show death */
   case 6:
     len = strlcpy(buf, "Death Traps\r\n-----------\r\n", sizeof(buf));
-    for (i = 0, j = 0; i <= top_of_world; i++)
+    for (i = next_room_by_vnum(NOWHERE), j = 0; i != NOWHERE; i = next_room_by_vnum(i))
       if (ROOM_FLAGGED(i, ROOM_DEATH)) {
         nlen = snprintf(buf + len, sizeof(buf) - len, "%2d: [%5d] %s%s\r\n", ++j, GET_ROOM_VNUM(i), world[i].name, QNRM);
         if (len + nlen >= sizeof(buf))
@@ -2666,7 +2677,7 @@ ACMD(do_show)
   /* show godrooms */
   case 7:
     len = strlcpy(buf, "Godrooms\r\n--------------------------\r\n", sizeof(buf));
-    for (i = 0, j = 0; i <= top_of_world; i++)
+    for (i = next_room_by_vnum(NOWHERE), j = 0; i != NOWHERE; i = next_room_by_vnum(i))
       if (ROOM_FLAGGED(i, ROOM_GODROOM)) {
         nlen = snprintf(buf + len, sizeof(buf) - len, "%2d: [%5d] %s%s\r\n", ++j, GET_ROOM_VNUM(i), world[i].name, QNRM);
         if (len + nlen >= sizeof(buf))
@@ -2755,6 +2766,45 @@ ACMD(do_show)
     page_string(ch->desc, buf, TRUE);
     break;
 
+  /* Time the vnum lookup tables against a binary search. */
+  case 14:
+    show_vnum_lookups(ch);
+    break;
+
+  /* show strings */
+  case 15: {
+    long refs, bytes, saved;
+
+    str_pool_stats(&i, &refs, &bytes, &saved);
+    send_to_char(ch,
+	"Shared world and prototype text:\r\n"
+	"  %8d distinct strings\r\n"
+	"  %8ld references\r\n"
+	"  %8ld bytes in the pool\r\n"
+	"  %8ld bytes saved\r\n",
+	i, refs, bytes, saved);
+    desc_store_stats(&i, &bytes);
+    if (i > 0)
+      send_to_char(ch, "Room descriptions paged from %s:\r\n"
+	"  %8d room texts\r\n"
+	"  %8ld bytes mapped\r\n", ROOM_DESC_STORE, i, bytes);
+    break;
+  }
+
+  /* show resets */
+  case 16:
+    show_zone_resets(ch);
+    break;
+
+  /* Time reading the player files from memory against stdio. */
+  case 17:
+    show_file_reads(ch);
+    break;
+
+  case 18:
+    show_tick_passes(ch);
+    break;
+
   /* show what? */
   default:
     send_to_char(ch, "Sorry, I don't understand that.\r\n");
@@ -3037,7 +3087,7 @@ static int perform_set(struct char_data *ch, struct char_data *vict, int mode, c
         return (0);
       }
       RANGE(1, LVL_IMPL);
-      vict->player.level = value;
+      GET_LEVEL(vict) = value;
       break;
     case 26: /* loadroom */
       if (!str_cmp(val_arg, "off")) {
@@ -3095,7 +3145,9 @@ static int perform_set(struct char_data *ch, struct char_data *vict, int mode, c
         send_to_char(ch, "You aren't godly enough for that!\r\n");
         return (0);
       }
+      zone_presence_from(vict);
       SET_OR_REMOVE(PRF_FLAGS(vict), PRF_NOHASSLE);
+      zone_presence_to(vict);
       break;
     case 35: /* nosummon */
       SET_OR_REMOVE(PRF_FLAGS(vict), PRF_SUMMONABLE);
@@ -3343,7 +3395,7 @@ ACMD(do_set)
     }
   } else if (is_file) {
     /* try to load the player off disk */
-    CREATE(cbuf, struct char_data, 1);
+    SLAB_CREATE(cbuf, struct char_data, char_slab);
     clear_char(cbuf);
     CREATE(cbuf->player_specials, struct player_special_data, 1);
     new_mobile_data(cbuf);
@@ -3417,7 +3469,7 @@ ACMD(do_links)
   zone_rnum zrnum;
   zone_vnum zvnum;
   room_rnum nr, to_room;
-  int first, last, j;
+  int first, last, vnum, j;
   char arg[MAX_INPUT_LENGTH];
 
 
@@ -3441,8 +3493,8 @@ ACMD(do_links)
   first = zone_table[zrnum].bot;
 
   send_to_char(ch, "Zone %d is linked to the following zones:\r\n", zvnum);
-  for (nr = 0; nr <= top_of_world && (GET_ROOM_VNUM(nr) <= last); nr++) {
-    if (GET_ROOM_VNUM(nr) >= first) {
+  for (vnum = first; vnum <= last; vnum++) {
+    if ((nr = real_room(vnum)) != NOWHERE) {
       for (j = 0; j < DIR_COUNT; j++) {
         if (world[nr].dir_option[j]) {
           to_room = world[nr].dir_option[j]->to_room;
@@ -4217,6 +4269,36 @@ ACMD(do_peace)
   }
 }
 
+ACMD(do_memory)
+{
+  char arg[MAX_INPUT_LENGTH], arg2[MAX_INPUT_LENGTH];
+
+  /* Not two_arguments(), which would take "on" for a fill word. */
+  half_chop(argument, arg, arg2);
+
+  if (is_abbrev(arg, "poison") && *arg) {
+    if (GET_LEVEL(ch) < LVL_IMPL)
+      send_to_char(ch, "You are not holy enough to do that.\r\n");
+    else if (!*arg2)
+      send_to_char(ch, "Poisoning of freed slab elements is %s.\r\n", slab_poison ? "on" : "off");
+    else if (!str_cmp(arg2, "on") || !str_cmp(arg2, "off")) {
+      set_slab_poison(!str_cmp(arg2, "on"));
+      send_to_char(ch, "Poisoning of freed slab elements is now %s.\r\n", slab_poison ? "on" : "off");
+      mudlog(BRF, LVL_IMPL, TRUE, "(GC) %s turned slab poisoning %s.", GET_NAME(ch), slab_poison ? "on" : "off");
+    } else
+      send_to_char(ch, "Usage: memory [poison [on|off]]\r\n");
+    return;
+  } else if (*arg) {
+    send_to_char(ch, "Usage: memory [poison [on|off]]\r\n");
+    return;
+  }
+
+  show_mem_stats(ch);
+  send_to_char(ch, "\r\n");
+  show_slab_pools(ch);
+  show_outbuf_pools(ch);
+}
+
 ACMD(do_zpurge)
 {
   int vroom, room, vzone = 0, zone = 0;
@@ -4311,6 +4393,7 @@ ACMD(do_file)
     { "badpws",         LVL_GOD,    BADPWS_LOGFILE,      TRUE},
     { "olc",            LVL_GOD,    OLC_LOGFILE,         TRUE},
     { "trigger",        LVL_GOD,    TRIGGER_LOGFILE,     TRUE},
+    { "trigprof",       LVL_GOD,    TRIGPROF_LOGFILE,    FALSE},
     { "\n", 0, "\n", FALSE } /* This must be the last entry */
   };
 
@@ -4625,7 +4708,7 @@ bool change_player_name(struct char_data *ch, struct char_data *vict, char *new_
     return FALSE;
   } else  {
     /* try to load the player off disk */
-    CREATE(temp_ch, struct char_data, 1);
+    SLAB_CREATE(temp_ch, struct char_data, char_slab);
     clear_char(temp_ch);
     CREATE(temp_ch->player_specials, struct player_special_data, 1);
     new_mobile_data(temp_ch);
@@ -4,6 +4,8 @@
 *  by Michael Scott                                                       *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
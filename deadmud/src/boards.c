@@ -229,7 +229,7 @@ int board_show_board(int board_type, struct char_data *ch, char *arg, struct obj
 
   one_argument(arg, tmp);
 
-  if (!*tmp || !isname(tmp, board->name))
+  if (!*tmp || !obj_isname(tmp, board))
     return (0);
 
   if (GET_LEVEL(ch) < READ_LVL(board_type)) {
@@ -288,7 +288,7 @@ int board_display_msg(int board_type, struct char_data *ch, char *arg, struct ob
   one_argument(arg, number);
   if (!*number)
     return (0);
-  if (isname(number, board->name))	/* so "read board" works */
+  if (obj_isname(number, board))	/* so "read board" works */
     return (board_show_board(board_type, ch, arg, board));
   if (!is_number(number))	/* read 2.mail, look 2.sword */
     return (0);
@@ -5,6 +5,8 @@
 *  Copyright 2002-2003 Kip Potter                                         *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
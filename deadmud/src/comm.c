@@ -9,6 +9,7 @@
 **************************************************************************/
 
 #define __COMM_C__
+#define MEM_TAG MEM_OUTPUT
 
 #include "conf.h"
 #include "sysdep.h"
@@ -83,6 +84,8 @@
 #include "quest.h"
 #include "ibt.h" /* for free_ibt_lists */
 #include "mud_event.h"
+#include "mapfile.h"
+#include "slab.h"
 
 #ifndef INVALID_SOCKET
 #define INVALID_SOCKET (-1)
@@ -95,7 +98,7 @@ extern time_t newsmod;
 struct descriptor_data *descriptor_list = NULL;   /* master desc list */
 int buf_largecount = 0;   /* # of large buffers which exist */
 int buf_overflows = 0;    /* # of overflows of output */
-int buf_switches = 0;     /* # of switches from small to large buf */
+int buf_switches = 0;     /* # of switches to a larger buf */
 int circle_shutdown = 0;  /* clean shutdown */
 int circle_reboot = 0;    /* reboot the game after a shutdown */
 int no_specials = 0;      /* Suppress ass. of special routines */
@@ -109,7 +112,32 @@ int next_tick = SECS_PER_MUD_HOUR;  /* Tick countdown */
 long last_webster_teller = -1L;
 
 /* static local global variable declarations (current file scope only) */
-static struct txt_block *bufpool = 0;  /* pool of large output buffers */
+/* Output that outgrows a descriptor's small_outbuf moves to a buffer of the
+ * smallest class that holds it, and on to a larger class if it grows again.
+ * Sent buffers go back to the pool of their class, which keeps at most keep
+ * of them; a spike of output, a mass "who" say, leaves more than the game
+ * goes on to need, so every PULSE_BUFTRIM half of the buffers that sat in a
+ * pool the whole time are freed. */
+struct outbuf_class {
+  int size;                /* bytes in each buffer */
+  int keep;                /* most buffers kept in the pool */
+  struct txt_block *pool;  /* buffers free to hand out */
+  int free;                /* buffers in the pool */
+  int low;                 /* fewest in the pool since the last trim */
+  int in_use;              /* buffers held by descriptors */
+  int peak;                /* most in use at once */
+  long taken;              /* times a buffer was handed out */
+  long made;               /* buffers allocated */
+  long trimmed;            /* buffers freed while the game runs */
+};
+
+static struct outbuf_class outbuf_classes[] = {
+  { 4 * 1024, 32 },
+  { 8 * 1024, 16 },
+  { LARGE_BUFSIZE, 8 }
+};
+
+#define NUM_OUTBUF_CLASSES ((int) (sizeof(outbuf_classes) / sizeof(outbuf_classes[0])))
 static int max_players = 0;   /* max descriptors available */
 static int tics_passed = 0;     /* for extern checkpointing */
 static struct timeval null_time; /* zero-valued time structure */
@@ -155,6 +183,10 @@ static void init_descriptor (struct descriptor_data *newd, int desc);
 static struct in_addr *get_bind_addr(void);
 static int parse_ip(const char *addr, struct in_addr *inaddr);
 static int set_sendbuf(socket_t s);
+static struct txt_block *take_outbuf(int cls);
+static void release_outbuf(struct descriptor_data *t);
+static void grow_outbuf(struct descriptor_data *t, int need);
+static void trim_outbufs(void);
 static void free_bufpool(void);
 static void setup_log(const char *filename, int fd);
 static int open_logfile(const char *filename, FILE *stderr_fp);
@@ -277,6 +309,16 @@ int main(int argc, char **argv)
 	exit(1);
       }
       break;
+    case 'j':
+      if (*(argv[pos] + 2))
+	boot_threads = atoi(argv[pos] + 2);
+      else if (++pos < argc)
+	boot_threads = atoi(argv[pos]);
+      if (boot_threads < 1 || boot_threads > MAX_BOOT_THREADS) {
+	printf("SYSERR: Number of threads (1 to %d) expected after option -j.\n", MAX_BOOT_THREADS);
+	exit(1);
+      }
+      break;
     case 'm':
       mini_mud = 1;
       no_rent_check = 1;
@@ -286,6 +328,10 @@ int main(int argc, char **argv)
       scheck = 1;
       puts("Syntax check mode enabled.");
       break;
+    case 'p':
+      page_room_text = 1;
+      puts("Paging room descriptions in from the world.desc file.");
+      break;
     case 'q':
       no_rent_check = 1;
       puts("Quick boot mode -- rent check supressed.");
@@ -298,19 +344,26 @@ int main(int argc, char **argv)
       no_specials = 1;
       puts("Suppressing assignment of special routines.");
       break;
+    case 'S':
+      stdio_reads = 1;
+      puts("Reading world and player files through stdio.");
+      break;
     case 'h':
       /* From: Anil Mahajan. Do NOT use -C, this is the copyover mode and
        * without the proper copyover.dat file, the game will go nuts! */
-      printf("Usage: %s [-c] [-m] [-q] [-r] [-s] [-d pathname] [port #]\n"
+      printf("Usage: %s [-c] [-m] [-p] [-q] [-r] [-s] [-S] [-d pathname] [-j threads] [port #]\n"
               "  -c             Enable syntax check mode.\n"
               "  -d <directory> Specify library directory (defaults to 'lib').\n"
               "  -h             Print this command line argument help.\n"
+              "  -j <threads>   Read the world files on this many threads.\n"
               "  -m             Start in mini-MUD mode.\n"
 	      "  -f<file>       Use <file> for configuration.\n"
 	      "  -o <file>      Write log to <file> instead of stderr.\n"
+              "  -p             Page room descriptions in from a mapped file.\n"
               "  -q             Quick boot (doesn't scan rent for object limits)\n"
               "  -r             Restrict MUD -- no new players allowed.\n"
               "  -s             Suppress special procedure assignments.\n"
+              "  -S             Read world and player files through stdio, not maps.\n"
               " Note:		These arguments are 'CaSe SeNsItIvE!!!'\n",
 		 argv[0]
       );
@@ -324,7 +377,7 @@ int main(int argc, char **argv)
 
   if (pos < argc) {
     if (!isdigit(*argv[pos])) {
-      printf("Usage: %s [-c] [-m] [-q] [-r] [-s] [-d pathname] [port #]\n", argv[0]);
+      printf("Usage: %s [-c] [-m] [-p] [-q] [-r] [-s] [-S] [-d pathname] [-j threads] [port #]\n", argv[0]);
       exit(1);
     } else if ((port = atoi(argv[pos])) <= 1024) {
       printf("SYSERR: Illegal port number %d.\n", port);
@@ -447,7 +500,7 @@ void copyover_recover()
     CopyoverSet(d,guiopt);
 
     /* Now, find the pfile */
-    CREATE(d->character, struct char_data, 1);
+    SLAB_CREATE(d->character, struct char_data, char_slab);
     clear_char(d->character);
     CREATE(d->character->player_specials, struct player_special_data, 1);
     
@@ -981,6 +1034,8 @@ void heartbeat(int heart_pulse)
   if (!(heart_pulse % PULSE_ZONE))
     zone_update();
 
+  run_zone_resets();
+
   if (!(heart_pulse % PULSE_IDLEPWD))		/* 15 seconds */
     check_idle_passwords();
 
@@ -1010,6 +1065,9 @@ void heartbeat(int heart_pulse)
   if (!(heart_pulse % PULSE_USAGE))
     record_usage();
 
+  if (!(heart_pulse % PULSE_BUFTRIM))
+    trim_outbufs();
+
   if (!(heart_pulse % PULSE_TIMESAVE))
   save_mud_time(&time_info);
 
@@ -1068,6 +1126,7 @@ static void record_usage(void)
 
   log("nusage: %-3d sockets connected, %-3d sockets playing",
 	  sockets_connected, sockets_playing);
+  log_mem_stats();
 
 #ifdef RUSAGE	/* Not RUSAGE_SELF because it doesn't guarantee prototype. */
   {
@@ -1210,7 +1269,7 @@ void write_to_q(const char *txt, struct txt_q *queue, int aliased)
 {
   struct txt_block *newt;
 
-  CREATE(newt, struct txt_block, 1);
+  SLAB_CREATE(newt, struct txt_block, txt_slab);
   newt->text = strdup(txt);
   newt->aliased = aliased;
 
@@ -1240,7 +1299,7 @@ static int get_from_q(struct txt_q *queue, char *dest, int *aliased)
   tmp = queue->head;
   queue->head = queue->head->next;
   free(tmp->text);
-  free(tmp);
+  slab_free(&txt_slab, tmp);
 
   return (1);
 }
@@ -1248,15 +1307,12 @@ static int get_from_q(struct txt_q *queue, char *dest, int *aliased)
 /* Empty the queues before closing connection */
 static void flush_queues(struct descriptor_data *d)
 {
-  if (d->large_outbuf) {
-    d->large_outbuf->next = bufpool;
-    bufpool = d->large_outbuf;
-  }
+  release_outbuf(d);
   while (d->input.head) {
     struct txt_block *tmp = d->input.head;
     d->input.head = d->input.head->next;
     free(tmp->text);
-    free(tmp);
+    slab_free(&txt_slab, tmp);
   }
 }
 
@@ -1307,51 +1363,147 @@ size_t vwrite_to_output(struct descriptor_data *t, const char *format, va_list a
     buf_overflows++;
   }
 
-  /* If we have enough space, just write to buffer and that's it! If the
-   * text just barely fits, then it's switched to a large buffer instead. */
-  if (t->bufspace > size) {
-    strcpy(t->output + t->bufptr, txt);	/* strcpy: OK (size checked above) */
-    t->bufspace -= size;
-    t->bufptr += size;
-    return (t->bufspace);
-  }
+  /* If the text does not fit, or just barely fits, move to a larger buffer
+   * first. The largest is LARGE_BUFSIZE, which holds it after the above. */
+  if (t->bufspace <= size)
+    grow_outbuf(t, t->bufptr + size + 1);
 
-  buf_switches++;
+  strcpy(t->output + t->bufptr, txt);	/* strcpy: OK (size checked above) */
+  t->bufspace -= size;
+  t->bufptr += size;
 
-  /* if the pool has a buffer in it, grab it */
-  if (bufpool != NULL) {
-    t->large_outbuf = bufpool;
-    bufpool = bufpool->next;
-  } else {			/* else create a new one */
-    CREATE(t->large_outbuf, struct txt_block, 1);
-    CREATE(t->large_outbuf->text, char, LARGE_BUFSIZE);
+  return (t->bufspace);
+}
+
+static struct txt_block *take_outbuf(int cls)
+{
+  struct outbuf_class *oc = &outbuf_classes[cls];
+  struct txt_block *buf;
+
+  if ((buf = oc->pool) != NULL) {
+    oc->pool = buf->next;
+    if (--oc->free < oc->low)
+      oc->low = oc->free;
+  } else {
+    CREATE(buf, struct txt_block, 1);
+    CREATE(buf->text, char, oc->size);
+    oc->made++;
     buf_largecount++;
   }
 
-  strcpy(t->large_outbuf->text, t->output);	/* strcpy: OK (size checked previously) */
-  t->output = t->large_outbuf->text;	/* make big buffer primary */
-  strcat(t->output, txt);	/* strcat: OK (size checked) */
+  oc->taken++;
+  if (++oc->in_use > oc->peak)
+    oc->peak = oc->in_use;
 
-  /* set the pointer for the next write */
-  t->bufptr = strlen(t->output);
+  return (buf);
+}
 
-  /* calculate how much space is left in the buffer */
-  t->bufspace = LARGE_BUFSIZE - 1 - t->bufptr;
+static void free_outbuf(struct txt_block *buf)
+{
+  free(buf->text);
+  free(buf);
+  buf_largecount--;
+}
 
-  return (t->bufspace);
+/* Gives back the buffer t writes to, if it is not its small_outbuf. */
+static void release_outbuf(struct descriptor_data *t)
+{
+  struct outbuf_class *oc;
+
+  if (!t->large_outbuf)
+    return;
+
+  oc = &outbuf_classes[t->outbuf_class];
+  oc->in_use--;
+  if (oc->free < oc->keep) {
+    t->large_outbuf->next = oc->pool;
+    oc->pool = t->large_outbuf;
+    oc->free++;
+  } else {
+    free_outbuf(t->large_outbuf);
+    oc->trimmed++;
+  }
+
+  t->large_outbuf = NULL;
+  t->output = t->small_outbuf;
+}
+
+/* Moves the output of t to the smallest class of buffer with more than need
+ * bytes, and larger than the one it has. Past the largest class, t keeps
+ * what it has. */
+static void grow_outbuf(struct descriptor_data *t, int need)
+{
+  struct txt_block *buf;
+  int cls = t->large_outbuf ? t->outbuf_class + 1 : 0;
+
+  if (cls >= NUM_OUTBUF_CLASSES)
+    return;
+  while (cls < NUM_OUTBUF_CLASSES - 1 && outbuf_classes[cls].size <= need)
+    cls++;
+
+  buf = take_outbuf(cls);
+  strcpy(buf->text, t->output);	/* strcpy: OK (the new class is larger) */
+  release_outbuf(t);
+
+  t->large_outbuf = buf;
+  t->outbuf_class = cls;
+  t->output = buf->text;
+  t->bufptr = strlen(t->output);
+  t->bufspace = outbuf_classes[cls].size - 1 - t->bufptr;
+  buf_switches++;
+}
+
+/* Frees half of the buffers no descriptor needed since the last trim. */
+static void trim_outbufs(void)
+{
+  struct outbuf_class *oc;
+  struct txt_block *buf;
+  int cls, idle;
+
+  for (cls = 0; cls < NUM_OUTBUF_CLASSES; cls++) {
+    oc = &outbuf_classes[cls];
+    for (idle = (oc->low + 1) / 2; idle > 0 && oc->pool; idle--) {
+      buf = oc->pool;
+      oc->pool = buf->next;
+      oc->free--;
+      free_outbuf(buf);
+      oc->trimmed++;
+    }
+    oc->low = oc->free;
+  }
 }
 
 static void free_bufpool(void)
 {
-  struct txt_block *tmp;
+  struct txt_block *buf;
+  int cls;
 
-  while (bufpool) {
-    tmp = bufpool->next;
-    if (bufpool->text)
-      free(bufpool->text);
-    free(bufpool);
-    bufpool = tmp;
+  for (cls = 0; cls < NUM_OUTBUF_CLASSES; cls++)
+    while ((buf = outbuf_classes[cls].pool) != NULL) {
+      outbuf_classes[cls].pool = buf->next;
+      free_outbuf(buf);
+    }
+}
+
+void show_outbuf_pools(struct char_data *ch)
+{
+  struct outbuf_class *oc;
+  long bytes = 0;
+  int cls;
+
+  send_to_char(ch, "\r\nOutput buffers  Size  In use    Peak    Free Keep     Taken    Made  Trimmed\r\n"
+                   "-------------- ----- ------- ------- ------- ---- --------- ------- --------\r\n");
+
+  for (cls = 0; cls < NUM_OUTBUF_CLASSES; cls++) {
+    oc = &outbuf_classes[cls];
+    send_to_char(ch, "%-14d %5d %7d %7d %7d %4d %9ld %7ld %8ld\r\n", cls + 1,
+                 oc->size, oc->in_use, oc->peak, oc->free, oc->keep,
+                 oc->taken, oc->made, oc->trimmed);
+    bytes += (long) (oc->in_use + oc->free) * oc->size;
   }
+
+  send_to_char(ch, "Total: %d buffers, %ldKB. %d switches to a larger buffer, %d overflows.\r\n",
+               buf_largecount, bytes / 1024, buf_switches, buf_overflows);
 }
 
 /*  socket handling */
@@ -1593,12 +1745,7 @@ static int process_output(struct descriptor_data *t)
   if (result >= t->bufptr) {
     /* If we were using a large buffer, put the large buffer on the buffer pool
      * and switch back to the small one. */
-    if (t->large_outbuf) {
-      t->large_outbuf->next = bufpool;
-      bufpool = t->large_outbuf;
-      t->large_outbuf = NULL;
-      t->output = t->small_outbuf;
-    }
+    release_outbuf(t);
     /* reset total bufspace back to that of a small buffer */
     t->bufspace = SMALL_BUFSIZE - 1;
     t->bufptr = 0;
@@ -1611,8 +1758,8 @@ static int process_output(struct descriptor_data *t)
       size_t savetextlen = strlen(osb + result);
 
       strcat(t->output, osb + result);
-      t->bufptr   -= savetextlen;
-      t->bufspace += savetextlen;
+      t->bufptr   += savetextlen;
+      t->bufspace -= savetextlen;
     }
 
   } else {
@@ -58,6 +58,7 @@ void echo_off(struct descriptor_data *d);
 void echo_on(struct descriptor_data *d);
 void game_loop(socket_t mother_desc);
 void heartbeat(int heart_pulse);
+void show_outbuf_pools(struct char_data *ch);
 void copyover_recover(void);
 
 /* global buffering system - allow access to global variables within comm.c */
@@ -30,6 +30,7 @@
 #include "spec_procs.h"
 #include "genzon.h"
 #include "genolc.h"
+#include "genmob.h" /* for copy_mobile_strings */
 #include "genobj.h" /* for free_object_strings */
 #include "config.h" /* for the default config values. */
 #include "fight.h"
@@ -38,9 +39,22 @@
 #include "quest.h"
 #include "ibt.h"
 #include "mud_event.h"
+#include "worldsnap.h"
+#include "strpool.h"
+#include "descstore.h"
+#include "mapfile.h"
+#include "nameindex.h"
 #include "msgedit.h"
+#include "slab.h"
 #include <sys/stat.h>
 
+/* The world files can be read on several threads, see parse_world_files().
+ * zmalloc keeps its tables unlocked, so not with MEMORY_DEBUG. */
+#if defined(CIRCLE_UNIX) && !defined(MEMORY_DEBUG)
+#define PARALLEL_BOOT
+#include <pthread.h>
+#endif
+
 /*  declarations of most of the 'global' variables */
 struct config_data config_info; /* Game configuration list.	 */
 
@@ -84,6 +98,8 @@ int top_shop = -1;              /* top of shop table             */
 
 int no_mail = 0;                /* mail disabled?		 */
 int mini_mud = 0;               /* mini-mud mode?		 */
+int boot_threads = 0;           /* threads reading world files	 */
+int page_room_text = 0;         /* room descriptions in world.desc	 */
 int no_rent_check = 0;          /* skip rent check on boot?	 */
 time_t boot_time = 0;           /* time of mud boot		 */
 int circle_restrict = 0;        /* level of game restriction	 */
@@ -127,6 +143,29 @@ struct happyhour happy_data = {0,0,0,0};
 /* declaration of local (file scope) variables */
 static int converting = FALSE;
 
+/* modes positions correspond to DB_BOOT_xxx in db.h */
+static const char *boot_modes[] = {"world", "mob", "obj", "ZON", "SHP", "HLP", "trg", "qst"};
+/* What the memory read for each type is counted against, see memacct.c. */
+static const int boot_mem_tags[] = {MEM_WORLD, MEM_PROTO, MEM_PROTO, MEM_WORLD,
+  MEM_PROTO, MEM_OTHER, MEM_SCRIPT, MEM_PROTO};
+/* How long index_boot() took for each type, for "show reading". */
+static long boot_read_msecs[DB_BOOT_QST + 1];
+static int boot_read_world = FALSE;
+
+/* One world file of a parallel boot, and where its records go. */
+struct parse_job {
+  char filename[PATH_MAX];
+  int mode;           /* DB_BOOT_WLD, DB_BOOT_MOB or DB_BOOT_OBJ */
+  int first;          /* first slot of its records in the world or proto table */
+  int used;           /* records read so far */
+  char *msgs;         /* messages logged while reading it, each NUL terminated */
+  size_t msgs_len, msgs_size;
+  struct mem_stats mem[NUM_MEM_TAGS];  /* memory its thread took and gave back */
+};
+
+static struct parse_job *parse_jobs = NULL;
+static int num_parse_jobs = 0;
+
 /* Local (file scope) utility functions */
 static int check_bitvector_names(bitvector_t bits, size_t namecount, const char *whatami, const char *whatbits);
 static int check_object_spell_number(struct obj_data *obj, int val);
@@ -136,16 +175,29 @@ static void load_zones(FILE *fl, char *zonename);
 static int file_to_string(const char *name, char *buf);
 static int file_to_string_alloc(const char *name, char **buf);
 static int count_alias_records(FILE *fl);
-static void parse_simple_mob(FILE *mob_f, int i, int nr);
+static void discrete_load_to(struct map_file *fl, int mode, char *filename, struct parse_job *job);
+static void set_room_zone(room_rnum room_nr);
+static void parse_room_at(struct map_file *fl, room_rnum room_nr);
+static void parse_mobile_at(struct map_file *mob_f, int nr, int i);
+static void parse_object_at(struct map_file *obj_f, int nr, int i, char *line);
+static void lower_article(char *str);
+static void mark_converted(int vnum, int type);
+static long boot_msecs(struct timeval *start);
+#ifdef PARALLEL_BOOT
+static void parse_world_files(int slots);
+#endif
+static void parse_simple_mob(struct map_file *mob_f, int i, int nr);
 static void interpret_espec(const char *keyword, const char *value, int i, int nr);
 static void parse_espec(char *buf, int i, int nr);
-static void parse_enhanced_mob(FILE *mob_f, int i, int nr);
+static void parse_enhanced_mob(struct map_file *mob_f, int i, int nr);
 static void get_one_line(FILE *fl, char *buf);
 static void check_start_rooms(void);
 static void renum_zone_table(void);
 static void log_zone_error(zone_rnum zone, int cmd_no, const char *message);
+static int run_zone_commands(zone_rnum zone, int *pcmd_no, int *plast_cmd, struct timeval *deadline);
+static void end_zone_reset(zone_rnum zone, long usecs, int pulses);
+static int past_deadline(struct timeval *deadline);
 static void reset_time(void);
-static char fread_letter(FILE *fp);
 static void free_followers(struct follow_type *k);
 static void load_default_config( void );
 static void free_extra_descriptions(struct extra_descr_data *edesc);
@@ -426,8 +478,26 @@ ACMD(do_reboot)
   send_to_char(ch, "%s", CONFIG_OK);
 }
 
+static void log_string_pool(void)
+{
+  int strings;
+  long refs, bytes, saved;
+
+  str_pool_stats(&strings, &refs, &bytes, &saved);
+  log("   %d distinct strings for %ld references, %ld bytes saved.", strings, refs, saved);
+}
+
 void boot_world(void)
 {
+  if (load_world_snapshot()) {
+    log_string_pool();
+    log("Checking start rooms.");
+    check_start_rooms();
+    if (page_room_text)
+      page_room_descriptions();
+    return;
+  }
+
   log("Loading zone table.");
   index_boot(DB_BOOT_ZON);
 
@@ -451,6 +521,7 @@ void boot_world(void)
 
   log("Renumbering zone table.");
   renum_zone_table();
+  log_string_pool();
 
   if(converting) {
     log("Saving 128bit world files to disk.");
@@ -465,6 +536,11 @@ void boot_world(void)
   log("Loading quests.");
   index_boot(DB_BOOT_QST);
 
+  if (!converting)
+    save_world_snapshot();
+
+  if (page_room_text && !scheck)
+    page_room_descriptions();
 }
 
 static void free_extra_descriptions(struct extra_descr_data *edesc)
@@ -474,8 +550,8 @@ static void free_extra_descriptions(struct extra_descr_data *edesc)
   for (; edesc; edesc = enext) {
     enext = edesc->next;
 
-    free(edesc->keyword);
-    free(edesc->description);
+    str_release(edesc->keyword);
+    str_release(edesc->description);
     free(edesc);
   }
 }
@@ -505,10 +581,8 @@ void destroy_db(void)
 
   /* Rooms */
   for (cnt = 0; cnt <= top_of_world; cnt++) {
-    if (world[cnt].name)
-      free(world[cnt].name);
-    if (world[cnt].description)
-      free(world[cnt].description);
+    str_release(world[cnt].name);
+    str_release(world[cnt].description);
     free_extra_descriptions(world[cnt].ex_description);
 
   if (world[cnt].events != NULL) {
@@ -532,26 +606,21 @@ void destroy_db(void)
       if (!world[cnt].dir_option[itr])
         continue;
 
-      if (world[cnt].dir_option[itr]->general_description)
-        free(world[cnt].dir_option[itr]->general_description);
-      if (world[cnt].dir_option[itr]->keyword)
-        free(world[cnt].dir_option[itr]->keyword);
+      str_release(world[cnt].dir_option[itr]->general_description);
+      str_release(world[cnt].dir_option[itr]->keyword);
       free(world[cnt].dir_option[itr]);
     }
   }
   free(world);
   top_of_world = 0;
+  free_desc_store();
 
   /* Objects */
   for (cnt = 0; cnt <= top_of_objt; cnt++) {
-    if (obj_proto[cnt].name)
-      free(obj_proto[cnt].name);
-    if (obj_proto[cnt].description)
-      free(obj_proto[cnt].description);
-    if (obj_proto[cnt].short_description)
-      free(obj_proto[cnt].short_description);
-    if (obj_proto[cnt].action_description)
-      free(obj_proto[cnt].action_description);
+    str_release(obj_proto[cnt].name);
+    str_release(obj_proto[cnt].description);
+    str_release(obj_proto[cnt].short_description);
+    str_release(obj_proto[cnt].action_description);
     free_extra_descriptions(obj_proto[cnt].ex_description);
 
     /* free script proto list */
@@ -562,16 +631,11 @@ void destroy_db(void)
 
   /* Mobiles */
   for (cnt = 0; cnt <= top_of_mobt; cnt++) {
-    if (mob_proto[cnt].player.name)
-      free(mob_proto[cnt].player.name);
-    if (mob_proto[cnt].player.title)
-      free(mob_proto[cnt].player.title);
-    if (mob_proto[cnt].player.short_descr)
-      free(mob_proto[cnt].player.short_descr);
-    if (mob_proto[cnt].player.long_descr)
-      free(mob_proto[cnt].player.long_descr);
-    if (mob_proto[cnt].player.description)
-      free(mob_proto[cnt].player.description);
+    str_release(mob_proto[cnt].player.name);
+    str_release(mob_proto[cnt].player.title);
+    str_release(mob_proto[cnt].player.short_descr);
+    str_release(mob_proto[cnt].player.long_descr);
+    str_release(mob_proto[cnt].player.description);
 
     /* free script proto list */
     free_proto_script(&mob_proto[cnt], MOB_TRIGGER);
@@ -635,6 +699,7 @@ void destroy_db(void)
           j = i->next;
           if (i->cmd)
             free(i->cmd);
+          free_dg_expr(i->expr);
           free(i);
           i = j;
         }
@@ -645,6 +710,13 @@ void destroy_db(void)
   }
   free(trig_index);
 
+  /* Vnum lookup tables */
+  free_vnum_index();
+  free_name_index();
+
+  /* Everything from the slab pools has been given back by now. */
+  free_slab_pools();
+
   /* Events */
   event_free_all();
 
@@ -692,7 +764,9 @@ void boot_db(void)
   index_boot(DB_BOOT_HLP);
 
   log("Generating player index.");
+  mem_tag = MEM_PLAYER;
   build_player_index();
+  mem_tag = MEM_OTHER;
 
   if (auto_pwipe) {
     log("Cleaning out inactive pfiles.");
@@ -913,8 +987,10 @@ void index_boot(int mode)
 {
   const char *index_filename, *prefix = NULL;	/* NULL or egcs 1.1 complains */
   FILE *db_index, *db_file;
-  int rec_count = 0, size[2], i;
+  struct map_file *mf;
+  int rec_count = 0, size[2], i, files = 0, parallel = FALSE, old_tag;
   char buf2[PATH_MAX], buf1[MAX_STRING_LENGTH];
+  struct timeval start;
 
   switch (mode) {
   case DB_BOOT_WLD:
@@ -951,31 +1027,62 @@ void index_boot(int mode)
   else
     index_filename = INDEX_FILE;
 
+  gettimeofday(&start, NULL);
+
   snprintf(buf2, sizeof(buf2), "%s%s", prefix, index_filename);
   if (!(db_index = fopen(buf2, "r"))) {
     log("SYSERR: opening index file '%s': %s", buf2, strerror(errno));
     exit(1);
   }
 
+  /* Rooms, mobs and objects are independent until renumbered, so their files
+   * can be read in parallel; each file gets the slots it counted here. */
+  if (boot_threads > 1 && (mode == DB_BOOT_WLD || mode == DB_BOOT_MOB || mode == DB_BOOT_OBJ)) {
+#ifdef PARALLEL_BOOT
+    parallel = TRUE;
+#else
+    log("Reading world files on one thread, threads are not supported by this build.");
+#endif
+  }
+
   /* first, count the number of records in the file so we can malloc */
   i = fscanf(db_index, "%s\n", buf1);
   while (*buf1 != '$') {
     snprintf(buf2, sizeof(buf2), "%s%s", prefix, buf1);
-    if (!(db_file = fopen(buf2, "r"))) {
-      log("SYSERR: File '%s' listed in '%s/%s': %s", buf2, prefix,
-	  index_filename, strerror(errno));
-      i = fscanf(db_index, "%s\n", buf1);
-      continue;
-    } else {
+    files++;
+    if (parallel) {
+      /* A file that cannot be opened keeps its job, reading it fails later. */
+      RECREATE(parse_jobs, struct parse_job, num_parse_jobs + 1);
+      memset(&parse_jobs[num_parse_jobs], 0, sizeof(struct parse_job));
+      strlcpy(parse_jobs[num_parse_jobs].filename, buf2, PATH_MAX);
+      parse_jobs[num_parse_jobs].mode = mode;
+      parse_jobs[num_parse_jobs++].first = rec_count;
+    }
+    /* Zones, help and shops are read through stdio. */
+    if (mode == DB_BOOT_ZON || mode == DB_BOOT_HLP || mode == DB_BOOT_SHP) {
+      if (!(db_file = fopen(buf2, "r"))) {
+        log("SYSERR: File '%s' listed in '%s/%s': %s", buf2, prefix,
+	    index_filename, strerror(errno));
+        i = fscanf(db_index, "%s\n", buf1);
+        continue;
+      }
       if (mode == DB_BOOT_ZON)
 	rec_count++;
       else if (mode == DB_BOOT_HLP)
 	rec_count += count_alias_records(db_file);
       else
 	rec_count += count_hash_records(db_file);
+      fclose(db_file);
+    } else if (!(mf = mf_open(buf2))) {
+      log("SYSERR: File '%s' listed in '%s/%s': %s", buf2, prefix,
+	  index_filename, strerror(errno));
+      i = fscanf(db_index, "%s\n", buf1);
+      continue;
+    } else {
+      rec_count += mf_count_hash_records(mf);
+      mf_close(mf);
     }
 
-    fclose(db_file);
     i = fscanf(db_index, "%s\n", buf1);
   }
 
@@ -988,6 +1095,9 @@ void index_boot(int mode)
     exit(1);
   }
 
+  old_tag = mem_tag;
+  mem_tag = boot_mem_tags[mode];
+
   /* "bytes" does _not_ include strings or other later malloc'd things. */
   switch (mode) {
   case DB_BOOT_TRG:
@@ -1031,32 +1141,41 @@ void index_boot(int mode)
 
   rewind(db_index);
   i = fscanf(db_index, "%s\n", buf1);
+#ifdef PARALLEL_BOOT
+  if (parallel) {
+    parse_world_files(rec_count);
+    *buf1 = '$';
+  }
+#endif
   while (*buf1 != '$') {
     snprintf(buf2, sizeof(buf2), "%s%s", prefix, buf1);
-    if (!(db_file = fopen(buf2, "r"))) {
-      log("SYSERR: %s: %s", buf2, strerror(errno));
-      exit(1);
-    }
-    switch (mode) {
-    case DB_BOOT_WLD:
-    case DB_BOOT_OBJ:
-    case DB_BOOT_MOB:
-    case DB_BOOT_TRG:
-    case DB_BOOT_QST:
-      discrete_load(db_file, mode, buf2);
-      break;
-    case DB_BOOT_ZON:
-      load_zones(db_file, buf2);
-      break;
-    case DB_BOOT_HLP:
-      load_help(db_file, buf2);
-      break;
-    case DB_BOOT_SHP:
-      boot_the_shops(db_file, buf2, rec_count);
-      break;
+    if (mode == DB_BOOT_ZON || mode == DB_BOOT_HLP || mode == DB_BOOT_SHP) {
+      if (!(db_file = fopen(buf2, "r"))) {
+        log("SYSERR: %s: %s", buf2, strerror(errno));
+        exit(1);
+      }
+      switch (mode) {
+      case DB_BOOT_ZON:
+        load_zones(db_file, buf2);
+        break;
+      case DB_BOOT_HLP:
+        load_help(db_file, buf2);
+        break;
+      case DB_BOOT_SHP:
+        boot_the_shops(db_file, buf2, rec_count);
+        break;
+      }
+      fclose(db_file);
+    } else {
+      /* Rooms, mobs, objects, triggers and quests */
+      if (!(mf = mf_open(buf2))) {
+        log("SYSERR: %s: %s", buf2, strerror(errno));
+        exit(1);
+      }
+      discrete_load(mf, mode, buf2);
+      mf_close(mf);
     }
 
-    fclose(db_file);
     i = fscanf(db_index, "%s\n", buf1);
   }
   fclose(db_index);
@@ -1065,21 +1184,51 @@ void index_boot(int mode)
   if (mode == DB_BOOT_HLP) {
     qsort(help_table, top_of_helpt, sizeof(struct help_index_element), hsort);
   }
+
+  /* Rooms get their scripts once they are all read, in order. */
+  if (mode == DB_BOOT_WLD)
+    for (i = 0; i <= top_of_world; i++)
+      assign_triggers(&world[i], WLD_TRIGGER);
+
+  if (mode == DB_BOOT_WLD || mode == DB_BOOT_MOB || mode == DB_BOOT_OBJ ||
+      mode == DB_BOOT_ZON || mode == DB_BOOT_QST)
+    index_vnums(mode, 0);
+
+  /* The workers above must not touch the string pool, so the text is pooled
+   * here, once everything is read. */
+  if (mode == DB_BOOT_WLD || mode == DB_BOOT_MOB || mode == DB_BOOT_OBJ)
+    pool_world_strings(mode);
+
+  boot_read_msecs[mode] = boot_msecs(&start);
+  if (mode == DB_BOOT_WLD)
+    boot_read_world = TRUE;
+  if (parallel)
+    log("   %d %s files read in %ld ms on %d threads.", files, boot_modes[mode],
+        boot_read_msecs[mode], MIN(boot_threads, files));
+  else
+    log("   %d %s files read in %ld ms.", files, boot_modes[mode], boot_read_msecs[mode]);
+
+  mem_tag = old_tag;
+}
+
+void discrete_load(struct map_file *fl, int mode, char *filename)
+{
+  discrete_load_to(fl, mode, filename, NULL);
 }
 
-void discrete_load(FILE *fl, int mode, char *filename)
+/* Reads the records of one file, after the ones read before it, or into the
+ * slots of job if one is given. */
+static void discrete_load_to(struct map_file *fl, int mode, char *filename, struct parse_job *job)
 {
   int nr = -1, last;
   char line[READ_SIZE];
-
-  const char *modes[] = {"world", "mob", "obj", "ZON", "SHP", "HLP", "trg", "qst"};
-  /* modes positions correspond to DB_BOOT_xxx in db.h */
+  const char **modes = boot_modes;
 
   for (;;) {
     /* We have to do special processing with the obj files because they have no
      * end-of-record marker. */
     if (mode != DB_BOOT_OBJ || nr < 0)
-      if (!get_line(fl, line)) {
+      if (!mf_get_line(fl, line)) {
 	if (nr == -1) {
 	  log("SYSERR: %s file %s is empty!", modes[mode], filename);
 	} else {
@@ -1104,16 +1253,26 @@ void discrete_load(FILE *fl, int mode, char *filename)
       else
 	switch (mode) {
 	case DB_BOOT_WLD:
-	  parse_room(fl, nr);
+	  if (job) {
+	    world[job->first + job->used].number = nr;
+	    parse_room_at(fl, job->first + job->used++);
+	  } else
+	    parse_room(fl, nr);
 	  break;
 	case DB_BOOT_MOB:
-	  parse_mobile(fl, nr);
+	  if (job)
+	    parse_mobile_at(fl, nr, job->first + job->used++);
+	  else
+	    parse_mobile(fl, nr);
 	  break;
         case DB_BOOT_TRG:
           parse_trigger(fl, nr);
           break;
 	case DB_BOOT_OBJ:
-	  strlcpy(line, parse_object(fl, nr), sizeof(line));
+	  if (job)
+	    parse_object_at(fl, nr, job->first + job->used++, line);
+	  else
+	    strlcpy(line, parse_object(fl, nr), sizeof(line));
 	  break;
   case DB_BOOT_QST:
     parse_quest(fl, nr);
@@ -1128,13 +1287,228 @@ void discrete_load(FILE *fl, int mode, char *filename)
   }
 }
 
-static char fread_letter(FILE *fp)
+static long boot_msecs(struct timeval *start)
 {
-  char c;
-  do {
-    c = getc(fp);
-  } while (isspace(c));
-  return c;
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+  return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_usec - start->tv_usec) / 1000;
+}
+
+#ifdef PARALLEL_BOOT
+/* Guards the job queue, the messages of the jobs and the save list. */
+static pthread_mutex_t parse_lock = PTHREAD_MUTEX_INITIALIZER;
+/* The job a boot thread is reading, NULL on any other thread. */
+static pthread_key_t parse_job_key;
+static int next_parse_job = 0;
+static int parse_merging = FALSE;
+
+/* Keeps what a boot thread logs with the file it is reading, so that the log
+ * reads as if the files were read one after another. */
+static int parse_log_hook(const char *format, va_list args)
+{
+  struct parse_job *job = pthread_getspecific(parse_job_key);
+  char msg[MAX_STRING_LENGTH];
+  size_t len;
+
+  if (!job)
+    return (FALSE);
+
+  vsnprintf(msg, sizeof(msg), format, args);
+  len = strlen(msg) + 1;
+
+  pthread_mutex_lock(&parse_lock);
+  if (job->msgs_len + len > job->msgs_size) {
+    job->msgs_size = MAX(job->msgs_size * 2, job->msgs_len + len);
+    RECREATE(job->msgs, char, job->msgs_size);
+  }
+  memcpy(job->msgs + job->msgs_len, msg, len);
+  job->msgs_len += len;
+  pthread_mutex_unlock(&parse_lock);
+
+  return (TRUE);
+}
+
+/* Boot threads count their memory with their job, so they need no lock. */
+static struct mem_stats *parse_mem_hook(void)
+{
+  struct parse_job *job = pthread_getspecific(parse_job_key);
+
+  return (job ? job->mem : NULL);
+}
+
+static void flush_job_msgs(struct parse_job *job)
+{
+  size_t pos;
+
+  for (pos = 0; pos < job->msgs_len; pos += strlen(job->msgs + pos) + 1)
+    log("%s", job->msgs + pos);
+
+  if (job->msgs)
+    free(job->msgs);
+  job->msgs = NULL;
+  job->msgs_len = job->msgs_size = 0;
+}
+
+/* A boot thread called exit() on a bad file. Log what the files up to that
+ * one had to say, as a boot on one thread would have, and nothing after. The
+ * lock is kept so the other threads stay quiet until the process is gone. */
+static void flush_parse_jobs(void)
+{
+  struct parse_job *failed;
+  int i;
+
+  if (!parse_jobs || parse_merging)
+    return;
+
+  pthread_mutex_lock(&parse_lock);
+  failed = pthread_getspecific(parse_job_key);
+  pthread_setspecific(parse_job_key, NULL);
+
+  for (i = 0; i < num_parse_jobs; i++) {
+    flush_job_msgs(&parse_jobs[i]);
+    if (&parse_jobs[i] == failed)
+      break;
+  }
+}
+
+static void *parse_worker(void *unused)
+{
+  struct parse_job *job;
+  struct map_file *fl;
+
+  for (;;) {
+    pthread_mutex_lock(&parse_lock);
+    job = next_parse_job < num_parse_jobs ? &parse_jobs[next_parse_job++] : NULL;
+    pthread_mutex_unlock(&parse_lock);
+
+    if (!job)
+      break;
+
+    pthread_setspecific(parse_job_key, job);
+    if (!(fl = mf_open(job->filename))) {
+      log("SYSERR: %s: %s", job->filename, strerror(errno));
+      exit(1);
+    }
+    discrete_load_to(fl, job->mode, job->filename, job);
+    mf_close(fl);
+  }
+
+  pthread_setspecific(parse_job_key, NULL);
+  return (NULL);
+}
+
+/* Reads the files queued in parse_jobs on boot_threads threads, each into the
+ * slots index_boot() counted for it. Then closes the gaps left by miscounts,
+ * in file order, and finishes what needs the final table: room zones and the
+ * rnums the prototypes keep of themselves. */
+static void parse_world_files(int slots)
+{
+  static int key_made = FALSE;
+  pthread_t threads[MAX_BOOT_THREADS];
+  struct parse_job *job;
+  int mode = parse_jobs[0].mode, top = 0, i, j, n, err;
+
+  if (!key_made) {
+    pthread_key_create(&parse_job_key, NULL);
+    atexit(flush_parse_jobs);
+    key_made = TRUE;
+  }
+
+  next_parse_job = 0;
+  log_hook = parse_log_hook;
+  mem_stats_hook = parse_mem_hook;
+
+  /* This thread reads files too. */
+  for (n = 0; n < MIN(boot_threads, num_parse_jobs) - 1; n++)
+    if ((err = pthread_create(&threads[n], NULL, parse_worker, NULL)) != 0) {
+      log("SYSERR: Could not start boot thread %d: %s", n + 1, strerror(err));
+      break;
+    }
+  parse_worker(NULL);
+  for (i = 0; i < n; i++)
+    pthread_join(threads[i], NULL);
+
+  log_hook = NULL;
+  mem_stats_hook = NULL;
+  parse_merging = TRUE;
+
+  for (i = 0; i < num_parse_jobs; i++) {
+    job = &parse_jobs[i];
+    flush_job_msgs(job);
+    mem_merge_stats(job->mem);
+
+    switch (mode) {
+    case DB_BOOT_WLD:
+      memmove(world + top, world + job->first, job->used * sizeof(struct room_data));
+      for (j = top; j < top + job->used; j++)
+        set_room_zone(j);
+      break;
+    case DB_BOOT_MOB:
+      memmove(mob_proto + top, mob_proto + job->first, job->used * sizeof(struct char_data));
+      memmove(mob_index + top, mob_index + job->first, job->used * sizeof(struct index_data));
+      for (j = top; j < top + job->used; j++)
+        mob_proto[j].nr = j;
+      break;
+    case DB_BOOT_OBJ:
+      memmove(obj_proto + top, obj_proto + job->first, job->used * sizeof(struct obj_data));
+      memmove(obj_index + top, obj_index + job->first, job->used * sizeof(struct index_data));
+      for (j = top; j < top + job->used; j++)
+        obj_proto[j].item_number = j;
+      break;
+    }
+    top += job->used;
+  }
+
+  /* What a boot on one thread leaves of unused slots: zeroes. */
+  switch (mode) {
+  case DB_BOOT_WLD:
+    memset(world + top, 0, (slots - top) * sizeof(struct room_data));
+    top_of_world = top - 1;
+    break;
+  case DB_BOOT_MOB:
+    memset(mob_proto + top, 0, (slots - top) * sizeof(struct char_data));
+    memset(mob_index + top, 0, (slots - top) * sizeof(struct index_data));
+    top_of_mobt = top - 1;
+    break;
+  case DB_BOOT_OBJ:
+    memset(obj_proto + top, 0, (slots - top) * sizeof(struct obj_data));
+    memset(obj_index + top, 0, (slots - top) * sizeof(struct index_data));
+    top_of_objt = top - 1;
+    break;
+  }
+
+  free(parse_jobs);
+  parse_jobs = NULL;
+  num_parse_jobs = 0;
+  parse_merging = FALSE;
+}
+#endif /* PARALLEL_BOOT */
+
+/* Queues the zone of vnum to be saved in the 128 bit format, see config.c. */
+static void mark_converted(int vnum, int type)
+{
+#ifdef PARALLEL_BOOT
+  pthread_mutex_lock(&parse_lock);
+#endif
+  add_to_save_list(zone_table[real_zone_by_thing(vnum)].number, type);
+  converting = TRUE;
+#ifdef PARALLEL_BOOT
+  pthread_mutex_unlock(&parse_lock);
+#endif
+}
+
+/* Lowercases the first letter of str if its first word is an article, as the
+ * short descriptions of mobs and objects are used mid sentence. */
+static void lower_article(char *str)
+{
+  size_t len;
+
+  for (len = 0; isalpha(str[len]); len++);
+
+  if ((len == 1 && !strn_cmp(str, "a", 1)) || (len == 2 && !strn_cmp(str, "an", 2)) ||
+      (len == 3 && !strn_cmp(str, "the", 3)))
+    *str = LOWER(*str);
 }
 
 bitvector_t asciiflag_conv(char *flag)
@@ -1184,17 +1558,21 @@ static bitvector_t asciiflag_conv_aff(char *flag)
 }
 
 /* load the rooms */
-void parse_room(FILE *fl, int virtual_nr)
+void parse_room(struct map_file *fl, int virtual_nr)
 {
-  static int room_nr = 0, zone = 0;
-  int t[10], i, retval;
-  char line[READ_SIZE], flags[128], flags2[128], flags3[128];
-  char flags4[128], buf2[MAX_STRING_LENGTH], buf[128];
-  struct extra_descr_data *new_descr;
-  char letter;
+  static room_rnum room_nr = 0;
 
-  /* This really had better fit or there are other problems. */
-  snprintf(buf2, sizeof(buf2), "room #%d", virtual_nr);
+  world[room_nr].number = virtual_nr;
+  set_room_zone(room_nr);
+  parse_room_at(fl, room_nr);
+  top_of_world = room_nr++;
+}
+
+/* Rooms are given their zones in order, each after the rooms before it. */
+static void set_room_zone(room_rnum room_nr)
+{
+  static zone_rnum zone = 0;
+  room_vnum virtual_nr = world[room_nr].number;
 
   if (virtual_nr < zone_table[zone].bot) {
     log("SYSERR: Room #%d is below zone %d (bot=%d, top=%d).", virtual_nr, zone_table[zone].number, zone_table[zone].bot, zone_table[zone].top);
@@ -1206,11 +1584,25 @@ void parse_room(FILE *fl, int virtual_nr)
       exit(1);
     }
   world[room_nr].zone = zone;
-  world[room_nr].number = virtual_nr;
-  world[room_nr].name = fread_string(fl, buf2);
-  world[room_nr].description = fread_string(fl, buf2);
+}
+
+/* Reads the room world[room_nr].number into that slot. */
+static void parse_room_at(struct map_file *fl, room_rnum room_nr)
+{
+  int virtual_nr = world[room_nr].number;
+  int t[10], i, retval;
+  char line[READ_SIZE], flags[128], flags2[128], flags3[128];
+  char flags4[128], buf2[MAX_STRING_LENGTH], buf[128];
+  struct extra_descr_data *new_descr;
+  char letter;
+
+  /* This really had better fit or there are other problems. */
+  snprintf(buf2, sizeof(buf2), "room #%d", virtual_nr);
+
+  world[room_nr].name = mf_fread_string(fl, buf2);
+  world[room_nr].description = mf_fread_string(fl, buf2);
 
-  if (!get_line(fl, line)) {
+  if (!mf_get_line(fl, line)) {
     log("SYSERR: Expecting roomflags/sector type of room #%d but file ended!",
 	virtual_nr);
     exit(1);
@@ -1238,10 +1630,8 @@ void parse_room(FILE *fl, int virtual_nr)
     /* No need to scan the other three sections; they're 0 anyway. */
     check_bitvector_names(world[room_nr].room_flags[0], room_bits_count, flags, "room");
 
-    if(bitsavetodisk) { /* Maybe the implementor just wants to look at the 128bit files */
-      add_to_save_list(zone_table[real_zone_by_thing(virtual_nr)].number, 3);
-      converting = TRUE;
-    }
+    if(bitsavetodisk) /* Maybe the implementor just wants to look at the 128bit files */
+      mark_converted(virtual_nr, 3);
 
   log("   done.");
   } else if (retval == 6) {
@@ -1278,7 +1668,7 @@ void parse_room(FILE *fl, int virtual_nr)
   snprintf(buf, sizeof(buf), "SYSERR: Format error in room #%d (expecting D/E/S)", virtual_nr);
 
   for (;;) {
-    if (!get_line(fl, line)) {
+    if (!mf_get_line(fl, line)) {
       log("%s", buf);
       exit(1);
     }
@@ -1288,8 +1678,8 @@ void parse_room(FILE *fl, int virtual_nr)
       break;
     case 'E':
       CREATE(new_descr, struct extra_descr_data, 1);
-      new_descr->keyword = fread_string(fl, buf2);
-      new_descr->description = fread_string(fl, buf2);
+      new_descr->keyword = mf_fread_string(fl, buf2);
+      new_descr->description = mf_fread_string(fl, buf2);
       /* Fix for crashes in the editor when formatting. E-descs are assumed to
        * end with a \r\n. -Welcor */
       {
@@ -1306,14 +1696,13 @@ void parse_room(FILE *fl, int virtual_nr)
       break;
     case 'S':			/* end of room */
       /* DG triggers -- script is defined after the end of the room */
-      letter = fread_letter(fl);
-      ungetc(letter, fl);
+      letter = mf_fread_letter(fl);
+      mf_ungetc(letter, fl);
       while (letter=='T') {
         dg_read_trigger(fl, &world[room_nr], WLD_TRIGGER);
-        letter = fread_letter(fl);
-        ungetc(letter, fl);
+        letter = mf_fread_letter(fl);
+        mf_ungetc(letter, fl);
       }
-      top_of_world = room_nr++;
       return;
     default:
       log("%s", buf);
@@ -1323,7 +1712,7 @@ void parse_room(FILE *fl, int virtual_nr)
 }
 
 /* read direction data */
-void setup_dir(FILE *fl, int room, int dir)
+void setup_dir(struct map_file *fl, int room, int dir)
 {
   int t[5];
   char line[READ_SIZE], buf2[128];
@@ -1336,10 +1725,10 @@ void setup_dir(FILE *fl, int room, int dir)
   }
 
   CREATE(world[room].dir_option[dir], struct room_direction_data, 1);
-  world[room].dir_option[dir]->general_description = fread_string(fl, buf2);
-  world[room].dir_option[dir]->keyword = fread_string(fl, buf2);
+  world[room].dir_option[dir]->general_description = mf_fread_string(fl, buf2);
+  world[room].dir_option[dir]->keyword = mf_fread_string(fl, buf2);
 
-  if (!get_line(fl, line)) {
+  if (!mf_get_line(fl, line)) {
     log("SYSERR: Format error, %s", buf2);
     exit(1);
   }
@@ -1466,7 +1855,7 @@ static void renum_zone_table(void)
     }
 }
 
-static void parse_simple_mob(FILE *mob_f, int i, int nr)
+static void parse_simple_mob(struct map_file *mob_f, int i, int nr)
 {
   int j, t[10];
   char line[READ_SIZE];
@@ -1478,7 +1867,7 @@ static void parse_simple_mob(FILE *mob_f, int i, int nr)
   mob_proto[i].real_abils.con = 11;
   mob_proto[i].real_abils.cha = 11;
 
-  if (!get_line(mob_f, line)) {
+  if (!mf_get_line(mob_f, line)) {
     log("SYSERR: Format error in mob #%d, file ended after S flag!", nr);
     exit(1);
   }
@@ -1507,7 +1896,7 @@ static void parse_simple_mob(FILE *mob_f, int i, int nr)
   mob_proto[i].mob_specials.damsizedice = t[7];
   GET_DAMROLL(mob_proto + i) = t[8];
 
-  if (!get_line(mob_f, line)) {
+  if (!mf_get_line(mob_f, line)) {
       log("SYSERR: Format error in mob #%d, second line after S flag\n"
 	  "...expecting line of form '# #', but file ended!", nr);
       exit(1);
@@ -1522,7 +1911,7 @@ static void parse_simple_mob(FILE *mob_f, int i, int nr)
   GET_GOLD(mob_proto + i) = t[0];
   GET_EXP(mob_proto + i) = t[1];
 
-  if (!get_line(mob_f, line)) {
+  if (!mf_get_line(mob_f, line)) {
     log("SYSERR: Format error in last line of mob #%d\n"
 	"...expecting line of form '# # #', but file ended!", nr);
     exit(1);
@@ -1657,13 +2046,13 @@ static void parse_espec(char *buf, int i, int nr)
   interpret_espec(buf, ptr, i, nr);
 }
 
-static void parse_enhanced_mob(FILE *mob_f, int i, int nr)
+static void parse_enhanced_mob(struct map_file *mob_f, int i, int nr)
 {
   char line[READ_SIZE];
 
   parse_simple_mob(mob_f, i, nr);
 
-  while (get_line(mob_f, line)) {
+  while (mf_get_line(mob_f, line)) {
     if (!strcmp(line, "E"))	/* end of the enhanced section */
       return;
     else if (*line == '#') {	/* we've hit the next mob, maybe? */
@@ -1677,9 +2066,17 @@ static void parse_enhanced_mob(FILE *mob_f, int i, int nr)
   exit(1);
 }
 
-void parse_mobile(FILE *mob_f, int nr)
+void parse_mobile(struct map_file *mob_f, int nr)
 {
   static int i = 0;
+
+  parse_mobile_at(mob_f, nr, i);
+  top_of_mobt = i++;
+}
+
+/* Reads mob nr into slot i of the mob tables. */
+static void parse_mobile_at(struct map_file *mob_f, int nr, int i)
+{
   int j, t[10], retval;
   char line[READ_SIZE], *tmpptr, letter;
   char f1[128], f2[128], f3[128], f4[128], f5[128], f6[128], f7[128], f8[128], buf2[128];
@@ -1697,18 +2094,16 @@ void parse_mobile(FILE *mob_f, int nr)
   sprintf(buf2, "mob vnum %d", nr);	/* sprintf: OK (for 'buf2 >= 19') */
 
   /* String data */
-  mob_proto[i].player.name = fread_string(mob_f, buf2);
-  tmpptr = mob_proto[i].player.short_descr = fread_string(mob_f, buf2);
+  mob_proto[i].player.name = mf_fread_string(mob_f, buf2);
+  tmpptr = mob_proto[i].player.short_descr = mf_fread_string(mob_f, buf2);
   if (tmpptr && *tmpptr)
-    if (!str_cmp(fname(tmpptr), "a") || !str_cmp(fname(tmpptr), "an") ||
-	!str_cmp(fname(tmpptr), "the"))
-      *tmpptr = LOWER(*tmpptr);
-  mob_proto[i].player.long_descr = fread_string(mob_f, buf2);
-  mob_proto[i].player.description = fread_string(mob_f, buf2);
+    lower_article(tmpptr);
+  mob_proto[i].player.long_descr = mf_fread_string(mob_f, buf2);
+  mob_proto[i].player.description = mf_fread_string(mob_f, buf2);
   GET_TITLE(mob_proto + i) = NULL;
 
   /* Numeric data */
-  if (!get_line(mob_f, line)) {
+  if (!mf_get_line(mob_f, line)) {
     log("SYSERR: Format error after string section of mob #%d\n"
 	"...expecting line of form '# # # {S | E}', but file ended!", nr);
     exit(1);
@@ -1752,10 +2147,8 @@ void parse_mobile(FILE *mob_f, int nr)
      * characters, but this shouldn't occur anyway. */
     letter = *f4;
 
-    if(bitsavetodisk) {
-      add_to_save_list(zone_table[real_zone_by_thing(nr)].number, 0);
-      converting =TRUE;
-    }
+    if(bitsavetodisk)
+      mark_converted(nr, 0);
 
   log("   done.");
   } else if (retval == 10) {
@@ -1803,12 +2196,12 @@ void parse_mobile(FILE *mob_f, int nr)
   }
 
   /* DG triggers -- script info follows mob S/E section */
-  letter = fread_letter(mob_f);
-  ungetc(letter, mob_f);
+  letter = mf_fread_letter(mob_f);
+  mf_ungetc(letter, mob_f);
   while (letter=='T') {
     dg_read_trigger(mob_f, &mob_proto[i], MOB_TRIGGER);
-    letter = fread_letter(mob_f);
-    ungetc(letter, mob_f);
+    letter = mf_fread_letter(mob_f);
+    mf_ungetc(letter, mob_f);
   }
 
   mob_proto[i].aff_abils = mob_proto[i].real_abils;
@@ -1818,15 +2211,23 @@ void parse_mobile(FILE *mob_f, int nr)
 
   mob_proto[i].nr = i;
   mob_proto[i].desc = NULL;
-
-  top_of_mobt = i++;
 }
 
 /* read all objects from obj file; generate index and prototypes */
-char *parse_object(FILE *obj_f, int nr)
+char *parse_object(struct map_file *obj_f, int nr)
 {
   static int i = 0;
   static char line[READ_SIZE];
+
+  parse_object_at(obj_f, nr, i, line);
+  top_of_objt = i++;
+  return (line);
+}
+
+/* Reads object nr into slot i of the object tables, leaving the line that
+ * ended it in line, which must hold READ_SIZE. */
+static void parse_object_at(struct map_file *obj_f, int nr, int i, char *line)
+{
   int t[10], j, retval;
   char *tmpptr, buf2[128], f1[READ_SIZE], f2[READ_SIZE], f3[READ_SIZE], f4[READ_SIZE];
   char f5[READ_SIZE], f6[READ_SIZE], f7[READ_SIZE], f8[READ_SIZE];
@@ -1843,23 +2244,21 @@ char *parse_object(FILE *obj_f, int nr)
   sprintf(buf2, "object #%d", nr);	/* sprintf: OK (for 'buf2 >= 19') */
 
   /* string data */
-  if ((obj_proto[i].name = fread_string(obj_f, buf2)) == NULL) {
+  if ((obj_proto[i].name = mf_fread_string(obj_f, buf2)) == NULL) {
     log("SYSERR: Null obj name or format error at or near %s", buf2);
     exit(1);
   }
-  tmpptr = obj_proto[i].short_description = fread_string(obj_f, buf2);
+  tmpptr = obj_proto[i].short_description = mf_fread_string(obj_f, buf2);
   if (tmpptr && *tmpptr)
-    if (!str_cmp(fname(tmpptr), "a") || !str_cmp(fname(tmpptr), "an") ||
-	!str_cmp(fname(tmpptr), "the"))
-      *tmpptr = LOWER(*tmpptr);
+    lower_article(tmpptr);
 
-  tmpptr = obj_proto[i].description = fread_string(obj_f, buf2);
+  tmpptr = obj_proto[i].description = mf_fread_string(obj_f, buf2);
   if (tmpptr && *tmpptr)
     CAP(tmpptr);
-  obj_proto[i].action_description = fread_string(obj_f, buf2);
+  obj_proto[i].action_description = mf_fread_string(obj_f, buf2);
 
   /* numeric data */
-  if (!get_line(obj_f, line)) {
+  if (!mf_get_line(obj_f, line)) {
     log("SYSERR: Expecting first numeric line of %s, but file ended!", buf2);
     exit(1);
   }
@@ -1890,10 +2289,8 @@ char *parse_object(FILE *obj_f, int nr)
     GET_OBJ_PERM(obj_proto + i)[2] = 0;
     GET_OBJ_PERM(obj_proto + i)[3] = 0;
 
-    if(bitsavetodisk) {
-      add_to_save_list(zone_table[real_zone_by_thing(nr)].number, 1);
-      converting = TRUE;
-    }
+    if(bitsavetodisk)
+      mark_converted(nr, 1);
 
     log("   done.");
   } else if (retval == 13) {
@@ -1919,7 +2316,7 @@ char *parse_object(FILE *obj_f, int nr)
   /* Object flags checked in check_object(). */
   GET_OBJ_TYPE(obj_proto + i) = t[0];
 
-  if (!get_line(obj_f, line)) {
+  if (!mf_get_line(obj_f, line)) {
     log("SYSERR: Expecting second numeric line of %s, but file ended!", buf2);
     exit(1);
   }
@@ -1932,7 +2329,7 @@ char *parse_object(FILE *obj_f, int nr)
   GET_OBJ_VAL(obj_proto + i, 2) = t[2];
   GET_OBJ_VAL(obj_proto + i, 3) = t[3];
 
-  if (!get_line(obj_f, line)) {
+  if (!mf_get_line(obj_f, line)) {
     log("SYSERR: Expecting third numeric line of %s, but file ended!", buf2);
     exit(1);
   }
@@ -1974,15 +2371,15 @@ char *parse_object(FILE *obj_f, int nr)
   j = 0;
 
   for (;;) {
-    if (!get_line(obj_f, line)) {
+    if (!mf_get_line(obj_f, line)) {
       log("SYSERR: Format error in %s", buf2);
       exit(1);
     }
     switch (*line) {
     case 'E':
       CREATE(new_descr, struct extra_descr_data, 1);
-      new_descr->keyword = fread_string(obj_f, buf2);
-      new_descr->description = fread_string(obj_f, buf2);
+      new_descr->keyword = mf_fread_string(obj_f, buf2);
+      new_descr->description = mf_fread_string(obj_f, buf2);
       new_descr->next = obj_proto[i].ex_description;
       obj_proto[i].ex_description = new_descr;
       break;
@@ -1991,7 +2388,7 @@ char *parse_object(FILE *obj_f, int nr)
 	log("SYSERR: Too many A fields (%d max), %s", MAX_OBJ_AFFECT, buf2);
 	exit(1);
       }
-      if (!get_line(obj_f, line)) {
+      if (!mf_get_line(obj_f, line)) {
 	log("SYSERR: Format error in 'A' field, %s\n"
 	    "...expecting 2 numeric constants but file ended!", buf2);
 	exit(1);
@@ -2012,10 +2409,8 @@ char *parse_object(FILE *obj_f, int nr)
       break;
     case '$':
     case '#':
-      top_of_objt = i;
       check_object(obj_proto + i);
-      i++;
-      return (line);
+      return;
     default:
       log("SYSERR: Format error in (%c): %s", *line, buf2);
       exit(1);
@@ -2292,7 +2687,7 @@ int vnum_mobile(char *searchname, struct char_data *ch)
   int nr, found = 0;
 
   for (nr = 0; nr <= top_of_mobt; nr++)
-    if (isname(searchname, mob_proto[nr].player.name))
+    if (char_isname(searchname, &mob_proto[nr]))
       send_to_char(ch, "%3d. [%5d] %-40s %s\r\n",
                    ++found, mob_index[nr].vnum, mob_proto[nr].player.short_descr,
                    mob_proto[nr].proto_script ? "[TRIG]" : "" );
@@ -2305,7 +2700,7 @@ int vnum_object(char *searchname, struct char_data *ch)
   int nr, found = 0;
 
   for (nr = 0; nr <= top_of_objt; nr++)
-    if (isname(searchname, obj_proto[nr].name))
+    if (obj_isname(searchname, &obj_proto[nr]))
       send_to_char(ch, "%3d. [%5d] %-40s %s\r\n",
                    ++found, obj_index[nr].vnum, obj_proto[nr].short_description,
                    obj_proto[nr].proto_script ? "[TRIG]" : "" );
@@ -2315,9 +2710,10 @@ int vnum_object(char *searchname, struct char_data *ch)
 
 int vnum_room(char *searchname, struct char_data *ch)
 {
- int nr, found = 0;
+ room_rnum nr;
+ int found = 0;
 
- for (nr = 0; nr <= top_of_world; nr++)
+ for (nr = next_room_by_vnum(NOWHERE); nr != NOWHERE; nr = next_room_by_vnum(nr))
    if (isname(searchname, world[nr].name))
    send_to_char(ch, "%3d. [%5d] %-40s %s\r\n",
    ++found, world[nr].number, world[nr].name,
@@ -2340,17 +2736,18 @@ struct char_data *create_char(void)
 {
   struct char_data *ch;
 
-  CREATE(ch, struct char_data, 1);
+  SLAB_CREATE(ch, struct char_data, char_slab);
   clear_char(ch);
   
   new_mobile_data(ch);
   
-  ch->next = character_list;
-  character_list = ch;
+  char_to_list(ch);
+  ch->list_stamp = ++char_list_stamp;
 
   GET_ID(ch) = max_mob_id++;
   /* find_char helper */
   add_to_lookup_table(GET_ID(ch), (void *)ch);
+  char_to_unshared(ch);
 
   return (ch);
 }
@@ -2376,12 +2773,14 @@ struct char_data *read_mobile(mob_vnum nr, int type) /* and mob_rnum */
   } else
     i = nr;
 
-  CREATE(mob, struct char_data, 1);
+  SLAB_CREATE(mob, struct char_data, char_slab);
   clear_char(mob);
  
   *mob = mob_proto[i];
-  mob->next = character_list;
-  character_list = mob;
+  copy_mobile_strings(mob, &mob_proto[i]);
+  char_to_list(mob);
+  mob->list_stamp = ++char_list_stamp;
+  mob->next_unshared = mob->prev_unshared = NULL;
   
   new_mobile_data(mob);  
   
@@ -2400,6 +2799,7 @@ struct char_data *read_mobile(mob_vnum nr, int type) /* and mob_rnum */
   mob->player.time.logon = time(0);
 
   mob_index[i].number++;
+  char_to_instances(mob);
 
   GET_ID(mob) = max_mob_id++;
   
@@ -2417,16 +2817,16 @@ struct obj_data *create_obj(void)
 {
   struct obj_data *obj;
 
-  CREATE(obj, struct obj_data, 1);
+  SLAB_CREATE(obj, struct obj_data, obj_slab);
   clear_object(obj);
-  obj->next = object_list;
-  object_list = obj;
+  obj_to_list(obj);
   
   obj->events = NULL;
 
   GET_ID(obj) = max_obj_id++;
   /* find_obj helper */
   add_to_lookup_table(GET_ID(obj), (void *)obj);
+  obj_to_unshared(obj);
 
   return (obj);
 }
@@ -2442,17 +2842,18 @@ struct obj_data *read_object(obj_vnum nr, int type) /* and obj_rnum */
     return (NULL);
   }
 
-  CREATE(obj, struct obj_data, 1);
+  SLAB_CREATE(obj, struct obj_data, obj_slab);
   clear_object(obj);
-  *obj = obj_proto[i];
-  obj->next = object_list;
-  object_list = obj;
+  copy_object_preserve(obj, &obj_proto[i]);
+  obj_to_list(obj);
   
   obj->events = NULL;
+  obj->next_unshared = obj->prev_unshared = NULL;
 
   obj_index[i].number++;
-
   GET_ID(obj) = max_obj_id++;
+  obj_to_instances(obj);
+
   /* find_obj helper */
   add_to_lookup_table(GET_ID(obj), (void *)obj);
 
@@ -2463,13 +2864,42 @@ struct obj_data *read_object(obj_vnum nr, int type) /* and obj_rnum */
 }
 
 #define ZO_DEAD  999
-/* update zone ages, queue for reset if necessary, and dequeue when possible */
+
+/* Due zones wait on reset_q and are reset by run_zone_resets(), a little every
+ * pulse: it runs reset commands until ZONE_RESET_USECS have gone by and then
+ * leaves the rest of the zone for the next pulse. One zone is reset at a time,
+ * and reset_now remembers how far it has got. */
+static struct {
+  zone_vnum zone;           /* NOWHERE when no reset is under way */
+  int cmd_no;               /* the next command to run */
+  int last_cmd;
+  long usecs;               /* spent on it so far */
+  int pulses;               /* it has run in */
+} reset_now = { NOWHERE, 0, 0, 0, 0 };
+
+static int reset_backlog_max = 0;   /* most zones queued at once */
+static int resets_paused = 0;       /* times a reset ran out of budget */
+
+static int reset_backlog(void)
+{
+  struct reset_q_element *q;
+  int n = 0;
+
+  for (q = reset_q.head; q; q = q->next)
+    n++;
+  return n;
+}
+
+/* update zone ages and queue zones for reset if necessary */
 void zone_update(void)
 {
   int i;
-  struct reset_q_element *update_u, *temp;
+  struct reset_q_element *update_u;
   static int timer = 0;
 
+  if (CONFIG_DEBUG_MODE)
+    check_zone_presence();
+
   /* jelson 10/22/92 */
   if (((++timer * PULSE_ZONE) / PASSES_PER_SEC) >= 60) {
     /* one minute has passed NOT accurate unless PULSE_ZONE is a multiple of
@@ -2489,7 +2919,8 @@ void zone_update(void)
 
 	CREATE(update_u, struct reset_q_element, 1);
 
-	update_u->zone_to_reset = i;
+	update_u->zone_to_reset = zone_table[i].number;
+	update_u->queued = time(0);
 	update_u->next = 0;
 
 	if (!reset_q.head)
@@ -2502,32 +2933,148 @@ void zone_update(void)
 	zone_table[i].age = ZO_DEAD;
       }
     }
+
+    if ((i = reset_backlog()) > reset_backlog_max)
+      reset_backlog_max = i;
   }	/* end - one minute has passed */
+}
 
-  /* Dequeue zones (if possible) and reset. This code is executed every 10
-   * seconds (i.e. PULSE_ZONE). */
-  for (update_u = reset_q.head; update_u; update_u = update_u->next)
-    if (zone_table[update_u->zone_to_reset].reset_mode == 2 ||
-	is_empty(update_u->zone_to_reset)) {
-      reset_zone(update_u->zone_to_reset);
-      mudlog(CMP, LVL_IMPL, FALSE, "Auto zone reset: %s (Zone %d)",
-          zone_table[update_u->zone_to_reset].name, zone_table[update_u->zone_to_reset].number);
-      /* dequeue */
-      if (update_u == reset_q.head)
-	reset_q.head = reset_q.head->next;
-      else {
-	for (temp = reset_q.head; temp->next != update_u;
-	     temp = temp->next);
+/* Takes the most pressing zone that may be reset now off the queue and starts
+ * its reset. Zones that reset with players in them come first, as somebody is
+ * there to notice, then the zone that has waited longest. Zones that only
+ * reset when empty are passed over while they are not. */
+static int next_zone_reset(void)
+{
+  struct reset_q_element *update_u, *prev, *best = NULL, *best_prev = NULL;
+  int occupied, best_occupied = FALSE;
+  zone_rnum zone;
 
-	if (!update_u->next)
-	  reset_q.tail = temp;
+  for (prev = NULL, update_u = reset_q.head; update_u; prev = update_u, update_u = update_u->next) {
+    if ((zone = real_zone(update_u->zone_to_reset)) == NOWHERE)
+      continue;
+    occupied = !is_empty(zone);
+    if (occupied && zone_table[zone].reset_mode != 2)
+      continue;
+    if (!best || (occupied && !best_occupied) ||
+        (occupied == best_occupied && update_u->queued < best->queued)) {
+      best = update_u;
+      best_prev = prev;
+      best_occupied = occupied;
+    }
+  }
 
-	temp->next = update_u->next;
-      }
+  if (!best)
+    return FALSE;
 
-      free(update_u);
+  /* dequeue */
+  if (best_prev)
+    best_prev->next = best->next;
+  else
+    reset_q.head = best->next;
+  if (reset_q.tail == best)
+    reset_q.tail = best_prev;
+
+  reset_now.zone = best->zone_to_reset;
+  reset_now.cmd_no = 0;
+  reset_now.last_cmd = 0;
+  reset_now.usecs = 0;
+  reset_now.pulses = 0;
+  free(best);
+  return TRUE;
+}
+
+/** Resets queued zones for up to ZONE_RESET_USECS. Called every pulse. */
+void run_zone_resets(void)
+{
+  struct timeval start, deadline;
+  zone_rnum zone;
+  int n, done;
+
+  if (reset_now.zone == NOWHERE && !reset_q.head)
+    return;
+
+  gettimeofday(&start, NULL);
+  deadline.tv_sec = start.tv_sec + (start.tv_usec + ZONE_RESET_USECS) / 1000000;
+  deadline.tv_usec = (start.tv_usec + ZONE_RESET_USECS) % 1000000;
+
+  do {
+    if (reset_now.zone == NOWHERE && !next_zone_reset())
       break;
+
+    if ((zone = real_zone(reset_now.zone)) == NOWHERE) {
+      reset_now.zone = NOWHERE;
+      continue;
     }
+
+    /* OLC may have taken commands out since the last pulse. */
+    for (n = 0; n < reset_now.cmd_no && zone_table[zone].cmd[n].command != 'S'; n++)
+      ;
+    reset_now.cmd_no = n;
+
+    gettimeofday(&start, NULL);
+    done = run_zone_commands(zone, &reset_now.cmd_no, &reset_now.last_cmd, &deadline);
+    reset_now.usecs += usecs_since(&start);
+    reset_now.pulses++;
+
+    if (!done) {
+      resets_paused++;
+      break;
+    }
+
+    reset_now.zone = NOWHERE;
+    end_zone_reset(zone, reset_now.usecs, reset_now.pulses);
+    mudlog(CMP, LVL_IMPL, FALSE, "Auto zone reset: %s (Zone %d)",
+        zone_table[zone].name, zone_table[zone].number);
+  } while (!past_deadline(&deadline));
+}
+
+/* show resets */
+void show_zone_resets(struct char_data *ch)
+{
+  struct reset_q_element *q;
+  char buf[MAX_STRING_LENGTH];
+  size_t len;
+  zone_rnum zone;
+  int nlen;
+
+  len = snprintf(buf, sizeof(buf),
+      "Zone resets: %d ms per pulse, %d queued (at most %d), %d paused for later pulses.\r\n",
+      ZONE_RESET_USECS / 1000, reset_backlog(), reset_backlog_max, resets_paused);
+
+  if (reset_now.zone != NOWHERE && (zone = real_zone(reset_now.zone)) != NOWHERE)
+    len += snprintf(buf + len, sizeof(buf) - len,
+        "Resetting [%3d] %s: command %d, %.1f ms over %d pulses so far.\r\n",
+        zone_table[zone].number, zone_table[zone].name, reset_now.cmd_no,
+        reset_now.usecs / 1000.0, reset_now.pulses);
+
+  for (q = reset_q.head; q && len < sizeof(buf); q = q->next) {
+    if ((zone = real_zone(q->zone_to_reset)) == NOWHERE)
+      continue;
+    nlen = snprintf(buf + len, sizeof(buf) - len, "Queued    [%3d] %-30s waiting %lds%s\r\n",
+        zone_table[zone].number, zone_table[zone].name, (long)(time(0) - q->queued),
+        zone_table[zone].reset_mode == 2 || is_empty(zone) ? "" : " (occupied)");
+    if (len + nlen >= sizeof(buf))
+      break;
+    len += nlen;
+  }
+
+  nlen = snprintf(buf + len, sizeof(buf) - len,
+      "\r\nZone  Name                            Resets  Last ms   Max ms  Pulses\r\n");
+  if (len + nlen < sizeof(buf))
+    len += nlen;
+  for (zone = 0; zone <= top_of_zone_table; zone++) {
+    if (!zone_table[zone].resets)
+      continue;
+    nlen = snprintf(buf + len, sizeof(buf) - len, "[%3d] %-30.30s %7d %8.1f %8.1f %7d\r\n",
+        zone_table[zone].number, zone_table[zone].name, zone_table[zone].resets,
+        zone_table[zone].reset_usecs / 1000.0, zone_table[zone].reset_max_usecs / 1000.0,
+        zone_table[zone].reset_pulses);
+    if (len + nlen >= sizeof(buf))
+      break;
+    len += nlen;
+  }
+
+  page_string(ch->desc, buf, TRUE);
 }
 
 static void log_zone_error(zone_rnum zone, int cmd_no, const char *message)
@@ -2540,18 +3087,45 @@ static void log_zone_error(zone_rnum zone, int cmd_no, const char *message)
 #define ZONE_ERROR(message) \
 	{ log_zone_error(zone, cmd_no, message); last_cmd = 0; }
 
-/* execute the reset command table of a given zone */
-void reset_zone(zone_rnum zone)
+static int past_deadline(struct timeval *deadline)
+{
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+  return now.tv_sec > deadline->tv_sec ||
+    (now.tv_sec == deadline->tv_sec && now.tv_usec >= deadline->tv_usec);
+}
+
+long usecs_since(struct timeval *start)
+{
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+  return (now.tv_sec - start->tv_sec) * 1000000L + (now.tv_usec - start->tv_usec);
+}
+
+/* Runs the reset commands of a zone from *pcmd_no on. With a deadline it may
+ * stop early, but only before an 'M' or 'O' command: those start a new group,
+ * so the mob and object the commands after them work on are never carried
+ * from one pulse to the next, when they might already be gone. Returns TRUE
+ * once the 'S' at the end is reached. */
+static int run_zone_commands(zone_rnum zone, int *pcmd_no, int *plast_cmd,
+                             struct timeval *deadline)
 {
-  int cmd_no, last_cmd = 0;
+  int cmd_no, last_cmd = *plast_cmd;
   struct char_data *mob = NULL;
   struct obj_data *obj, *obj_to;
-  room_vnum rvnum;
-  room_rnum rrnum;
   struct char_data *tmob=NULL; /* for trigger assignment */
   struct obj_data *tobj=NULL;  /* for trigger assignment */
 
-  for (cmd_no = 0; ZCMD.command != 'S'; cmd_no++) {
+  for (cmd_no = *pcmd_no; ZCMD.command != 'S'; cmd_no++) {
+
+    if (deadline && cmd_no > *pcmd_no && (ZCMD.command == 'M' ||
+        ZCMD.command == 'O') && past_deadline(deadline)) {
+      *pcmd_no = cmd_no;
+      *plast_cmd = last_cmd;
+      return FALSE;
+    }
 
     if (ZCMD.if_flag && !last_cmd)
       continue;
@@ -2708,11 +3282,13 @@ void reset_zone(zone_rnum zone)
         if (!SCRIPT(tmob))
           CREATE(SCRIPT(tmob), struct script_data, 1);
         add_trigger(SCRIPT(tmob), read_trigger(ZCMD.arg2), -1);
+        script_listeners_add(tmob, MOB_TRIGGER);
         last_cmd = 1;
       } else if (ZCMD.arg1==OBJ_TRIGGER && tobj) {
         if (!SCRIPT(tobj))
           CREATE(SCRIPT(tobj), struct script_data, 1);
         add_trigger(SCRIPT(tobj), read_trigger(ZCMD.arg2), -1);
+        script_listeners_add(tobj, OBJ_TRIGGER);
         last_cmd = 1;
       } else if (ZCMD.arg1==WLD_TRIGGER) {
         if (ZCMD.arg3 == NOWHERE || ZCMD.arg3>top_of_world) {
@@ -2762,6 +3338,23 @@ void reset_zone(zone_rnum zone)
     }
   }
 
+  *pcmd_no = cmd_no;
+  *plast_cmd = last_cmd;
+  return TRUE;
+}
+
+/* Finishes a reset once all of its commands have run. */
+static void end_zone_reset(zone_rnum zone, long usecs, int pulses)
+{
+  room_vnum rvnum;
+  room_rnum rrnum;
+
+  zone_table[zone].resets++;
+  zone_table[zone].reset_usecs = usecs;
+  zone_table[zone].reset_pulses = pulses;
+  if (usecs > zone_table[zone].reset_max_usecs)
+    zone_table[zone].reset_max_usecs = usecs;
+
   zone_table[zone].age = 0;
 
   /* handle reset_wtrigger's */
@@ -2773,27 +3366,27 @@ void reset_zone(zone_rnum zone)
   }
 }
 
-/* for use in reset_zone; return TRUE if zone 'nr' is free of PC's  */
-int is_empty(zone_rnum zone_nr)
+/* execute the reset command table of a given zone */
+void reset_zone(zone_rnum zone)
 {
-  struct descriptor_data *i;
+  int cmd_no = 0, last_cmd = 0;
+  struct timeval start;
 
-  for (i = descriptor_list; i; i = i->next) {
-    if (STATE(i) != CON_PLAYING)
-      continue;
-    if (IN_ROOM(i->character) == NOWHERE)
-      continue;
-    if (world[IN_ROOM(i->character)].zone != zone_nr)
-      continue;
-    /* If an immortal has nohassle off, he counts as present. Added for testing
-     * zone reset triggers -Welcor */
-    if ((!IS_NPC(i->character)) && (GET_LEVEL(i->character) >= LVL_IMMORT) && (PRF_FLAGGED(i->character, PRF_NOHASSLE)))
-      continue;
+  /* A full reset takes the place of one the scheduler has under way. */
+  if (reset_now.zone == zone_table[zone].number)
+    reset_now.zone = NOWHERE;
 
-    return (0);
-  }
+  gettimeofday(&start, NULL);
+  run_zone_commands(zone, &cmd_no, &last_cmd, NULL);
+  end_zone_reset(zone, usecs_since(&start), 1);
+}
 
-  return (1);
+/* for use in reset_zone; return TRUE if zone 'nr' is free of PC's. Players
+ * with nohassle do not count, so that an immortal can watch a zone reset by
+ * turning it on. See zone_presence_to(). */
+int is_empty(zone_rnum zone_nr)
+{
+  return (zone_table[zone_nr].players == 0);
 }
 
 /* Functions of a general utility nature. */
@@ -3159,7 +3752,7 @@ static void free_followers(struct follow_type *k)
     free_followers(k->next);
 
   k->follower = NULL;
-  free(k);
+  slab_free(&follow_slab, k);
 }
 
 /* release memory allocated for a char struct */
@@ -3207,17 +3800,8 @@ void free_char(struct char_data *ch)
     free_proto_script(ch, MOB_TRIGGER);
 
   } else if ((i = GET_MOB_RNUM(ch)) != NOBODY) {
-    /* otherwise, free strings only if the string is not pointing at proto */
-    if (ch->player.name && ch->player.name != mob_proto[i].player.name)
-      free(ch->player.name);
-    if (ch->player.title && ch->player.title != mob_proto[i].player.title)
-      free(ch->player.title);
-    if (ch->player.short_descr && ch->player.short_descr != mob_proto[i].player.short_descr)
-      free(ch->player.short_descr);
-    if (ch->player.long_descr && ch->player.long_descr != mob_proto[i].player.long_descr)
-      free(ch->player.long_descr);
-    if (ch->player.description && ch->player.description != mob_proto[i].player.description)
-      free(ch->player.description);
+    /* otherwise, give back the strings read_mobile() took references to */
+    free_mobile_strings(ch);
     /* free script proto list if it's not the prototype */
     if (ch->proto_script && ch->proto_script != mob_proto[i].proto_script)
       free_proto_script(ch, MOB_TRIGGER);
@@ -3252,21 +3836,19 @@ void free_char(struct char_data *ch)
   if (GET_ID(ch) != 0)
   remove_from_lookup_table(GET_ID(ch));
 
-  free(ch);
+  slab_free(&char_slab, ch);
 }
 
 /* release memory allocated for an obj struct */
 void free_obj(struct obj_data *obj)
 {
+  free_object_strings(obj);
+
   if (GET_OBJ_RNUM(obj) == NOWHERE) {
-    free_object_strings(obj);
     /* free script proto list */
     free_proto_script(obj, OBJ_TRIGGER);
-  } else {
-    free_object_strings_proto(obj);
-    if (obj->proto_script != obj_proto[GET_OBJ_RNUM(obj)].proto_script)
-      free_proto_script(obj, OBJ_TRIGGER);
-  }
+  } else if (obj->proto_script != obj_proto[GET_OBJ_RNUM(obj)].proto_script)
+    free_proto_script(obj, OBJ_TRIGGER);
 
   /* free any assigned scripts */
   if (SCRIPT(obj))
@@ -3275,7 +3857,7 @@ void free_obj(struct obj_data *obj)
   /* find_obj helper */
   remove_from_lookup_table(GET_ID(obj));
 
-  free(obj);
+  slab_free(&obj_slab, obj);
 }
 
 /* Steps: 1: Read contents of a text file. 2: Make sure no one is using the
@@ -3385,7 +3967,7 @@ void reset_char(struct char_data *ch)
   ch->next_in_room = NULL;
   FIGHTING(ch) = NULL;
   char_from_furniture(ch);
-  ch->char_specials.position = POS_STANDING;
+  GET_POS(ch) = POS_STANDING;
   ch->mob_specials.default_pos = POS_STANDING;
   ch->char_specials.carry_weight = 0;
   ch->char_specials.carry_items = 0;
@@ -3524,108 +4106,342 @@ void init_char(struct char_data *ch)
   SET_BIT_AR(PRF_FLAGS(ch), PRF_DISPMOVE);
 }
 
-/* returns the real number of the room with given virtual number */
-room_rnum real_room(room_vnum vnum)
-{
-  room_rnum bot, top, mid;
+/* Direct vnum to rnum tables behind the real_*() lookups, indexed by the
+ * DB_BOOT_* type of the table.  A vnum is an IDXTYPE, so one slot for each of
+ * them is only 128k per type.  A table is NULL until its type is read, and the
+ * lookups search the prototypes until then. */
+#define VNUM_SLOTS    ((int)IDXTYPE_MAX - (int)IDXTYPE_MIN + 1)
+#define VNUM_SLOT(v)  ((int)(v) - (int)IDXTYPE_MIN)
 
-  bot = 0;
-  top = top_of_world;
+static IDXTYPE *vnum_index[DB_BOOT_QST + 1];
 
-  if (world[bot].number > vnum || world[top].number < vnum)
-    return (NOWHERE);
+/* The rooms in vnum order, for next_room_by_vnum(): the first one, and for
+ * each rnum the room with the next higher vnum. */
+static room_rnum first_room_vnum = NOWHERE;
+static room_rnum *next_room_vnum = NULL;
+static int next_room_vnum_size = 0;
 
-  /* perform binary search on world-table */
-  while (bot<= top) {
-    mid = (bot + top) / 2;
+static IDXTYPE vnum_of(int mode, int rnum)
+{
+  switch (mode) {
+  case DB_BOOT_WLD: return world[rnum].number;
+  case DB_BOOT_MOB: return mob_index[rnum].vnum;
+  case DB_BOOT_OBJ: return obj_index[rnum].vnum;
+  case DB_BOOT_ZON: return zone_table[rnum].number;
+  case DB_BOOT_QST: return QST_NUM(rnum);
+  }
+  return NOWHERE;
+}
 
-    if ((world + mid)->number == vnum)
-      return (mid);
-    if ((world + mid)->number > vnum)
-      top = mid - 1;
-    else
-      bot = mid + 1;
+static int vnum_entries(int mode)
+{
+  switch (mode) {
+  case DB_BOOT_WLD: return world ? top_of_world + 1 : 0;
+  case DB_BOOT_MOB: return mob_index ? top_of_mobt + 1 : 0;
+  case DB_BOOT_OBJ: return obj_index ? top_of_objt + 1 : 0;
+  case DB_BOOT_ZON: return zone_table ? top_of_zone_table + 1 : 0;
+  case DB_BOOT_QST: return aquest_table ? total_quests : 0;
   }
-  return (NOWHERE);
+  return 0;
 }
 
-/* returns the real number of the monster with given virtual number */
-mob_rnum real_mobile(mob_vnum vnum)
+/* What real_*() did before the tables: a binary search on the sorted
+ * prototypes, and a scan of the quests, which are kept in file order. */
+static IDXTYPE vnum_search(int mode, IDXTYPE vnum)
 {
-  mob_rnum bot, top, mid;
+  int bot = 0, top = vnum_entries(mode) - 1, mid;
 
-  bot = 0;
-  top = top_of_mobt;
+  if (mode == DB_BOOT_QST) {
+    for (mid = 0; mid <= top; mid++)
+      if (vnum_of(mode, mid) == vnum)
+        return (mid);
+    return (NOWHERE);
+  }
 
   /* quickly reject out-of-range vnums */
-  if (mob_index[bot].vnum > vnum || mob_index[top].vnum < vnum)
-    return (NOBODY);
+  if (top < 0 || vnum_of(mode, bot) > vnum || vnum_of(mode, top) < vnum)
+    return (NOWHERE);
 
-  /* perform binary search on mob-table */
   while (bot <= top) {
     mid = (bot + top) / 2;
 
-    if ((mob_index + mid)->vnum == vnum)
+    if (vnum_of(mode, mid) == vnum)
       return (mid);
-    if ((mob_index + mid)->vnum > vnum)
+    if (vnum_of(mode, mid) > vnum)
       top = mid - 1;
     else
       bot = mid + 1;
   }
-  return (NOBODY);
+  return (NOWHERE);
 }
 
-/* returns the real number of the object with given virtual number */
-obj_rnum real_object(obj_vnum vnum)
+/* The room with the highest vnum below vnum, NOWHERE if there is none.  Only
+ * genolc adding or deleting a room needs this, and the rooms of a zone sit
+ * close together, so the walk down the slots is short. */
+static room_rnum room_before_vnum(int vnum)
 {
-  obj_rnum bot, top, mid;
+  IDXTYPE *slot = vnum_index[DB_BOOT_WLD];
 
-  bot = 0;
-  top = top_of_objt;
+  while (--vnum >= IDXTYPE_MIN)
+    if (slot[VNUM_SLOT(vnum)] != NOWHERE)
+      return slot[VNUM_SLOT(vnum)];
+  return (NOWHERE);
+}
 
-  /* quickly reject out-of-range vnums */
-  if (obj_index[bot].vnum > vnum || obj_index[top].vnum < vnum)
-    return (NOTHING);
+static void grow_next_room_vnum(int size)
+{
+  int i;
 
-  /* perform binary search on obj-table */
-  while (bot <= top) {
-    mid = (bot + top) / 2;
+  if (size <= next_room_vnum_size)
+    return;
+  RECREATE(next_room_vnum, room_rnum, size);
+  for (i = next_room_vnum_size; i < size; i++)
+    next_room_vnum[i] = NOWHERE;
+  next_room_vnum_size = size;
+}
 
-    if ((obj_index + mid)->vnum == vnum)
-      return (mid);
-    if ((obj_index + mid)->vnum > vnum)
-      top = mid - 1;
-    else
-      bot = mid + 1;
+/* Chains every room in vnum order, from the top vnum down. */
+static void link_rooms_by_vnum(void)
+{
+  IDXTYPE *slot = vnum_index[DB_BOOT_WLD];
+  room_rnum next = NOWHERE;
+  int vnum;
+
+  grow_next_room_vnum(top_of_world + 1);
+  for (vnum = IDXTYPE_MAX; vnum >= IDXTYPE_MIN; vnum--)
+    if (slot[VNUM_SLOT(vnum)] != NOWHERE) {
+      next_room_vnum[slot[VNUM_SLOT(vnum)]] = next;
+      next = slot[VNUM_SLOT(vnum)];
+    }
+  first_room_vnum = next;
+}
+
+/* Points the slots of the entries from rnum 'from' to the top of the table at
+ * their rnums.  Called for the whole table once it is read, and by genolc from
+ * the entry it added or removed, as everything above that one moved. */
+void index_vnums(int mode, int from)
+{
+  IDXTYPE *slot;
+  int i, entries = vnum_entries(mode);
+
+  if (!vnum_index[mode])
+    CREATE(vnum_index[mode], IDXTYPE, VNUM_SLOTS);
+  slot = vnum_index[mode];
+
+  name_index_changed(mode);
+
+  if (from <= 0) {
+    for (i = 0; i < VNUM_SLOTS; i++)
+      slot[i] = NOWHERE;
+    from = 0;
   }
-  return (NOTHING);
+  for (i = from; i < entries; i++)
+    if (vnum_of(mode, i) != NOWHERE)
+      slot[VNUM_SLOT(vnum_of(mode, i))] = i;
+
+  if (mode == DB_BOOT_WLD)
+    link_rooms_by_vnum();
 }
 
-/* returns the real number of the zone with given virtual number */
-zone_rnum real_zone(zone_vnum vnum)
+/* Points the slot of a single entry at its rnum, for one that did not move. */
+void index_vnum(int mode, IDXTYPE rnum)
 {
-  zone_rnum bot, top, mid;
+  IDXTYPE vnum = vnum_of(mode, rnum);
+  room_rnum prev;
 
-  bot = 0;
-  top = top_of_zone_table;
+  if (!vnum_index[mode] || vnum_index[mode][VNUM_SLOT(vnum)] == rnum)
+    return;
+  vnum_index[mode][VNUM_SLOT(vnum)] = rnum;
 
-  if (zone_table[bot].number > vnum || zone_table[top].number < vnum)
-    return (NOWHERE);
+  if (mode == DB_BOOT_WLD) {
+    grow_next_room_vnum(rnum + 1);
+    if ((prev = room_before_vnum(vnum)) == NOWHERE) {
+      next_room_vnum[rnum] = first_room_vnum;
+      first_room_vnum = rnum;
+    } else {
+      next_room_vnum[rnum] = next_room_vnum[prev];
+      next_room_vnum[prev] = rnum;
+    }
+  }
+}
 
-  /* perform binary search on zone-table */
-  while (bot <= top) {
-    mid = (bot + top) / 2;
+/* Forgets a vnum that is about to be deleted from its table. */
+void unindex_vnum(int mode, IDXTYPE vnum)
+{
+  room_rnum rnum, prev;
 
-    if ((zone_table + mid)->number == vnum)
-      return (mid);
-    if ((zone_table + mid)->number > vnum)
-      top = mid - 1;
+  if (!vnum_index[mode] || (rnum = vnum_index[mode][VNUM_SLOT(vnum)]) == NOWHERE)
+    return;
+  vnum_index[mode][VNUM_SLOT(vnum)] = NOWHERE;
+
+  if (mode == DB_BOOT_WLD) {
+    if ((prev = room_before_vnum(vnum)) == NOWHERE)
+      first_room_vnum = next_room_vnum[rnum];
     else
-      bot = mid + 1;
+      next_room_vnum[prev] = next_room_vnum[rnum];
+    next_room_vnum[rnum] = NOWHERE;
   }
+}
+
+void free_vnum_index(void)
+{
+  int mode;
+
+  for (mode = 0; mode <= DB_BOOT_QST; mode++)
+    if (vnum_index[mode]) {
+      free(vnum_index[mode]);
+      vnum_index[mode] = NULL;
+    }
+  if (next_room_vnum)
+    free(next_room_vnum);
+  next_room_vnum = NULL;
+  next_room_vnum_size = 0;
+  first_room_vnum = NOWHERE;
+}
+
+/* The rnum of vnum in the table of type mode, NOWHERE if there is none. */
+IDXTYPE vnum_to_rnum(int mode, IDXTYPE vnum)
+{
+  if (vnum_index[mode])
+    return vnum_index[mode][VNUM_SLOT(vnum)];
+  return vnum_search(mode, vnum);
+}
+
+/* Times the tables against the searches they replaced, for "show lookups".
+ * Every vnum from the lowest to the highest of a type is looked up, so the
+ * misses between the zones count as well. */
+void show_vnum_lookups(struct char_data *ch)
+{
+  static const int modes[] = { DB_BOOT_WLD, DB_BOOT_MOB, DB_BOOT_OBJ, DB_BOOT_ZON, DB_BOOT_QST };
+  static const char *names[] = { "rooms", "mobiles", "objects", "zones", "quests" };
+  struct timeval start, stop;
+  volatile IDXTYPE sink = 0;
+  long usecs[2];
+  int m, mode, pass, passes, lo, hi, v, entries, lookups;
+
+  send_to_char(ch, "Type      Entries   Vnums  Lookups   Table ns  Search ns\r\n");
+  for (m = 0; m < (int)(sizeof(modes) / sizeof(modes[0])); m++) {
+    mode = modes[m];
+    if ((entries = vnum_entries(mode)) == 0 || !vnum_index[mode])
+      continue;
+    lo = vnum_of(mode, 0);
+    hi = vnum_of(mode, entries - 1);
+    for (v = 0; v < entries; v++) {
+      if (vnum_of(mode, v) == NOWHERE)
+        continue;
+      lo = MIN(lo, vnum_of(mode, v));
+      hi = MAX(hi, vnum_of(mode, v));
+    }
+    passes = MAX(1, 1000000 / (hi - lo + 1));
+    lookups = passes * (hi - lo + 1);
+
+    gettimeofday(&start, NULL);
+    for (pass = 0; pass < passes; pass++)
+      for (v = lo; v <= hi; v++)
+        sink += vnum_to_rnum(mode, v);
+    gettimeofday(&stop, NULL);
+    usecs[0] = (stop.tv_sec - start.tv_sec) * 1000000L + (stop.tv_usec - start.tv_usec);
+
+    gettimeofday(&start, NULL);
+    for (pass = 0; pass < passes; pass++)
+      for (v = lo; v <= hi; v++)
+        sink += vnum_search(mode, v);
+    gettimeofday(&stop, NULL);
+    usecs[1] = (stop.tv_sec - start.tv_sec) * 1000000L + (stop.tv_usec - start.tv_usec);
+
+    send_to_char(ch, "%-8s  %7d  %6d  %7d  %9.1f  %9.1f\r\n", names[m], entries,
+        hi - lo + 1, lookups, usecs[0] * 1000.0 / lookups, usecs[1] * 1000.0 / lookups);
+  }
+}
+
+/* Reads the player files from memory and through stdio in turns, for "show
+ * reading", after the times the world files took at boot. Each file is read
+ * about a thousand times, so that one read of a small file does not decide. */
+void show_file_reads(struct char_data *ch)
+{
+  static const int modes[] = { DB_BOOT_WLD, DB_BOOT_MOB, DB_BOOT_OBJ, DB_BOOT_TRG, DB_BOOT_QST };
+  struct char_data *victim;
+  struct timeval start;
+  long usecs[2] = { 0, 0 }, reads = 0;
+  int m, i, round, rounds, pass, was_stdio = stdio_reads;
+
+  if (!boot_read_world)
+    send_to_char(ch, "The world was booted from its snapshot, no world files were read.\r\n");
+  else {
+    send_to_char(ch, "World files were read %s at boot:\r\n",
+        stdio_reads ? "through stdio" : "from memory");
+    for (m = 0; m < (int)(sizeof(modes) / sizeof(modes[0])); m++)
+      send_to_char(ch, "  %-6s %6ld ms\r\n", boot_modes[modes[m]], boot_read_msecs[modes[m]]);
+  }
+
+  rounds = MAX(1, 1000 / (top_of_p_table + 1));
+  for (round = 0; round < rounds; round++)
+    for (pass = 0; pass < 2; pass++) {
+      stdio_reads = (round + pass) % 2;
+      gettimeofday(&start, NULL);
+      for (i = 0; i <= top_of_p_table; i++) {
+        SLAB_CREATE(victim, struct char_data, char_slab);
+        clear_char(victim);
+        CREATE(victim->player_specials, struct player_special_data, 1);
+        if (load_char(player_table[i].name, victim) >= 0 && stdio_reads)
+          reads++;
+        free_char(victim);
+      }
+      usecs[stdio_reads] += usecs_since(&start);
+    }
+  stdio_reads = was_stdio;
+
+  if (reads)
+    send_to_char(ch, "Player files, %ld reads each way:\r\n"
+        "  memory %8.1f us a file\r\n"
+        "  stdio  %8.1f us a file\r\n", reads,
+        (double) usecs[0] / reads, (double) usecs[1] / reads);
+}
+
+/* returns the real number of the room with given virtual number */
+room_rnum real_room(room_vnum vnum)
+{
+  return vnum_to_rnum(DB_BOOT_WLD, vnum);
+}
+
+/* Rooms keep the rnum they were added with, so world is only in vnum order
+ * up to the first room built online.  This follows the rooms' vnum chain
+ * instead: it returns the room after rnum by vnum, the first room for
+ * NOWHERE, and NOWHERE after the last one. */
+room_rnum next_room_by_vnum(room_rnum rnum)
+{
+  room_rnum next;
+  int vnum;
+
+  if (next_room_vnum)
+    return (rnum == NOWHERE) ? first_room_vnum : next_room_vnum[rnum];
+
+  /* Before the rooms are indexed, try each vnum after rnum's. */
+  vnum = (rnum == NOWHERE) ? IDXTYPE_MIN : GET_ROOM_VNUM(rnum) + 1;
+  for (; vnum <= IDXTYPE_MAX; vnum++)
+    if ((next = real_room(vnum)) != NOWHERE)
+      return (next);
   return (NOWHERE);
 }
 
+/* returns the real number of the monster with given virtual number */
+mob_rnum real_mobile(mob_vnum vnum)
+{
+  return vnum_to_rnum(DB_BOOT_MOB, vnum);
+}
+
+/* returns the real number of the object with given virtual number */
+obj_rnum real_object(obj_vnum vnum)
+{
+  return vnum_to_rnum(DB_BOOT_OBJ, vnum);
+}
+
+/* returns the real number of the zone with given virtual number */
+zone_rnum real_zone(zone_vnum vnum)
+{
+  return vnum_to_rnum(DB_BOOT_ZON, vnum);
+}
+
 /* Extend later to include more checks and add checks for unknown bitvectors. */
 static int check_object(struct obj_data *obj)
 {
@@ -24,6 +24,9 @@
 #define DB_BOOT_TRG	6
 #define DB_BOOT_QST 7
 
+/* most threads index_boot() reads world files on, see -j */
+#define MAX_BOOT_THREADS 16
+
 #if defined(CIRCLE_MACINTOSH)
 #define LIB_WORLD	":world:"
 #define LIB_TEXT	":text:"
@@ -84,6 +87,8 @@
 #define TRG_PREFIX  LIB_WORLD"trg"SLASH	/* trigger files	*/
 #define HLP_PREFIX  LIB_TEXT"help"SLASH /* Help files           */
 #define QST_PREFIX  LIB_WORLD"qst"SLASH /* quest files          */
+#define WORLD_SNAPSHOT LIB_WORLD"world.snap" /* booted world, see worldsnap.c */
+#define ROOM_DESC_STORE LIB_WORLD"world.desc" /* paged room text, see descstore.c */
 
 #define CREDITS_FILE	LIB_TEXT"credits" /* for the 'credits' command	*/
 #define NEWS_FILE	LIB_TEXT"news"	/* for the 'news' command	*/
@@ -126,6 +131,7 @@
 #define BADPWS_LOGFILE     PREFIX_LOGFILE"badpws"
 #define OLC_LOGFILE        PREFIX_LOGFILE"olc"
 #define TRIGGER_LOGFILE    PREFIX_LOGFILE"trigger"
+#define TRIGPROF_LOGFILE   PREFIX_LOGFILE"trigprof"
 /**/
 /* END: Assumed default locations for logfiles, mainly used in do_file. */
 
@@ -189,6 +195,12 @@ struct zone_data {
    zone_vnum number;	    /* virtual number of this zone	  */
    struct reset_com *cmd;   /* command table for reset	          */
 
+   int resets;              /* resets since boot                  */
+   long reset_usecs;        /* time the last reset took           */
+   long reset_max_usecs;    /* longest reset so far               */
+   int reset_pulses;        /* pulses the last reset was spread on */
+   int players;             /* players in the zone, save nohassle */
+
    /* Reset mode:
     *   0: Don't reset, and don't update age.
     *   1: Reset if no PC's are located in zone.
@@ -197,7 +209,8 @@ struct zone_data {
 
 /* for queueing zones for update   */
 struct reset_q_element {
-   zone_rnum zone_to_reset;            /* ref to zone_data */
+   zone_vnum zone_to_reset;            /* ref to zone_data */
+   time_t queued;                      /* when it came due */
    struct reset_q_element *next;
 };
 
@@ -236,12 +249,16 @@ struct obj_save_data_t {
 typedef struct obj_save_data_t obj_save_data;
 
 
+struct map_file;	/* mapfile.h */
+
 /* public procedures in db.c */
 void  boot_db(void);
 void  destroy_db(void);
 char *fread_action(FILE *fl, int nr);
 int   create_entry(char *name);
 void  zone_update(void);
+void  run_zone_resets(void);
+void  show_zone_resets(struct char_data *ch);
 char  *fread_string(FILE *fl, const char *error);
 char  *fread_clean_string(FILE *fl, const char *error);
 int   fread_number(FILE *fp);
@@ -260,8 +277,17 @@ void  new_mobile_data(struct char_data *ch);
 
 zone_rnum real_zone(zone_vnum vnum);
 room_rnum real_room(room_vnum vnum);
+room_rnum next_room_by_vnum(room_rnum rnum);
 mob_rnum real_mobile(mob_vnum vnum);
 obj_rnum real_object(obj_vnum vnum);
+IDXTYPE vnum_to_rnum(int mode, IDXTYPE vnum);
+void  index_vnums(int mode, int from);
+void  index_vnum(int mode, IDXTYPE rnum);
+void  unindex_vnum(int mode, IDXTYPE vnum);
+void  free_vnum_index(void);
+void  show_vnum_lookups(struct char_data *ch);
+void  show_file_reads(struct char_data *ch);
+long  usecs_since(struct timeval *start);
 
 /* Public Procedures from objsave.c */
 void  Crash_save_all(void);
@@ -274,7 +300,7 @@ int Crash_delete_crashfile(struct char_data *ch);
 int Crash_delete_file(char *name);
 void update_obj_file(void);
 void Crash_rentsave(struct char_data *ch, int cost);
-obj_save_data *objsave_parse_objects(FILE *fl);
+obj_save_data *objsave_parse_objects(struct map_file *fl);
 int objsave_save_obj_record(struct obj_data *obj, FILE *fl, int location);
 /* Special functions */
 SPECIAL(receptionist);
@@ -305,12 +331,12 @@ int    vnum_object(char *searchname, struct char_data *ch);
 int    vnum_room(char *, struct char_data *);
 int    vnum_trig(char *, struct char_data *);
 
-void setup_dir(FILE *fl, int room, int dir);
+void setup_dir(struct map_file *fl, int room, int dir);
 void index_boot(int mode);
-void discrete_load(FILE *fl, int mode, char *filename);
-void parse_room(FILE *fl, int virtual_nr);
-void parse_mobile(FILE *mob_f, int nr);
-char *parse_object(FILE *obj_f, int nr);
+void discrete_load(struct map_file *fl, int mode, char *filename);
+void parse_room(struct map_file *fl, int virtual_nr);
+void parse_mobile(struct map_file *mob_f, int nr);
+char *parse_object(struct map_file *obj_f, int nr);
 int is_empty(zone_rnum zone_nr);
 void reset_zone(zone_rnum zone);
 void reboot_wizlists(void);
@@ -352,6 +378,8 @@ extern struct help_index_element *help_table;
 /* Mud configurable variables */
 extern int no_mail;
 extern int mini_mud;
+extern int boot_threads;
+extern int page_room_text;
 extern int no_rent_check;
 extern time_t boot_time;
 extern int circle_restrict;
@@ -0,0 +1,173 @@
+/**************************************************************************
+*  File: descstore.c                                       Part of tbaMUD *
+*  Usage: Room descriptions paged in from a mapped file on demand.        *
+*                                                                         *
+*  All rights reserved.  See license for complete information.            *
+**************************************************************************/
+
+#define MEM_TAG MEM_WORLD
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "db.h"
+#include "strpool.h"
+#include "descstore.h"
+#include <sys/mman.h>
+#include <fcntl.h>
+
+/* Room descriptions are most of the world's text, and most rooms go unseen
+ * for hours. With -p they are not kept on the heap: once the world is booted,
+ * from the world files or the snapshot, the descriptions and extra
+ * descriptions of all rooms are written to world/world.desc, each text once
+ * and NUL terminated, and the file is mapped read-only. The rooms then point
+ * into the map. The kernel reads a description in when it is first shown and
+ * may drop it again when memory is short, and nothing that reads room text
+ * needs to know.
+ *
+ * The map is never written to. OLC saves and the other code that replaces a
+ * room's text put heap strings in its place, and str_release() leaves text in
+ * the map alone. */
+
+static char *desc_map = NULL;
+static size_t desc_map_len = 0;
+static int desc_texts = 0;
+
+/* Texts already written, by address: pooled rooms share their text. */
+struct desc_seen {
+  const char *str;
+  long offset;
+};
+
+int desc_store_has(const char *str)
+{
+  return desc_map && str >= desc_map && str < desc_map + desc_map_len;
+}
+
+/* Collects the room fields that go to the store, in a fixed order. */
+static char ***room_texts(int *count)
+{
+  struct extra_descr_data *ex;
+  char ***texts;
+  room_rnum i;
+  int n, pass;
+
+  texts = NULL;
+  for (pass = 0; pass < 2; pass++) {
+    n = 0;
+    for (i = 0; i <= top_of_world; i++) {
+      if (world[i].description) {
+        if (texts)
+          texts[n] = &world[i].description;
+        n++;
+      }
+      for (ex = world[i].ex_description; ex; ex = ex->next)
+        if (ex->description) {
+          if (texts)
+            texts[n] = &ex->description;
+          n++;
+        }
+    }
+    if (!texts && n > 0)
+      CREATE(texts, char **, n);
+  }
+  *count = n;
+  return texts;
+}
+
+static long write_text(FILE *fl, const char *str, struct desc_seen *seen,
+                       int seen_size, long *pos)
+{
+  unsigned long h = ((unsigned long) str >> 4) & (seen_size - 1);
+  size_t len;
+
+  for (; seen[h].str; h = (h + 1) & (seen_size - 1))
+    if (seen[h].str == str)
+      return seen[h].offset;
+
+  len = strlen(str) + 1;
+  if (fwrite(str, 1, len, fl) != len)
+    return -1;
+  seen[h].str = str;
+  seen[h].offset = *pos;
+  *pos += len;
+  return seen[h].offset;
+}
+
+/** Moves the text of every room into world/world.desc and maps it. Rooms keep
+ * their heap strings if anything goes wrong. */
+void page_room_descriptions(void)
+{
+  struct desc_seen *seen;
+  char ***texts;
+  long *offsets, pos = 0;
+  int count, seen_size, i, fd;
+  FILE *fl;
+  void *map;
+
+  if (!(texts = room_texts(&count)))
+    return;
+
+  for (seen_size = 1024; seen_size < count * 2; seen_size *= 2)
+    ;
+  CREATE(seen, struct desc_seen, seen_size);
+  CREATE(offsets, long, count);
+
+  if (!(fl = fopen(ROOM_DESC_STORE ".new", "wb"))) {
+    log("SYSERR: Could not write room descriptions to %s: %s", ROOM_DESC_STORE, strerror(errno));
+    goto done;
+  }
+  for (i = 0; i < count; i++)
+    if ((offsets[i] = write_text(fl, *texts[i], seen, seen_size, &pos)) < 0)
+      break;
+  if (fclose(fl) != 0 || i < count || rename(ROOM_DESC_STORE ".new", ROOM_DESC_STORE) < 0) {
+    log("SYSERR: Could not write room descriptions to %s: %s", ROOM_DESC_STORE, strerror(errno));
+    remove(ROOM_DESC_STORE ".new");
+    goto done;
+  }
+
+  if ((fd = open(ROOM_DESC_STORE, O_RDONLY)) < 0 ||
+      (map = mmap(NULL, pos, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+    log("SYSERR: Could not map room descriptions %s: %s", ROOM_DESC_STORE, strerror(errno));
+    if (fd >= 0)
+      close(fd);
+    goto done;
+  }
+  close(fd);
+
+  /* The advice lets the kernel skip read-ahead: rooms are looked at in no
+   * particular order. */
+  madvise(map, pos, MADV_RANDOM);
+  desc_map = map;
+  desc_map_len = pos;
+
+  for (i = 0; i < count; i++) {
+    str_release(*texts[i]);
+    *texts[i] = desc_map + offsets[i];
+  }
+  desc_texts = count;
+  log("   %d room texts paged from %s, %ld bytes.", count, ROOM_DESC_STORE, pos);
+
+done:
+  free(offsets);
+  free(seen);
+  free(texts);
+}
+
+/** Unmaps the store. Call it only once no room points into it. */
+void free_desc_store(void)
+{
+  if (!desc_map)
+    return;
+  munmap(desc_map, desc_map_len);
+  desc_map = NULL;
+  desc_map_len = 0;
+  desc_texts = 0;
+}
+
+void desc_store_stats(int *texts, long *bytes)
+{
+  *texts = desc_texts;
+  *bytes = desc_map_len;
+}
@@ -0,0 +1,17 @@
+/**
+* @file descstore.h
+* Read-only, memory mapped store of room descriptions, read in by the kernel
+* only when a room's text is needed.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*/
+#ifndef _DESCSTORE_H_
+#define _DESCSTORE_H_
+
+void page_room_descriptions(void);
+void free_desc_store(void);
+int desc_store_has(const char *str);
+void desc_store_stats(int *texts, long *bytes);
+
+#endif /* _DESCSTORE_H_ */
@@ -0,0 +1,454 @@
+/**************************************************************************
+*  File: dg_check.c                                        Part of tbaMUD *
+*  Usage: Reading the lines of a trigger, and checking them for mistakes. *
+*                                                                         *
+*  All rights reserved.  See license for complete information.            *
+**************************************************************************/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "dg_scripts.h"
+#include "dg_check.h"
+
+/* This file is built into both the mud and util/dglint. script_driver() and
+ * the command interpreters of dg_objcmd.c and dg_wldcmd.c read a trigger
+ * with dg_line_type(), dg_script_command() and dg_find_command(); the checks
+ * below follow the same rules, so what dglint and trigedit warn about is what
+ * the mud would trip over at run time. Nothing here may use the rest of the
+ * mud: dglint has only the C library. */
+
+/* The commands script_driver() handles itself, see the DG_CMD_ numbers. */
+const struct dg_script_cmd dg_script_cmds[] = {
+  { "eval"     , TRUE  },
+  { "nop"      , FALSE },
+  { "extract"  , TRUE  },
+  { "dg_letter", TRUE  },
+  { "makeuid"  , TRUE  },
+  { "halt"     , FALSE },
+  { "dg_cast"  , TRUE  },
+  { "dg_affect", TRUE  },
+  { "global"   , TRUE  },
+  { "context"  , TRUE  },
+  { "remote"   , TRUE  },
+  { "rdelete"  , TRUE  },
+  { "return"   , TRUE  },
+  { "set"      , TRUE  },
+  { "unset"    , TRUE  },
+  { "wait"     , TRUE  },
+  { "attach"   , TRUE  },
+  { "detach"   , TRUE  },
+  { "\n"       , FALSE }
+};
+
+/* The object and room command names, from the lists in dg_check.h. */
+#define DG_CMD_NAME(name, func, subcmd) name,
+
+const char *dg_obj_cmds[] = {
+  "RESERVED",  /* this must be first -- for specprocs */
+  DG_OBJ_COMMANDS(DG_CMD_NAME)
+  "\n"
+};
+
+const char *dg_wld_cmds[] = {
+  "RESERVED",  /* this must be first -- for specprocs */
+  DG_WLD_COMMANDS(DG_CMD_NAME)
+  "\n"
+};
+
+/* The fields var_subst() in dg_variables.c knows. Keep these in step. */
+static const char *char_fields[] = {
+  "affect", "alias", "align", "armor", "canbeseen", "cha", "class", "con",
+  "damroll", "dex", "drunk", "eq", "exp", "fighting", "follower", "global",
+  "gold", "has_item", "hasattached", "heshe", "himher", "hisher", "hitp",
+  "hitroll", "hunger", "id", "int", "inventory", "is_killer", "is_pc",
+  "is_thief", "level", "mana", "master", "maxhitp", "maxmana", "maxmove",
+  "move", "name", "next_in_room", "pos", "prac", "pref", "qp", "qpnts",
+  "quest", "questdone", "questpoints", "race", "room", "saving_breath",
+  "saving_para", "saving_petri", "saving_rod", "saving_spell", "sex", "skill",
+  "skillset", "str", "stradd", "thirst", "title", "varexists", "vnum",
+  "weight", "wis", "\n"
+};
+
+static const char *obj_fields[] = {
+  "affects", "carried_by", "contents", "cost", "cost_per_day", "count",
+  "extra", "has_in", "hasattached", "id", "is_inroom", "is_pc", "name",
+  "next_in_list", "oset", "room", "shortdesc", "timer", "type", "val0",
+  "val1", "val2", "val3", "vnum", "wearflag", "weight", "worn_by", "\n"
+};
+
+static const char *room_fields[] = {
+  "contents", "down", "east", "hasattached", "id", "name", "north", "people",
+  "roomflag", "sector", "south", "up", "vnum", "weather", "west", "zonename",
+  "zonenumber", "\n"
+};
+
+static const char *text_fields[] = {
+  "strlen", "trim", "contains", "car", "cdr", "charat", "mudcommand", "\n"
+};
+
+/* The trigger types that mean something for each attach type. */
+#define MTRIG_VALID (MTRIG_GLOBAL | MTRIG_RANDOM | MTRIG_COMMAND | \
+    MTRIG_SPEECH | MTRIG_ACT | MTRIG_DEATH | MTRIG_GREET | MTRIG_GREET_ALL | \
+    MTRIG_ENTRY | MTRIG_RECEIVE | MTRIG_FIGHT | MTRIG_HITPRCNT | MTRIG_BRIBE | \
+    MTRIG_LOAD | MTRIG_MEMORY | MTRIG_CAST | MTRIG_LEAVE | MTRIG_DOOR | \
+    MTRIG_TIME)
+#define OTRIG_VALID (OTRIG_GLOBAL | OTRIG_RANDOM | OTRIG_COMMAND | \
+    OTRIG_TIMER | OTRIG_GET | OTRIG_DROP | OTRIG_GIVE | OTRIG_WEAR | \
+    OTRIG_REMOVE | OTRIG_LOAD | OTRIG_CAST | OTRIG_LEAVE | OTRIG_CONSUME | \
+    OTRIG_TIME)
+#define WTRIG_VALID (WTRIG_GLOBAL | WTRIG_RANDOM | WTRIG_COMMAND | \
+    WTRIG_SPEECH | WTRIG_RESET | WTRIG_ENTER | WTRIG_DROP | WTRIG_CAST | \
+    WTRIG_LEAVE | WTRIG_DOOR | WTRIG_LOGIN | WTRIG_TIME)
+
+static void check_report(struct dg_check *chk, int error, int line,
+    const char *fmt, ...) __attribute__ ((format (printf, 4, 5)));
+
+static void check_report(struct dg_check *chk, int error, int line,
+    const char *fmt, ...)
+{
+  char msg[MAX_STRING_LENGTH];
+  va_list args;
+
+  va_start(args, fmt);
+  vsnprintf(msg, sizeof(msg), fmt, args);
+  va_end(args);
+
+  chk->report(chk, error, line, msg);
+}
+
+static int in_list(const char **list, const char *word, size_t len)
+{
+  for (; **list != '\n'; list++)
+    if (strlen(*list) == len && !strn_cmp(*list, word, len))
+      return (TRUE);
+  return (FALSE);
+}
+
+/* What a line of a trigger is, leading spaces and all. */
+int dg_line_type(const char *line)
+{
+  while (*line && isspace((unsigned char) *line))
+    line++;
+
+  if (!*line || *line == '*')
+    return (DG_LINE_COMMENT);
+  if (!strn_cmp(line, "if ", 3))
+    return (DG_LINE_IF);
+  if (!strn_cmp(line, "elseif ", 7))
+    return (DG_LINE_ELSEIF);
+  if (!strn_cmp(line, "else", 4))
+    return (DG_LINE_ELSE);
+  if (!strn_cmp(line, "while ", 6))
+    return (DG_LINE_WHILE);
+  if (!strn_cmp(line, "switch ", 7))
+    return (DG_LINE_SWITCH);
+  if (!strn_cmp(line, "end", 3))
+    return (DG_LINE_END);
+  if (!strn_cmp(line, "done", 4))
+    return (DG_LINE_DONE);
+  if (!strn_cmp(line, "break", 5))
+    return (DG_LINE_BREAK);
+  if (!strn_cmp(line, "case", 4))
+    return (DG_LINE_CASE);
+  if (!strn_cmp(line, "default", 7))
+    return (DG_LINE_DEFAULT);
+
+  return (DG_LINE_COMMAND);
+}
+
+/* The DG_CMD_ number of a command script_driver() runs itself, or -1. */
+int dg_script_command(const char *cmd)
+{
+  size_t len;
+  int i;
+
+  for (i = 0; *dg_script_cmds[i].name != '\n'; i++) {
+    len = strlen(dg_script_cmds[i].name);
+    if (!strn_cmp(cmd, dg_script_cmds[i].name, len) &&
+        (!cmd[len] || isspace((unsigned char) cmd[len])))
+      return (i);
+  }
+
+  return (-1);
+}
+
+/* The command of dg_obj_cmds[] or dg_wld_cmds[] the first word of arg is an
+ * abbreviation of, or -1. As in the mud's own interpreter, the first match
+ * wins and case matters. */
+int dg_find_command(const char **cmds, const char *arg)
+{
+  size_t len;
+  int i;
+
+  for (len = 0; arg[len] && !isspace((unsigned char) arg[len]); len++);
+  if (!len)
+    return (-1);
+
+  for (i = 1; *cmds[i] != '\n'; i++)
+    if (!strncmp(cmds[i], arg, len))
+      return (i);
+
+  return (-1);
+}
+
+/* Calls found() for each variable a global or remote line makes readable as
+ * a field, as in %actor.name%. */
+void dg_global_names(const char *line,
+    void (*found)(const char *name, size_t len, void *data), void *data)
+{
+  size_t len;
+  int cmd;
+
+  while (*line && isspace((unsigned char) *line))
+    line++;
+  if ((cmd = dg_script_command(line)) != DG_CMD_GLOBAL && cmd != DG_CMD_REMOTE)
+    return;
+
+  for (line += strlen(dg_script_cmds[cmd].name); *line; line += len) {
+    while (*line && isspace((unsigned char) *line))
+      line++;
+    for (len = 0; line[len] && !isspace((unsigned char) line[len]); len++);
+    if (len && *line != '%')
+      found(line, len, data);
+    if (cmd == DG_CMD_REMOTE)  /* remote <name> <id> */
+      break;
+  }
+}
+
+/* Checks the %var.field% references on one line. */
+static void check_vars(struct dg_check *chk, int line, const char *cmd)
+{
+  const char *p, *end, *var, *field, **fields, *type;
+  size_t vlen, flen;
+  int count = 0;
+
+  for (p = cmd; *p; p++)
+    if (*p == '%')
+      count++;
+  if (count % 2)
+    check_report(chk, FALSE, line, "unmatched '%%' in '%s'", cmd);
+
+  if (!chk->is_global)
+    return;
+
+  for (p = strchr(cmd, '%'); p && (end = strchr(p + 1, '%')); p = strchr(end + 1, '%')) {
+    var = p + 1;
+    for (vlen = 0; var + vlen < end && var[vlen] != '.' && var[vlen] != '('; vlen++);
+    if (var + vlen >= end || var[vlen] != '.')
+      continue;
+
+    field = var + vlen + 1;
+    for (flen = 0; field + flen < end && field[flen] != '.' && field[flen] != '(' &&
+         !isspace((unsigned char) field[flen]); flen++);
+    if (!flen || (field + flen < end && isspace((unsigned char) field[flen])))
+      continue;
+
+    if ((vlen == 5 && !strn_cmp(var, "actor", 5)) ||
+        (vlen == 6 && !strn_cmp(var, "victim", 6))) {
+      fields = char_fields;
+      type = "char";
+    } else if (vlen == 4 && !strn_cmp(var, "self", 4)) {
+      switch (chk->attach_type) {
+        case MOB_TRIGGER: fields = char_fields; type = "char"; break;
+        case OBJ_TRIGGER: fields = obj_fields;  type = "obj";  break;
+        default:          fields = room_fields; type = "room"; break;
+      }
+    } else
+      continue;
+
+    if (!in_list(fields, field, flen) && !in_list(text_fields, field, flen) &&
+        !chk->is_global(field, flen, chk->data))
+      check_report(chk, FALSE, line, "unknown %s field '%.*s' in %%%.*s%%", type,
+          (int) flen, field, (int) (end - var), var);
+  }
+}
+
+void dg_check_start(struct dg_check *chk, int attach_type)
+{
+  chk->attach_type = attach_type;
+  chk->depth = 0;
+}
+
+/* Checks the header of a trigger: its types, numeric argument and argument. */
+void dg_check_header(struct dg_check *chk, int line, long trigger_type,
+    int narg, const char *arglist)
+{
+  long valid;
+
+  switch (chk->attach_type) {
+    case MOB_TRIGGER: valid = MTRIG_VALID; break;
+    case OBJ_TRIGGER: valid = OTRIG_VALID; break;
+    case WLD_TRIGGER: valid = WTRIG_VALID; break;
+    default:
+      check_report(chk, TRUE, line, "attach type %d is not 0 (mob), 1 (obj) or 2 (room)",
+          chk->attach_type);
+      valid = 0;
+      break;
+  }
+  if (!trigger_type)
+    check_report(chk, FALSE, line, "has no trigger type and will never run");
+  else if (valid && (trigger_type & ~valid))
+    check_report(chk, FALSE, line, "has trigger type bits 0x%lx that mean nothing for this attach type",
+        trigger_type & ~valid);
+
+  /* Command triggers are bit 2 and speech triggers bit 3 for each type. */
+  if ((!arglist || !*arglist) &&
+      ((trigger_type & MTRIG_COMMAND) ||
+       ((chk->attach_type == MOB_TRIGGER || chk->attach_type == WLD_TRIGGER) &&
+        (trigger_type & MTRIG_SPEECH)) ||
+       (chk->attach_type == MOB_TRIGGER && (trigger_type & MTRIG_ACT))))
+    check_report(chk, TRUE, line, "command, speech or act trigger without a text argument");
+
+  if ((trigger_type & MTRIG_RANDOM) && (narg <= 0 || narg > 100))
+    check_report(chk, FALSE, line, "random trigger with a %d%% chance", narg);
+
+  if (chk->attach_type == OBJ_TRIGGER && (trigger_type & OTRIG_COMMAND) &&
+      !(narg & (OCMD_EQUIP | OCMD_INVEN | OCMD_ROOM)))
+    check_report(chk, FALSE, line, "object command trigger that fires neither worn, carried nor in the room");
+}
+
+/* Checks one line of a script, following the block rules of script_driver(),
+ * find_end(), find_else_end() and find_done(). */
+void dg_check_line(struct dg_check *chk, int line, const char *cmd)
+{
+  const char *p, *s;
+  int type, in_loop = 0, i;
+
+  for (p = cmd; *p && isspace((unsigned char) *p); p++);
+
+  for (i = chk->depth - 1; i >= 0; i--)
+    if (chk->stack[i].type != DG_LINE_IF) {
+      in_loop = chk->stack[i].type;
+      break;
+    }
+
+  switch ((type = dg_line_type(p))) {
+    case DG_LINE_COMMENT:
+      break;
+
+    case DG_LINE_IF:
+    case DG_LINE_WHILE:
+    case DG_LINE_SWITCH:
+      check_vars(chk, line, p);
+      if (type == DG_LINE_IF) {
+        for (s = p + 3; *s == ' '; s++);
+        if (!*s)
+          check_report(chk, TRUE, line, "'if' without a condition");
+      }
+      if (chk->depth < DG_CHECK_NEST) {
+        chk->stack[chk->depth].type = type;
+        chk->stack[chk->depth].line = line;
+        chk->stack[chk->depth++].seen_else = FALSE;
+      }
+      break;
+
+    case DG_LINE_ELSEIF:
+    case DG_LINE_ELSE:
+      if (type == DG_LINE_ELSE && isalnum((unsigned char) p[4]))
+        check_report(chk, FALSE, line, "'%s' is read as 'else'", p);
+      if (!chk->depth || chk->stack[chk->depth - 1].type != DG_LINE_IF)
+        check_report(chk, TRUE, line, "'%s' without 'if'",
+            type == DG_LINE_ELSEIF ? "elseif" : "else");
+      else if (chk->stack[chk->depth - 1].seen_else)
+        check_report(chk, FALSE, line, "'%s' after 'else' is never reached",
+            type == DG_LINE_ELSEIF ? "elseif" : "else");
+      else if (type == DG_LINE_ELSE)
+        chk->stack[chk->depth - 1].seen_else = TRUE;
+      if (type == DG_LINE_ELSEIF)
+        check_vars(chk, line, p);
+      break;
+
+    case DG_LINE_END:
+      if (isalnum((unsigned char) p[3]))
+        check_report(chk, FALSE, line, "'%s' is read as 'end'", p);
+      if (!chk->depth || chk->stack[chk->depth - 1].type != DG_LINE_IF)
+        check_report(chk, TRUE, line, "'end' without 'if'");
+      else
+        chk->depth--;
+      break;
+
+    case DG_LINE_DONE:
+      if (!chk->depth)
+        check_report(chk, TRUE, line, "'done' without 'while' or 'switch'");
+      else if (chk->stack[chk->depth - 1].type == DG_LINE_IF)
+        check_report(chk, TRUE, line, "'done' closes the 'if' of line %d, expected 'end'",
+            chk->stack[chk->depth - 1].line);
+      else
+        chk->depth--;
+      break;
+
+    case DG_LINE_BREAK:
+      if (!in_loop)
+        check_report(chk, TRUE, line, "'break' outside 'while' or 'switch'");
+      break;
+
+    case DG_LINE_CASE:
+    case DG_LINE_DEFAULT:
+      if (in_loop != DG_LINE_SWITCH)
+        check_report(chk, TRUE, line, "'%s' outside 'switch'", p);
+      break;
+
+    default:
+      /* An ordinary command, run after variable substitution. */
+      check_vars(chk, line, p);
+      if (*p == '%')
+        break;
+
+      if ((i = dg_script_command(p)) >= 0) {
+        for (s = p + strlen(dg_script_cmds[i].name); *s == ' '; s++);
+        if (dg_script_cmds[i].need_arg && !*s)
+          check_report(chk, TRUE, line, "'%s' without an argument", dg_script_cmds[i].name);
+        else if (i == DG_CMD_WAIT && strn_cmp(s, "until ", 6) &&
+                 !isdigit((unsigned char) *s) && *s != '%')
+          check_report(chk, TRUE, line, "'wait %s' is neither a number nor 'until <time>'", s);
+        else if (i == DG_CMD_EVAL && !strchr(s, ' '))
+          check_report(chk, FALSE, line, "'eval %s' has no expression", s);
+      } else if (chk->attach_type == OBJ_TRIGGER || chk->attach_type == WLD_TRIGGER) {
+        /* A mob can run any player command or social, so those are not
+         * checked. */
+        if (dg_find_command(chk->attach_type == OBJ_TRIGGER ? dg_obj_cmds :
+            dg_wld_cmds, p) < 0)
+          check_report(chk, TRUE, line, "unknown %s command '%s'",
+              chk->attach_type == OBJ_TRIGGER ? "object" : "room", p);
+      }
+      break;
+  }
+}
+
+/* Checks a whole script as it is typed, lines separated by \r\n, the first
+ * one being line first_line. */
+void dg_check_text(struct dg_check *chk, int first_line, const char *text)
+{
+  char cmd[MAX_STRING_LENGTH];
+  const char *e;
+  size_t len;
+
+  for (; text && *text; text = e, first_line++) {
+    for (e = text; *e && *e != '\r' && *e != '\n'; e++);
+    if ((len = e - text) >= sizeof(cmd))
+      len = sizeof(cmd) - 1;
+    memcpy(cmd, text, len);
+    cmd[len] = '\0';
+    if (*e == '\r')
+      e++;
+    if (*e == '\n')
+      e++;
+
+    dg_check_line(chk, first_line, cmd);
+  }
+}
+
+/* Reports the blocks still open at the end of a script. */
+void dg_check_end(struct dg_check *chk)
+{
+  int i;
+
+  for (i = chk->depth - 1; i >= 0; i--)
+    check_report(chk, TRUE, chk->stack[i].line, "'%s' without '%s'",
+        chk->stack[i].type == DG_LINE_IF ? "if" :
+        chk->stack[i].type == DG_LINE_WHILE ? "while" : "switch",
+        chk->stack[i].type == DG_LINE_IF ? "end" : "done");
+  chk->depth = 0;
+}
@@ -0,0 +1,130 @@
+/**
+* @file dg_check.h
+* How the script engine reads the lines of a trigger, and the checks made on
+* them before it runs them. Built into both the mud and util/dglint, so the
+* two read scripts the same way.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*/
+#ifndef _DG_CHECK_H_
+#define _DG_CHECK_H_
+
+/* What a line of a trigger is to script_driver(), see dg_line_type(). */
+#define DG_LINE_COMMAND  0  /**< Anything else, run after var_subst() */
+#define DG_LINE_COMMENT  1  /**< Blank, or starting with '*' */
+#define DG_LINE_IF       2
+#define DG_LINE_ELSEIF   3
+#define DG_LINE_ELSE     4
+#define DG_LINE_END      5
+#define DG_LINE_WHILE    6
+#define DG_LINE_SWITCH   7
+#define DG_LINE_CASE     8
+#define DG_LINE_DEFAULT  9
+#define DG_LINE_BREAK    10
+#define DG_LINE_DONE     11
+
+/* The commands script_driver() runs itself, in the order of
+ * dg_script_cmds[]. */
+#define DG_CMD_EVAL      0
+#define DG_CMD_NOP       1
+#define DG_CMD_EXTRACT   2
+#define DG_CMD_LETTER    3
+#define DG_CMD_MAKEUID   4
+#define DG_CMD_HALT      5
+#define DG_CMD_CAST      6
+#define DG_CMD_AFFECT    7
+#define DG_CMD_GLOBAL    8
+#define DG_CMD_CONTEXT   9
+#define DG_CMD_REMOTE    10
+#define DG_CMD_RDELETE   11
+#define DG_CMD_RETURN    12
+#define DG_CMD_SET       13
+#define DG_CMD_UNSET     14
+#define DG_CMD_WAIT      15
+#define DG_CMD_ATTACH    16
+#define DG_CMD_DETACH    17
+
+/* The object and room commands: name, function and subcommand of each, in
+ * the order of their numbers. dg_check.c takes the names for dg_obj_cmds[]
+ * and dg_wld_cmds[], dg_objcmd.c and dg_wldcmd.c the rest for their
+ * dispatch tables, so the two can not get out of step. */
+#define DG_OBJ_COMMANDS(CMD) \
+  CMD("oasound "    , do_oasound   , 0) \
+  CMD("oat "        , do_oat       , 0) \
+  CMD("odoor "      , do_odoor     , 0) \
+  CMD("odamage "    , do_odamage   , 0) \
+  CMD("oecho "      , do_oecho     , 0) \
+  CMD("oechoaround ", do_osend     , SCMD_OECHOAROUND) \
+  CMD("oforce "     , do_oforce    , 0) \
+  CMD("oload "      , do_dgoload   , 0) \
+  CMD("opurge "     , do_opurge    , 0) \
+  CMD("orecho "     , do_orecho    , 0) \
+  CMD("osend "      , do_osend     , SCMD_OSEND) \
+  CMD("osetval "    , do_osetval   , 0) \
+  CMD("oteleport "  , do_oteleport , 0) \
+  CMD("otimer "     , do_otimer    , 0) \
+  CMD("otransform " , do_otransform, 0) \
+  CMD("ozoneecho "  , do_ozoneecho , 0) /* fix by Rumble */ \
+  CMD("omove "      , do_omove     , 0)
+
+#define DG_WLD_COMMANDS(CMD) \
+  CMD("wasound "    , do_wasound   , 0) \
+  CMD("wdoor "      , do_wdoor     , 0) \
+  CMD("wecho "      , do_wecho     , 0) \
+  CMD("wechoaround ", do_wsend     , SCMD_WECHOAROUND) \
+  CMD("wforce "     , do_wforce    , 0) \
+  CMD("wload "      , do_wload     , 0) \
+  CMD("wpurge "     , do_wpurge    , 0) \
+  CMD("wrecho "     , do_wrecho    , 0) \
+  CMD("wsend "      , do_wsend     , SCMD_WSEND) \
+  CMD("wteleport "  , do_wteleport , 0) \
+  CMD("wzoneecho "  , do_wzoneecho , 0) \
+  CMD("wdamage "    , do_wdamage   , 0) \
+  CMD("wat "        , do_wat       , 0) \
+  CMD("wmove "      , do_wmove     , 0)
+
+/** Deepest nesting of blocks dg_check_line() follows. */
+#define DG_CHECK_NEST    64
+
+struct dg_script_cmd {
+  const char *name;
+  int need_arg;          /**< Does nothing useful without an argument */
+};
+
+/** The state of a trigger being checked, one line at a time. */
+struct dg_check {
+  int attach_type;       /**< MOB_TRIGGER, OBJ_TRIGGER or WLD_TRIGGER */
+  /** Is this name made global or remote by some trigger? NULL to leave out
+   * the checks of %actor%, %victim% and %self% fields. */
+  int (*is_global)(const char *name, size_t len, void *data);
+  /** Told about each problem found, error FALSE for a warning. */
+  void (*report)(struct dg_check *chk, int error, int line, const char *msg);
+  void *data;            /**< For the two functions above */
+
+  int depth;             /**< Blocks open at this line */
+  struct {
+    int type;            /**< DG_LINE_IF, DG_LINE_WHILE or DG_LINE_SWITCH */
+    int line;
+    int seen_else;
+  } stack[DG_CHECK_NEST];
+};
+
+extern const struct dg_script_cmd dg_script_cmds[];
+extern const char *dg_obj_cmds[];
+extern const char *dg_wld_cmds[];
+
+int dg_line_type(const char *line);
+int dg_script_command(const char *cmd);
+int dg_find_command(const char **cmds, const char *arg);
+void dg_global_names(const char *line,
+    void (*found)(const char *name, size_t len, void *data), void *data);
+
+void dg_check_start(struct dg_check *chk, int attach_type);
+void dg_check_header(struct dg_check *chk, int line, long trigger_type,
+    int narg, const char *arglist);
+void dg_check_line(struct dg_check *chk, int line, const char *cmd);
+void dg_check_text(struct dg_check *chk, int first_line, const char *text);
+void dg_check_end(struct dg_check *chk);
+
+#endif /* _DG_CHECK_H_ */
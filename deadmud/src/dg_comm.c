@@ -12,6 +12,8 @@
 *  $Revision: 1.0.14 $                                                    *
 **************************************************************************/
 
+#define MEM_TAG MEM_SCRIPT
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -12,6 +12,8 @@
 *  $Revision: 1.0.14 $                                                    *
 **************************************************************************/
 
+#define MEM_TAG MEM_SCRIPT
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -23,15 +25,56 @@
 #include "comm.h"
 #include "constants.h"
 #include "interpreter.h" /* For half_chop */
+#include "mapfile.h"
 
 /* local functions */
 static void trig_data_init(trig_data *this_data);
+static struct cmdlist_element *split_cmdlist(char *cmds);
 
-void parse_trigger(FILE *trig_f, int nr)
+void parse_trigger(struct map_file *trig_f, int nr)
 {
     int t[2], k, attach_type;
-    char line[256], *cmds, *s, flags[256], errors[MAX_INPUT_LENGTH];
-    struct cmdlist_element *cle;
+    char line[256], *name, *arglist, *cmds, flags[256], errors[MAX_INPUT_LENGTH];
+
+    snprintf(errors, sizeof(errors), "trig vnum %d", nr);
+
+    name = mf_fread_string(trig_f, errors);
+
+    mf_get_line(trig_f, line);
+    k = sscanf(line, "%d %s %d", &attach_type, flags, t);
+
+    arglist = mf_fread_string(trig_f, errors);
+    cmds = mf_fread_string(trig_f, errors);
+
+    add_trigger_proto(nr, name, attach_type, (long)asciiflag_conv(flags),
+        (k == 3) ? t[0] : 0, arglist, split_cmdlist(cmds));
+}
+
+/* Splits a script as read from a file into its command list, leaving out the
+ * empty lines. cmds, which may be NULL, is freed. */
+static struct cmdlist_element *split_cmdlist(char *cmds)
+{
+    struct cmdlist_element *cmdlist = NULL, **cle = &cmdlist;
+    char *s;
+
+    if (!cmds)
+      return NULL;
+
+    for (s = strtok(cmds, "\n\r"); s; s = strtok(NULL, "\n\r")) {
+      CREATE(*cle, struct cmdlist_element, 1);
+      (*cle)->cmd = strdup(s);
+      cle = &(*cle)->next;
+    }
+    free(cmds);
+
+    return cmdlist;
+}
+
+/* Adds the prototype of trigger nr to trig_index. name, arglist and cmdlist
+ * are kept; an empty cmdlist gets a comment line. */
+void add_trigger_proto(int nr, char *name, int attach_type,
+    long trigger_type, int narg, char *arglist, struct cmdlist_element *cmdlist)
+{
     struct index_data *t_index;
     struct trig_data *trig;
 
@@ -43,33 +86,18 @@ void parse_trigger(FILE *trig_f, int nr)
     t_index->func = NULL;
     t_index->proto = trig;
 
-    snprintf(errors, sizeof(errors), "trig vnum %d", nr);
-
     trig->nr = top_of_trigt;
-    trig->name = fread_string(trig_f, errors);
-
-    get_line(trig_f, line);
-    k = sscanf(line, "%d %s %d", &attach_type, flags, t);
+    trig->name = name;
     trig->attach_type = (byte)attach_type;
-    trig->trigger_type = (long)asciiflag_conv(flags);
-    trig->narg = (k == 3) ? t[0] : 0;
-
-    trig->arglist = fread_string(trig_f, errors);
+    trig->trigger_type = trigger_type;
+    trig->narg = narg;
+    trig->arglist = arglist;
 
-    cmds = s = fread_string(trig_f, errors);
-
-    CREATE(trig->cmdlist, struct cmdlist_element, 1);
-    trig->cmdlist->cmd = strdup(strtok(s, "\n\r"));
-    cle = trig->cmdlist;
-
-    while ((s = strtok(NULL, "\n\r"))) {
-	CREATE(cle->next, struct cmdlist_element, 1);
-	cle = cle->next;
-	cle->cmd = strdup(s);
+    if (!(trig->cmdlist = cmdlist)) {
+      CREATE(trig->cmdlist, struct cmdlist_element, 1);
+      trig->cmdlist->cmd = strdup("* No Script");
     }
 
-    free(cmds);
-
     trig_index[top_of_trigt++] = t_index;
 }
 
@@ -105,6 +133,7 @@ static void trig_data_init(trig_data *this_data)
     this_data->wait_event = NULL;
     this_data->purged = FALSE;
     this_data->var_list = NULL;
+    this_data->phrases = NULL;
 
     this_data->next = NULL;
 }
@@ -129,7 +158,7 @@ void trig_data_copy(trig_data *this_data, const trig_data *trg)
 }
 
 /* for mobs and rooms: */
-void dg_read_trigger(FILE *fp, void *proto, int type)
+void dg_read_trigger(struct map_file *fp, void *proto, int type)
 {
   char line[READ_SIZE];
   char junk[8];
@@ -138,7 +167,7 @@ void dg_read_trigger(FILE *fp, void *proto, int type)
   room_data *room;
   struct trig_proto_list *trg_proto, *new_trg;
 
-  get_line(fp, line);
+  mf_get_line(fp, line);
   count = sscanf(line,"%7s %d",junk,&vnum);
 
   if (count != 2) {
@@ -158,7 +187,7 @@ void dg_read_trigger(FILE *fp, void *proto, int type)
       case WLD_TRIGGER:
         mudlog(BRF, LVL_BUILDER, TRUE,
                "SYSERR: dg_read_trigger: Trigger vnum #%d asked for but non-existant! (room:%d)",
-               vnum, GET_ROOM_VNUM( ((room_data *)proto)->number ));
+               vnum, ((room_data *)proto)->number);
         break;
       default:
         mudlog(BRF, LVL_BUILDER, TRUE,
@@ -197,16 +226,7 @@ void dg_read_trigger(FILE *fp, void *proto, int type)
           trg_proto = trg_proto->next;
         trg_proto->next = new_trg;
       }
-
-      if (rnum != NOTHING) {
-        if (!(room->script))
-          CREATE(room->script, struct script_data, 1);
-        add_trigger(SCRIPT(room), read_trigger(rnum), -1);
-      } else {
-        mudlog(BRF, LVL_BUILDER, TRUE,
-               "SYSERR: non-existant trigger #%d assigned to room #%d",
-               vnum, room->number);
-      }
+      /* index_boot() attaches the room script once all rooms are read. */
       break;
     default:
       mudlog(BRF, LVL_BUILDER, TRUE,
@@ -275,6 +295,7 @@ void assign_triggers(void *i, int type)
         }
         trg_proto = trg_proto->next;
       }
+      script_listeners_add(mob, MOB_TRIGGER);
       break;
     case OBJ_TRIGGER:
       obj = (obj_data *)i;
@@ -291,6 +312,7 @@ void assign_triggers(void *i, int type)
         }
         trg_proto = trg_proto->next;
       }
+      script_listeners_add(obj, OBJ_TRIGGER);
       break;
     case WLD_TRIGGER:
       room = (struct room_data *)i;
@@ -16,6 +16,8 @@
 */
 
 
+#define MEM_TAG MEM_EVENT
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
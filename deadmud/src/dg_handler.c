@@ -12,6 +12,8 @@
 *  $Revision: 1.0.14 $                                                    *
 ***************************************************************************/
 
+#define MEM_TAG MEM_SCRIPT
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -80,6 +82,7 @@ void free_trigger(struct trig_data *trig)
       free(trig->arglist);
       trig->arglist = NULL;
     }
+    free_trig_phrases(trig);
     if (trig->var_list) {
       free_varlist(trig->var_list);
       trig->var_list = NULL;
@@ -7,6 +7,8 @@
 *  $Revision: 1.0.14 $                                                    *
 **************************************************************************/
 
+#define MEM_TAG MEM_SCRIPT
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -21,6 +23,7 @@
 #include "spells.h"
 #include "constants.h"
 #include "fight.h"
+#include "strpool.h"
 
 
 /* copied from spell_parser.c: */
@@ -131,11 +134,14 @@ void do_dg_cast(void *go, struct script_data *sc, trig_data *trig, int type, cha
       return;
     }
     /* set the caster's name to that of the object, or the gods.... */
-    if (type==OBJ_TRIGGER)
+    if (type==OBJ_TRIGGER) {
+      str_release(caster->player.short_descr);
       caster->player.short_descr =
         strdup(((struct obj_data *)go)->short_description);
-    else if (type==WLD_TRIGGER)
+    } else if (type==WLD_TRIGGER) {
+      str_release(caster->player.short_descr);
       caster->player.short_descr = strdup("The gods");
+    }
     caster->next_in_room = caster_room->people;
     caster_room->people = caster;
     caster->in_room = real_room(caster_room->number);
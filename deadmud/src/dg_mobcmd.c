@@ -7,6 +7,8 @@
 *  $Revision: 1.0.14 $                                                    *
 **************************************************************************/
 
+#define MEM_TAG MEM_SCRIPT
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -20,8 +22,12 @@
 #include "spells.h"
 #include "constants.h"
 #include "genzon.h" /* for real_zone_by_thing */
+#include "genmob.h" /* for copy_mobile_strings */
 #include "act.h"
 #include "fight.h"
+#include "strpool.h"
+#include "nameindex.h"
+#include "slab.h"
 
 
 /* Local file scope functions. */
@@ -176,7 +182,7 @@ ACMD(do_mjunk)
     } else {
         for (obj = ch->carrying; obj != NULL; obj = obj_next) {
             obj_next = obj->next_content;
-            if (arg[3] == '\0' || isname(arg+4, obj->name)) {
+            if (arg[3] == '\0' || obj_isname(arg+4, obj)) {
                 extract_obj(obj);
             }
         }
@@ -751,6 +757,7 @@ ACMD(do_mhunt)
         return;
     }
     HUNTING(ch) = victim;
+    victim->char_specials.hunted = TRUE;
 
 
 }
@@ -916,21 +923,14 @@ ACMD(do_mtransform)
 
     memcpy(&tmpmob, m, sizeof(*m));
 
-    /* Thanks to Russell Ryan for this fix. RRfon we need to copy the
-       the strings so we don't end up free'ing the prototypes later */
-    if(m->player.name)
-      tmpmob.player.name = strdup(m->player.name);
-    if(m->player.title)
-      tmpmob.player.title = strdup(m->player.title);
-    if(m->player.short_descr)
-      tmpmob.player.short_descr = strdup(m->player.short_descr);
-    if(m->player.long_descr)
-      tmpmob.player.long_descr = strdup(m->player.long_descr);
-    if(m->player.description)
-      tmpmob.player.description = strdup(m->player.description);
+    /* Thanks to Russell Ryan for this fix. RRfon we need our own
+       references to the strings, as extracting m gives back its own */
+    copy_mobile_strings(&tmpmob, m);
 
     tmpmob.id = ch->id;
     tmpmob.affected = ch->affected;
+    memcpy(tmpmob.applies, ch->applies, sizeof(ch->applies));
+    memcpy(tmpmob.aff_sources, ch->aff_sources, sizeof(ch->aff_sources));
     tmpmob.carrying = ch->carrying;
     tmpmob.proto_script = ch->proto_script;
     tmpmob.script = ch->script;
@@ -938,7 +938,16 @@ ACMD(do_mtransform)
     tmpmob.events = ch->events;
     tmpmob.next_in_room = ch->next_in_room;
     tmpmob.next = ch->next;
+    tmpmob.prev = ch->prev;
+    tmpmob.next_instance = ch->next_instance;
+    tmpmob.prev_instance = ch->prev_instance;
+    tmpmob.next_unshared = ch->next_unshared;
+    tmpmob.prev_unshared = ch->prev_unshared;
+    tmpmob.list_stamp = ch->list_stamp;
     tmpmob.next_fighting = ch->next_fighting;
+    tmpmob.prev_fighting = ch->prev_fighting;
+    tmpmob.next_extract = ch->next_extract;
+    tmpmob.char_specials.hunted = ch->char_specials.hunted;
     tmpmob.followers = ch->followers;
     tmpmob.master = ch->master;
     tmpmob.group = ch->group;
@@ -955,6 +964,7 @@ ACMD(do_mtransform)
     IS_CARRYING_N(&tmpmob) = IS_CARRYING_N(ch);
     FIGHTING(&tmpmob) = FIGHTING(ch);
     HUNTING(&tmpmob) = HUNTING(ch);
+    free_mobile_strings(ch);
     memcpy(ch, &tmpmob, sizeof(*ch));
 
     for (pos = 0; pos < NUM_WEARS; pos++) {
@@ -963,6 +973,7 @@ ACMD(do_mtransform)
     }
 
     ch->nr = this_rnum;
+    char_to_unshared(ch);
     extract_char(m);
   }
 }
@@ -1022,10 +1033,8 @@ ACMD(do_mdoor)
     /* purge exit */
     if (fd == 0) {
         if (newexit) {
-            if (newexit->general_description)
-                free(newexit->general_description);
-            if (newexit->keyword)
-                free(newexit->keyword);
+            str_release(newexit->general_description);
+            str_release(newexit->keyword);
             free(newexit);
             rm->dir_option[dir] = NULL;
         }
@@ -1039,8 +1048,7 @@ ACMD(do_mdoor)
 
         switch (fd) {
         case 1:  /* description */
-            if (newexit->general_description)
-                free(newexit->general_description);
+            str_release(newexit->general_description);
             CREATE(newexit->general_description, char, strlen(value) + 3);
             strcpy(newexit->general_description, value);
             strcat(newexit->general_description, "\r\n");
@@ -1052,8 +1060,7 @@ ACMD(do_mdoor)
             newexit->key = atoi(value);
             break;
         case 4:  /* name        */
-            if (newexit->keyword)
-                free(newexit->keyword);
+            str_release(newexit->keyword);
             CREATE(newexit->keyword, char, strlen(value) + 1);
             strcpy(newexit->keyword, value);
             break;
@@ -1110,13 +1117,13 @@ ACMD(do_mfollow)
     if (ch->master->followers->follower == ch) {	/* Head of follower-list? */
       k = ch->master->followers;
       ch->master->followers = k->next;
-      free(k);
+      slab_free(&follow_slab, k);
     } else {			/* locate follower who is not head of list */
       for (k = ch->master->followers; k->next->follower != ch; k = k->next);
 
       j = k->next;
       k->next = j->next;
-      free(j);
+      slab_free(&follow_slab, j);
     }
     ch->master = NULL;
   }
@@ -1131,7 +1138,7 @@ ACMD(do_mfollow)
 
   ch->master = leader;
 
-  CREATE(k, struct follow_type, 1);
+  SLAB_CREATE(k, struct follow_type, follow_slab);
 
   k->follower = ch;
   k->next = leader->followers;
@@ -7,11 +7,14 @@
 *  $Revision: 1.0.14 $                                                    *
 **************************************************************************/
 
+#define MEM_TAG MEM_SCRIPT
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
 #include "screen.h"
 #include "dg_scripts.h"
+#include "dg_check.h"
 #include "utils.h"
 #include "comm.h"
 #include "interpreter.h"
@@ -20,6 +23,9 @@
 #include "constants.h"
 #include "genzon.h" /* for access to real_zone_by_thing */
 #include "fight.h" /* for die() */
+#include "genobj.h" /* for copy_object_preserve */
+#include "strpool.h"
+#include "nameindex.h"
 
 
 
@@ -47,7 +53,6 @@ static OCMD(do_oat);
 static OCMD(do_omove);
 
 struct obj_command_info {
-   char *command;
    void        (*command_pointer)(obj_data *obj, char *argument, int cmd, int subcmd);
    int        subcmd;
 };
@@ -282,7 +287,7 @@ static OCMD(do_otimer)
   else if (!isdigit(*arg))
     obj_log(obj, "otimer: bad argument");
   else
-    GET_OBJ_TIMER(obj) = atoi(arg);
+    set_obj_timer(obj, atoi(arg));
 }
 
 /* Transform into a different object. Note: this shouldn't be used with 
@@ -292,7 +297,7 @@ static OCMD(do_otransform)
   char arg[MAX_INPUT_LENGTH];
   obj_data *o, tmpobj;
   struct char_data *wearer=NULL;
-  int pos = 0;
+  int pos = 0, timer;
 
   one_argument(argument, arg);
 
@@ -306,6 +311,9 @@ static OCMD(do_otransform)
       obj_log(obj, "otransform: bad object vnum");
       return;
     }
+    timer = obj_timer(o);
+    obj_timer_unschedule(o);
+    obj_timer_unschedule(obj);
 
     if (obj->worn_by) {
       pos = obj->worn_on;
@@ -313,8 +321,14 @@ static OCMD(do_otransform)
       unequip_char(obj->worn_by, pos);
     }
 
+    /* The old object becomes an instance of the new one's prototype. */
+    obj_from_instances(obj);
+    obj_from_unshared(obj);
+    if (GET_OBJ_RNUM(obj) != NOTHING)
+      obj_index[GET_OBJ_RNUM(obj)].number--;
+
     /* move new obj info over to old object and delete new obj */
-    memcpy(&tmpobj, o, sizeof(*o));
+    copy_object_preserve(&tmpobj, o);
     tmpobj.in_room = IN_ROOM(obj);
     tmpobj.carried_by = obj->carried_by;
     tmpobj.worn_by = obj->worn_by;
@@ -326,7 +340,14 @@ static OCMD(do_otransform)
     tmpobj.script = obj->script;
     tmpobj.next_content = obj->next_content;
     tmpobj.next = obj->next;
+    tmpobj.prev = obj->prev;
+    tmpobj.next_instance = tmpobj.prev_instance = NULL;
+    tmpobj.next_unshared = tmpobj.prev_unshared = NULL;
+    free_object_strings(obj);
     memcpy(obj, &tmpobj, sizeof(*obj));
+    set_obj_timer(obj, timer);
+    obj_to_instances(obj);
+    obj_index[GET_OBJ_RNUM(obj)].number++;
 
     if (wearer) {
       equip_char(wearer, obj, pos);
@@ -635,10 +656,8 @@ static OCMD(do_odoor)
     /* purge exit */
     if (fd == 0) {
         if (newexit) {
-            if (newexit->general_description)
-                free(newexit->general_description);
-            if (newexit->keyword)
-                free(newexit->keyword);
+            str_release(newexit->general_description);
+            str_release(newexit->keyword);
             free(newexit);
             rm->dir_option[dir] = NULL;
         }
@@ -652,8 +671,7 @@ static OCMD(do_odoor)
 
         switch (fd) {
         case 1:  /* description */
-            if (newexit->general_description)
-                free(newexit->general_description);
+            str_release(newexit->general_description);
             CREATE(newexit->general_description, char, strlen(value) + 3);
             strcpy(newexit->general_description, value);
             strcat(newexit->general_description, "\r\n"); /* strcat : OK */
@@ -665,8 +683,7 @@ static OCMD(do_odoor)
             newexit->key = atoi(value);
             break;
         case 4:  /* name        */
-            if (newexit->keyword)
-                free(newexit->keyword);
+            str_release(newexit->keyword);
             CREATE(newexit->keyword, char, strlen(value) + 1);
             strcpy(newexit->keyword, value);
             break;
@@ -785,33 +802,18 @@ static OCMD(do_omove)
     obj_to_room(obj, target);
 }
 
+/* The functions of the commands in DG_OBJ_COMMANDS, see dg_check.h. */
+#define OBJ_CMD_INFO(name, func, subcmd) { func, subcmd },
+
 const struct obj_command_info obj_cmd_info[] = {
-    { "RESERVED", 0, 0 },/* this must be first -- for specprocs */
-
-    { "oasound "    , do_oasound  , 0 },
-    { "oat "        , do_oat      , 0 },
-    { "odoor "      , do_odoor    , 0 },
-    { "odamage "    , do_odamage,   0 },
-    { "oecho "      , do_oecho    , 0 },
-    { "oechoaround ", do_osend    , SCMD_OECHOAROUND },
-    { "oforce "     , do_oforce   , 0 },
-    { "oload "      , do_dgoload  , 0 },
-    { "opurge "     , do_opurge   , 0 },
-    { "orecho "     , do_orecho   , 0 },
-    { "osend "      , do_osend    , SCMD_OSEND },
-    { "osetval "    , do_osetval  , 0 },
-    { "oteleport "  , do_oteleport, 0 },
-    { "otimer "     , do_otimer   , 0 },
-    { "otransform " , do_otransform, 0 },
-    { "ozoneecho "  , do_ozoneecho , 0 }, /* fix by Rumble */
-    { "omove "      , do_omove     , 0 },
-    { "\n", 0, 0 }        /* this must be last */
+    { 0, 0 },/* RESERVED, this must be first -- for specprocs */
+    DG_OBJ_COMMANDS(OBJ_CMD_INFO)
 };
 
 /* This is the command interpreter used by objects, called by script_driver. */
 void obj_command_interpreter(obj_data *obj, char *argument)
 {
-    int cmd, length;
+    int cmd;
     char *line, arg[MAX_INPUT_LENGTH];
 
     skip_spaces(&argument);
@@ -824,12 +826,7 @@ void obj_command_interpreter(obj_data *obj, char *argument)
 
 
     /* find the command */
-    for (length = strlen(arg),cmd = 0;
-         *obj_cmd_info[cmd].command != '\n'; cmd++)
-        if (!strncmp(obj_cmd_info[cmd].command, arg, length))
-            break;
-
-    if (*obj_cmd_info[cmd].command == '\n')
+    if ((cmd = dg_find_command(dg_obj_cmds, arg)) < 0)
       obj_log(obj, "Unknown object cmd: '%s'", argument);
     else
         ((*obj_cmd_info[cmd].command_pointer)
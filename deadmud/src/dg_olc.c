@@ -7,6 +7,8 @@
 *  $Revision: 1.0.14 $                                                    *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -17,10 +19,12 @@
 #include "interpreter.h"
 #include "oasis.h"
 #include "dg_olc.h"
+#include "dg_check.h"
 #include "dg_event.h"
 #include "genzon.h"      /* for real_zone_by_thing */
 #include "constants.h"   /* for the *trig_types */
 #include "modify.h"      /* for smash_tilde */
+#include "worldsnap.h"
 
 
 /* local functions */
@@ -28,6 +32,7 @@ static void trigedit_disp_menu(struct descriptor_data *d);
 static void trigedit_disp_types(struct descriptor_data *d);
 static void trigedit_create_index(int znum, char *type);
 static void trigedit_setup_new(struct descriptor_data *d);
+static void trigedit_check_script(struct descriptor_data *d);
 
 
 /* Trigedit */
@@ -412,12 +417,14 @@ void trigedit_save(struct descriptor_data *d)
       next_cmd = cmd->next;
       if (cmd->cmd)
         free(cmd->cmd);
+      free_dg_expr(cmd->expr);
       free(cmd);
     }
 
 
     free(proto->arglist);
     free(proto->name);
+    free_trig_phrases(proto);
 
     /* Recompile the command list from the new script */
     s = OLC_STORAGE(d);
@@ -451,6 +458,7 @@ void trigedit_save(struct descriptor_data *d)
           free(live_trig->arglist);
           live_trig->arglist = NULL;
         }
+        free_trig_phrases(live_trig);
         if (live_trig->name) {
           free(live_trig->name);
           live_trig->name = NULL;
@@ -629,6 +637,7 @@ void trigedit_save(struct descriptor_data *d)
 
   remove(buf);
   rename(fname, buf);
+  remove_world_snapshot();
 
   write_to_output(d, "Trigger saved to disk.\r\n");
   trigedit_create_index(zone, "trg");
@@ -847,10 +856,95 @@ int dg_script_edit_parse(struct descriptor_data *d, char *arg)
   return 1;
 }
 
+/* A script being checked, with the names every trigger makes global or
+ * remote, gathered once for the whole check. */
+struct trigedit_check {
+  struct descriptor_data *d;
+  char **globals;        /**< Sorted, for trigedit_is_global() */
+  int num_globals;
+  int max_globals;
+};
+
+static void trigedit_add_global(const char *name, size_t len, void *data)
+{
+  struct trigedit_check *tc = (struct trigedit_check *) data;
+
+  if (tc->num_globals == tc->max_globals) {
+    tc->max_globals = tc->max_globals ? tc->max_globals * 2 : 64;
+    RECREATE(tc->globals, char *, tc->max_globals);
+  }
+  CREATE(tc->globals[tc->num_globals], char, len + 1);
+  memcpy(tc->globals[tc->num_globals], name, len);
+  tc->num_globals++;
+}
+
+static int trigedit_global_cmp(const void *a, const void *b)
+{
+  return (strcmp(*(char * const *) a, *(char * const *) b));
+}
+
+/* Is this a name any trigger makes global or remote, which scripts may then
+ * read as a field? */
+static int trigedit_is_global(const char *name, size_t len, void *data)
+{
+  struct trigedit_check *tc = (struct trigedit_check *) data;
+  char buf[MAX_INPUT_LENGTH], *key = buf;
+
+  if (!tc->num_globals || len >= sizeof(buf))
+    return (FALSE);
+  memcpy(buf, name, len);
+  buf[len] = '\0';
+
+  return (bsearch(&key, tc->globals, tc->num_globals, sizeof(char *),
+      trigedit_global_cmp) != NULL);
+}
+
+static void trigedit_check_report(struct dg_check *chk, int error, int line,
+    const char *msg)
+{
+  struct trigedit_check *tc = (struct trigedit_check *) chk->data;
+
+  write_to_output(tc->d, "%sLine %d: %s\r\n",
+      error ? "Error: " : "Warning: ", line, msg);
+}
+
+/* Tells the builder about the mistakes in the script just written, the same
+ * ones util/dglint finds. It is saved as it is all the same. */
+static void trigedit_check_script(struct descriptor_data *d)
+{
+  struct trigedit_check tc;
+  struct dg_check chk;
+  struct cmdlist_element *c;
+  int i;
+
+  tc.d = d;
+  tc.globals = NULL;
+  tc.num_globals = tc.max_globals = 0;
+  for (i = 0; i < top_of_trigt; i++)
+    for (c = trig_index[i]->proto->cmdlist; c; c = c->next)
+      dg_global_names(c->cmd, trigedit_add_global, &tc);
+  if (tc.num_globals)
+    qsort(tc.globals, tc.num_globals, sizeof(char *), trigedit_global_cmp);
+
+  dg_check_start(&chk, OLC_TRIG(d)->attach_type);
+  chk.is_global = trigedit_is_global;
+  chk.report = trigedit_check_report;
+  chk.data = &tc;
+
+  dg_check_text(&chk, 1, OLC_STORAGE(d));
+  dg_check_end(&chk);
+
+  for (i = 0; i < tc.num_globals; i++)
+    free(tc.globals[i]);
+  if (tc.globals)
+    free(tc.globals);
+}
+
 void trigedit_string_cleanup(struct descriptor_data *d, int terminator)
 {
   switch (OLC_MODE(d)) {
     case TRIGEDIT_COMMANDS:
+      trigedit_check_script(d);
       trigedit_disp_menu(d);
       break;
   }
@@ -862,6 +956,7 @@ int format_script(struct descriptor_data *d)
   char *sc;
   size_t len = 0, nlen = 0, llen = 0;
   int indent = 0, indent_next = FALSE, found_case = FALSE, i, line_num = 0;
+  int line_type;
 
   if (!d->str || !*d->str)
     return FALSE;
@@ -873,14 +968,13 @@ int format_script(struct descriptor_data *d)
   while (t) {
     line_num++;
     skip_spaces(&t);
-    if (!strn_cmp(t, "if ", 3) ||
-        !strn_cmp(t, "switch ", 7)) {
+    line_type = dg_line_type(t);
+    if (line_type == DG_LINE_IF || line_type == DG_LINE_SWITCH) {
       indent_next = TRUE;
-    } else if (!strn_cmp(t, "while ", 6)) {
+    } else if (line_type == DG_LINE_WHILE) {
       found_case = TRUE;  /* so you can 'break' a loop without complains */
       indent_next = TRUE;
-    } else if (!strn_cmp(t, "end", 3) ||
-               !strn_cmp(t, "done", 4)) {
+    } else if (line_type == DG_LINE_END || line_type == DG_LINE_DONE) {
       if (!indent) {
         write_to_output(d, "Unmatched 'end' or 'done' (line %d)!\r\n", line_num);
         free(sc);
@@ -888,7 +982,7 @@ int format_script(struct descriptor_data *d)
       }
       indent--;
       indent_next = FALSE;
-    } else if (!strn_cmp(t, "else", 4)) {
+    } else if (line_type == DG_LINE_ELSE || line_type == DG_LINE_ELSEIF) {
       if (!indent) {
         write_to_output(d, "Unmatched 'else' (line %d)!\r\n", line_num);
         free(sc);
@@ -896,8 +990,7 @@ int format_script(struct descriptor_data *d)
       }
       indent--;
       indent_next = TRUE;
-    } else if (!strn_cmp(t, "case", 4) ||
-               !strn_cmp(t, "default", 7)) {
+    } else if (line_type == DG_LINE_CASE || line_type == DG_LINE_DEFAULT) {
       if (!indent) {
         write_to_output(d, "Case/default outside switch (line %d)!\r\n", line_num);
         free(sc);
@@ -906,7 +999,7 @@ int format_script(struct descriptor_data *d)
       if (!found_case) /* so we don't indent multiple case statements without a break */
         indent_next = TRUE;
       found_case = TRUE;
-    } else if (!strn_cmp(t, "break", 5)) {
+    } else if (line_type == DG_LINE_BREAK) {
       if (!found_case || !indent ) {
         write_to_output(d, "Break not in case (line %d)!\r\n", line_num);
         free(sc);
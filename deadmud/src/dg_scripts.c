@@ -12,6 +12,8 @@
 * $Revision: 1.0.14 $                                                    
 */
 
+#define MEM_TAG MEM_SCRIPT
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -29,9 +31,42 @@
 #include "genzon.h" /* for real_zone_by_thing */
 #include "act.h"
 #include "modify.h"
+#include "mapfile.h"
+#include "nameindex.h"
+#include "dg_check.h"
 
 #define PULSES_PER_MUD_HOUR     (SECS_PER_MUD_HOUR*PASSES_PER_SEC)
 
+/* Per trigger vnum run time accounting, read with 'tstat profile'. Entries
+ * are keyed by vnum so they survive trigedit renumbering the trig_index.
+ * The counts are always kept; run times only while trig_profiling is on. */
+#define TRIG_PROF_HASH          256
+
+struct trig_prof_data {
+  trig_vnum vnum;
+  unsigned long calls;      /* runs started by an event (TRIG_NEW)     */
+  unsigned long resumes;    /* runs restarted after a wait             */
+  unsigned long cmds;       /* script lines executed                   */
+  unsigned long loops;      /* while loop iterations                   */
+  unsigned long waits;      /* suspensions, explicit or forced         */
+  unsigned long preempts;   /* suspensions for exceeding the budget    */
+  unsigned long usec;       /* wall time, including nested triggers    */
+  unsigned long self_usec;  /* wall time, less that of nested triggers */
+  unsigned long max_usec;   /* longest single run                      */
+  struct trig_prof_data *next;
+};
+
+static struct trig_prof_data *trig_prof_table[TRIG_PROF_HASH];
+static int trig_profiling = FALSE;      /* 'tstat profile on' */
+static unsigned long nested_usec = 0;   /* of the triggers the current one ran */
+
+/* Script time used in the current pulse, see SCRIPT_PULSE_BUDGET. Only the
+ * outermost script_driver() call is counted, nested triggers run inside it. */
+static unsigned long budget_pulse = 0;
+static unsigned long budget_used = 0;
+static struct timeval budget_start;
+static int driver_nesting = 0;
+
 /* Local functions not used elsewhere */
 static obj_data *find_obj(long n);
 static room_data *find_room(long n);
@@ -46,13 +81,17 @@ static void eval_expr(char *line, char *result, void *go, struct script_data *sc
           trig_data *trig, int type);
 static int eval_lhs_op_rhs(char *expr, char *result, void *go, struct script_data *sc,
           trig_data *trig, int type);
-static int process_if(char *cond, void *go, struct script_data *sc,
-          trig_data *trig, int type);
+static int process_if(struct cmdlist_element *cl, char *cond, void *go,
+          struct script_data *sc, trig_data *trig, int type);
 static struct cmdlist_element *find_end(trig_data *trig, struct cmdlist_element *cl);
 static struct cmdlist_element *find_else_end(trig_data *trig,
           struct cmdlist_element *cl, void *go, struct script_data *sc, int type);
 static void process_wait(void *go, trig_data *trig, int type, char *cmd,
           struct cmdlist_element *cl);
+static void suspend_trigger(void *go, trig_data *trig, int type, long when,
+          struct cmdlist_element *resume);
+static int script_budget_exceeded(void);
+static int trig_preemptible(trig_data *trig, int type, int mode);
 static void process_set(struct script_data *sc, trig_data *trig, char *cmd);
 static void process_attach(void *go, struct script_data *sc, trig_data *trig,
           int type, char *cmd);
@@ -74,6 +113,10 @@ static struct cmdlist_element *find_done(struct cmdlist_element *cl);
 static struct char_data *find_char_by_uid_in_lookup_table(long uid);
 static struct obj_data *find_obj_by_uid_in_lookup_table(long uid);
 static EVENTFUNC(trig_wait_event);
+static struct trig_prof_data *trig_profile(trig_vnum vnum);
+static int run_trigger(void *go_adress, trig_data *trig, int type, int mode,
+          struct trig_prof_data *prof);
+static void do_trig_profile(struct char_data *ch, char *argument);
 
 
 /* Return pointer to first occurrence of string ct in cs, or NULL if not 
@@ -156,7 +199,7 @@ obj_data *get_obj_in_list(char *name, obj_data *list)
       
     } else {
       for (i = list; i; i = i->next_content)
-        if (isname(name, i->name))
+        if (obj_isname(name, i))
           return i;
     }
 
@@ -198,7 +241,7 @@ obj_data *get_object_in_equip(char_data * ch, char *name)
 
     for (j = 0; (j < NUM_WEARS) && (n <= number); j++)
       if ((obj = GET_EQ(ch, j)))
-        if (isname(tmp, obj->name))
+        if (obj_isname(tmp, obj))
           if (++n == number)
             return (obj);
   }
@@ -336,7 +379,8 @@ static room_data *find_room(long n)
  * @retval char_data * Pointer to the char or NULL if char is not found. */
 char_data *get_char(char *name)
 {
-  char_data *i;
+  char_data *i, **found;
+  int n, k;
 
   if (*name == UID_CHAR) {
     i = find_char(atoi(name + 1));
@@ -344,10 +388,11 @@ char_data *get_char(char *name)
     if (i && valid_dg_target(i, DG_ALLOW_GODS))
       return i;
   } else {
-    for (i = character_list; i; i = i->next)
-      if (isname(name, i->player.name) &&
-          valid_dg_target(i, DG_ALLOW_GODS))
-        return i;
+    n = chars_by_name(name, &found);
+    for (k = 0; k < n; k++)
+      if (char_isname(name, found[k]) &&
+          valid_dg_target(found[k], DG_ALLOW_GODS))
+        return found[k];
   }
 
   return NULL;
@@ -375,7 +420,7 @@ char_data *get_char_near_obj(obj_data *obj, char *name)
     room_rnum num;
     if ((num = obj_room(obj)) != NOWHERE)
       for (ch = world[num].people; ch; ch = ch->next_in_room)
-        if (isname(name, ch->player.name) &&
+        if (char_isname(name, ch) &&
             valid_dg_target(ch, DG_ALLOW_GODS))
           return ch;
   }
@@ -403,7 +448,7 @@ char_data *get_char_in_room(room_data *room, char *name)
       return ch;
   } else {
     for (ch = room->people; ch; ch = ch->next_in_room)
-      if (isname(name, ch->player.name) &&
+      if (char_isname(name, ch) &&
           valid_dg_target(ch, DG_ALLOW_GODS))
         return ch;
     }
@@ -439,7 +484,7 @@ obj_data *get_obj_near_obj(obj_data *obj, char *name)
 
       if (id == GET_ID(obj->in_obj))
         return obj->in_obj;
-    } else if (isname(name, obj->in_obj->name))
+    } else if (obj_isname(name, obj->in_obj))
       return obj->in_obj;
   }
   /* or worn ?*/
@@ -465,14 +510,16 @@ obj_data *get_obj_near_obj(obj_data *obj, char *name)
 /* returns the object in the world with name name, or NULL if not found */
 obj_data *get_obj(char *name)
 {
-  obj_data *obj;
+  obj_data **found;
+  int n, k;
 
   if (*name == UID_CHAR)
     return find_obj(atoi(name + 1));
   else {
-    for (obj = object_list; obj; obj = obj->next)
-      if (isname(name, obj->name))
-        return obj;
+    n = objs_by_name(name, &found);
+    for (k = 0; k < n; k++)
+      if (obj_isname(name, found[k]))
+        return found[k];
   }
 
   return NULL;
@@ -504,19 +551,16 @@ char_data *get_char_by_obj(obj_data *obj, char *name)
       return ch;
   } else {
     if (obj->carried_by &&
-        isname(name, obj->carried_by->player.name) &&
+        char_isname(name, obj->carried_by) &&
         valid_dg_target(obj->carried_by, DG_ALLOW_GODS))
       return obj->carried_by;
 
     if (obj->worn_by &&
-        isname(name, obj->worn_by->player.name) &&
+        char_isname(name, obj->worn_by) &&
         valid_dg_target(obj->worn_by, DG_ALLOW_GODS))
       return obj->worn_by;
 
-    for (ch = character_list; ch; ch = ch->next)
-      if (isname(name, ch->player.name) &&
-          valid_dg_target(ch, DG_ALLOW_GODS))
-        return ch;
+    return get_char(name);
   }
 
   return NULL;
@@ -535,14 +579,11 @@ char_data *get_char_by_room(room_data *room, char *name)
       return ch;
   } else {
     for (ch = room->people; ch; ch = ch->next_in_room)
-      if (isname(name, ch->player.name) &&
+      if (char_isname(name, ch) &&
           valid_dg_target(ch, DG_ALLOW_GODS))
         return ch;
 
-    for (ch = character_list; ch; ch = ch->next)
-      if (isname(name, ch->player.name) &&
-          valid_dg_target(ch, DG_ALLOW_GODS))
-        return ch;
+    return get_char(name);
   }
 
   return NULL;
@@ -564,7 +605,7 @@ obj_data *get_obj_by_obj(obj_data *obj, char *name)
   if (obj->contains && (i = get_obj_in_list(name, obj->contains)))
     return i;
 
-  if (obj->in_obj && isname(name, obj->in_obj->name))
+  if (obj->in_obj && obj_isname(name, obj->in_obj))
       return obj->in_obj;
 
   if (obj->worn_by && (i = get_object_in_equip(obj->worn_by, name)))
@@ -594,7 +635,7 @@ obj_data *get_obj_in_room(room_data *room, char *name)
               return obj;
   } else {
       for (obj = room->contents; obj; obj = obj->next_content)
-          if (isname(name, obj->name))
+          if (obj_isname(name, obj))
               return obj;
   }
 
@@ -610,14 +651,10 @@ obj_data *get_obj_by_room(room_data *room, char *name)
     return find_obj(atoi(name+1));
 
   for (obj = room->contents; obj; obj = obj->next_content)
-    if (isname(name, obj->name))
+    if (obj_isname(name, obj))
       return obj;
 
-  for (obj = object_list; obj; obj = obj->next)
-    if (isname(name, obj->name))
-      return obj;
-
-  return NULL;
+  return get_obj(name);
 }
 
 /* checks every PULSE_SCRIPT for random triggers */
@@ -987,6 +1024,7 @@ ACMD(do_attach)
     if (!SCRIPT(victim))
       CREATE(SCRIPT(victim), struct script_data, 1);
     add_trigger(SCRIPT(victim), trig, loc);
+    script_listeners_add(victim, MOB_TRIGGER);
 
     if (IS_NPC(victim))
     send_to_char(ch, "Trigger %d (%s) attached to %s [%d].\r\n",
@@ -1029,6 +1067,7 @@ ACMD(do_attach)
     if (!SCRIPT(object))
       CREATE(SCRIPT(object), struct script_data, 1);
     add_trigger(SCRIPT(object), trig, loc);
+    script_listeners_add(object, OBJ_TRIGGER);
 
     send_to_char(ch, "Trigger %d (%s) attached to %s [%d].\r\n",
                  tn, GET_TRIG_NAME(trig),
@@ -1346,103 +1385,129 @@ static int is_num(char *arg)
    return TRUE;
 }
 
-/* evaluates 'lhs op rhs', and copies to result */
-static void eval_op(char *op, char *lhs, char *rhs, char *result, void *go,
-             struct script_data *sc, trig_data *trig)
-{
-  unsigned char *p;
-  int n;
-
-  /* strip off extra spaces at begin and end */
-  while (*lhs && isspace(*lhs))
-    lhs++;
-  while (*rhs && isspace(*rhs))
-    rhs++;
-
-  for (p = (unsigned char *) lhs; *p; p++);
-  for (--p; isspace(*p) && ((char *)p > lhs); *p-- = '\0');
-  for (p = (unsigned char *) rhs; *p; p++);
-  for (--p; isspace(*p) && ((char *)p > rhs); *p-- = '\0');
-
-
-  /* find the op, and figure out the value */
-  if (!strcmp("||", op)) {
-    if ((!*lhs || (*lhs == '0')) && (!*rhs || (*rhs == '0')))
-      strcpy(result, "0");
-    else
-      strcpy(result, "1");
-  }
-
-  else if (!strcmp("&&", op)) {
-    if (!*lhs || (*lhs == '0') || !*rhs || (*rhs == '0'))
-      strcpy (result, "0");
-    else
-      strcpy (result, "1");
-  }
+/* Valid operators, in order of priority. The DG_OP_ values index this table,
+ * so keep them in step. */
+static const char *expr_ops[] = {
+  "||",
+  "&&",
+  "==",
+  "!=",
+  "<=",
+  ">=",
+  "<",
+  ">",
+  "/=",
+  "-",
+  "+",
+  "/",
+  "*",
+  "!",
+  "\n"
+};
 
-  else if (!strcmp("==", op)) {
-    if (is_num(lhs) && is_num(rhs))
-      sprintf(result, "%d", atoi(lhs) == atoi(rhs));
-    else
-      sprintf(result, "%d", !str_cmp(lhs, rhs));
-  }
+enum {
+  DG_OP_OR, DG_OP_AND, DG_OP_EQ, DG_OP_NE, DG_OP_LE, DG_OP_GE, DG_OP_LT,
+  DG_OP_GT, DG_OP_SUBSTR, DG_OP_SUB, DG_OP_ADD, DG_OP_DIV, DG_OP_MUL, DG_OP_NOT
+};
 
-  else if (!strcmp("!=", op)) {
-    if (is_num(lhs) && is_num(rhs))
-      sprintf(result, "%d", atoi(lhs) != atoi(rhs));
-    else
-      sprintf(result, "%d", str_cmp(lhs, rhs));
-  }
+#define DG_EXPR_LEAF -1
 
-  else if (!strcmp("<=", op)) {
-    if (is_num(lhs) && is_num(rhs))
-      sprintf(result, "%d", atoi(lhs) <= atoi(rhs));
-    else
-      sprintf(result, "%d", str_cmp(lhs, rhs) <= 0);
-  }
+/* An operand or result while evaluating an expression. Results of operators
+ * are kept as numbers and only printed if a string is needed. */
+struct dg_value {
+  char buf[MAX_INPUT_LENGTH];
+  char *str;		/* the operand, or NULL for a number */
+  int num;		/* atoi(str), or the number */
+  int is_num;		/* str is all digits, or a number */
+};
 
-  else if (!strcmp(">=", op)) {
-    if (is_num(lhs) && is_num(rhs))
-      sprintf(result, "%d", atoi(lhs) >= atoi(rhs));
-    else
-      sprintf(result, "%d", str_cmp(lhs, rhs) <= 0);
+/* the value as a string, as eval_op() always used to see it */
+static char *dg_value_str(struct dg_value *v)
+{
+  if (!v->str) {
+    snprintf(v->buf, sizeof(v->buf), "%d", v->num);
+    v->str = v->buf;
   }
+  return v->str;
+}
 
-  else if (!strcmp("<", op)) {
-    if (is_num(lhs) && is_num(rhs))
-      sprintf(result, "%d", atoi(lhs) < atoi(rhs));
-    else
-      sprintf(result, "%d", str_cmp(lhs, rhs) < 0);
-  }
+/* strip off extra spaces at begin and end, and note what number it is */
+static void dg_value_set(struct dg_value *v, char *str)
+{
+  unsigned char *p;
 
-  else if (!strcmp(">", op)) {
-    if (is_num(lhs) && is_num(rhs))
-      sprintf(result, "%d", atoi(lhs) > atoi(rhs));
-    else
-      sprintf(result, "%d", str_cmp(lhs, rhs) > 0);
+  while (*str && isspace(*str))
+    str++;
+  if (*str) {
+    for (p = (unsigned char *) str; *p; p++);
+    for (--p; isspace(*p) && ((char *)p > str); *p-- = '\0');
+  }
+
+  v->str = str;
+  v->is_num = is_num(str);
+  v->num = atoi(str);
+}
+
+static int dg_value_false(struct dg_value *v)
+{
+  return v->str ? (!*v->str || *v->str == '0') : !v->num;
+}
+
+/* applies operator op to lhs and rhs, and returns the (always numeric) result */
+static int dg_apply_op(int op, struct dg_value *lhs, struct dg_value *rhs)
+{
+  int both = lhs->is_num && rhs->is_num;
+
+  switch (op) {
+    case DG_OP_OR:
+      return !(dg_value_false(lhs) && dg_value_false(rhs));
+    case DG_OP_AND:
+      return !(dg_value_false(lhs) || dg_value_false(rhs));
+    case DG_OP_EQ:
+      return both ? lhs->num == rhs->num : !str_cmp(dg_value_str(lhs), dg_value_str(rhs));
+    case DG_OP_NE:
+      return both ? lhs->num != rhs->num : str_cmp(dg_value_str(lhs), dg_value_str(rhs)) != 0;
+    case DG_OP_LE:
+      return both ? lhs->num <= rhs->num : str_cmp(dg_value_str(lhs), dg_value_str(rhs)) <= 0;
+    case DG_OP_GE:
+      return both ? lhs->num >= rhs->num : str_cmp(dg_value_str(lhs), dg_value_str(rhs)) <= 0;
+    case DG_OP_LT:
+      return both ? lhs->num < rhs->num : str_cmp(dg_value_str(lhs), dg_value_str(rhs)) < 0;
+    case DG_OP_GT:
+      return both ? lhs->num > rhs->num : str_cmp(dg_value_str(lhs), dg_value_str(rhs)) > 0;
+    case DG_OP_SUBSTR:
+      return str_str(dg_value_str(lhs), dg_value_str(rhs)) != NULL;
+    case DG_OP_SUB:
+      return lhs->num - rhs->num;
+    case DG_OP_ADD:
+      return lhs->num + rhs->num;
+    case DG_OP_DIV:
+      return rhs->num ? lhs->num / rhs->num : 0;
+    case DG_OP_MUL:
+      return lhs->num * rhs->num;
+    case DG_OP_NOT:
+      return rhs->is_num ? !rhs->num : !*dg_value_str(rhs);
   }
+  return 0;
+}
 
-  else if (!strcmp("/=", op))
-    sprintf(result, "%c", str_str(lhs, rhs) ? '1' : '0');
-
-  else if (!strcmp("*", op))
-    sprintf(result, "%d", atoi(lhs) * atoi(rhs));
-
-  else if (!strcmp("/", op))
-    sprintf(result, "%d", (n = atoi(rhs)) ? (atoi(lhs) / n) : 0);
+/* evaluates 'lhs op rhs', and copies to result */
+static void eval_op(char *op, char *lhs, char *rhs, char *result, void *go,
+             struct script_data *sc, trig_data *trig)
+{
+  struct dg_value l, r;
+  int i;
 
-  else if (!strcmp("+", op))
-    sprintf(result, "%d", atoi(lhs) + atoi(rhs));
+  for (i = 0; *expr_ops[i] != '\n'; i++)
+    if (!strcmp(expr_ops[i], op))
+      break;
 
-  else if (!strcmp("-", op))
-    sprintf(result, "%d", atoi(lhs) - atoi(rhs));
+  if (*expr_ops[i] == '\n')
+    return;
 
-  else if (!strcmp("!", op)) {
-    if (is_num(rhs))
-      sprintf(result, "%d", !atoi(rhs));
-    else
-      sprintf(result, "%d", !*rhs);
-  }
+  dg_value_set(&l, lhs);
+  dg_value_set(&r, rhs);
+  sprintf(result, "%d", dg_apply_op(i, &l, &r));
 }
 
 /* p points to the first quote, returns the matching end quote, or the last 
@@ -1478,6 +1543,40 @@ static char *matching_paren(char *p)
   return --p;
 }
 
+/* Finds the operator of lowest priority outside parens and quotes in line.
+ * Cuts line at the operator, leaving the left hand side in line, and points
+ * rhs to the right hand side. Returns the operator or DG_EXPR_LEAF. */
+static int split_expr_op(char *line, char **rhs)
+{
+  char *p, *tokens[MAX_INPUT_LENGTH];
+  int i, j;
+
+  /* Initialize tokens, an array of pointers to locations in line where the 
+   * ops could possibly occur. */
+  for (j = 0, p = line; *p; j++) {
+    tokens[j] = p;
+    if (*p == '(')
+      p = matching_paren(p) + 1;
+    else if (*p == '"')
+      p = matching_quote(p) + 1;
+    else if (isalnum(*p))
+      for (p++; *p && (isalnum(*p) || isspace(*p)); p++);
+    else
+      p++;
+  }
+  tokens[j] = NULL;
+
+  for (i = 0; *expr_ops[i] != '\n'; i++)
+    for (j = 0; tokens[j]; j++)
+      if (!strn_cmp(expr_ops[i], tokens[j], strlen(expr_ops[i]))) {
+        *tokens[j] = '\0';
+        *rhs = tokens[j] + strlen(expr_ops[i]);
+        return i;
+      }
+
+  return DG_EXPR_LEAF;
+}
+
 /* evaluates line, and returns answer in result */
 static void eval_expr(char *line, char *result, void *go, struct script_data *sc,
                trig_data *trig, int type)
@@ -1505,80 +1604,115 @@ static void eval_expr(char *line, char *result, void *go, struct script_data *sc
 static int eval_lhs_op_rhs(char *expr, char *result, void *go, struct script_data *sc,
                     trig_data *trig, int type)
 {
-  char *p, *tokens[MAX_INPUT_LENGTH];
   char line[MAX_INPUT_LENGTH], lhr[MAX_INPUT_LENGTH], rhr[MAX_INPUT_LENGTH];
-  int i, j;
+  char *p;
+  int op;
 
-  /*
-   * valid operands, in order of priority
-   * each must also be defined in eval_op()
-   */
-  static char *ops[] = {
-    "||",
-    "&&",
-    "==",
-    "!=",
-    "<=",
-    ">=",
-    "<",
-    ">",
-    "/=",
-    "-",
-    "+",
-    "/",
-    "*",
-    "!",
-    "\n"
-  };
+  strcpy(line, expr);
 
-  p = strcpy(line, expr);
+  if ((op = split_expr_op(line, &p)) == DG_EXPR_LEAF)
+    return 0;
 
-  /* Initialize tokens, an array of pointers to locations in line where the 
-   * ops could possibly occur. */
-  for (j = 0; *p; j++) {
-    tokens[j] = p;
-    if (*p == '(')
-      p = matching_paren(p) + 1;
-    else if (*p == '"')
-      p = matching_quote(p) + 1;
-    else if (isalnum(*p))
-      for (p++; *p && (isalnum(*p) || isspace(*p)); p++);
-    else
-      p++;
+  eval_expr(line, lhr, go, sc, trig, type);
+  eval_expr(p, rhr, go, sc, trig, type);
+  eval_op((char *)expr_ops[op], lhr, rhr, result, go, sc, trig);
+
+  return 1;
+}
+
+/* Parses line the way eval_expr() reads it, into a tree that can be evaluated
+ * many times without looking at the text again. */
+static struct dg_expr *compile_expr(char *line)
+{
+  char expr[MAX_INPUT_LENGTH], *p;
+  struct dg_expr *e;
+
+  while (*line && isspace(*line))
+    line++;
+
+  strlcpy(expr, line, sizeof(expr));
+
+  CREATE(e, struct dg_expr, 1);
+
+  if ((e->op = split_expr_op(expr, &p)) != DG_EXPR_LEAF) {
+    e->lhs = compile_expr(expr);
+    e->rhs = compile_expr(p);
+  } else if (*expr == '(') {
+    free(e);
+    p = matching_paren(expr);
+    *p = '\0';
+    return compile_expr(expr + 1);
+  } else if ((e->has_vars = (strchr(expr, '%') != NULL)))
+    e->text = strdup(expr);
+  else {
+    struct dg_value v;
+
+    /* A constant: trim and convert it now, rather than on every use. */
+    dg_value_set(&v, expr);
+    e->text = strdup(v.str);
+    e->is_num = v.is_num;
+    e->num = v.num;
   }
-  tokens[j] = NULL;
 
-  for (i = 0; *ops[i] != '\n'; i++)
-    for (j = 0; tokens[j]; j++)
-      if (!strn_cmp(ops[i], tokens[j], strlen(ops[i]))) {
-        *tokens[j] = '\0';
-        p = tokens[j] + strlen(ops[i]);
+  return e;
+}
 
-        eval_expr(line, lhr, go, sc, trig, type);
-        eval_expr(p, rhr, go, sc, trig, type);
-        eval_op(ops[i], lhr, rhr, result, go, sc, trig);
+void free_dg_expr(struct dg_expr *e)
+{
+  if (!e)
+    return;
 
-        return 1;
-      }
+  free_dg_expr(e->lhs);
+  free_dg_expr(e->rhs);
+  if (e->text)
+    free(e->text);
+  free(e);
+}
+
+/* evaluates a compiled expression into v. Only the operands with variables in
+ * them are substituted, everything else was worked out by compile_expr(). */
+static void eval_dg_expr(struct dg_expr *e, struct dg_value *v, void *go,
+               struct script_data *sc, trig_data *trig, int type)
+{
+  struct dg_value l, r;
+
+  if (e->op != DG_EXPR_LEAF) {
+    /* both sides are always evaluated, variables may have side effects */
+    eval_dg_expr(e->lhs, &l, go, sc, trig, type);
+    eval_dg_expr(e->rhs, &r, go, sc, trig, type);
+    v->num = dg_apply_op(e->op, &l, &r);
+    v->str = NULL;
+    v->is_num = TRUE;
+  } else if (e->has_vars) {
+    var_subst(go, sc, trig, type, e->text, v->buf);
+    dg_value_set(v, v->buf);
+  } else {
+    v->str = e->text;
+    v->is_num = e->is_num;
+    v->num = e->num;
+  }
+}
 
-  return 0;
+/* Evaluates the condition cond on line cl, parsing it the first time. The
+ * command lists are shared with the prototype, so each is parsed once. */
+static void eval_cond(struct cmdlist_element *cl, char *cond, struct dg_value *v,
+               void *go, struct script_data *sc, trig_data *trig, int type)
+{
+  if (!cl->expr)
+    cl->expr = compile_expr(cond);
+
+  eval_dg_expr(cl->expr, v, go, sc, trig, type);
 }
 
 /* returns 1 if cond is true, else 0 */
-static int process_if(char *cond, void *go, struct script_data *sc,
-               trig_data *trig, int type)
+static int process_if(struct cmdlist_element *cl, char *cond, void *go,
+               struct script_data *sc, trig_data *trig, int type)
 {
-  char result[MAX_INPUT_LENGTH], *p;
-
-  eval_expr(cond, result, go, sc, trig, type);
+  struct dg_value v;
 
-  p = result;
-  skip_spaces(&p);
+  eval_cond(cl, cond, &v, go, sc, trig, type);
 
-  if (!*p || *p == '0')
-    return 0;
-  else
-    return 1;
+  return !dg_value_false(&v);
 }
 
 /* Scans for end of if-block.  returns the line containg 'end', or the last
@@ -1586,7 +1720,7 @@ static int process_if(char *cond, void *go, struct script_data *sc,
 static struct cmdlist_element *find_end(trig_data *trig, struct cmdlist_element *cl)
 {
   struct cmdlist_element *c;
-  char *p;
+  int line_type;
 
   if (!(cl->next)) { /* rryan: if this is the last line, theres no end */
     script_log("Trigger VNum %d has 'if' without 'end'. (error 1)", GET_TRIG_VNUM(trig));
@@ -1594,11 +1728,11 @@ static struct cmdlist_element *find_end(trig_data *trig, struct cmdlist_element
   }
 
   for (c = cl->next; c; c = c->next) {
-    for (p = c->cmd; *p && isspace(*p); p++);
+    line_type = dg_line_type(c->cmd);
 
-    if (!strn_cmp("if ", p, 3))
+    if (line_type == DG_LINE_IF)
       c = find_end(trig, c);
-    else if (!strn_cmp("end", p, 3))
+    else if (line_type == DG_LINE_END)
       return c;
 
     /* thanks to Russell Ryan for this fix */
@@ -1620,29 +1754,31 @@ static struct cmdlist_element *find_else_end(trig_data *trig,
 {
   struct cmdlist_element *c;
   char *p;
+  int line_type;
 
   if (!(cl->next))
     return cl;
 
   for (c = cl->next;c->next; c = c->next) {
     for (p = c->cmd; *p && isspace(*p); p++); /* skip spaces */
+    line_type = dg_line_type(p);
 
-    if (!strn_cmp("if ", p, 3))
+    if (line_type == DG_LINE_IF)
       c = find_end(trig, c);
 
-    else if (!strn_cmp("elseif ", p, 7)) {
-      if (process_if(p + 7, go, sc, trig, type)) {
+    else if (line_type == DG_LINE_ELSEIF) {
+      if (process_if(c, p + 7, go, sc, trig, type)) {
         GET_TRIG_DEPTH(trig)++;
         return c;
       }
     }
 
-    else if (!strn_cmp("else", p, 4)) {
+    else if (line_type == DG_LINE_ELSE) {
       GET_TRIG_DEPTH(trig)++;
       return c;
     }
 
-    else if (!strn_cmp("end", p, 3))
+    else if (line_type == DG_LINE_END)
       return c;
 
     /* thanks to Russell Ryan for this fix */
@@ -1653,8 +1789,7 @@ static struct cmdlist_element *find_else_end(trig_data *trig,
   }
 
   /* rryan: if we got here, it's the last line, if its not an end, log it. */
-  for (p = c->cmd; *p && isspace(*p); p++); /* skip spaces */
-  if(strn_cmp("end", p, 3))
+  if (dg_line_type(c->cmd) != DG_LINE_END)
     script_log("Trigger VNum %d has 'if' without 'end'. (error 5)", GET_TRIG_VNUM(trig));
   return c;
 }
@@ -1664,7 +1799,6 @@ static void process_wait(void *go, trig_data *trig, int type, char *cmd,
                   struct cmdlist_element *cl)
 {
   char buf[MAX_INPUT_LENGTH], *arg;
-  struct wait_event_data *wait_event_obj;
   long when, hr, min, ntime;
   char c;
 
@@ -1707,13 +1841,22 @@ static void process_wait(void *go, trig_data *trig, int type, char *cmd,
     }
   }
 
+  suspend_trigger(go, trig, type, when, cl->next);
+}
+
+/* Pauses trig for when pulses, to carry on at line resume. */
+static void suspend_trigger(void *go, trig_data *trig, int type, long when,
+                  struct cmdlist_element *resume)
+{
+  struct wait_event_data *wait_event_obj;
+
   CREATE(wait_event_obj, struct wait_event_data, 1);
   wait_event_obj->trigger = trig;
   wait_event_obj->go = go;
   wait_event_obj->type = type;
 
   GET_TRIG_WAIT(trig) = event_create(trig_wait_event, wait_event_obj, when);
-  trig->curr_state = cl->next;
+  trig->curr_state = resume;
 }
 
 /* processes a script set command */
@@ -1821,6 +1964,7 @@ static void process_attach(void *go, struct script_data *sc, trig_data *trig,
     if (!SCRIPT(c))
       CREATE(SCRIPT(c), struct script_data, 1);
     add_trigger(SCRIPT(c), newtrig, -1);
+    script_listeners_add(c, MOB_TRIGGER);
     return;
   }
 
@@ -1828,6 +1972,7 @@ static void process_attach(void *go, struct script_data *sc, trig_data *trig,
     if (!SCRIPT(o))
       CREATE(SCRIPT(o), struct script_data, 1);
     add_trigger(SCRIPT(o), newtrig, -1);
+    script_listeners_add(o, OBJ_TRIGGER);
     return;
   }
 
@@ -2455,6 +2600,91 @@ static void dg_letter_value(struct script_data *sc, trig_data *trig, char *cmd)
      TRIG_NEW     just started from dg_triggers.c
      TRIG_RESTART restarted after a 'wait' */
 int script_driver(void *go_adress, trig_data *trig, int type, int mode)
+{
+  struct trig_prof_data *prof;
+  struct timeval start, end;
+  unsigned long usec = 0, outer_nested;
+  int ret_val, profiled, timed;
+
+  prof = trig_profile(GET_TRIG_VNUM(trig));
+  if (mode == TRIG_NEW)
+    prof->calls++;
+  else
+    prof->resumes++;
+
+  /* The budget only needs the outermost run timed. */
+  profiled = trig_profiling;
+  timed = profiled || !driver_nesting;
+
+  if (timed)
+    gettimeofday(&start, NULL);
+  if (!driver_nesting++) {
+    if (budget_pulse != pulse) {
+      budget_pulse = pulse;
+      budget_used = 0;
+    }
+    budget_start = start;
+  }
+  outer_nested = nested_usec;
+  nested_usec = 0;
+
+  ret_val = run_trigger(go_adress, trig, type, mode, prof);
+
+  if (timed) {
+    gettimeofday(&end, NULL);
+    usec = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+  }
+  if (!--driver_nesting)
+    budget_used += usec;
+
+  if (profiled) {
+    prof->usec += usec;
+    prof->self_usec += usec > nested_usec ? usec - nested_usec : 0;
+    if (usec > prof->max_usec)
+      prof->max_usec = usec;
+  }
+  nested_usec = outer_nested + usec;
+
+  return ret_val;
+}
+
+/* Returns TRUE once the scripts run in this pulse have used more than
+ * SCRIPT_PULSE_BUDGET. Scripts run while booting (pulse 0) are not limited. */
+static int script_budget_exceeded(void)
+{
+  struct timeval now;
+
+  if (!pulse)
+    return FALSE;
+
+  gettimeofday(&now, NULL);
+  return budget_used + (now.tv_sec - budget_start.tv_sec) * 1000000L +
+    (now.tv_usec - budget_start.tv_usec) > SCRIPT_PULSE_BUDGET;
+}
+
+/* Whether trig may be suspended by the script budget, see MTRIG_PREEMPTIBLE.
+ * Death and command triggers, and the others whose return value decides
+ * what happens or whose owner may be gone by the next pulse, run to the end
+ * or to their own 'wait'. */
+static int trig_preemptible(trig_data *trig, int type, int mode)
+{
+  long allowed = 0;
+
+  if (mode == TRIG_RESTART)
+    return TRUE;
+
+  switch (type) {
+    case MOB_TRIGGER: allowed = MTRIG_PREEMPTIBLE; break;
+    case OBJ_TRIGGER: allowed = OTRIG_PREEMPTIBLE; break;
+    case WLD_TRIGGER: allowed = WTRIG_PREEMPTIBLE; break;
+  }
+
+  return !(GET_TRIG_TYPE(trig) & ~allowed);
+}
+
+/* Executes the trigger for script_driver(), counting into prof. */
+static int run_trigger(void *go_adress, trig_data *trig, int type, int mode,
+          struct trig_prof_data *prof)
 {
   static int depth = 0;
   int ret_val = 1;
@@ -2462,7 +2692,8 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
   char cmd[MAX_INPUT_LENGTH], *p;
   struct script_data *sc = 0;
   struct cmdlist_element *temp;
-  unsigned long loops = 0;
+  unsigned long loops = 0, lines = 0;
+  int preemptible, line_type, script_cmd;
   void *go = NULL;
 
   void obj_command_interpreter(obj_data *obj, char *argument);
@@ -2519,23 +2750,38 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
   }
 
   dg_owner_purged = 0;
+  preemptible = trig_preemptible(trig, type, mode);
 
   for (cl = (mode == TRIG_NEW) ? trig->cmdlist : trig->curr_state;
       cl && GET_TRIG_DEPTH(trig); cl = cl->next) {
+    /* Out of script time for this pulse: carry on from this line in the
+     * next one, the same way a 'wait 1' would. Every run gets at least one
+     * line so that a preempted script always makes progress. */
+    if (lines++ && preemptible && script_budget_exceeded()) {
+      if (!prof->preempts++ || !(prof->preempts % 100))
+        script_log("Trigger: %s, VNum %d preempted after exceeding the script"
+            " time budget (%lu times).", GET_TRIG_NAME(trig),
+            GET_TRIG_VNUM(trig), prof->preempts);
+      suspend_trigger(go, trig, type, 1, cl);
+      depth--;
+      return ret_val;
+    }
+
+    prof->cmds++;
     for (p = cl->cmd; *p && isspace(*p); p++);
+    line_type = dg_line_type(p);
 
-    if (*p == '*') /* comment */
+    if (line_type == DG_LINE_COMMENT) /* comment */
       continue;
 
-    else if (!strn_cmp(p, "if ", 3)) {
-      if (process_if(p + 3, go, sc, trig, type))
+    else if (line_type == DG_LINE_IF) {
+      if (process_if(cl, p + 3, go, sc, trig, type))
         GET_TRIG_DEPTH(trig)++;
       else
         cl = find_else_end(trig, cl, go, sc, type);
     }
 
-    else if (!strn_cmp("elseif ", p, 7) ||
-       !strn_cmp("else", p, 4)) {
+    else if (line_type == DG_LINE_ELSEIF || line_type == DG_LINE_ELSE) {
       /* If not in an if-block, ignore the extra 'else[if]' and warn about it. */
       if (GET_TRIG_DEPTH(trig) == 1) {
         script_log("Trigger VNum %d has 'else' without 'if'.",
@@ -2544,22 +2790,22 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
       }
       cl = find_end(trig, cl);
       GET_TRIG_DEPTH(trig)--;
-    } else if (!strn_cmp("while ", p, 6)) {
+    } else if (line_type == DG_LINE_WHILE) {
       temp = find_done(cl);
       if (!temp) {
         script_log("Trigger VNum %d has 'while' without 'done'.",
                    GET_TRIG_VNUM(trig));
         return ret_val;
       }
-      if (process_if(p + 6, go, sc, trig, type)) {
+      if (process_if(cl, p + 6, go, sc, trig, type)) {
          temp->original = cl;
       } else {
          cl = temp;
          loops = 0;
       }
-    } else if (!strn_cmp("switch ", p, 7)) {
+    } else if (line_type == DG_LINE_SWITCH) {
       cl = find_case(trig, cl, go, sc, type, p + 7);
-    } else if (!strn_cmp("end", p, 3)) {
+    } else if (line_type == DG_LINE_END) {
       /* If not in an if-block, ignore the extra 'end' and warn about it. */
       if (GET_TRIG_DEPTH(trig) == 1) {
         script_log("Trigger VNum %d has 'end' without 'if'.",
@@ -2567,17 +2813,19 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
         continue;
       }
       GET_TRIG_DEPTH(trig)--;
-    } else if (!strn_cmp("done", p, 4)) {
+    } else if (line_type == DG_LINE_DONE) {
       /* if in a while loop, cl->original is non-NULL */
       if (cl->original) {
       char *orig_cmd = cl->original->cmd;
       while (*orig_cmd && isspace(*orig_cmd)) orig_cmd++;
-      if (cl->original && process_if(orig_cmd + 6, go, sc, trig,
-          type)) {
+      if (cl->original && process_if(cl->original, orig_cmd + 6, go, sc,
+          trig, type)) {
         cl = cl->original;
         loops++;
         GET_TRIG_LOOPS(trig)++;
+        prof->loops++;
         if (loops == 30) {
+          prof->waits++;
           process_wait(go, trig, type, "wait 1", cl);
            depth--;
           return ret_val;
@@ -2591,69 +2839,71 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
          /* if we're falling through a switch statement, this ends it. */
         }
       }
-    } else if (!strn_cmp("break", p, 5)) {
+    } else if (line_type == DG_LINE_BREAK) {
       cl = find_done(cl);
-    } else if (!strn_cmp("case", p, 4)) {
+    } else if (line_type == DG_LINE_CASE) {
        /* Do nothing, this allows multiple cases to a single instance */
     }
 
     else {
       var_subst(go, sc, trig, type, p, cmd);
+      script_cmd = dg_script_command(cmd);
 
-      if (!strn_cmp(cmd, "eval ", 5))
+      if (script_cmd == DG_CMD_EVAL)
         process_eval(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "nop ", 4)); /* nop: do nothing */
+      else if (script_cmd == DG_CMD_NOP); /* nop: do nothing */
 
-      else if (!strn_cmp(cmd, "extract ", 8))
+      else if (script_cmd == DG_CMD_EXTRACT)
         extract_value(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "dg_letter ", 10))
+      else if (script_cmd == DG_CMD_LETTER)
         dg_letter_value(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "makeuid ", 8))
+      else if (script_cmd == DG_CMD_MAKEUID)
         makeuid_var(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "halt", 4))
+      else if (script_cmd == DG_CMD_HALT)
         break;
 
-      else if (!strn_cmp(cmd, "dg_cast ", 8))
+      else if (script_cmd == DG_CMD_CAST)
         do_dg_cast(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "dg_affect ", 10))
+      else if (script_cmd == DG_CMD_AFFECT)
         do_dg_affect(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "global ", 7))
+      else if (script_cmd == DG_CMD_GLOBAL)
         process_global(sc, trig, cmd, sc->context);
 
-      else if (!strn_cmp(cmd, "context ", 8))
+      else if (script_cmd == DG_CMD_CONTEXT)
         process_context(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "remote ", 7))
+      else if (script_cmd == DG_CMD_REMOTE)
         process_remote(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "rdelete ", 8))
+      else if (script_cmd == DG_CMD_RDELETE)
         process_rdelete(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "return ", 7))
+      else if (script_cmd == DG_CMD_RETURN)
         ret_val = process_return(trig, cmd);
 
-      else if (!strn_cmp(cmd, "set ", 4))
+      else if (script_cmd == DG_CMD_SET)
         process_set(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "unset ", 6))
+      else if (script_cmd == DG_CMD_UNSET)
         process_unset(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "wait ", 5)) {
+      else if (script_cmd == DG_CMD_WAIT) {
+        prof->waits++;
         process_wait(go, trig, type, cmd, cl);
         depth--;
         return ret_val;
       }
 
-      else if (!strn_cmp(cmd, "attach ", 7))
+      else if (script_cmd == DG_CMD_ATTACH)
         process_attach(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "detach ", 7))
+      else if (script_cmd == DG_CMD_DETACH)
         process_detach(go, sc, trig, type, cmd);
 
       else {
@@ -2718,13 +2968,178 @@ trig_rnum real_trigger(trig_vnum vnum)
   return (NOTHING);
 }
 
+/* Returns the profile entry of a trigger vnum, creating it on first use. */
+static struct trig_prof_data *trig_profile(trig_vnum vnum)
+{
+  struct trig_prof_data *prof;
+  int bucket = vnum % TRIG_PROF_HASH;
+
+  for (prof = trig_prof_table[bucket]; prof; prof = prof->next)
+    if (prof->vnum == vnum)
+      return prof;
+
+  CREATE(prof, struct trig_prof_data, 1);
+  prof->vnum = vnum;
+  prof->next = trig_prof_table[bucket];
+  trig_prof_table[bucket] = prof;
+
+  return prof;
+}
+
+static int trig_prof_compare(const void *a, const void *b)
+{
+  const struct trig_prof_data *pa = *(struct trig_prof_data * const *)a;
+  const struct trig_prof_data *pb = *(struct trig_prof_data * const *)b;
+
+  if (pa->self_usec != pb->self_usec)
+    return (pa->self_usec < pb->self_usec) ? 1 : -1;
+  return pa->vnum - pb->vnum;
+}
+
+/* Collects the profile entries that have run into a new array, most
+ * expensive in their own time first. The caller frees the array. */
+static struct trig_prof_data **sorted_trig_profile(int *count)
+{
+  struct trig_prof_data *prof, **list;
+  int i, n = 0;
+
+  for (i = 0; i < TRIG_PROF_HASH; i++)
+    for (prof = trig_prof_table[i]; prof; prof = prof->next)
+      if (prof->calls || prof->resumes)
+        n++;
+
+  CREATE(list, struct trig_prof_data *, n + 1);
+
+  for (n = 0, i = 0; i < TRIG_PROF_HASH; i++)
+    for (prof = trig_prof_table[i]; prof; prof = prof->next)
+      if (prof->calls || prof->resumes)
+        list[n++] = prof;
+
+  qsort(list, n, sizeof(struct trig_prof_data *), trig_prof_compare);
+  *count = n;
+
+  return list;
+}
+
+static const char *trig_prof_name(trig_vnum vnum)
+{
+  trig_rnum rnum = real_trigger(vnum);
+
+  if (rnum == NOTHING || !trig_index[rnum]->proto->name)
+    return "<deleted>";
+  return trig_index[rnum]->proto->name;
+}
+
+/* Writes the whole profile to TRIGPROF_LOGFILE, one trigger per line. */
+static int dump_trig_profile(void)
+{
+  struct trig_prof_data **list;
+  FILE *fl;
+  int i, n;
+
+  if (!(fl = fopen(TRIGPROF_LOGFILE, "w"))) {
+    log("SYSERR: Unable to open trigger profile file '%s': %s",
+        TRIGPROF_LOGFILE, strerror(errno));
+    return -1;
+  }
+
+  list = sorted_trig_profile(&n);
+  fprintf(fl, "# vnum calls resumes cmds loops waits preempts self_usec usec max_usec name\n");
+  for (i = 0; i < n; i++)
+    fprintf(fl, "%d %lu %lu %lu %lu %lu %lu %lu %lu %lu %s\n", list[i]->vnum,
+        list[i]->calls, list[i]->resumes, list[i]->cmds, list[i]->loops,
+        list[i]->waits, list[i]->preempts, list[i]->self_usec, list[i]->usec,
+        list[i]->max_usec, trig_prof_name(list[i]->vnum));
+  fclose(fl);
+  free(list);
+
+  return n;
+}
+
+/* tstat profile [on | off | top <n> | dump | reset] */
+static void do_trig_profile(struct char_data *ch, char *argument)
+{
+  struct trig_prof_data **list, *prof;
+  char arg[MAX_INPUT_LENGTH];
+  int i, n, top = 20;
+
+  argument = any_one_arg(argument, arg);  /* "on" is a fill word */
+
+  if (!strcmp(arg, "on") || !strcmp(arg, "off")) {
+    trig_profiling = (*(arg + 1) == 'n');
+    send_to_char(ch, "Trigger run times are %s timed.\r\n",
+        trig_profiling ? "now" : "no longer");
+    mudlog(CMP, MAX(LVL_BUILDER, GET_INVIS_LEV(ch)), TRUE,
+      "%s turned trigger profiling %s.", GET_NAME(ch), arg);
+    return;
+  }
+
+  if (*arg && is_abbrev(arg, "dump")) {
+    if ((n = dump_trig_profile()) < 0)
+      send_to_char(ch, "Could not write %s.\r\n", TRIGPROF_LOGFILE);
+    else {
+      send_to_char(ch, "Profile of %d triggers written to %s.\r\n", n, TRIGPROF_LOGFILE);
+      mudlog(CMP, MAX(LVL_BUILDER, GET_INVIS_LEV(ch)), TRUE,
+        "%s dumped the trigger profile to %s.", GET_NAME(ch), TRIGPROF_LOGFILE);
+    }
+    return;
+  }
+
+  if (*arg && is_abbrev(arg, "reset")) {
+    for (i = 0; i < TRIG_PROF_HASH; i++)
+      for (prof = trig_prof_table[i]; prof; prof = prof->next) {
+        trig_vnum vnum = prof->vnum;
+        struct trig_prof_data *next = prof->next;
+
+        memset(prof, 0, sizeof(*prof));
+        prof->vnum = vnum;
+        prof->next = next;
+      }
+    send_to_char(ch, "Trigger profile reset.\r\n");
+    return;
+  }
+
+  if (*arg && is_abbrev(arg, "top"))
+    one_argument(argument, arg);
+  if (*arg) {
+    if ((top = atoi(arg)) <= 0) {
+      send_to_char(ch, "Usage: tstat profile [on | off | top <n> | dump | reset]\r\n");
+      return;
+    }
+    top = MIN(top, 100);
+  }
+
+  list = sorted_trig_profile(&n);
+  if (!n) {
+    send_to_char(ch, "No triggers have run yet.\r\n");
+    free(list);
+    return;
+  }
+
+  send_to_char(ch, " Vnum    Calls  Resume     Cmds   Loops  Waits  Preem    Self ms   Total ms  Avg us  Max us  Name\r\n"
+                   "------ -------- ------- -------- ------- ------ ------ ---------- ---------- ------- -------  ----\r\n");
+  for (i = 0; i < n && i < top; i++) {
+    prof = list[i];
+    send_to_char(ch, "%6d %8lu %7lu %8lu %7lu %6lu %6lu %10.1f %10.1f %7lu %7lu  %s\r\n",
+        prof->vnum, prof->calls, prof->resumes, prof->cmds, prof->loops,
+        prof->waits, prof->preempts, prof->self_usec / 1000.0,
+        prof->usec / 1000.0, prof->self_usec / MAX(1, prof->calls + prof->resumes),
+        prof->max_usec, trig_prof_name(prof->vnum));
+  }
+  if (!trig_profiling)
+    send_to_char(ch, "Run times are not being taken, see 'tstat profile on'.\r\n");
+  free(list);
+}
+
 ACMD(do_tstat)
 {
   int rnum;
   char str[MAX_INPUT_LENGTH];
 
   half_chop(argument, str, argument);
-  if (*str) {
+  if (*str && !isdigit(*str) && is_abbrev(str, "profile"))
+    do_trig_profile(ch, argument);
+  else if (*str) {
     rnum = real_trigger(atoi(str));
     if (rnum == NOTHING) {
       send_to_char(ch, "That vnum does not exist.\r\n");
@@ -2733,7 +3148,7 @@ ACMD(do_tstat)
 
     do_stat_trigger(ch, trig_index[rnum]->proto);
   } else
-    send_to_char(ch, "Usage: tstat <vnum>\r\n");
+    send_to_char(ch, "Usage: tstat <vnum> | tstat profile [on | off | top <n> | dump | reset]\r\n");
 }
 
 /* Scans for a case/default instance. Returns the line containg the correct 
@@ -2744,29 +3159,34 @@ find_case(struct trig_data *trig, struct cmdlist_element *cl,
 {
   char result[MAX_INPUT_LENGTH];
   struct cmdlist_element *c;
+  struct dg_value v;
   char *p, *buf;
+  int line_type;
 
-  eval_expr(cond, result, go, sc, trig, type);
+  eval_cond(cl, cond, &v, go, sc, trig, type);
+  strlcpy(result, dg_value_str(&v), sizeof(result));
 
   if (!(cl->next))
     return cl;
 
   for (c = cl->next; c->next; c = c->next) {
     for (p = c->cmd; *p && isspace(*p); p++);
+    line_type = dg_line_type(p);
 
-    if (!strn_cmp("while ", p, 6) || !strn_cmp("switch", p, 6))
+    if (line_type == DG_LINE_WHILE || line_type == DG_LINE_SWITCH)
       c = find_done(c);
-    else if (!strn_cmp("case ", p, 5)) {
+    else if (line_type == DG_LINE_CASE) {
+      for (p += 4; *p && isspace(*p); p++);
       buf = (char*)malloc(MAX_STRING_LENGTH);
-      eval_op("==", result, p + 5, buf, go, sc, trig);
+      eval_op("==", result, p, buf, go, sc, trig);
       if (*buf && *buf!='0') {
         free(buf);
         return c;
       }
       free(buf);
-    } else if (!strn_cmp("default", p, 7))
+    } else if (line_type == DG_LINE_DEFAULT)
       return c;
-    else if (!strn_cmp("done", p, 3))
+    else if (line_type == DG_LINE_DONE)
      return c;
   }
   return c;
@@ -2778,17 +3198,17 @@ find_case(struct trig_data *trig, struct cmdlist_element *cl,
 static struct cmdlist_element *find_done(struct cmdlist_element *cl)
 {
   struct cmdlist_element *c;
-  char *p;
+  int line_type;
 
   if (!cl || !(cl->next))
     return cl;
 
   for (c = cl->next; c && c->next; c = c->next) {
-    for (p = c->cmd; *p && isspace(*p); p++);
+    line_type = dg_line_type(c->cmd);
 
-    if (!strn_cmp("while ", p, 6) || !strn_cmp("switch ", p, 7))
+    if (line_type == DG_LINE_WHILE || line_type == DG_LINE_SWITCH)
       c = find_done(c);
-    else if (!strn_cmp("done", p, 3))
+    else if (line_type == DG_LINE_DONE)
       return c;
   }
 
@@ -2883,7 +3303,7 @@ void save_char_vars(struct char_data *ch)
 }
 
 /* load in a character's saved variables from an ASCII pfile*/
-void read_saved_vars_ascii(FILE *file, struct char_data *ch, int count)
+void read_saved_vars_ascii(struct map_file *file, struct char_data *ch, int count)
 {
   long context;
   char input_line[1024], *temp, *p;
@@ -2904,7 +3324,7 @@ void read_saved_vars_ascii(FILE *file, struct char_data *ch, int count)
   /* walk through each line in the file parsing variables */
   for (i = 0; i < count; i++)
   {
-    if (get_line(file, input_line)>0) {
+    if (mf_get_line(file, input_line)>0) {
       p = temp = strdup(input_line);
       temp = any_one_arg(temp, varname);
       temp = any_one_arg(temp, context_str);
@@ -130,9 +130,32 @@
 
 #define SCRIPT_ERROR_CODE     -9999999   /* this shouldn't happen too often */
 
+#define SCRIPT_PULSE_BUDGET   20000       /* usec of script time allowed per
+                                             pulse before running scripts are
+                                             suspended until the next one */
+
+/* The triggers the budget may suspend when they are first run: those fired
+ * on their own, whose caller does not wait on the outcome or on the owner.
+ * Any trigger that has already done a 'wait' may be suspended again. */
+#define MTRIG_PREEMPTIBLE (MTRIG_GLOBAL | MTRIG_RANDOM | MTRIG_FIGHT | \
+                           MTRIG_HITPRCNT | MTRIG_MEMORY | MTRIG_TIME)
+#define OTRIG_PREEMPTIBLE (OTRIG_GLOBAL | OTRIG_RANDOM | OTRIG_TIME)
+#define WTRIG_PREEMPTIBLE (WTRIG_GLOBAL | WTRIG_RANDOM | WTRIG_RESET | WTRIG_TIME)
+
+/* an if/while/switch condition, parsed once into operators and operands */
+struct dg_expr {
+  int op;				/* index into the operators, or -1 */
+  struct dg_expr *lhs, *rhs;		/* operands of an operator           */
+  char *text;				/* an operand as written             */
+  ubyte has_vars;			/* text needs var_subst() at runtime */
+  ubyte is_num;				/* constant text is a number: num    */
+  int num;
+};
+
 /* one line of the trigger */
 struct cmdlist_element {
   char *cmd;				/* one line of a trigger */
+  struct dg_expr *expr;			/* the condition, parsed on first use */
   struct cmdlist_element *original;
   struct cmdlist_element *next;
 };
@@ -161,11 +184,23 @@ struct trig_data {
     struct event *wait_event;           /**< event to pause the trigger  */
     ubyte purged;                       /**< trigger is set to be purged     */
     struct trig_var_data *var_list;	    /**< list of local vars for trigger  */
+    struct trig_phrases *phrases;       /**< compiled speech/act arglist     */
 
     struct trig_data *next;
     struct trig_data *next_in_world;    /**< next in the global trigger list */
 };
 
+/** A speech or act trigger's argument list, split into its phrases once so
+ * a message can be matched in a single pass. */
+struct trig_phrases {
+  char *buf;                 /**< the phrases, NUL separated            */
+  char **phrase;             /**< start of each phrase within buf       */
+  int *len;                  /**< length of each phrase                 */
+  int count;                 /**< number of phrases                     */
+  ubyte wildcard;            /**< word list was '*', matches everything */
+  ubyte first[32];           /**< bitmap of the phrases' first letters  */
+};
+
 /** a complete script (composed of several triggers) */
 struct script_data {
   long types;                        /**< bitvector of trigger types */
@@ -203,6 +238,10 @@ typedef struct char_data char_data;
 char *one_phrase(char *arg, char *first_arg);
 int is_substring(char *sub, char *string);
 int word_check(char *str, char *wordlist);
+int trig_phrase_check(trig_data *t, char *str);
+void free_trig_phrases(trig_data *t);
+long room_listeners(room_rnum room, int type);
+void script_listeners_add(void *go, int type);
 
 void act_mtrigger(const char_data *ch, char *str,
 	char_data *actor, char_data *victim, obj_data *object, obj_data *target, char *arg);
@@ -263,6 +302,8 @@ void time_wtrigger(room_data *room);
 
 int login_wtrigger(struct room_data *room, char_data *actor);
 
+struct map_file;	/* mapfile.h */
+
 /* function prototypes from dg_scripts.c */
 ACMD(do_attach) ;
 ACMD(do_detach);
@@ -296,9 +337,10 @@ void add_trigger(struct script_data *sc, trig_data *t, int loc);
 void script_vlog(const char *format, va_list args);
 void script_log(const char *format, ...) __attribute__ ((format (printf, 1, 2)));
 char *matching_quote(char *p);
+void free_dg_expr(struct dg_expr *e);
 struct room_data *dg_room_of_obj(struct obj_data *obj);
 bool check_flags_by_name_ar(int *array, int numflags, char *search, const char *namelist[]);
-void read_saved_vars_ascii(FILE *file, struct char_data *ch, int count);
+void read_saved_vars_ascii(struct map_file *file, struct char_data *ch, int count);
 void save_char_vars_ascii(FILE *file, struct char_data *ch);
 int perform_set_dg_var(struct char_data *ch, struct char_data *vict, char *val_arg);
 int trig_is_attached(struct script_data *sc, int trig_num);
@@ -316,10 +358,12 @@ void add_to_lookup_table(long uid, void *c);
 void remove_from_lookup_table(long uid);
 
 /* from dg_db_scripts.c */
-void parse_trigger(FILE *trig_f, int nr);
+void parse_trigger(struct map_file *trig_f, int nr);
+void add_trigger_proto(int nr, char *name, int attach_type,
+    long trigger_type, int narg, char *arglist, struct cmdlist_element *cmdlist);
 trig_data *read_trigger(int nr);
 void trig_data_copy(trig_data *this_data, const trig_data *trg);
-void dg_read_trigger(FILE *fp, void *proto, int type);
+void dg_read_trigger(struct map_file *fp, void *proto, int type);
 void dg_obj_trigger(char *line, struct obj_data *obj);
 void assign_triggers(void *i, int type);
 
@@ -12,6 +12,8 @@
 *  $Revision: 1.0.14 $                                                    *
 **************************************************************************/
 
+#define MEM_TAG MEM_SCRIPT
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -106,6 +108,157 @@ int word_check(char *str, char *wordlist)
     return 0;
 }
 
+/* Splits a speech/act trigger's argument into its phrases, the same way
+ * word_check() does. A non-zero narg means arglist is a word list, otherwise
+ * the whole arglist is a single phrase (the is_substring() case). */
+static struct trig_phrases *compile_trig_phrases(char *arglist, int narg)
+{
+  struct trig_phrases *tp;
+  char words[MAX_INPUT_LENGTH], phrase[MAX_INPUT_LENGTH], *s, *b;
+  int max, len;
+
+  CREATE(tp, struct trig_phrases, 1);
+
+  if (narg && *arglist == '*') {
+    tp->wildcard = TRUE;
+    return tp;
+  }
+
+  len = strlen(arglist);
+  max = narg ? len / 2 + 2 : 1;
+  CREATE(tp->buf, char, len + 2);
+  CREATE(tp->phrase, char *, max);
+  CREATE(tp->len, int, max);
+
+  if (!narg) {
+    strcpy(tp->buf, arglist);
+    tp->phrase[0] = tp->buf;
+    tp->len[0] = len;
+    tp->count = len ? 1 : 0;
+  } else {
+    strlcpy(words, arglist, sizeof(words));
+    b = tp->buf;
+    for (s = one_phrase(words, phrase); *phrase && tp->count < max;
+         s = one_phrase(s, phrase)) {
+      len = strlen(phrase);
+      strcpy(b, phrase);
+      tp->phrase[tp->count] = b;
+      tp->len[tp->count++] = len;
+      b += len + 1;
+    }
+  }
+
+  for (len = 0; len < tp->count; len++) {
+    unsigned char c = LOWER(*tp->phrase[len]);
+    tp->first[c >> 3] |= 1 << (c & 7);
+  }
+
+  return tp;
+}
+
+void free_trig_phrases(trig_data *t)
+{
+  if (!t->phrases)
+    return;
+
+  if (t->phrases->buf)
+    free(t->phrases->buf);
+  if (t->phrases->phrase)
+    free(t->phrases->phrase);
+  if (t->phrases->len)
+    free(t->phrases->len);
+  free(t->phrases);
+  t->phrases = NULL;
+}
+
+/* Return 1 if str matches the speech/act argument of trigger t. Equivalent to
+ * word_check() or is_substring() depending on the trigger's narg, but the
+ * argument is only tokenised once and str is walked a single time, checking
+ * phrases only at word starts whose letter begins one of them. */
+int trig_phrase_check(trig_data *t, char *str)
+{
+  struct trig_phrases *tp;
+  unsigned char c;
+  char *s, *e;
+  int i;
+
+  if (!t->phrases)
+    t->phrases = compile_trig_phrases(GET_TRIG_ARG(t), GET_TRIG_NARG(t));
+  tp = t->phrases;
+
+  if (tp->wildcard)
+    return 1;
+
+  for (s = str; *s; s++) {
+    if (s != str && !isspace(*(s - 1)) && !ispunct(*(s - 1)))
+      continue;
+
+    c = LOWER(*s);
+    if (!(tp->first[c >> 3] & (1 << (c & 7))))
+      continue;
+
+    for (i = 0; i < tp->count; i++) {
+      if (strn_cmp(tp->phrase[i], s, tp->len[i]))
+        continue;
+      e = s + tp->len[i];
+      if (!*e || isspace(*e) || ispunct(*e))
+        return 1;
+    }
+  }
+
+  return 0;
+}
+
+/* Trigger types present in a room, cached per room. char_to_room() and
+ * obj_to_room() add the types of a scripted arrival, script_listeners_add()
+ * those of a trigger attached in place, and leaving drops the cache of that
+ * room. Detaching leaves it alone. The cache may hold stale extra bits but
+ * never misses one, so it is safe to skip a room on it. */
+
+/* Called after attaching triggers to go. Only the room holding go can have
+ * gained a listener; a mob or object not yet in the world gets its types
+ * added when it is placed. */
+void script_listeners_add(void *go, int type)
+{
+  char_data *ch;
+  obj_data *obj;
+
+  switch (type) {
+  case MOB_TRIGGER:
+    ch = (char_data *)go;
+    if (SCRIPT(ch) && IN_ROOM(ch) != NOWHERE)
+      world[IN_ROOM(ch)].mob_listeners |= SCRIPT_TYPES(SCRIPT(ch));
+    break;
+  case OBJ_TRIGGER:
+    obj = (obj_data *)go;
+    if (SCRIPT(obj) && IN_ROOM(obj) != NOWHERE)
+      world[IN_ROOM(obj)].obj_listeners |= SCRIPT_TYPES(SCRIPT(obj));
+    break;
+  }
+}
+
+/* Returns the union of the trigger types of the mobs (type MOB_TRIGGER) or
+ * the objects lying on the floor (type OBJ_TRIGGER) in room. */
+long room_listeners(room_rnum room, int type)
+{
+  struct room_data *r = &world[room];
+  char_data *ch;
+  obj_data *obj;
+
+  if (!r->listeners_valid) {
+    r->mob_listeners = r->obj_listeners = 0;
+    for (ch = r->people; ch; ch = ch->next_in_room)
+      if (SCRIPT(ch))
+        r->mob_listeners |= SCRIPT_TYPES(SCRIPT(ch));
+    for (obj = r->contents; obj; obj = obj->next_content)
+      if (SCRIPT(obj))
+        r->obj_listeners |= SCRIPT_TYPES(SCRIPT(obj));
+    r->listeners_valid = TRUE;
+  }
+
+  return (type == MOB_TRIGGER ? r->mob_listeners : r->obj_listeners);
+}
+
 /*Mob triggers. */
 void random_mtrigger(char_data *ch)
 {
@@ -300,6 +453,9 @@ int command_mtrigger(char_data *actor, char *cmd, char *argument)
   if (!valid_dg_target(actor, 0))
     return 0;
 
+  if (!IS_SET(room_listeners(IN_ROOM(actor), MOB_TRIGGER), MTRIG_COMMAND))
+    return 0;
+
   for (ch = world[IN_ROOM(actor)].people; ch; ch = ch_next) {
     ch_next = ch->next_in_room;
 
@@ -339,6 +495,9 @@ void speech_mtrigger(char_data *actor, char *str)
   trig_data *t;
   char buf[MAX_INPUT_LENGTH];
 
+  if (!IS_SET(room_listeners(IN_ROOM(actor), MOB_TRIGGER), MTRIG_SPEECH))
+    return;
+
   for (ch = world[IN_ROOM(actor)].people; ch; ch = ch_next)
   {
     ch_next = ch->next_in_room;
@@ -355,8 +514,7 @@ void speech_mtrigger(char_data *actor, char *str)
           continue;
         }
 
-        if (((GET_TRIG_NARG(t) && word_check(str, GET_TRIG_ARG(t))) ||
-             (!GET_TRIG_NARG(t) && is_substring(GET_TRIG_ARG(t), str)))) {
+        if (trig_phrase_check(t, str)) {
           ADD_UID_VAR(buf, t, actor, "actor", 0);
           add_var(&GET_TRIG_VARS(t), "speech", str, 0);
           script_driver(&ch, t, MOB_TRIGGER, TRIG_NEW);
@@ -385,8 +543,7 @@ void act_mtrigger(const char_data *ch, char *str, char_data *actor,
         continue;
       }
 
-      if (((GET_TRIG_NARG(t) && word_check(str, GET_TRIG_ARG(t))) ||
-           (!GET_TRIG_NARG(t) && is_substring(GET_TRIG_ARG(t), str)))) {
+      if (trig_phrase_check(t, str)) {
         if (actor)
           ADD_UID_VAR(buf, t, actor, "actor", 0);
         if (victim)
@@ -741,6 +898,9 @@ int command_otrigger(char_data *actor, char *cmd, char *argument)
     if (cmd_otrig(obj, actor, cmd, argument, OCMD_INVEN))
       return 1;
 
+  if (!IS_SET(room_listeners(IN_ROOM(actor), OBJ_TRIGGER), OTRIG_COMMAND))
+    return 0;
+
   for (obj = world[IN_ROOM(actor)].contents; obj; obj = obj->next_content)
     if (cmd_otrig(obj, actor, cmd, argument, OCMD_ROOM))
       return 1;
@@ -1100,9 +1260,7 @@ void speech_wtrigger(char_data *actor, char *str)
       continue;
     }
 
-    if (*GET_TRIG_ARG(t)=='*' ||
-       (GET_TRIG_NARG(t) && word_check(str, GET_TRIG_ARG(t))) ||
-       (!GET_TRIG_NARG(t) && is_substring(GET_TRIG_ARG(t), str))) {
+    if (*GET_TRIG_ARG(t)=='*' || trig_phrase_check(t, str)) {
       ADD_UID_VAR(buf, t, actor, "actor", 0);
       add_var(&GET_TRIG_VARS(t), "speech", str, 0);
       script_driver(&room, t, WLD_TRIGGER, TRIG_NEW);
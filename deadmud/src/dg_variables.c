@@ -7,6 +7,8 @@
 *  $Revision: 1.0.14 $                                                    *
 **************************************************************************/
 
+#define MEM_TAG MEM_SCRIPT
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -109,7 +111,7 @@ int item_in_list(char *item, obj_data *list)
     }
   } else {
     for (i = list; i; i = i->next_content) {
-      if (isname(item, i->name))
+      if (obj_isname(item, i))
         count++;
       if (GET_OBJ_TYPE(i) == ITEM_CONTAINER)
         count += item_in_list(item, i->contains);
@@ -1278,7 +1280,7 @@ o->contains) ? "1" : "0"));
             sprinttype(GET_OBJ_TYPE(o), item_types, str, slen);
 
           else if (!str_cmp(field, "timer"))
-            snprintf(str, slen, "%d", GET_OBJ_TIMER(o));
+            snprintf(str, slen, "%d", obj_timer(o));
           break;
         case 'v':
           if (!str_cmp(field, "vnum"))
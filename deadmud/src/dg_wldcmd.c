@@ -7,11 +7,14 @@
 *  $Revision: 1.0.14 $                                                    *
 **************************************************************************/
 
+#define MEM_TAG MEM_SCRIPT
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
 #include "screen.h"
 #include "dg_scripts.h"
+#include "dg_check.h"
 #include "utils.h"
 #include "comm.h"
 #include "interpreter.h"
@@ -20,6 +23,7 @@
 #include "constants.h"
 #include "genzon.h" /* for zone_rnum real_zone_by_thing */
 #include "fight.h"  /* for die() */
+#include "strpool.h"
 
 /* Local functions, macros, defines and structs */
 
@@ -31,7 +35,6 @@
 #define SCMD_WECHOAROUND  1
 
 struct wld_command_info {
-    char *command;
     void (*command_pointer)
            (room_data *room, char *argument, int cmd, int subcmd);
     int        subcmd;
@@ -232,10 +235,8 @@ WCMD(do_wdoor)
     /* purge exit */
     if (fd == 0) {
         if (newexit) {
-            if (newexit->general_description)
-                free(newexit->general_description);
-            if (newexit->keyword)
-                free(newexit->keyword);
+            str_release(newexit->general_description);
+            str_release(newexit->keyword);
             free(newexit);
             rm->dir_option[dir] = NULL;
         }
@@ -249,8 +250,7 @@ WCMD(do_wdoor)
 
         switch (fd) {
         case 1:  /* description */
-            if (newexit->general_description)
-                free(newexit->general_description);
+            str_release(newexit->general_description);
             CREATE(newexit->general_description, char, strlen(value) + 3);
             strcpy(newexit->general_description, value);
             strcat(newexit->general_description, "\r\n");
@@ -262,8 +262,7 @@ WCMD(do_wdoor)
             newexit->key = atoi(value);
             break;
         case 4:  /* name        */
-            if (newexit->keyword)
-                free(newexit->keyword);
+            str_release(newexit->keyword);
             CREATE(newexit->keyword, char, strlen(value) + 1);
             strcpy(newexit->keyword, value);
             break;
@@ -607,30 +606,18 @@ WCMD(do_wmove)
     }
 }
 
+/* The functions of the commands in DG_WLD_COMMANDS, see dg_check.h. */
+#define WLD_CMD_INFO(name, func, subcmd) { func, subcmd },
+
 const struct wld_command_info wld_cmd_info[] = {
-    { "RESERVED", 0, 0 },/* this must be first -- for specprocs */
-
-    { "wasound "    , do_wasound   , 0 },
-    { "wdoor "      , do_wdoor     , 0 },
-    { "wecho "      , do_wecho     , 0 },
-    { "wechoaround ", do_wsend     , SCMD_WECHOAROUND },
-    { "wforce "     , do_wforce    , 0 },
-    { "wload "      , do_wload     , 0 },
-    { "wpurge "     , do_wpurge    , 0 },
-    { "wrecho "     , do_wrecho    , 0 },
-    { "wsend "      , do_wsend     , SCMD_WSEND },
-    { "wteleport "  , do_wteleport , 0 },
-    { "wzoneecho "  , do_wzoneecho , 0 },
-    { "wdamage "    , do_wdamage,    0 },
-    { "wat "        , do_wat,        0 },
-    { "wmove "      , do_wmove     , 0 },
-    { "\n", 0, 0 }        /* this must be last */
+    { 0, 0 },/* RESERVED, this must be first -- for specprocs */
+    DG_WLD_COMMANDS(WLD_CMD_INFO)
 };
 
 /* This is the command interpreter used by rooms, called by script_driver. */
 void wld_command_interpreter(room_data *room, char *argument)
 {
-    int cmd, length;
+    int cmd;
     char *line, arg[MAX_INPUT_LENGTH];
 
     skip_spaces(&argument);
@@ -643,12 +630,7 @@ void wld_command_interpreter(room_data *room, char *argument)
 
 
     /* find the command */
-    for (length = strlen(arg), cmd = 0;
-         *wld_cmd_info[cmd].command != '\n'; cmd++)
-        if (!strncmp(wld_cmd_info[cmd].command, arg, length))
-            break;
-
-    if (*wld_cmd_info[cmd].command == '\n')
+    if ((cmd = dg_find_command(dg_wld_cmds, arg)) < 0)
         wld_log(room, "Unknown world cmd: '%s'", argument);
     else
       ((*wld_cmd_info[cmd].command_pointer)
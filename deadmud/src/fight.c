@@ -9,6 +9,7 @@
 **************************************************************************/
 
 #define __FIGHT_C__
+#define MEM_TAG MEM_LIVE
 
 #include "conf.h"
 #include "sysdep.h"
@@ -134,7 +135,10 @@ void set_fighting(struct char_data *ch, struct char_data *vict)
     return;
   }
 
+  ch->prev_fighting = NULL;
   ch->next_fighting = combat_list;
+  if (combat_list)
+    combat_list->prev_fighting = ch;
   combat_list = ch;
 
   if (AFF_FLAGGED(ch, AFF_SLEEP))
@@ -150,13 +154,19 @@ void set_fighting(struct char_data *ch, struct char_data *vict)
 /* remove a char from the list of fighting chars */
 void stop_fighting(struct char_data *ch)
 {
-  struct char_data *temp;
-
   if (ch == next_combat_list)
     next_combat_list = ch->next_fighting;
 
-  REMOVE_FROM_LIST(ch, combat_list, next_fighting);
-  ch->next_fighting = NULL;
+  /* combat_list is doubly linked; ch may not be on it at all. */
+  if (ch->prev_fighting || combat_list == ch) {
+    if (ch->prev_fighting)
+      ch->prev_fighting->next_fighting = ch->next_fighting;
+    else
+      combat_list = ch->next_fighting;
+    if (ch->next_fighting)
+      ch->next_fighting->prev_fighting = ch->prev_fighting;
+  }
+  ch->next_fighting = ch->prev_fighting = NULL;
   FIGHTING(ch) = NULL;
   GET_POS(ch) = POS_STANDING;
   update_pos(ch);
@@ -195,9 +205,9 @@ static void make_corpse(struct char_data *ch)
   GET_OBJ_WEIGHT(corpse) = GET_WEIGHT(ch) + IS_CARRYING_W(ch);
   GET_OBJ_RENT(corpse) = 100000;
   if (IS_NPC(ch))
-    GET_OBJ_TIMER(corpse) = CONFIG_MAX_NPC_CORPSE_TIME;
+    set_obj_timer(corpse, CONFIG_MAX_NPC_CORPSE_TIME);
   else
-    GET_OBJ_TIMER(corpse) = CONFIG_MAX_PC_CORPSE_TIME;
+    set_obj_timer(corpse, CONFIG_MAX_PC_CORPSE_TIME);
 
   /* transfer character's inventory to the corpse */
   corpse->contains = ch->carrying;
@@ -5,6 +5,8 @@
 *  Copyright 1996 by Harvey Gilpin, 1997-2001 by George Greer.            *
 **************************************************************************/
 
+#define MEM_TAG MEM_PROTO
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -17,6 +19,8 @@
 #include "genzon.h"
 #include "dg_olc.h"
 #include "spells.h"
+#include "strpool.h"
+#include "worldsnap.h"
 
 /* local functions */
 static void extract_mobile_all(mob_vnum vnum);
@@ -30,11 +34,11 @@ int add_mobile(struct char_data *mob, mob_vnum vnum)
   if ((rnum = real_mobile(vnum)) != NOBODY) {
     /* Copy over the mobile and free() the old strings. */
     copy_mobile(&mob_proto[rnum], mob);
+    pool_mobile_strings(rnum);
 
     /* Now re-point all existing mobile strings to here. */
-    for (live_mob = character_list; live_mob; live_mob = live_mob->next)
-      if (rnum == live_mob->nr)
-        update_mobile_strings(live_mob, &mob_proto[rnum]);
+    for (live_mob = mob_index[rnum].mobs; live_mob; live_mob = live_mob->next_instance)
+      update_mobile_strings(live_mob, &mob_proto[rnum]);
 
     add_to_save_list(zone_table[real_zone_by_thing(vnum)].number, SL_MOB);
     log("GenOLC: add_mobile: Updated existing mobile #%d.", vnum);
@@ -53,6 +57,7 @@ int add_mobile(struct char_data *mob, mob_vnum vnum)
       mob_index[i].vnum = vnum;
       mob_index[i].number = 0;
       mob_index[i].func = 0;
+      mob_index[i].mobs = NULL;
       found = i;
       break;
     }
@@ -67,7 +72,10 @@ int add_mobile(struct char_data *mob, mob_vnum vnum)
     mob_index[0].vnum = vnum;
     mob_index[0].number = 0;
     mob_index[0].func = 0;
+    mob_index[0].mobs = NULL;
   }
+  pool_mobile_strings(found);
+  index_vnums(DB_BOOT_MOB, found);
 
   log("GenOLC: add_mobile: Added mobile %d at index #%d.", vnum, found);
 
@@ -104,37 +112,20 @@ static void extract_mobile_all(mob_vnum vnum)
   struct char_data *next, *ch;
   int i;
 
-  for (ch = character_list; ch; ch = next) {
-    next = ch->next;
-    if (GET_MOB_VNUM(ch) == vnum) {
-			if ((i = GET_MOB_RNUM(ch)) != NOBODY) {
-	    if (ch->player.name && ch->player.name != mob_proto[i].player.name)
-          free(ch->player.name);
-				ch->player.name = NULL;
-				
-        if (ch->player.title && ch->player.title != mob_proto[i].player.title)
-          free(ch->player.title);
-				ch->player.title = NULL;
-				
-        if (ch->player.short_descr && ch->player.short_descr != mob_proto[i].player.short_descr)
-          free(ch->player.short_descr);
-				ch->player.short_descr = NULL;
-				
-        if (ch->player.long_descr && ch->player.long_descr != mob_proto[i].player.long_descr)
-          free(ch->player.long_descr);
-				ch->player.long_descr = NULL;
-				
-        if (ch->player.description && ch->player.description != mob_proto[i].player.description)
-          free(ch->player.description);
-				ch->player.description = NULL;
-    
-        /* free script proto list if it's not the prototype */
-        if (ch->proto_script && ch->proto_script != mob_proto[i].proto_script)
-          free_proto_script(ch, MOB_TRIGGER);			
-				ch->proto_script = NULL;
-			}
-      extract_char(ch);
-		}
+  if ((i = real_mobile(vnum)) == NOBODY)
+    return;
+
+  for (ch = mob_index[i].mobs; ch; ch = next) {
+    next = ch->next_instance;
+
+    /* free script proto list if it's not the prototype */
+    if (ch->proto_script && ch->proto_script != mob_proto[i].proto_script)
+      free_proto_script(ch, MOB_TRIGGER);
+    ch->proto_script = NULL;
+
+    /* The prototype is gone before the extraction happens. */
+    char_from_instances(ch);
+    extract_char(ch);
   }
 }
 
@@ -159,8 +150,12 @@ int delete_mobile(mob_rnum refpt)
   proto = &mob_proto[refpt];
   
   extract_mobile_all(vnum);
-  extract_char(proto);
 
+  /* The prototype is not in the game; it only gives back what it holds. */
+  free_mobile_strings(proto);
+  free_proto_script(proto, MOB_TRIGGER);
+
+  unindex_vnum(DB_BOOT_MOB, vnum);
   for (counter = refpt; counter < top_of_mobt; counter++) {
     mob_index[counter] = mob_index[counter + 1];
     mob_proto[counter] = mob_proto[counter + 1];
@@ -170,6 +165,7 @@ int delete_mobile(mob_rnum refpt)
   top_of_mobt--;
   RECREATE(mob_index, struct index_data, top_of_mobt + 1);
   RECREATE(mob_proto, struct char_data, top_of_mobt + 1);
+  index_vnums(DB_BOOT_MOB, refpt);
 
   /* Update live mobile rnums. */
   for (live_mob = character_list; live_mob; live_mob = live_mob->next)
@@ -198,45 +194,50 @@ int delete_mobile(mob_rnum refpt)
 int copy_mobile_strings(struct char_data *t, struct char_data *f)
 {
   if (f->player.name)
-    t->player.name = strdup(f->player.name);
+    t->player.name = str_ref(f->player.name);
   if (f->player.title)
-    t->player.title = strdup(f->player.title);
+    t->player.title = str_ref(f->player.title);
   if (f->player.short_descr)
-    t->player.short_descr = strdup(f->player.short_descr);
+    t->player.short_descr = str_ref(f->player.short_descr);
   if (f->player.long_descr)
-    t->player.long_descr = strdup(f->player.long_descr);
+    t->player.long_descr = str_ref(f->player.long_descr);
   if (f->player.description)
-    t->player.description = strdup(f->player.description);
+    t->player.description = str_ref(f->player.description);
   return TRUE;
 }
 
 int update_mobile_strings(struct char_data *t, struct char_data *f)
 {
-  if (f->player.name)
-    t->player.name = f->player.name;
-  if (f->player.title)
-    t->player.title = f->player.title;
-  if (f->player.short_descr)
-    t->player.short_descr = f->player.short_descr;
-  if (f->player.long_descr)
-    t->player.long_descr = f->player.long_descr;
-  if (f->player.description)
-    t->player.description = f->player.description;
+  if (f->player.name) {
+    str_release(t->player.name);
+    t->player.name = str_ref(f->player.name);
+  }
+  if (f->player.title) {
+    str_release(t->player.title);
+    t->player.title = str_ref(f->player.title);
+  }
+  if (f->player.short_descr) {
+    str_release(t->player.short_descr);
+    t->player.short_descr = str_ref(f->player.short_descr);
+  }
+  if (f->player.long_descr) {
+    str_release(t->player.long_descr);
+    t->player.long_descr = str_ref(f->player.long_descr);
+  }
+  if (f->player.description) {
+    str_release(t->player.description);
+    t->player.description = str_ref(f->player.description);
+  }
   return TRUE;
 }
 
 int free_mobile_strings(struct char_data *mob)
 {
-  if (mob->player.name)
-    free(mob->player.name);
-  if (mob->player.title)
-    free(mob->player.title);
-  if (mob->player.short_descr)
-    free(mob->player.short_descr);
-  if (mob->player.long_descr)
-    free(mob->player.long_descr);
-  if (mob->player.description)
-    free(mob->player.description);
+  str_release(mob->player.name);
+  str_release(mob->player.title);
+  str_release(mob->player.short_descr);
+  str_release(mob->player.long_descr);
+  str_release(mob->player.description);
   return TRUE;
 }
 
@@ -249,22 +250,13 @@ int free_mobile(struct char_data *mob)
   if (mob == NULL)
     return FALSE;
 
+  free_mobile_strings(mob);
+
   /* Non-prototyped mobile.  Also known as new mobiles. */
   if ((i = GET_MOB_RNUM(mob)) == NOBODY) {
-    free_mobile_strings(mob);
     /* free script proto list */
     free_proto_script(mob, MOB_TRIGGER);
    } else {	/* Prototyped mobile. */
-    if (mob->player.name && mob->player.name != mob_proto[i].player.name)
-      free(mob->player.name);
-    if (mob->player.title && mob->player.title != mob_proto[i].player.title)
-      free(mob->player.title);
-    if (mob->player.short_descr && mob->player.short_descr != mob_proto[i].player.short_descr)
-      free(mob->player.short_descr);
-    if (mob->player.long_descr && mob->player.long_descr != mob_proto[i].player.long_descr)
-      free(mob->player.long_descr);
-    if (mob->player.description && mob->player.description != mob_proto[i].player.description)
-      free(mob->player.description);
     /* free script proto list if it's not the prototype */
     if (mob->proto_script && mob->proto_script != mob_proto[i].proto_script)
       free_proto_script(mob, MOB_TRIGGER);
@@ -318,6 +310,7 @@ int save_mobiles(zone_rnum rznum)
   snprintf(usedfname, sizeof(usedfname), "%s%d.mob", MOB_PREFIX, vznum);
   remove(usedfname);
   rename(mobfname, usedfname);
+  remove_world_snapshot();
 
   if (in_save_list(vznum, SL_MOB))
     remove_from_save_list(vznum, SL_MOB);
@@ -429,8 +422,7 @@ void check_mobile_string(mob_vnum i, char **string, const char *desc)
     char smbuf[128];
     sprintf(smbuf, "GenOLC: Mob #%d has an invalid %s.", i, desc);
     mudlog(BRF, LVL_GOD, TRUE, "%s", smbuf);
-    if (*string)
-      free(*string);
-    *string = strdup("An undefined string.\n");
+    str_release(*string);
+    *string = str_pool(strdup("An undefined string.\n"));
   }
 }
@@ -5,6 +5,8 @@
 *  Copyright 1996 by Harvey Gilpin, 1997-2001 by George Greer.            *
 **************************************************************************/
 
+#define MEM_TAG MEM_PROTO
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -19,6 +21,9 @@
 #include "handler.h"
 #include "interpreter.h"
 #include "boards.h" /* for board_info */
+#include "strpool.h"
+#include "nameindex.h"
+#include "worldsnap.h"
 
 
 /* local functions */
@@ -33,6 +38,7 @@ obj_rnum add_object(struct obj_data *newobj, obj_vnum ovnum)
   /* Write object to internal tables. */
   if ((newobj->item_number = real_object(ovnum)) != NOTHING) {
     copy_object(&obj_proto[newobj->item_number], newobj);
+    pool_object_strings(newobj->item_number);
     update_all_objects(&obj_proto[newobj->item_number]);
     add_to_save_list(zone_table[rznum].number, SL_OBJ);
     return newobj->item_number;
@@ -53,15 +59,14 @@ static int update_all_objects(struct obj_data *refobj)
   struct obj_data *obj, swap;
   int count = 0;
 
-  for (obj = object_list; obj; obj = obj->next) {
-    if (obj->item_number != refobj->item_number)
-      continue;
-
+  for (obj = obj_index[refobj->item_number].objs; obj; obj = obj->next_instance) {
     count++;
 
     /* Update the existing object but save a copy for private information. */
+    obj_timer_unschedule(obj);
     swap = *obj;
-    *obj = *refobj;
+    copy_object_preserve(obj, refobj);
+    free_object_strings(&swap);
 
     /* Copy game-time dependent variables over. */
     GET_ID(obj) = swap.id;
@@ -73,7 +78,13 @@ static int update_all_objects(struct obj_data *refobj)
     obj->contains = swap.contains;
     obj->next_content = swap.next_content;
     obj->next = swap.next;
+    obj->prev = swap.prev;
+    obj->next_instance = swap.next_instance;
+    obj->prev_instance = swap.prev_instance;
+    obj->next_unshared = swap.next_unshared;
+    obj->prev_unshared = swap.prev_unshared;
     obj->sitting_here = swap.sitting_here;
+    set_obj_timer(obj, GET_OBJ_TIMER(refobj));
   }
 
   return count;
@@ -169,8 +180,11 @@ obj_rnum index_object(struct obj_data *obj, obj_vnum ovnum, obj_rnum ornum)
   obj_index[ornum].vnum = ovnum;
   obj_index[ornum].number = 0;
   obj_index[ornum].func = NULL;
+  obj_index[ornum].objs = NULL;
+  index_vnums(DB_BOOT_OBJ, ornum);
 
   copy_object_preserve(&obj_proto[ornum], obj);
+  pool_object_strings(ornum);
   obj_proto[ornum].in_room = NOWHERE;
 
   return ornum;
@@ -285,6 +299,7 @@ int save_objects(zone_rnum zone_num)
   snprintf(buf, sizeof(buf), "%s/%d.obj", OBJ_PREFIX, zone_table[zone_num].number);
   remove(buf);
   rename(filename, buf);
+  remove_world_snapshot();
 
   if (in_save_list(zone_table[zone_num].number, SL_OBJ))
     remove_from_save_list(zone_table[zone_num].number, SL_OBJ);
@@ -294,60 +309,20 @@ int save_objects(zone_rnum zone_num)
 /* Free all, unconditionally. */
 void free_object_strings(struct obj_data *obj)
 {
-  if (obj->name)
-    free(obj->name);
-  if (obj->description)
-    free(obj->description);
-  if (obj->short_description)
-    free(obj->short_description);
-  if (obj->action_description)
-    free(obj->action_description);
+  str_release(obj->name);
+  str_release(obj->description);
+  str_release(obj->short_description);
+  str_release(obj->action_description);
   if (obj->ex_description)
     free_ex_descriptions(obj->ex_description);
 }
 
-/* For object instances that are not the prototype. */
-void free_object_strings_proto(struct obj_data *obj)
-{
-  int robj_num = GET_OBJ_RNUM(obj);
-
-  if (obj->name && obj->name != obj_proto[robj_num].name)
-    free(obj->name);
-  if (obj->description && obj->description != obj_proto[robj_num].description)
-    free(obj->description);
-  if (obj->short_description && obj->short_description != obj_proto[robj_num].short_description)
-    free(obj->short_description);
-  if (obj->action_description && obj->action_description != obj_proto[robj_num].action_description)
-    free(obj->action_description);
-  if (obj->ex_description) {
-    struct extra_descr_data *thised, *plist, *next_one; /* O(horrible) */
-    int ok_key, ok_desc, ok_item;
-    for (thised = obj->ex_description; thised; thised = next_one) {
-      next_one = thised->next;
-      for (ok_item = ok_key = ok_desc = 1, plist = obj_proto[robj_num].ex_description; plist; plist = plist->next) {
-        if (plist->keyword == thised->keyword)
-          ok_key = 0;
-        if (plist->description == thised->description)
-          ok_desc = 0;
-        if (plist == thised)
-          ok_item = 0;
-      }
-      if (thised->keyword && ok_key)
-        free(thised->keyword);
-      if (thised->description && ok_desc)
-        free(thised->description);
-      if (ok_item)
-        free(thised);
-    }
-  }
-}
-
 static void copy_object_strings(struct obj_data *to, struct obj_data *from)
 {
-  to->name = from->name ? strdup(from->name) : NULL;
-  to->description = from->description ? strdup(from->description) : NULL;
-  to->short_description = from->short_description ? strdup(from->short_description) : NULL;
-  to->action_description = from->action_description ? strdup(from->action_description) : NULL;
+  to->name = str_ref(from->name);
+  to->description = str_ref(from->description);
+  to->short_description = str_ref(from->short_description);
+  to->action_description = str_ref(from->action_description);
 
   if (from->ex_description)
     copy_ex_descriptions(&to->ex_description, from->ex_description);
@@ -377,7 +352,7 @@ int delete_object(obj_rnum rnum)
 {
   obj_rnum i;
   zone_rnum zrnum;
-  struct obj_data *obj, *tmp, *next_obj;
+  struct obj_data *obj, *tmp;
   int shop, j, zone, cmd_no;
 
   if (rnum == NOTHING || rnum > top_of_objt)
@@ -390,11 +365,7 @@ int delete_object(obj_rnum rnum)
   /* This is something you might want to read about in the logs. */
   log("GenOLC: delete_object: Deleting object #%d (%s).", GET_OBJ_VNUM(obj), obj->short_description);
 
-  for (tmp = object_list; tmp; tmp = next_obj) {
-	next_obj = tmp->next;
-    if (tmp->item_number != obj->item_number)
-      continue;
-
+  while ((tmp = obj_index[rnum].objs) != NULL) {
     /* extract_obj() will just axe contents. */
     if (tmp->contains) {
       struct obj_data *this_content, *next_content;
@@ -427,6 +398,7 @@ int delete_object(obj_rnum rnum)
     GET_OBJ_RNUM(tmp) -= (GET_OBJ_RNUM(tmp) > rnum);
   }
 
+  unindex_vnum(DB_BOOT_OBJ, obj_index[rnum].vnum);
   for (i = rnum; i < top_of_objt; i++) {
     obj_index[i] = obj_index[i + 1];
     obj_proto[i] = obj_proto[i + 1];
@@ -436,6 +408,7 @@ int delete_object(obj_rnum rnum)
   top_of_objt--;
   RECREATE(obj_index, struct index_data, top_of_objt + 1);
   RECREATE(obj_proto, struct obj_data, top_of_objt + 1);
+  index_vnums(DB_BOOT_OBJ, rnum);
 
   /* Renumber notice boards. */
   for (j = 0; j < NUM_OF_BOARDS; j++)
@@ -483,17 +456,16 @@ int delete_object(obj_rnum rnum)
 bool oset_alias(struct obj_data *obj, char * argument)
 { 
   static int max_len = 64;
-  int i = GET_OBJ_RNUM(obj);
   
   skip_spaces(&argument);
   
   if (strlen(argument) > max_len)
     return FALSE;
   
-  if (i != NOWHERE && obj->name && obj->name != obj_proto[i].name)
-    free(obj->name);  
+  str_release(obj->name);
 		   	   
   obj->name = strdup(argument);  
+  obj_to_unshared(obj);
   
   return TRUE;
 }
@@ -554,15 +526,13 @@ bool oset_apply(struct obj_data *obj, char * argument)
 bool oset_short_description(struct obj_data *obj, char * argument)
 { 
   static int max_len = 64;
-  int i = GET_OBJ_RNUM(obj);
   
   skip_spaces(&argument);
   
   if (strlen(argument) > max_len)
     return FALSE;
   
-  if (i != NOWHERE && obj->short_description && obj->short_description != obj_proto[i].short_description)
-    free(obj->short_description);  
+  str_release(obj->short_description);
 		   	   
   obj->short_description = strdup(argument);  
   
@@ -572,15 +542,13 @@ bool oset_short_description(struct obj_data *obj, char * argument)
 bool oset_long_description(struct obj_data *obj, char * argument)
 {
   static int max_len = 128;
-  int i = GET_OBJ_RNUM(obj);  
   
   skip_spaces(&argument);
   
   if (strlen(argument) > max_len)
     return FALSE;  
   
-  if (i != NOWHERE && obj->description && obj->description != obj_proto[i].description)
-    free(obj->description);  
+  str_release(obj->description);
 		   	   
   obj->description = strdup(argument);  
   
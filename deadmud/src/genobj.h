@@ -12,7 +12,6 @@
 #ifndef _GENOBJ_H_
 #define _GENOBJ_H_
 
-void free_object_strings_proto(struct obj_data *obj);
 void free_object_strings(struct obj_data *obj);
 int copy_object(struct obj_data *to, struct obj_data *from);
 int copy_object_preserve(struct obj_data *to, struct obj_data *from);
@@ -6,6 +6,7 @@
 **************************************************************************/
 
 #define __GENOLC_C__
+#define MEM_TAG MEM_OLC
 
 #include "conf.h"
 #include "sysdep.h"
@@ -28,6 +29,7 @@
 #include "act.h"        /* for the space_to_minus function */
 #include "modify.h"      /* for smash_tilde */
 #include "quest.h"
+#include "strpool.h"
 
 /* Global variables defined here, used elsewhere */
 /* List of zones to be saved. */
@@ -139,8 +141,8 @@ void copy_ex_descriptions(struct extra_descr_data **to, struct extra_descr_data
   wpos = *to;
 
   for (; from; from = from->next, wpos = wpos->next) {
-    wpos->keyword = str_udup(from->keyword);
-    wpos->description = str_udup(from->description);
+    wpos->keyword = from->keyword && *from->keyword ? str_ref(from->keyword) : str_udup(from->keyword);
+    wpos->description = from->description && *from->description ? str_ref(from->description) : str_udup(from->description);
     if (from->next)
       CREATE(wpos->next, struct extra_descr_data, 1);
   }
@@ -157,10 +159,8 @@ void free_ex_descriptions(struct extra_descr_data *head)
 
   for (thised = head; thised; thised = next_one) {
     next_one = thised->next;
-    if (thised->keyword)
-      free(thised->keyword);
-    if (thised->description)
-      free(thised->description);
+    str_release(thised->keyword);
+    str_release(thised->description);
     free(thised);
   }
 }
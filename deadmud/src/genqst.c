@@ -8,6 +8,8 @@
 * Copyright 1997-2001 by George Greer (greerga@circlemud.org)     *
 ************************************************************************ */
 
+#define MEM_TAG MEM_PROTO
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -16,6 +18,7 @@
 #include "quest.h"
 #include "genolc.h"
 #include "genzon.h" /* for create_world_index */
+#include "worldsnap.h"
 
 
 /*-------------------------------------------------------------------*/
@@ -105,6 +108,7 @@ int add_quest(struct aq_data *nqst)
       aquest_table[rnum] = aquest_table[rnum - 1]; //shift quest up one
     }
     copy_quest(&aquest_table[rnum], nqst, FALSE);
+    index_vnums(DB_BOOT_QST, rnum);
   }
   qmrnum = real_mobile(QST_MASTER(rnum));
   /* Make sure we assign spec procs to the questmaster */
@@ -143,6 +147,7 @@ int delete_quest(qst_rnum rnum)
   tempfunc = QST_FUNC(rnum);
 
 
+  unindex_vnum(DB_BOOT_QST, QST_NUM(rnum));
   free_quest_strings(&aquest_table[rnum]);
   for (i = rnum; i < total_quests - 1; i++) {
     aquest_table[i] = aquest_table[i + 1];
@@ -154,6 +159,7 @@ int delete_quest(qst_rnum rnum)
     free(aquest_table);
     aquest_table = NULL; 
    }
+  index_vnums(DB_BOOT_QST, rnum);
   if (rznum != NOWHERE)
      add_to_save_list(zone_table[rznum].number, SL_QST);
   else
@@ -264,6 +270,7 @@ int save_quests(zone_rnum zone_num)
            QST_PREFIX, zone_table[zone_num].number);
   remove(oldname);
   rename(filename, oldname);
+  remove_world_snapshot();
 
   /* Do we need to update the index file? */
   if (num_quests > 0)
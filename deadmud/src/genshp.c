@@ -5,6 +5,8 @@
 *  Copyright 1996 by Harvey Gilpin, 1997-2001 by George Greer.            *
 **************************************************************************/
 
+#define MEM_TAG MEM_PROTO
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -14,6 +16,7 @@
 #include "genolc.h"
 #include "genshp.h"
 #include "genzon.h"
+#include "worldsnap.h"
 
 /* NOTE (gg): Didn't modify sedit much. Don't consider it as 'recent' as the
  * other editors with regard to updates or style. */
@@ -434,6 +437,7 @@ int save_shops(zone_rnum zone_num)
   snprintf(oldname, sizeof(oldname), "%s/%d.shp", SHP_PREFIX, zone_table[zone_num].number);
   remove(oldname);
   rename(fname, oldname);
+  remove_world_snapshot();
 
   if (num_shops > 0)
     create_world_index(zone_table[zone_num].number, "shp");
@@ -5,6 +5,8 @@
 *  By Levork. Copyright 1996 by Harvey Gilpin, 1997-2001 by George Greer. *
 **************************************************************************/
 
+#define MEM_TAG MEM_WORLD
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -18,7 +20,51 @@
 #include "shop.h"
 #include "dg_olc.h"
 #include "mud_event.h"
+#include "strpool.h"
+#include "worldsnap.h"
+
+
+/* A room keeps its rnum from the moment it is added until it is deleted, so
+ * building never renumbers the world.  New rooms take the slot of a deleted
+ * one, or go after the last room; world grows ROOM_SLAB rooms at a time. */
+#define ROOM_SLAB 64
+
+static room_rnum *free_rooms = NULL;	/* Slots of deleted rooms. */
+static int num_free_rooms = 0;
+static int world_slots = 0;		/* Rooms allocated in world. */
+
+/* Re-points the events that hold the address of a room, after world moved. */
+static void rehome_room_events(room_rnum rnum)
+{
+  struct event *pEvent;
 
+  update_wait_events(&world[rnum], &world[rnum]);
+
+  if (world[rnum].events == NULL)
+    return;
+
+  while ((pEvent = simple_list(world[rnum].events)) != NULL)
+    ((struct mud_event_data *)pEvent->event_obj)->pStruct = &world[rnum];
+}
+
+static room_rnum new_room_slot(void)
+{
+  struct room_data *old_world = world;
+  room_rnum i;
+
+  if (num_free_rooms > 0)
+    return free_rooms[--num_free_rooms];
+
+  world_slots = MAX(world_slots, top_of_world + 1);
+  if (top_of_world + 1 >= world_slots) {
+    world_slots += ROOM_SLAB;
+    RECREATE(world, struct room_data, world_slots);
+    if (world != old_world)
+      for (i = 0; i <= top_of_world; i++)
+        rehome_room_events(i);
+  }
+  return ++top_of_world;
+}
 
 /* This function will copy the strings so be sure you free your own copies of 
  * the description, title, and such. */
@@ -26,7 +72,6 @@ room_rnum add_room(struct room_data *room)
 {
   struct char_data *tch;
   struct obj_data *tobj;
-  int j, found = FALSE;
   room_rnum i;
 
   if (room == NULL)
@@ -38,6 +83,7 @@ room_rnum add_room(struct room_data *room)
     tch = world[i].people;
     tobj = world[i].contents;
     copy_room(&world[i], room);
+    pool_room_strings(&world[i]);
     world[i].people = tch;
     world[i].contents = tobj;
     add_to_save_list(zone_table[room->zone].number, SL_WLD);
@@ -45,78 +91,18 @@ room_rnum add_room(struct room_data *room)
     return i;
   }
 
-  RECREATE(world, struct room_data, top_of_world + 2);
-  top_of_world++;
-
-  for (i = top_of_world; i > 0; i--) {
-    if (room->number > world[i - 1].number) {
-      world[i] = *room;
-      copy_room_strings(&world[i], room);
-      found = i;
-      break;
-    } else {
-      /* Copy the room over now. */
-      world[i] = world[i - 1];
-      update_wait_events(&world[i], &world[i-1]);
-
-      /* People in this room must have their in_rooms moved up one. */
-      for (tch = world[i].people; tch; tch = tch->next_in_room)
-	IN_ROOM(tch) += (IN_ROOM(tch) != NOWHERE);
-
-      /* Move objects too. */
-      for (tobj = world[i].contents; tobj; tobj = tobj->next_content)
-	IN_ROOM(tobj) += (IN_ROOM(tobj) != NOWHERE);
-    }
-  }
-  if (!found) {
-    world[0] = *room;	/* Last place, in front. */
-    copy_room_strings(&world[0], room);
-  }
-
-  log("GenOLC: add_room: Added room %d at index #%d.", room->number, found);
-  /* found is equal to the array index where we added the room. */
-
-  /* Find what zone that room was in so we can update the loading table. */
-  for (i = room->zone; i <= top_of_zone_table; i++)
-    for (j = 0; ZCMD(i, j).command != 'S'; j++)
-      switch (ZCMD(i, j).command) {
-      case 'M':
-      case 'O':
-      case 'T':
-      case 'V':
-	ZCMD(i, j).arg3 += (ZCMD(i, j).arg3 != NOWHERE && ZCMD(i, j).arg3 >= found);
-	break;
-      case 'D':
-      case 'R':
-	ZCMD(i, j).arg1 += (ZCMD(i, j).arg1 != NOWHERE && ZCMD(i, j).arg1 >= found);
-      case 'G':
-      case 'P':
-      case 'E':
-      case '*':
-	/* Known zone entries we don't care about. */
-        break;
-      default:
-        mudlog(BRF, LVL_GOD, TRUE, "SYSERR: GenOLC: add_room: Unknown zone entry found!");
-      }
-
-  /* Update the loadroom table. Adds 1 or 0. */
-  r_mortal_start_room += (r_mortal_start_room >= found);
-  r_immort_start_room += (r_immort_start_room >= found);
-  r_frozen_start_room += (r_frozen_start_room >= found);
+  i = new_room_slot();
+  world[i] = *room;
+  copy_room_strings(&world[i], room);
+  pool_room_strings(&world[i]);
+  index_vnum(DB_BOOT_WLD, i);
 
-  /* Update world exits. */
-  i = top_of_world + 1;
-  do {
-    i--;
-    for (j = 0; j < DIR_COUNT; j++)
-      if (W_EXIT(i, j) && W_EXIT(i, j)->to_room != NOWHERE)
-	W_EXIT(i, j)->to_room += (W_EXIT(i, j)->to_room >= found);
-  } while (i > 0);
+  log("GenOLC: add_room: Added room %d at index #%d.", room->number, i);
 
   add_to_save_list(zone_table[room->zone].number, SL_WLD);
 
   /* Return what array entry we placed the new room in. */
-  return found;
+  return i;
 }
 
 int delete_room(room_rnum rnum)
@@ -127,7 +113,7 @@ int delete_room(room_rnum rnum)
   struct obj_data *obj, *next_obj;
   struct room_data *room;
 
-  if (rnum <= 0 || rnum > top_of_world)	/* Can't delete void yet. */
+  if (rnum <= 0 || !VALID_ROOM_RNUM(rnum))	/* Can't delete void yet. */
     return FALSE;
 
   room = &world[rnum];
@@ -179,30 +165,23 @@ int delete_room(room_rnum rnum)
     room->events = NULL;
   }
 
-  /* Change any exit going to this room to go the void. Also fix all the exits 
-   * pointing to rooms above this. */
+  /* Change any exit going to this room to go the void. */
   i = top_of_world + 1;
   do {
     i--;
     for (j = 0; j < DIR_COUNT; j++) {
-      if (W_EXIT(i, j) == NULL)
+      if (W_EXIT(i, j) == NULL || W_EXIT(i, j)->to_room != rnum)
         continue;
-      else if (W_EXIT(i, j)->to_room > rnum)
-        W_EXIT(i, j)->to_room -= (W_EXIT(i, j)->to_room != NOWHERE); /* with unsigned NOWHERE > any rnum */
-      else if (W_EXIT(i, j)->to_room == rnum) {
-      	if ((!W_EXIT(i, j)->keyword || !*W_EXIT(i, j)->keyword) &&
-      	    (!W_EXIT(i, j)->general_description || !*W_EXIT(i, j)->general_description)) {
-          /* no description, remove exit completely */
-          if (W_EXIT(i, j)->keyword)
-            free(W_EXIT(i, j)->keyword);
-          if (W_EXIT(i, j)->general_description)
-            free(W_EXIT(i, j)->general_description);
-          free(W_EXIT(i, j));
-          W_EXIT(i, j) = NULL;
-        } else {
-          /* description is set, just point to nowhere */
-          W_EXIT(i, j)->to_room = NOWHERE;
-        }
+      if ((!W_EXIT(i, j)->keyword || !*W_EXIT(i, j)->keyword) &&
+          (!W_EXIT(i, j)->general_description || !*W_EXIT(i, j)->general_description)) {
+        /* no description, remove exit completely */
+        str_release(W_EXIT(i, j)->keyword);
+        str_release(W_EXIT(i, j)->general_description);
+        free(W_EXIT(i, j));
+        W_EXIT(i, j) = NULL;
+      } else {
+        /* description is set, just point to nowhere */
+        W_EXIT(i, j)->to_room = NOWHERE;
       }
     }
   } while (i > 0);
@@ -217,15 +196,11 @@ int delete_room(room_rnum rnum)
       case 'V':
 	if (ZCMD(i, j).arg3 == rnum)
 	  ZCMD(i, j).command = '*';	/* Cancel command. */
-	else if (ZCMD(i, j).arg3 > rnum)
-	  ZCMD(i, j).arg3 -= (ZCMD(i, j).arg3 != NOWHERE); /* with unsigned NOWHERE > any rnum */
 	break;
       case 'D':
       case 'R':
 	if (ZCMD(i, j).arg1 == rnum)
 	  ZCMD(i, j).command = '*';	/* Cancel command. */
-	else if (ZCMD(i, j).arg1 > rnum)
-	  ZCMD(i, j).arg1 -= (ZCMD(i, j).arg1 != NOWHERE); /* with unsigned NOWHERE > any rnum */
       case 'G':
       case 'P':
       case 'E':
@@ -243,20 +218,21 @@ int delete_room(room_rnum rnum)
         SHOP_ROOM(i, j) = 0; /* set to the void */
     }
   }
-  /* Now we actually move the rooms down. */
-  for (i = rnum; i < top_of_world; i++) {
-    world[i] = world[i + 1];
-    update_wait_events(&world[i], &world[i+1]);
-
-    for (ppl = world[i].people; ppl; ppl = ppl->next_in_room)
-      IN_ROOM(ppl) -= (IN_ROOM(ppl) != NOWHERE);	/* Redundant check? */
 
-    for (obj = world[i].contents; obj; obj = obj->next_content)
-      IN_ROOM(obj) -= (IN_ROOM(obj) != NOWHERE);	/* Redundant check? */
-  }
+  /* Leave an empty slot for the next new room; an empty room has no vnum. */
+  unindex_vnum(DB_BOOT_WLD, world[rnum].number);
+  for (j = 0; j < NUM_OF_DIRS; j++)	/* free_room_strings() stops at DIR_COUNT */
+    if (room->dir_option[j]) {
+      str_release(room->dir_option[j]->keyword);
+      str_release(room->dir_option[j]->general_description);
+      free(room->dir_option[j]);
+    }
+  memset(room, 0, sizeof(struct room_data));
+  room->number = NOWHERE;
+  room->zone = NOWHERE;
 
-  top_of_world--;
-  RECREATE(world, struct room_data, top_of_world + 1);
+  RECREATE(free_rooms, room_rnum, num_free_rooms + 1);
+  free_rooms[num_free_rooms++] = rnum;
 
   return TRUE;
 }
@@ -379,6 +355,7 @@ int save_rooms(zone_rnum rzone)
 
   remove(buf);
   rename(filename, buf);
+  remove_world_snapshot();
 
   if (in_save_list(zone_table[rzone].number, SL_WLD))
     remove_from_save_list(zone_table[rzone].number, SL_WLD);
@@ -439,21 +416,16 @@ int free_room_strings(struct room_data *room)
   int i;
 
   /* Free descriptions. */
-  if (room->name)
-    free(room->name);
-  if (room->description)
-    free(room->description);
+  str_release(room->name);
+  str_release(room->description);
   if (room->ex_description)
     free_ex_descriptions(room->ex_description);
 
   /* Free exits. */
   for (i = 0; i < DIR_COUNT; i++) {
     if (room->dir_option[i]) {
-      if (room->dir_option[i]->general_description)
-        free(room->dir_option[i]->general_description);
-
-      if (room->dir_option[i]->keyword)
-        free(room->dir_option[i]->keyword);
+      str_release(room->dir_option[i]->general_description);
+      str_release(room->dir_option[i]->keyword);
 
       free(room->dir_option[i]);
       room->dir_option[i] = NULL;
@@ -5,6 +5,8 @@
 *  Copyright 1996 by Harvey Gilpin, 1997-2001 by George Greer.            *
 **************************************************************************/
 
+#define MEM_TAG MEM_WORLD
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -13,6 +15,7 @@
 #include "genolc.h"
 #include "genzon.h"
 #include "dg_scripts.h"
+#include "worldsnap.h"
 
 /* local functions */
 static void remove_cmd_from_list(struct reset_com **list, int pos);
@@ -200,6 +203,8 @@ rznum = i;
   zone->lifespan = 30;
   zone->age = 0;
   zone->reset_mode = 2;
+  zone->resets = zone->reset_pulses = zone->players = 0;
+  zone->reset_usecs = zone->reset_max_usecs = 0;
   zone->min_level = -1;
   zone->max_level = -1;
 
@@ -210,6 +215,7 @@ rznum = i;
   zone->cmd[0].command = 'S';
 
   top_of_zone_table++;
+  index_vnums(DB_BOOT_ZON, rznum);
 
   add_to_save_list(zone->number, SL_ZON);
   return rznum;
@@ -485,6 +491,7 @@ int save_zone(zone_rnum zone_num)
   snprintf(oldname, sizeof(oldname), "%s/%d.zon", ZON_PREFIX, zone_table[zone_num].number);
   remove(oldname);
   rename(fname, oldname);
+  remove_world_snapshot();
 
   if (in_save_list(zone_table[zone_num].number, SL_ZON))
     remove_from_save_list(zone_table[zone_num].number, SL_ZON);
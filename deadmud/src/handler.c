@@ -8,6 +8,8 @@
 *  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
 ************************************************************************ */
 
+#define MEM_TAG MEM_LIVE
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -24,14 +26,39 @@
 #include "fight.h"
 #include "quest.h"
 #include "mud_event.h"
+#include "nameindex.h"
+#include "slab.h"
 
 /* local file scope variables */
-static int extractions_pending = 0;
+/* Characters waiting for extract_pending_chars(), most recent first. */
+static struct char_data *extract_queue = NULL;
+
+/* Affects that wear off, kept in slots by the affect_update() pass they wear
+ * off in, so that each pass only looks at the affects due. Only the affects
+ * of characters on character_list are in the wheel; everyone else's keep
+ * their remaining hours in duration, the way affect_update() used to leave
+ * them alone. An affect due AFF_WHEEL_SLOTS or more passes out shares its
+ * slot with the ones due sooner and waits for its own lap. */
+#define AFF_WHEEL_SLOTS 128
+static struct affected_type *affect_wheel[AFF_WHEEL_SLOTS];
+static long affect_hours = 0;	/* affect_update() passes since boot */
+
+/* Objects on object_list whose timers are running, in slots by the
+ * point_update() pass the timer runs out in, the same way. The timer itself
+ * keeps the hours it was set to; obj_timer() works out what is left. */
+#define OBJ_WHEEL_SLOTS 128
+static struct obj_data *obj_wheel[OBJ_WHEEL_SLOTS];
+static long obj_hours = 0;	/* point_update() passes since boot */
 
 /* local file scope functions */
 static int apply_ac(struct char_data *ch, int eq_pos);
 static void update_object(struct obj_data *obj, int use);
 static void affect_modify_ar(struct char_data * ch, byte loc, sbyte mod, int bitv[], bool add);
+static void affect_schedule(struct char_data *ch, struct affected_type *af);
+static void affect_unschedule(struct affected_type *af);
+static void affects_to_wheel(struct char_data *ch);
+static void affects_from_wheel(struct char_data *ch);
+static void obj_timer_schedule(struct obj_data *obj);
 
 char *fname(const char *namelist)
 {
@@ -80,10 +107,19 @@ int is_name(const char *str, const char *namelist)
 
 /* allow abbreviations */
 #define WHITESPACE " \t"
+
+/* Skips *p to its next keyword and returns the keyword's length, 0 at the
+ * end of the namelist. */
+static size_t next_keyword(const char **p)
+{
+  *p += strspn(*p, WHITESPACE);
+  return strcspn(*p, WHITESPACE);
+}
+
 int isname(const char *str, const char *namelist)
 {
-  char *newlist;
-  char *curtok;
+  const char *curtok;
+  size_t len, toklen;
 
   if (!str || !*str || !namelist || !*namelist)
     return 0;
@@ -91,19 +127,106 @@ int isname(const char *str, const char *namelist)
   if (!strcmp(str, namelist)) /* the easy way */
     return 1;
 
-  newlist = strdup(namelist); /* make a copy since strtok 'modifies' strings */
-  for(curtok = strtok(newlist, WHITESPACE); curtok; curtok = strtok(NULL, WHITESPACE))
-    if(curtok && is_abbrev(str, curtok)) {
+  /* Walk the keywords in place rather than strtok() a copy. */
+  len = strlen(str);
+  for (curtok = namelist; (toklen = next_keyword(&curtok)) > 0; curtok += toklen)
+    if (len <= toklen && !strn_cmp(str, curtok, len)) {
       /* Don't allow abbreviated numbers. - Sryth */
       if (isdigit(*str) && (atoi(str) != atoi(curtok)))
         return 0;
-      free(newlist);
       return 1;
     }
-  free(newlist);
   return 0;
 }
 
+/** Splits a namelist into its keywords for char_isname() and obj_isname().
+ * The set is one block for free(), and keeps pointing at namelist, which
+ * must outlive it: the string pool builds them for its strings. */
+struct keyword_set *build_keyword_set(const char *namelist)
+{
+  struct keyword_set *kw;
+  const char *tok;
+  char *words;
+  int count = 0, i;
+  size_t toklen, size, j;
+
+  for (tok = namelist; (toklen = next_keyword(&tok)) > 0; tok += toklen)
+    count++;
+
+  size = sizeof(struct keyword_set) + MAX(count - 1, 0) * sizeof(struct keyword);
+  CREATE(words, char, size + strlen(namelist) + 1);
+  kw = (struct keyword_set *) words;
+  kw->text = namelist;
+  kw->count = count;
+  words += size;
+
+  for (i = 0, tok = namelist; (toklen = next_keyword(&tok)) > 0; i++, tok += toklen) {
+    kw->words[i].word = words;
+    kw->words[i].len = toklen;
+    for (j = 0; j < toklen; j++)
+      *words++ = LOWER(tok[j]);
+    *words++ = '\0';
+    kw->first |= 1U << (*kw->words[i].word & 31);
+  }
+  return kw;
+}
+
+/* Same as isname(), with the namelist already split. */
+static int isname_keywords(const char *str, const char *namelist, const struct keyword_set *kw)
+{
+  int i, j, len;
+  char c;
+
+  if (!kw || kw->text != namelist)
+    return isname(str, namelist);
+
+  if (!str || !*str || !namelist || !*namelist)
+    return 0;
+
+  if (!strcmp(str, namelist)) /* the easy way */
+    return 1;
+
+  c = LOWER(*str);
+  if (!(kw->first & (1U << (c & 31))))
+    return 0;
+
+  len = strlen(str);
+  for (i = 0; i < kw->count; i++) {
+    if (kw->words[i].len < len || *kw->words[i].word != c)
+      continue;
+    for (j = 1; j < len && LOWER(str[j]) == kw->words[i].word[j]; j++)
+      ;
+    if (j < len)
+      continue;
+    /* Don't allow abbreviated numbers. - Sryth */
+    if (isdigit(*str) && (atoi(str) != atoi(kw->words[i].word)))
+      return 0;
+    return 1;
+  }
+  return 0;
+}
+
+/** isname() on a character's keywords. Mobs use the keywords split from their
+ * prototype's name for as long as they share it. */
+int char_isname(const char *str, struct char_data *ch)
+{
+  mob_rnum rnum = IS_NPC(ch) ? GET_MOB_RNUM(ch) : NOBODY;
+
+  if (rnum != NOBODY && ch->player.name == mob_proto[rnum].player.name)
+    return isname_keywords(str, ch->player.name, mob_index[rnum].keywords);
+  return isname(str, ch->player.name);
+}
+
+/** isname() on an object's keywords, as char_isname() does for mobs. */
+int obj_isname(const char *str, struct obj_data *obj)
+{
+  obj_rnum rnum = GET_OBJ_RNUM(obj);
+
+  if (rnum != NOTHING && obj->name == obj_proto[rnum].name)
+    return isname_keywords(str, obj->name, obj_index[rnum].keywords);
+  return isname(str, obj->name);
+}
+
 void aff_apply_modify(struct char_data *ch, byte loc, sbyte mod, char *msg)
 {
   switch (loc) {
@@ -204,6 +327,9 @@ void aff_apply_modify(struct char_data *ch, byte loc, sbyte mod, char *msg)
   } /* switch */
 }
 
+/* Adds or takes away one modifier and bitvector, from equipment or an affect.
+ * Besides changing the points it applies to, this keeps ch->applies and
+ * ch->aff_sources up to date for affect_total(). */
 static void affect_modify_ar(struct char_data * ch, byte loc, sbyte mod, int bitv[], bool add)
 {
   int i , j;
@@ -211,49 +337,100 @@ static void affect_modify_ar(struct char_data * ch, byte loc, sbyte mod, int bit
   if (add) {
     for(i = 0; i < AF_ARRAY_MAX; i++)
       for(j = 0; j < 32; j++)
-        if(IS_SET_AR(bitv, (i*32)+j))
+        if(IS_SET_AR(bitv, (i*32)+j)) {
           SET_BIT_AR(AFF_FLAGS(ch), (i*32)+j);
+          if ((i*32)+j < NUM_AFF_FLAGS)
+            ch->aff_sources[(i*32)+j]++;
+        }
   } else {
     for(i = 0; i < AF_ARRAY_MAX; i++)
       for(j = 0; j < 32; j++)
-        if(IS_SET_AR(bitv, (i*32)+j))
+        if(IS_SET_AR(bitv, (i*32)+j)) {
           REMOVE_BIT_AR(AFF_FLAGS(ch), (i*32)+j);
+          if ((i*32)+j < NUM_AFF_FLAGS && ch->aff_sources[(i*32)+j])
+            ch->aff_sources[(i*32)+j]--;
+        }
     mod = -mod;
   }
 
+  if (loc < NUM_APPLIES)
+    ch->applies[loc] += mod;
   aff_apply_modify(ch, loc, mod, "affect_modify_ar");
 }
 
-/* This updates a character by subtracting everything he is affected by
- * restoring original abilities, and then affecting all again. */
-void affect_total(struct char_data *ch)
+/* Adds up everything a character is affected by from scratch and compares it
+ * with the sums affect_modify_ar() has kept, fixing them if they are off.
+ * Only run with the debug mode set to complete. */
+static void check_applies(struct char_data *ch)
 {
   struct affected_type *af;
-  int i, j;
+  struct obj_data *obj;
+  int applies[NUM_APPLIES], sources[NUM_AFF_FLAGS], i, j;
+
+  for (i = 0; i < NUM_APPLIES; i++)
+    applies[i] = 0;
+  for (i = 0; i < NUM_AFF_FLAGS; i++)
+    sources[i] = 0;
 
   for (i = 0; i < NUM_WEARS; i++) {
-    if (GET_EQ(ch, i))
-      for (j = 0; j < MAX_OBJ_AFFECT; j++)
-	affect_modify_ar(ch, GET_EQ(ch, i)->affected[j].location,
-		      GET_EQ(ch, i)->affected[j].modifier,
-		      GET_OBJ_AFFECT(GET_EQ(ch, i)), FALSE);
+    if (!(obj = GET_EQ(ch, i)))
+      continue;
+    if (GET_OBJ_TYPE(obj) == ITEM_ARMOR)
+      applies[APPLY_AC] -= apply_ac(ch, i);
+    for (j = 0; j < MAX_OBJ_AFFECT; j++)
+      if (obj->affected[j].location < NUM_APPLIES)
+        applies[obj->affected[j].location] += obj->affected[j].modifier;
+    /* equip_char() gives the bitvector with each of the object's modifiers. */
+    for (j = 0; j < NUM_AFF_FLAGS; j++)
+      if (IS_SET_AR(GET_OBJ_AFFECT(obj), j))
+        sources[j] += MAX_OBJ_AFFECT;
   }
 
-  for (af = ch->affected; af; af = af->next)
-    affect_modify_ar(ch, af->location, af->modifier, af->bitvector, FALSE);
+  for (af = ch->affected; af; af = af->next) {
+    if (af->location < NUM_APPLIES)
+      applies[af->location] += af->modifier;
+    for (j = 0; j < NUM_AFF_FLAGS; j++)
+      if (IS_SET_AR(af->bitvector, j))
+        sources[j]++;
+  }
 
-  ch->aff_abils = ch->real_abils;
+  for (i = 0; i < NUM_APPLIES; i++)
+    if (applies[i] != ch->applies[i]) {
+      log("SYSERR: affect_total: %s has %d from apply %d, should be %d.",
+          GET_NAME(ch), ch->applies[i], i, applies[i]);
+      ch->applies[i] = applies[i];
+    }
+  for (i = 0; i < NUM_AFF_FLAGS; i++)
+    if (sources[i] != ch->aff_sources[i]) {
+      log("SYSERR: affect_total: %s has %d sources of affect %d, should be %d.",
+          GET_NAME(ch), ch->aff_sources[i], i, sources[i]);
+      ch->aff_sources[i] = sources[i];
+    }
+}
 
-  for (i = 0; i < NUM_WEARS; i++) {
-    if (GET_EQ(ch, i))
-      for (j = 0; j < MAX_OBJ_AFFECT; j++)
-	affect_modify_ar(ch, GET_EQ(ch, i)->affected[j].location,
-		      GET_EQ(ch, i)->affected[j].modifier,
-		      GET_OBJ_AFFECT(GET_EQ(ch, i)), TRUE);
-  }
+/* This updates the abilities of a character from the unmodified ones and
+ * the sums of everything he is affected by, which affect_modify_ar() keeps
+ * as equipment and affects come and go. The points the applies change were
+ * changed there already. It also puts back any affect bit that something
+ * he is still affected by gives, in case another source took it away. */
+void affect_total(struct char_data *ch)
+{
+  int i;
 
-  for (af = ch->affected; af; af = af->next)
-    affect_modify_ar(ch, af->location, af->modifier, af->bitvector, TRUE);
+  if (CONFIG_DEBUG_MODE >= CMP)
+    check_applies(ch);
+
+  for (i = 0; i < NUM_AFF_FLAGS; i++)
+    if (ch->aff_sources[i])
+      SET_BIT_AR(AFF_FLAGS(ch), i);
+
+  ch->aff_abils = ch->real_abils;
+  GET_STR(ch) += ch->applies[APPLY_STR];
+  GET_DEX(ch) += ch->applies[APPLY_DEX];
+  GET_INT(ch) += ch->applies[APPLY_INT];
+  GET_WIS(ch) += ch->applies[APPLY_WIS];
+  GET_CON(ch) += ch->applies[APPLY_CON];
+  GET_CHA(ch) += ch->applies[APPLY_CHA];
 
   /* Make certain values are between 0..25, not < 0 and not > 25! */
   i = (IS_NPC(ch) || GET_LEVEL(ch) >= LVL_GRGOD) ? 25 : 18;
@@ -276,18 +453,117 @@ void affect_total(struct char_data *ch)
   }
 }
 
+/* Put an affect of a character in the game into the wheel slot of the pass
+ * that takes its duration to nothing. Permanent affects are left out. */
+static void affect_schedule(struct char_data *ch, struct affected_type *af)
+{
+  struct affected_type **slot;
+
+  af->owner = NULL;
+  af->next_due = af->prev_due = NULL;
+  if (af->duration == -1)
+    return;
+
+  af->owner = ch;
+  af->expires = affect_hours + MAX(0, af->duration) + 1;
+  slot = &affect_wheel[af->expires % AFF_WHEEL_SLOTS];
+  af->next_due = *slot;
+  if (*slot)
+    (*slot)->prev_due = af;
+  *slot = af;
+}
+
+/* Take an affect back out of the wheel, leaving what is left of it in
+ * duration. */
+static void affect_unschedule(struct affected_type *af)
+{
+  if (!af->owner)
+    return;
+
+  af->duration = affect_duration(af);
+  if (af->prev_due)
+    af->prev_due->next_due = af->next_due;
+  else
+    affect_wheel[af->expires % AFF_WHEEL_SLOTS] = af->next_due;
+  if (af->next_due)
+    af->next_due->prev_due = af->prev_due;
+  af->owner = NULL;
+  af->next_due = af->prev_due = NULL;
+}
+
+/* Hours an affect has left, as affect_update() used to count them down: it
+ * wears off in the pass after this reaches 0. -1 is permanent. */
+int affect_duration(struct affected_type *af)
+{
+  if (!af->owner)
+    return (af->duration);
+
+  return (MAX(0, af->expires - affect_hours - 1));
+}
+
+/* Called from char_to_list() and char_from_list(), as a character joins or
+ * leaves the game. */
+static void affects_to_wheel(struct char_data *ch)
+{
+  struct affected_type *af;
+
+  for (af = ch->affected; af; af = af->next)
+    if (!af->owner)
+      affect_schedule(ch, af);
+}
+
+static void affects_from_wheel(struct char_data *ch)
+{
+  struct affected_type *af;
+
+  for (af = ch->affected; af; af = af->next)
+    affect_unschedule(af);
+}
+
+/* Start the next affect_update() pass. */
+void affect_wheel_turn(void)
+{
+  affect_hours++;
+}
+
+/* TRUE if an affect wears off in the affect_update() pass under way. */
+bool affect_expiring(struct affected_type *af)
+{
+  return (af->owner && af->expires <= affect_hours);
+}
+
+/* A character with an affect that wears off in this pass, or NULL once
+ * affect_update() has seen to them all. */
+struct char_data *affect_expiring_char(void)
+{
+  struct affected_type *af;
+
+  for (af = affect_wheel[affect_hours % AFF_WHEEL_SLOTS]; af; af = af->next_due)
+    if (af->expires <= affect_hours)
+      return (af->owner);
+
+  return (NULL);
+}
+
 /* Insert an affect_type in a char_data structure. Automatically sets
  * apropriate bits and apply's */
 void affect_to_char(struct char_data *ch, struct affected_type *af)
 {
   struct affected_type *affected_alloc;
 
-  CREATE(affected_alloc, struct affected_type, 1);
+  SLAB_CREATE(affected_alloc, struct affected_type, affect_slab);
 
   *affected_alloc = *af;
   affected_alloc->next = ch->affected;
   ch->affected = affected_alloc;
 
+  if (ch->prev || character_list == ch)
+    affect_schedule(ch, affected_alloc);
+  else {
+    affected_alloc->owner = NULL;
+    affected_alloc->next_due = affected_alloc->prev_due = NULL;
+  }
+
   affect_modify_ar(ch, af->location, af->modifier, af->bitvector, TRUE);
   affect_total(ch);
 }
@@ -306,7 +582,8 @@ void affect_remove(struct char_data *ch, struct affected_type *af)
 
   affect_modify_ar(ch, af->location, af->modifier, af->bitvector, FALSE);
   REMOVE_FROM_LIST(af, ch->affected, next);
-  free(af);
+  affect_unschedule(af);
+  slab_free(&affect_slab, af);
   affect_total(ch);
 }
 
@@ -346,9 +623,9 @@ void affect_join(struct char_data *ch, struct affected_type *af,
 
     if ((hjp->spell == af->spell) && (hjp->location == af->location)) {
       if (add_dur)
-	af->duration += hjp->duration;
+	af->duration += affect_duration(hjp);
       else if (avg_dur)
-        af->duration = (af->duration+hjp->duration)/2;
+        af->duration = (af->duration+affect_duration(hjp))/2;
       if (add_mod)
 	af->modifier += hjp->modifier;
       else if (avg_mod)
@@ -383,6 +660,11 @@ void char_from_room(struct char_data *ch)
       if (GET_OBJ_VAL(GET_EQ(ch, WEAR_LIGHT), 2))	/* Light is ON */
 	world[IN_ROOM(ch)].light--;
 
+  if (SCRIPT(ch))
+    world[IN_ROOM(ch)].listeners_valid = FALSE;
+
+  zone_presence_from(ch);
+
   REMOVE_FROM_LIST(ch, world[IN_ROOM(ch)].people, next_in_room);
   IN_ROOM(ch) = NOWHERE;
   ch->next_in_room = NULL;
@@ -398,6 +680,10 @@ void char_to_room(struct char_data *ch, room_rnum room)
     ch->next_in_room = world[room].people;
     world[room].people = ch;
     IN_ROOM(ch) = room;
+    zone_presence_to(ch);
+
+    if (SCRIPT(ch))
+      world[room].mob_listeners |= SCRIPT_TYPES(SCRIPT(ch));
 
     autoquest_trigger_check(ch, 0, 0, AQ_ROOM_FIND);
     autoquest_trigger_check(ch, 0, 0, AQ_MOB_FIND);
@@ -501,7 +787,7 @@ int invalid_align(struct char_data *ch, struct obj_data *obj)
 
 void equip_char(struct char_data *ch, struct obj_data *obj, int pos)
 {
-  int j;
+  int j, ac;
 
   if (pos < 0 || pos >= NUM_WEARS) {
     core_dump();
@@ -533,8 +819,11 @@ void equip_char(struct char_data *ch, struct obj_data *obj, int pos)
   obj->worn_by = ch;
   obj->worn_on = pos;
 
-  if (GET_OBJ_TYPE(obj) == ITEM_ARMOR)
-    GET_AC(ch) -= apply_ac(ch, pos);
+  if (GET_OBJ_TYPE(obj) == ITEM_ARMOR) {
+    ac = apply_ac(ch, pos);
+    GET_AC(ch) -= ac;
+    ch->applies[APPLY_AC] -= ac;
+  }
 
   if (IN_ROOM(ch) != NOWHERE) {
     if (pos == WEAR_LIGHT && GET_OBJ_TYPE(obj) == ITEM_LIGHT)
@@ -553,7 +842,7 @@ void equip_char(struct char_data *ch, struct obj_data *obj, int pos)
 
 struct obj_data *unequip_char(struct char_data *ch, int pos)
 {
-  int j;
+  int j, ac;
   struct obj_data *obj;
 
   if ((pos < 0 || pos >= NUM_WEARS) || GET_EQ(ch, pos) == NULL) {
@@ -565,8 +854,11 @@ struct obj_data *unequip_char(struct char_data *ch, int pos)
   obj->worn_by = NULL;
   obj->worn_on = -1;
 
-  if (GET_OBJ_TYPE(obj) == ITEM_ARMOR)
-    GET_AC(ch) += apply_ac(ch, pos);
+  if (GET_OBJ_TYPE(obj) == ITEM_ARMOR) {
+    ac = apply_ac(ch, pos);
+    GET_AC(ch) += ac;
+    ch->applies[APPLY_AC] += ac;
+  }
 
   if (IN_ROOM(ch) != NOWHERE) {
     if (pos == WEAR_LIGHT && GET_OBJ_TYPE(obj) == ITEM_LIGHT)
@@ -624,11 +916,188 @@ struct obj_data *get_obj_in_list_num(int num, struct obj_data *list)
 /* search the entire world for an object number, and return a pointer  */
 struct obj_data *get_obj_num(obj_rnum nr)
 {
-  struct obj_data *i;
+  if (nr == NOTHING || nr > top_of_objt)
+    return (NULL);
 
-  for (i = object_list; i; i = i->next)
-    if (GET_OBJ_RNUM(i) == nr)
-      return (i);
+  return (obj_index[nr].objs);
+}
+
+/* Every object read from a prototype is on the list of its obj_index entry
+ * as well as on object_list, so the instances of one prototype can be found
+ * without walking every object in the game. The list is kept newest first by
+ * id, as nameindex.c expects; a new object goes straight to the head, and
+ * only an old one that otransform moves to another prototype walks it. */
+void obj_to_instances(struct obj_data *obj)
+{
+  obj_rnum nr = GET_OBJ_RNUM(obj);
+  struct obj_data *prev = NULL, *next;
+
+  for (next = obj_index[nr].objs; next && GET_ID(next) > GET_ID(obj); next = next->next_instance)
+    prev = next;
+
+  obj->prev_instance = prev;
+  obj->next_instance = next;
+  if (next)
+    next->prev_instance = obj;
+  if (prev)
+    prev->next_instance = obj;
+  else
+    obj_index[nr].objs = obj;
+}
+
+/* Takes an object off its prototype's list; objects that never were on one,
+ * like the mail from the post office, are left alone. */
+void obj_from_instances(struct obj_data *obj)
+{
+  obj_rnum nr = GET_OBJ_RNUM(obj);
+
+  if (obj->prev_instance)
+    obj->prev_instance->next_instance = obj->next_instance;
+  else if (nr != NOTHING && nr <= top_of_objt && obj_index[nr].objs == obj)
+    obj_index[nr].objs = obj->next_instance;
+  else
+    return;
+
+  if (obj->next_instance)
+    obj->next_instance->prev_instance = obj->prev_instance;
+  obj->next_instance = obj->prev_instance = NULL;
+}
+
+/* character_list and object_list are doubly linked, so that extracting
+ * something does not have to walk the list for whatever comes before it. New
+ * characters and objects go at the head, as they always have. */
+void char_to_list(struct char_data *ch)
+{
+  ch->prev = NULL;
+  ch->next = character_list;
+  if (character_list)
+    character_list->prev = ch;
+  character_list = ch;
+  affects_to_wheel(ch);
+}
+
+/* Characters that never joined character_list, like players loaded from file
+ * for a look at them, are left alone. */
+void char_from_list(struct char_data *ch)
+{
+  if (ch->prev)
+    ch->prev->next = ch->next;
+  else if (character_list == ch)
+    character_list = ch->next;
+  else
+    return;
+
+  if (ch->next)
+    ch->next->prev = ch->prev;
+  ch->next = ch->prev = NULL;
+  affects_from_wheel(ch);
+}
+
+void obj_to_list(struct obj_data *obj)
+{
+  obj->prev = NULL;
+  obj->next = object_list;
+  if (object_list)
+    object_list->prev = obj;
+  object_list = obj;
+  obj_timer_schedule(obj);
+}
+
+void obj_from_list(struct obj_data *obj)
+{
+  if (obj->prev)
+    obj->prev->next = obj->next;
+  else if (object_list == obj)
+    object_list = obj->next;
+  else
+    return;
+
+  if (obj->next)
+    obj->next->prev = obj->prev;
+  obj->next = obj->prev = NULL;
+  obj_timer_unschedule(obj);
+}
+
+/* Put an object on object_list into the wheel slot of the pass its timer
+ * runs out in. A timer counts down to 0 and then fires timer_otrigger(); a
+ * corpse decays in the pass its timer is 0 in, even if it was set to 0. */
+static void obj_timer_schedule(struct obj_data *obj)
+{
+  struct obj_data **slot;
+
+  obj->timer_expires = 0;
+  obj->next_due = obj->prev_due = NULL;
+  if (!obj->prev && object_list != obj)
+    return;
+
+  if (GET_OBJ_TIMER(obj) > 0)
+    obj->timer_expires = obj_hours + GET_OBJ_TIMER(obj);
+  else if (GET_OBJ_TIMER(obj) == 0 && IS_CORPSE(obj))
+    obj->timer_expires = obj_hours + 1;
+  else
+    return;
+
+  slot = &obj_wheel[obj->timer_expires % OBJ_WHEEL_SLOTS];
+  obj->next_due = *slot;
+  if (*slot)
+    (*slot)->prev_due = obj;
+  *slot = obj;
+}
+
+/* Take an object back out of the wheel, leaving what is left of its timer
+ * in the timer. Do this before copying over an object in the game, which
+ * set_obj_timer(obj, 0) does not do for a corpse. */
+void obj_timer_unschedule(struct obj_data *obj)
+{
+  if (!obj->timer_expires)
+    return;
+
+  GET_OBJ_TIMER(obj) = obj_timer(obj);
+  if (obj->prev_due)
+    obj->prev_due->next_due = obj->next_due;
+  else
+    obj_wheel[obj->timer_expires % OBJ_WHEEL_SLOTS] = obj->next_due;
+  if (obj->next_due)
+    obj->next_due->prev_due = obj->prev_due;
+  obj->timer_expires = 0;
+  obj->next_due = obj->prev_due = NULL;
+}
+
+/* Hours left on an object's timer, as point_update() used to count it down. */
+int obj_timer(struct obj_data *obj)
+{
+  if (!obj->timer_expires || GET_OBJ_TIMER(obj) <= 0)
+    return (GET_OBJ_TIMER(obj));
+
+  return (MAX(0, obj->timer_expires - obj_hours));
+}
+
+/* Set the timer of an object, in the game or not. Use this rather than
+ * GET_OBJ_TIMER() for anything but prototypes. */
+void set_obj_timer(struct obj_data *obj, int timer)
+{
+  obj_timer_unschedule(obj);
+  GET_OBJ_TIMER(obj) = timer;
+  obj_timer_schedule(obj);
+}
+
+/* Start the timer half of the next point_update() pass. */
+void obj_timer_turn(void)
+{
+  obj_hours++;
+}
+
+/* An object whose timer runs out in this pass, taken out of the wheel with
+ * its timer at 0, or NULL once point_update() has seen to them all. */
+struct obj_data *obj_timer_expired(void)
+{
+  struct obj_data *obj;
+
+  for (obj = obj_wheel[obj_hours % OBJ_WHEEL_SLOTS]; obj; obj = obj->next_due)
+    if (obj->timer_expires <= obj_hours) {
+      obj_timer_unschedule(obj);
+      return (obj);
+    }
 
   return (NULL);
 }
@@ -648,7 +1117,7 @@ struct char_data *get_char_room(char *name, int *number, room_rnum room)
     return (NULL);
 
   for (i = world[room].people; i && *number; i = i->next_in_room)
-    if (isname(name, i->player.name))
+    if (char_isname(name, i))
       if (--(*number) == 0)
 	return (i);
 
@@ -658,13 +1127,92 @@ struct char_data *get_char_room(char *name, int *number, room_rnum room)
 /* search all over the world for a char num, and return a pointer if found */
 struct char_data *get_char_num(mob_rnum nr)
 {
-  struct char_data *i;
+  if (nr == NOBODY || nr > top_of_mobt)
+    return (NULL);
 
-  for (i = character_list; i; i = i->next)
-    if (GET_MOB_RNUM(i) == nr)
-      return (i);
+  return (mob_index[nr].mobs);
+}
 
-  return (NULL);
+/* Mobs are kept on their mob_index entry's list the same way as objects,
+ * newest first by list_stamp. */
+void char_to_instances(struct char_data *ch)
+{
+  mob_rnum nr = GET_MOB_RNUM(ch);
+  struct char_data *prev = NULL, *next;
+
+  for (next = mob_index[nr].mobs; next && next->list_stamp > ch->list_stamp; next = next->next_instance)
+    prev = next;
+
+  ch->prev_instance = prev;
+  ch->next_instance = next;
+  if (next)
+    next->prev_instance = ch;
+  if (prev)
+    prev->next_instance = ch;
+  else
+    mob_index[nr].mobs = ch;
+}
+
+void char_from_instances(struct char_data *ch)
+{
+  mob_rnum nr = GET_MOB_RNUM(ch);
+
+  if (ch->prev_instance)
+    ch->prev_instance->next_instance = ch->next_instance;
+  else if (nr != NOBODY && nr <= top_of_mobt && mob_index[nr].mobs == ch)
+    mob_index[nr].mobs = ch->next_instance;
+  else
+    return;
+
+  if (ch->next_instance)
+    ch->next_instance->prev_instance = ch->prev_instance;
+  ch->next_instance = ch->prev_instance = NULL;
+}
+
+/* Each zone counts the players in it that mobs and scripts react to: those
+ * without nohassle. char_to_room() and char_from_room() keep the count, and
+ * anything that changes PRF_NOHASSLE on a character in the world calls
+ * zone_presence_from() before and zone_presence_to() after. */
+static int zone_present(struct char_data *ch)
+{
+  return !IS_NPC(ch) && !PRF_FLAGGED(ch, PRF_NOHASSLE);
+}
+
+void zone_presence_from(struct char_data *ch)
+{
+  if (IN_ROOM(ch) != NOWHERE && zone_present(ch))
+    zone_table[world[IN_ROOM(ch)].zone].players--;
+}
+
+void zone_presence_to(struct char_data *ch)
+{
+  if (IN_ROOM(ch) != NOWHERE && zone_present(ch))
+    zone_table[world[IN_ROOM(ch)].zone].players++;
+}
+
+/* Counts the players of each zone from scratch and compares them with the
+ * counts kept above, fixing any that are off. Only run with the debug mode
+ * set, by zone_update(). */
+void check_zone_presence(void)
+{
+  struct char_data *ch;
+  int *players;
+  zone_rnum zone;
+
+  CREATE(players, int, top_of_zone_table + 1);
+
+  for (ch = character_list; ch; ch = ch->next)
+    if (IN_ROOM(ch) != NOWHERE && zone_present(ch))
+      players[world[IN_ROOM(ch)].zone]++;
+
+  for (zone = 0; zone <= top_of_zone_table; zone++)
+    if (players[zone] != zone_table[zone].players) {
+      log("SYSERR: zone_update: Zone %d counts %d players, should be %d.",
+          zone_table[zone].number, zone_table[zone].players, players[zone]);
+      zone_table[zone].players = players[zone];
+    }
+
+  free(players);
 }
 
 /* put an object in a room */
@@ -678,6 +1226,8 @@ void obj_to_room(struct obj_data *object, room_rnum room)
     world[room].contents = object;
     IN_ROOM(object) = room;
     object->carried_by = NULL;
+    if (SCRIPT(object))
+      world[room].obj_listeners |= SCRIPT_TYPES(SCRIPT(object));
     if (ROOM_FLAGGED(room, ROOM_HOUSE))
       SET_BIT_AR(ROOM_FLAGS(room), ROOM_HOUSE_CRASH);
   }
@@ -704,6 +1254,9 @@ void obj_from_room(struct obj_data *object)
     }
   }
 
+  if (SCRIPT(object))
+    world[IN_ROOM(object)].listeners_valid = FALSE;
+
   REMOVE_FROM_LIST(object, world[IN_ROOM(object)].contents, next_content);
 
   if (ROOM_FLAGGED(IN_ROOM(object), ROOM_HOUSE))
@@ -781,7 +1334,6 @@ void object_list_new_owner(struct obj_data *list, struct char_data *ch)
 void extract_obj(struct obj_data *obj)
 {
   struct char_data *ch, *next = NULL;
-  struct obj_data *temp;
 
   if (obj->worn_by != NULL)
     if (unequip_char(obj->worn_by, obj->worn_on) != obj)
@@ -808,7 +1360,9 @@ void extract_obj(struct obj_data *obj)
   while (obj->contains)
     extract_obj(obj->contains);
 
-  REMOVE_FROM_LIST(obj, object_list, next);
+  obj_from_list(obj);
+  obj_from_instances(obj);
+  obj_from_unshared(obj);
 
   if (GET_OBJ_RNUM(obj) != NOTHING)
     (obj_index[GET_OBJ_RNUM(obj)].number)--;
@@ -836,8 +1390,8 @@ void extract_obj(struct obj_data *obj)
 static void update_object(struct obj_data *obj, int use)
 {
   /* dont update objects with a timer trigger */
-  if (!SCRIPT_CHECK(obj, OTRIG_TIMER) && (GET_OBJ_TIMER(obj) > 0))
-    GET_OBJ_TIMER(obj) -= use;
+  if (!SCRIPT_CHECK(obj, OTRIG_TIMER) && (obj_timer(obj) > 0))
+    set_obj_timer(obj, obj_timer(obj) - use);
   if (obj->contains)
     update_object(obj->contains, use);
   if (obj->next_content)
@@ -948,23 +1502,28 @@ void extract_char_final(struct char_data *ch)
       stop_fighting(k);
   }
   
-  /* Whipe character from the memory of hunters and other intelligent NPCs... */
-  for (temp = character_list; temp; temp = temp->next) {
-    /* PCs can't use MEMORY, and don't use HUNTING() */
-    if (!IS_NPC(temp))
-      continue;
-    /* If "temp" is hunting our extracted char, stop the hunt. */
-    if (HUNTING(temp) == ch)
-      HUNTING(temp) = NULL;
-    /* If "temp" has allocated memory data and our ch is a PC, forget the 
-     * extracted character (if he/she is remembered) */  
-    if (!IS_NPC(ch) && GET_POS(ch) == POS_DEAD && MEMORY(temp))
-      forget(temp, ch); /* forget() is safe to use without a check. */
-  }
+  /* Whipe character from the memory of hunters and other intelligent NPCs...
+   * Only players are remembered, and only those ever hunted can be hunted. */
+  if (!IS_NPC(ch) || ch->char_specials.hunted)
+    for (temp = character_list; temp; temp = temp->next) {
+      /* PCs can't use MEMORY, and don't use HUNTING() */
+      if (!IS_NPC(temp))
+        continue;
+      /* If "temp" is hunting our extracted char, stop the hunt. */
+      if (HUNTING(temp) == ch)
+        HUNTING(temp) = NULL;
+      /* If "temp" has allocated memory data and our ch is a PC, forget the 
+       * extracted character (if he/she is remembered) */  
+      if (!IS_NPC(ch) && GET_POS(ch) == POS_DEAD && MEMORY(temp))
+        forget(temp, ch); /* forget() is safe to use without a check. */
+    }
 
   char_from_room(ch);
+  char_from_list(ch);
+  char_from_unshared(ch);
 
   if (IS_NPC(ch)) {
+    char_from_instances(ch);
     if (GET_MOB_RNUM(ch) != NOTHING)	/* prototyped */
       mob_index[GET_MOB_RNUM(ch)].number--;
     clearMemory(ch);
@@ -992,6 +1551,17 @@ void extract_char_final(struct char_data *ch)
  * really confused otherwise. */
 void extract_char(struct char_data *ch)
 {
+  /* Already queued. The flag says so for any place in the queue, the tail
+   * included, whose next_extract is NULL like that of a character not in it. */
+  if (IS_NPC(ch) ? MOB_FLAGGED(ch, MOB_NOTDEADYET) : PLR_FLAGGED(ch, PLR_NOTDEADYET))
+    return;
+
+  /* Prototypes and characters never placed are not in the game to leave it. */
+  if (IN_ROOM(ch) == NOWHERE) {
+    log("SYSERR: extract_char: %s is not in the game.", GET_NAME(ch) ? GET_NAME(ch) : "<unnamed>");
+    return;
+  }
+
   char_from_furniture(ch);
   clear_char_event_list(ch);
 
@@ -1000,46 +1570,27 @@ void extract_char(struct char_data *ch)
   else
     SET_BIT_AR(PLR_FLAGS(ch), PLR_NOTDEADYET);
 
-  extractions_pending++;
+  ch->next_extract = extract_queue;
+  extract_queue = ch;
 }
 
-/* I'm not particularly pleased with the MOB/PLR hoops that have to be jumped
- * through but it hardly calls for a completely new variable. Ideally it would
- * be its own list, but that would change the '->next' pointer, potentially
- * confusing some code. -gg This doesn't handle recursive extractions. */
+/* Extracts everything queued by extract_char() since the last pulse, along
+ * with anything their extraction queues in turn. */
 void extract_pending_chars(void)
 {
-  struct char_data *vict, *next_vict, *prev_vict;
+  struct char_data *vict;
 
-  if (extractions_pending < 0)
-    log("SYSERR: Negative (%d) extractions pending.", extractions_pending);
-
-  for (vict = character_list, prev_vict = NULL; vict && extractions_pending; vict = next_vict) {
-    next_vict = vict->next;
+  while ((vict = extract_queue) != NULL) {
+    extract_queue = vict->next_extract;
+    vict->next_extract = NULL;
 
     if (MOB_FLAGGED(vict, MOB_NOTDEADYET))
       REMOVE_BIT_AR(MOB_FLAGS(vict), MOB_NOTDEADYET);
     else if (PLR_FLAGGED(vict, PLR_NOTDEADYET))
       REMOVE_BIT_AR(PLR_FLAGS(vict), PLR_NOTDEADYET);
-    else {
-      /* Last non-free'd character to continue chain from. */
-      prev_vict = vict;
-      continue;
-    }
 
     extract_char_final(vict);
-    extractions_pending--;
-
-    if (prev_vict)
-      prev_vict->next = next_vict;
-    else
-      character_list = next_vict;
   }
-
-  if (extractions_pending > 0)
-    log("SYSERR: Couldn't find %d extractions as counted.", extractions_pending);
-
-  extractions_pending = 0;
 }
 
 /* Here follows high-level versions of some earlier routines, ie functions
@@ -1054,7 +1605,8 @@ struct char_data *get_player_vis(struct char_data *ch, char *name, int *number,
     num = get_number(&name);
   }
 
-  for (i = character_list; i; i = i->next) {
+  /* Players are all on the unshared list, in character_list order. */
+  for (i = unshared_chars; i; i = i->next_unshared) {
     if (IS_NPC(i))
       continue;
     if (inroom == FIND_CHAR_ROOM && IN_ROOM(i) != IN_ROOM(ch))
@@ -1090,7 +1642,7 @@ struct char_data *get_char_room_vis(struct char_data *ch, char *name, int *numbe
     return (get_player_vis(ch, name, NULL, FIND_CHAR_ROOM));
 
   for (i = world[IN_ROOM(ch)].people; i && *number; i = i->next_in_room)
-    if (isname(name, i->player.name))
+    if (char_isname(name, i))
       if (CAN_SEE(ch, i))
 	if (--(*number) == 0)
 	  return (i);
@@ -1100,8 +1652,8 @@ struct char_data *get_char_room_vis(struct char_data *ch, char *name, int *numbe
 
 struct char_data *get_char_world_vis(struct char_data *ch, char *name, int *number)
 {
-  struct char_data *i;
-  int num;
+  struct char_data *i, **found;
+  int num, n, k;
 
   if (!number) {
     number = &num;
@@ -1114,10 +1666,12 @@ struct char_data *get_char_world_vis(struct char_data *ch, char *name, int *numb
   if (*number == 0)
     return get_player_vis(ch, name, NULL, 0);
 
-  for (i = character_list; i && *number; i = i->next) {
+  n = chars_by_name(name, &found);
+  for (k = 0; k < n && *number; k++) {
+    i = found[k];
     if (IN_ROOM(ch) == IN_ROOM(i))
       continue;
-    if (!isname(name, i->player.name))
+    if (!char_isname(name, i))
       continue;
     if (!CAN_SEE(ch, i))
       continue;
@@ -1153,7 +1707,7 @@ struct obj_data *get_obj_in_list_vis(struct char_data *ch, char *name, int *numb
     return (NULL);
 
   for (i = list; i && *number; i = i->next_content)
-    if (isname(name, i->name))
+    if (obj_isname(name, i))
       if (CAN_SEE_OBJ(ch, i))
 	if (--(*number) == 0)
 	  return (i);
@@ -1164,8 +1718,8 @@ struct obj_data *get_obj_in_list_vis(struct char_data *ch, char *name, int *numb
 /* search the entire world for an object, and return a pointer  */
 struct obj_data *get_obj_vis(struct char_data *ch, char *name, int *number)
 {
-  struct obj_data *i;
-  int num;
+  struct obj_data *i, **found;
+  int num, n, k;
 
   if (!number) {
     number = &num;
@@ -1184,11 +1738,12 @@ struct obj_data *get_obj_vis(struct char_data *ch, char *name, int *number)
     return (i);
 
   /* ok.. no luck yet. scan the entire obj list   */
-  for (i = object_list; i && *number; i = i->next)
-    if (isname(name, i->name))
-      if (CAN_SEE_OBJ(ch, i))
+  n = objs_by_name(name, &found);
+  for (k = 0; k < n && *number; k++)
+    if (obj_isname(name, found[k]))
+      if (CAN_SEE_OBJ(ch, found[k]))
 	if (--(*number) == 0)
-	  return (i);
+	  return (found[k]);
 
   return (NULL);
 }
@@ -1206,7 +1761,7 @@ struct obj_data *get_obj_in_equip_vis(struct char_data *ch, char *arg, int *numb
     return (NULL);
 
   for (j = 0; j < NUM_WEARS; j++)
-    if (equipment[j] && CAN_SEE_OBJ(ch, equipment[j]) && isname(arg, equipment[j]->name))
+    if (equipment[j] && CAN_SEE_OBJ(ch, equipment[j]) && obj_isname(arg, equipment[j]))
       if (--(*number) == 0)
         return (equipment[j]);
 
@@ -1226,7 +1781,7 @@ int get_obj_pos_in_equip_vis(struct char_data *ch, char *arg, int *number, struc
     return (-1);
 
   for (j = 0; j < NUM_WEARS; j++)
-    if (equipment[j] && CAN_SEE_OBJ(ch, equipment[j]) && isname(arg, equipment[j]->name))
+    if (equipment[j] && CAN_SEE_OBJ(ch, equipment[j]) && obj_isname(arg, equipment[j]))
       if (--(*number) == 0)
         return (j);
 
@@ -1366,7 +1921,7 @@ int generic_find(char *arg, bitvector_t bitvector, struct char_data *ch,
 
   if (IS_SET(bitvector, FIND_OBJ_EQUIP)) {
     for (found = FALSE, i = 0; i < NUM_WEARS && !found; i++)
-      if (GET_EQ(ch, i) && isname(name, GET_EQ(ch, i)->name) && --number == 0) {
+      if (GET_EQ(ch, i) && obj_isname(name, GET_EQ(ch, i)) && --number == 0) {
 	*tar_obj = GET_EQ(ch, i);
 	found = TRUE;
       }
@@ -20,11 +20,18 @@ void	affect_from_char(struct char_data *ch, int type);
 bool	affected_by_spell(struct char_data *ch, int type);
 void	affect_join(struct char_data *ch, struct affected_type *af,
 bool add_dur, bool avg_dur, bool add_mod, bool avg_mod);
+int	affect_duration(struct affected_type *af);
+void	affect_wheel_turn(void);
+bool	affect_expiring(struct affected_type *af);
+struct char_data *affect_expiring_char(void);
 
 /* utility */
 const char *money_desc(int amount);
 struct obj_data *create_money(int amount);
 int	isname(const char *str, const char *namelist);
+int	char_isname(const char *str, struct char_data *ch);
+int	obj_isname(const char *str, struct obj_data *obj);
+struct keyword_set *build_keyword_set(const char *namelist);
 int	is_name(const char *str, const char *namelist);
 char	*fname(const char *namelist);
 int	get_number(char **name);
@@ -50,6 +57,13 @@ void update_char_objects(struct char_data *ch);
 /* characters*/
 struct char_data *get_char_room(char *name, int *num, room_rnum room);
 struct char_data *get_char_num(mob_rnum nr);
+void char_to_list(struct char_data *ch);
+void char_from_list(struct char_data *ch);
+void char_to_instances(struct char_data *ch);
+void char_from_instances(struct char_data *ch);
+void zone_presence_from(struct char_data *ch);
+void zone_presence_to(struct char_data *ch);
+void check_zone_presence(void);
 
 void	char_from_room(struct char_data *ch);
 void	char_to_room(struct char_data *ch, room_rnum room);
@@ -65,6 +79,15 @@ struct char_data *get_char_world_vis(struct char_data *ch, char *name, int *numb
 
 struct obj_data *get_obj_in_list_num(int num, struct obj_data *list);
 struct obj_data *get_obj_num(obj_rnum nr);
+void obj_to_list(struct obj_data *obj);
+void obj_from_list(struct obj_data *obj);
+int obj_timer(struct obj_data *obj);
+void set_obj_timer(struct obj_data *obj, int timer);
+void obj_timer_unschedule(struct obj_data *obj);
+void obj_timer_turn(void);
+struct obj_data *obj_timer_expired(void);
+void obj_to_instances(struct obj_data *obj);
+void obj_from_instances(struct obj_data *obj);
 struct obj_data *get_obj_in_list_vis(struct char_data *ch, char *name, int *number, struct obj_data *list);
 struct obj_data *get_obj_vis(struct char_data *ch, char *name, int *num);
 struct obj_data *get_obj_in_equip_vis(struct char_data *ch, char *arg, int *number, struct obj_data *equipment[]);
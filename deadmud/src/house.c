@@ -19,6 +19,7 @@
 #include "house.h"
 #include "constants.h"
 #include "modify.h"
+#include "mapfile.h"
 
 /* local (file scope only) globals */
 static struct house_control_rec house_control[MAX_HOUSES];
@@ -55,7 +56,7 @@ static int House_get_filename(room_vnum vnum, char *filename, size_t maxlen)
 /* Load all objects for a house */
 static int House_load(room_vnum vnum)
 {
-  FILE *fl;
+  struct map_file *fl;
   char filename[MAX_STRING_LENGTH];
 	obj_save_data *loaded, *current;
   room_rnum rnum;
@@ -64,7 +65,7 @@ static int House_load(room_vnum vnum)
     return (0);
   if (!House_get_filename(vnum, filename, sizeof(filename)))
     return (0);
-  if (!(fl = fopen(filename, "r")))	/* no file found */
+  if (!(fl = mf_open(filename)))	/* no file found */
     return (0);
 
 	loaded = objsave_parse_objects(fl);
@@ -81,7 +82,7 @@ static int House_load(room_vnum vnum)
 		free(current);
 	}
 
-  fclose(fl);
+  mf_close(fl);
 
   return (1);
 }
@@ -162,7 +163,7 @@ static void House_delete_file(room_vnum vnum)
 /* List all objects in a house file */
 static void House_listrent(struct char_data *ch, room_vnum vnum)
 {
-  FILE *fl;
+  struct map_file *fl;
   char filename[MAX_STRING_LENGTH];
   char buf[MAX_STRING_LENGTH];
 	obj_save_data *loaded, *current;
@@ -170,7 +171,7 @@ static void House_listrent(struct char_data *ch, room_vnum vnum)
 
   if (!House_get_filename(vnum, filename, sizeof(filename)))
     return;
-  if (!(fl = fopen(filename, "rb"))) {
+  if (!(fl = mf_open(filename))) {
     send_to_char(ch, "No objects on file for house #%d.\r\n", vnum);
     return;
   }
@@ -194,7 +195,7 @@ static void House_listrent(struct char_data *ch, room_vnum vnum)
 	}
 
 	page_string(ch->desc,buf,0);
-  fclose(fl);
+  mf_close(fl);
 }
 
 /* Functions for house administration (creation, deletion, etc. */
@@ -747,7 +748,7 @@ static struct obj_data *Obj_from_store(struct obj_file_elem object, int *locatio
   for(taeller = 0; taeller < EF_ARRAY_MAX; taeller++)
     GET_OBJ_EXTRA(obj)[taeller] = object.extra_flags[taeller];
   GET_OBJ_WEIGHT(obj) = object.weight;
-  GET_OBJ_TIMER(obj) = object.timer;
+  set_obj_timer(obj, object.timer);
   for(taeller = 0; taeller < AF_ARRAY_MAX; taeller++)
     GET_OBJ_AFFECT(obj)[taeller] = object.bitvector[taeller];
 
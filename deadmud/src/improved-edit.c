@@ -3,6 +3,8 @@
 *  Usage: Routines specific to the improved editor.                       *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
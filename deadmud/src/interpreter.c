@@ -40,6 +40,8 @@
 #include "ibt.h"
 #include "mud_event.h"
 #include "race.h"
+#include "nameindex.h"
+#include "slab.h"
 
 /* local (file scope) functions */
 static int perform_dupe_check(struct descriptor_data *d);
@@ -210,6 +212,8 @@ cpp_extern const struct command_info cmd_info[] = {
   { "mail"     , "mail"    , POS_STANDING, do_not_here , 1, 0 },
   { "map"      , "map"     , POS_STANDING, do_map      , 1, 0 },
   { "medit"    , "med"     , POS_DEAD    , do_oasis_medit, LVL_BUILDER, 0 },
+  { "memory"   , "memory"  , POS_DEAD    , do_memory   , LVL_GRGOD, 0 },
+  { "memstats" , "memstats", POS_DEAD    , do_memory   , LVL_GRGOD, 0 },
   { "mlist"    , "mlist"   , POS_DEAD    , do_oasis_list, LVL_BUILDER, SCMD_OASIS_MLIST },
   { "mcopy"    , "mcopy"   , POS_DEAD    , do_oasis_copy, LVL_GOD, CON_MEDIT },
   { "msgedit"  , "msgedit" , POS_DEAD    , do_msgedit,   LVL_GOD, 0 },
@@ -1264,8 +1268,9 @@ int enter_player_game (struct descriptor_data *d)
   if (!SCRIPT(d->character))
     read_saved_vars(d->character);
 
-  d->character->next = character_list;
-  character_list = d->character;
+  char_to_list(d->character);
+  d->character->list_stamp = ++char_list_stamp;
+  char_to_unshared(d->character);
   char_to_room(d->character, load_room);
   load_result = Crash_load(d->character);
   
@@ -1359,7 +1364,7 @@ void nanny(struct descriptor_data *d, char *arg)
   break;
   case CON_GET_NAME:		/* wait for input of name */
     if (d->character == NULL) {
-      CREATE(d->character, struct char_data, 1);
+      SLAB_CREATE(d->character, struct char_data, char_slab);
       clear_char(d->character);
       CREATE(d->character->player_specials, struct player_special_data, 1);
       
@@ -1396,7 +1401,7 @@ void nanny(struct descriptor_data *d, char *arg)
             write_to_output(d, "Invalid name, please try another.\r\nName: ");
             return;
           }
-          CREATE(d->character, struct char_data, 1);
+          SLAB_CREATE(d->character, struct char_data, char_slab);
           clear_char(d->character);
           CREATE(d->character->player_specials, struct player_special_data, 1);
 
@@ -27,6 +27,9 @@
 static int graf(int grafage, int p0, int p1, int p2, int p3, int p4, int p5, int p6);
 static void check_idling(struct char_data *ch);
 
+/* Keeps the walks in show_tick_passes() from being optimized away. */
+static volatile long tick_sink;
+
 
 /* When age < 15 return the value p0
    When age is 15..29 calculate the line between p1 & p2
@@ -410,7 +413,7 @@ static void check_idling(struct char_data *ch)
 void point_update(void)
 {
   struct char_data *i, *next_char;
-  struct obj_data *j, *next_thing, *jj, *next_thing2;
+  struct obj_data *j, *jj, *next_thing2;
 
   /* characters */
   for (i = character_list; i; i = next_char) {
@@ -444,49 +447,38 @@ void point_update(void)
     }
   }
 
-  /* objects */
-  for (j = object_list; j; j = next_thing) {
-    next_thing = j->next;	/* Next in object list */
-
+  /* objects whose timers run out this hour; see the timer wheel in handler.c */
+  obj_timer_turn();
+  while ((j = obj_timer_expired()) != NULL) {
     /* If this is a corpse */
     if (IS_CORPSE(j)) {
-      /* timer count down */
-      if (GET_OBJ_TIMER(j) > 0)
-	GET_OBJ_TIMER(j)--;
-
-      if (!GET_OBJ_TIMER(j)) {
-
-	if (j->carried_by)
-	  act("$p decays in your hands.", FALSE, j->carried_by, j, 0, TO_CHAR);
-	else if ((IN_ROOM(j) != NOWHERE) && (world[IN_ROOM(j)].people)) {
-	  act("A quivering horde of maggots consumes $p.",
-	      TRUE, world[IN_ROOM(j)].people, j, 0, TO_ROOM);
-	  act("A quivering horde of maggots consumes $p.",
-	      TRUE, world[IN_ROOM(j)].people, j, 0, TO_CHAR);
-	}
-	for (jj = j->contains; jj; jj = next_thing2) {
-	  next_thing2 = jj->next_content;	/* Next in inventory */
-	  obj_from_obj(jj);
-
-	  if (j->in_obj)
-	    obj_to_obj(jj, j->in_obj);
-	  else if (j->carried_by)
-	    obj_to_room(jj, IN_ROOM(j->carried_by));
-	  else if (IN_ROOM(j) != NOWHERE)
-	    obj_to_room(jj, IN_ROOM(j));
-	  else
-	    core_dump();
-	}
-	extract_obj(j);
+      if (j->carried_by)
+	act("$p decays in your hands.", FALSE, j->carried_by, j, 0, TO_CHAR);
+      else if ((IN_ROOM(j) != NOWHERE) && (world[IN_ROOM(j)].people)) {
+	act("A quivering horde of maggots consumes $p.",
+	    TRUE, world[IN_ROOM(j)].people, j, 0, TO_ROOM);
+	act("A quivering horde of maggots consumes $p.",
+	    TRUE, world[IN_ROOM(j)].people, j, 0, TO_CHAR);
+      }
+      for (jj = j->contains; jj; jj = next_thing2) {
+	next_thing2 = jj->next_content;	/* Next in inventory */
+	obj_from_obj(jj);
+
+	if (j->in_obj)
+	  obj_to_obj(jj, j->in_obj);
+	else if (j->carried_by)
+	  obj_to_room(jj, IN_ROOM(j->carried_by));
+	else if (IN_ROOM(j) != NOWHERE)
+	  obj_to_room(jj, IN_ROOM(j));
+	else
+	  core_dump();
       }
+      extract_obj(j);
     }
-    /* If the timer is set, count it down and at 0, try the trigger
+    /* The timer reached 0, try the trigger
      * note to .rej hand-patchers: make this last in your point-update() */
-    else if (GET_OBJ_TIMER(j)>0) {
-      GET_OBJ_TIMER(j)--;
-      if (!GET_OBJ_TIMER(j))
-        timer_otrigger(j);
-    }
+    else
+      timer_otrigger(j);
   }
 
   /* Take 1 from the happy-hour tick counter, and end happy-hour if zero */
@@ -501,6 +493,59 @@ void point_update(void)
   }
 }
 
+/* Times walks over the characters that read what point_update(),
+ * mobile_activity() and perform_violence() read of every character before
+ * deciding to act on it, without acting on any. affect_update() only visits
+ * the characters with an affect due, so it has no walk to time. */
+void show_tick_passes(struct char_data *ch)
+{
+  static const char *passes[] = { "point_update", "mobile_activity", "perform_violence" };
+  struct char_data *i;
+  struct timeval start;
+  long usecs[3] = { 0, 0, 0 }, chars = 0, fighting = 0, sum = 0;
+  int round, pass;
+
+  for (i = character_list; i; i = i->next)
+    chars++;
+  for (i = combat_list; i; i = i->next_fighting)
+    fighting++;
+
+  for (round = 0; round < 20; round++) {
+    gettimeofday(&start, NULL);
+    for (i = character_list; i; i = i->next) {
+      if (GET_POS(i) >= POS_STUNNED)
+        sum += GET_MAX_HIT(i) - GET_HIT(i) + GET_MAX_MANA(i) - GET_MANA(i) +
+               GET_MAX_MOVE(i) - GET_MOVE(i) + AFF_FLAGGED(i, AFF_POISON);
+      if (!IS_NPC(i))
+        sum += GET_LEVEL(i);
+    }
+    usecs[0] += usecs_since(&start);
+
+    gettimeofday(&start, NULL);
+    for (i = character_list; i; i = i->next) {
+      if (!IS_MOB(i))
+        continue;
+      sum += MOB_FLAGGED(i, MOB_SPEC) + (FIGHTING(i) != NULL) + AWAKE(i) +
+             (HUNTING(i) != NULL) + MOB_FLAGGED(i, MOB_SENTINEL) +
+             (i->master != NULL) + AFF_FLAGGED(i, AFF_BLIND) + IN_ROOM(i);
+    }
+    usecs[1] += usecs_since(&start);
+
+    gettimeofday(&start, NULL);
+    for (i = combat_list; i; i = i->next_fighting)
+      if (FIGHTING(i) && IN_ROOM(i) == IN_ROOM(FIGHTING(i)))
+        sum += IS_NPC(i) ? GET_MOB_WAIT(i) : GET_POS(i);
+    usecs[2] += usecs_since(&start);
+  }
+  tick_sink = sum;
+
+  send_to_char(ch, "%ld characters, %ld fighting, 20 walks of each:\r\n", chars, fighting);
+  for (pass = 0; pass < 3; pass++)
+    send_to_char(ch, "  %-17s %8.1f us a walk, %6.1f ns a character\r\n", passes[pass],
+        usecs[pass] / 20.0, (pass == 2 ? fighting : chars) ?
+        usecs[pass] * 1000.0 / 20 / (pass == 2 ? fighting : chars) : 0.0);
+}
+
 /* Note: amt may be negative */
 int increase_gold(struct char_data *ch, int amt)
 {
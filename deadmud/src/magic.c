@@ -22,6 +22,8 @@
 #include "class.h"
 #include "fight.h"
 #include "mud_event.h"
+#include "nameindex.h"
+#include "strpool.h"
 
 
 /* local file scope function prototypes */
@@ -54,27 +56,27 @@ int mag_savingthrow(struct char_data *ch, int type, int modifier)
   return (FALSE);
 }
 
-/* affect_update: called from comm.c (causes spells to wear off) */
+/* affect_update: called from comm.c (causes spells to wear off). Only the
+ * characters with an affect due this hour are visited; see the affect wheel
+ * in handler.c. */
 void affect_update(void)
 {
   struct affected_type *af, *next;
   struct char_data *i;
 
-  for (i = character_list; i; i = i->next)
+  affect_wheel_turn();
+
+  while ((i = affect_expiring_char()) != NULL)
     for (af = i->affected; af; af = next) {
       next = af->next;
-      if (af->duration >= 1)
-	af->duration--;
-      else if (af->duration == -1)	/* No action */
-	;
-      else {
-	if ((af->spell > 0) && (af->spell <= MAX_SPELLS))
-	  if (!af->next || (af->next->spell != af->spell) ||
-	      (af->next->duration > 0))
-	    if (spell_info[af->spell].wear_off_msg)
-	      send_to_char(i, "%s\r\n", spell_info[af->spell].wear_off_msg);
-	affect_remove(i, af);
-      }
+      if (!affect_expiring(af))
+	continue;
+      if ((af->spell > 0) && (af->spell <= MAX_SPELLS))
+	if (!af->next || (af->next->spell != af->spell) ||
+	    (affect_duration(af->next) >= 0 && !affect_expiring(af->next)))
+	  if (spell_info[af->spell].wear_off_msg)
+	    send_to_char(i, "%s\r\n", spell_info[af->spell].wear_off_msg);
+      affect_remove(i, af);
     }
 }
 
@@ -764,9 +766,11 @@ void mag_summons(int level, struct char_data *ch, struct obj_data *obj,
     IS_CARRYING_N(mob) = 0;
     SET_BIT_AR(AFF_FLAGS(mob), AFF_CHARM);
     if (spellnum == SPELL_CLONE) {
-      /* Don't mess up the prototype; use new string copies. */
+      str_release(mob->player.name);
+      str_release(mob->player.short_descr);
       mob->player.name = strdup(GET_NAME(ch));
       mob->player.short_descr = strdup(GET_NAME(ch));
+      char_to_unshared(mob);
     }
     act(mag_summon_msgs[msg], FALSE, ch, 0, mob, TO_ROOM);
     load_mtrigger(mob);
@@ -19,6 +19,7 @@
 #include "handler.h"
 #include "mail.h"
 #include "modify.h"
+#include "mapfile.h"
 
 /* local (file scope) function prototypes */
 static void postmaster_send_mail(struct char_data *ch, struct char_data *mailman, int cmd, char *arg);
@@ -27,7 +28,7 @@ static void postmaster_receive_mail(struct char_data *ch, struct char_data *mail
 static int mail_recip_ok(const char *name);
 static void write_mail_record(FILE *mail_file, struct mail_t *record);
 static void free_mail_record(struct mail_t *record);
-static struct mail_t *read_mail_record(FILE *mail_file);
+static struct mail_t *read_mail_record(struct map_file *mail_file);
 
 static int mail_recip_ok(const char *name)
 {
@@ -47,14 +48,14 @@ static void free_mail_record(struct mail_t *record)
   free(record);
 }
 
-static struct mail_t *read_mail_record(FILE *mail_file)
+static struct mail_t *read_mail_record(struct map_file *mail_file)
 {
   char line[READ_SIZE];
   long sender, recipient;
   time_t sent_time;
   struct mail_t *record;
 
-  if (!get_line(mail_file, line))
+  if (!mf_get_line(mail_file, line))
   	return NULL;
 
   if (sscanf(line, "### %ld %ld %ld", &recipient, &sender, (long *)&sent_time) != 3) {
@@ -68,7 +69,7 @@ static struct mail_t *read_mail_record(FILE *mail_file)
   record->recipient = recipient;
   record->sender = sender;
   record->sent_time = sent_time;
-  record->body = fread_string(mail_file, "read mail record");
+  record->body = mf_fread_string(mail_file, "read mail record");
 
   return record;
 }
@@ -90,11 +91,11 @@ static void write_mail_record(FILE *mail_file, struct mail_t *record)
  * and indexes all entries currently in the mail file. */
 int scan_file(void)
 {
-  FILE *mail_file;
+  struct map_file *mail_file;
   int count = 0;
   struct mail_t *record;
 
-  if (!(mail_file = fopen(MAIL_FILE, "r"))) {
+  if (!(mail_file = mf_open(MAIL_FILE))) {
     log("   Mail file non-existant... creating new file.");
     touch(MAIL_FILE);
     return TRUE;
@@ -108,7 +109,7 @@ int scan_file(void)
     count++;
   }
 
-  fclose(mail_file);
+  mf_close(mail_file);
  	log("   Mail file read -- %d messages.", count);
  	return TRUE;
 }
@@ -120,10 +121,10 @@ int scan_file(void)
  * A simple little function which tells you if the player has mail or not. */
 int has_mail(long recipient)
 {
-  FILE *mail_file;
+  struct map_file *mail_file;
   struct mail_t *record;
 
-  if (!(mail_file = fopen(MAIL_FILE, "r"))) {
+  if (!(mail_file = mf_open(MAIL_FILE))) {
     perror("read_delete: Mail file not accessible.");
     return FALSE;
   }
@@ -133,13 +134,13 @@ int has_mail(long recipient)
   while (record) {
   	if (record->recipient == recipient) {
   		free_mail_record(record);
-  		fclose(mail_file);
+  		mf_close(mail_file);
   		return TRUE;
     }
     free_mail_record(record);
     record = read_mail_record(mail_file);
   }
-  fclose(mail_file);
+  mf_close(mail_file);
   return FALSE;
 }
 
@@ -180,18 +181,19 @@ void store_mail(long to, long from, char *message_pointer)
  * the file. Expects mail to exist. */
 char *read_delete(long recipient)
 {
-  FILE *mail_file, *new_file;
+  struct map_file *mail_file;
+  FILE *new_file;
   struct mail_t *record, *record_to_keep = NULL;
   char buf[MAX_STRING_LENGTH];
 
-  if (!(mail_file = fopen(MAIL_FILE, "r"))) {
+  if (!(mail_file = mf_open(MAIL_FILE))) {
     perror("read_delete: Mail file not accessible.");
     return strdup("Mail system malfunction - please report this");
   }
 
   if (!(new_file = fopen(MAIL_FILE_TMP, "w"))) {
     perror("read_delete: new Mail file not accessible.");
-    fclose(mail_file);
+    mf_close(mail_file);
     return strdup("Mail system malfunction - please report this");
   }
 
@@ -234,7 +236,7 @@ char *read_delete(long recipient)
 
     free_mail_record(record_to_keep);
   }
-  fclose(mail_file);
+  mf_close(mail_file);
   fclose(new_file);
 
   remove(MAIL_FILE);
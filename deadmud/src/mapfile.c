@@ -0,0 +1,251 @@
+/**************************************************************************
+*  File: mapfile.c                                         Part of tbaMUD *
+*  Usage: Reading world and player files from a memory map.               *
+*                                                                         *
+*  All rights reserved.  See license for complete information.            *
+**************************************************************************/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "db.h"
+#include "modify.h"
+#include "mapfile.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+/* The stdio readers copy every line at least twice: from the stream's buffer
+ * with fgets(), then into the caller's buffer, and fread_string() strcat()s
+ * its lines together before it strdup()s the result. Here the whole file is
+ * in memory, mapped or read in one go, and read in place: a line is copied
+ * once, into the caller's buffer, and a string is measured first and then
+ * copied once, into its own memory.
+ *
+ * The results are the same as those of the stdio functions, down to how they
+ * split lines too long for their buffers, and so are the errors: the same
+ * messages, and exit(1) where they exit. With stdio_reads set (-S) files are
+ * read through stdio after all, to compare the two. */
+
+int stdio_reads = 0;
+
+/* Mapping a file costs a few system calls and a page fault more than reading
+ * it, which only pays off once the copies saved outweigh them. Smaller files,
+ * like player and rent files, are read whole into memory with one read(). */
+#define MF_MAP_MIN (64 * 1024)
+
+/** Opens a file for reading.
+ * @retval struct map_file * The file, or NULL with errno set as fopen() would
+ * have it. */
+struct map_file *mf_open(const char *path)
+{
+  struct map_file *mf;
+  struct stat st;
+  void *map;
+  int fd;
+
+  CREATE(mf, struct map_file, 1);
+
+  if (!stdio_reads && (fd = open(path, O_RDONLY)) >= 0) {
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+      if (st.st_size == 0) {
+        close(fd);
+        mf->pos = mf->end = "";
+        return (mf);
+      }
+      if (st.st_size < MF_MAP_MIN) {
+        CREATE(mf->base, char, st.st_size);
+        if (read(fd, mf->base, st.st_size) == st.st_size) {
+          close(fd);
+          mf->len = st.st_size;
+          mf->pos = mf->base;
+          mf->end = mf->base + mf->len;
+          return (mf);
+        }
+        free(mf->base);
+        mf->base = NULL;
+      } else if ((map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) != MAP_FAILED) {
+        close(fd);
+        madvise(map, st.st_size, MADV_SEQUENTIAL);
+        mf->base = map;
+        mf->len = st.st_size;
+        mf->mapped = TRUE;
+        mf->pos = mf->base;
+        mf->end = mf->base + mf->len;
+        return (mf);
+      }
+    }
+    close(fd);
+  }
+
+  if (!(mf->fl = fopen(path, "r"))) {
+    free(mf);
+    return (NULL);
+  }
+  return (mf);
+}
+
+void mf_close(struct map_file *mf)
+{
+  if (mf->fl)
+    fclose(mf->fl);
+  else if (mf->mapped)
+    munmap(mf->base, mf->len);
+  else if (mf->base)
+    free(mf->base);
+  free(mf);
+}
+
+/* Takes the next piece of the file that fgets() with a buffer of size + 1
+ * would: up to and including a newline, but no more than size characters.
+ * Returns NULL at the end of the file. */
+static const char *next_piece(struct map_file *mf, size_t size, size_t *len)
+{
+  const char *start = mf->pos, *nl;
+  size_t avail = mf->end - mf->pos;
+
+  if (!avail)
+    return (NULL);
+  if (avail > size)
+    avail = size;
+  nl = memchr(start, '\n', avail);
+  *len = nl ? (size_t)(nl - start + 1) : avail;
+  mf->pos += *len;
+  return (start);
+}
+
+/** Same as get_line(). */
+int mf_get_line(struct map_file *mf, char *buf)
+{
+  const char *line;
+  size_t len;
+  int lines = 0;
+
+  if (mf->fl)
+    return get_line(mf->fl, buf);
+
+  do {
+    if (!(line = next_piece(mf, READ_SIZE - 1, &len)))
+      return (0);
+    lines++;
+  } while (*line == '*' || *line == '\n' || *line == '\r');
+
+  while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+    len--;
+
+  memcpy(buf, line, len);
+  buf[len] = '\0';
+  return (lines);
+}
+
+#define STRING_EOF      (-1)
+#define STRING_TOO_LONG (-2)
+
+/* Goes through the lines of a '~' terminated string. With str NULL it only
+ * measures the string, else it copies it there. Returns the length, or one of
+ * the errors above. */
+static long string_lines(struct map_file *mf, char *str)
+{
+  const char *line;
+  size_t len, text;
+  long length = 0;
+
+  for (;;) {
+    if (!(line = next_piece(mf, 511, &len)))
+      return (STRING_EOF);
+
+    for (text = len; text > 0 && (line[text - 1] == '\r' || line[text - 1] == '\n'); text--)
+      ;
+
+    /* If there is a '~', end the string; else put an "\r\n" over the '\n'. */
+    if (text > 0 && line[text - 1] == '~') {
+      if (length + (long)text - 1 >= MAX_STRING_LENGTH)
+        return (STRING_TOO_LONG);
+      if (str)
+        memcpy(str + length, line, text - 1);
+      return (length + text - 1);
+    }
+
+    if (length + (long)text + 2 >= MAX_STRING_LENGTH)
+      return (STRING_TOO_LONG);
+    if (str) {
+      memcpy(str + length, line, text);
+      str[length + text] = '\r';
+      str[length + text + 1] = '\n';
+    }
+    length += text + 2;
+  }
+}
+
+/** Same as fread_string(). */
+char *mf_fread_string(struct map_file *mf, const char *error)
+{
+  const char *start = mf->pos;
+  long length;
+  char *str;
+
+  if (mf->fl)
+    return fread_string(mf->fl, error);
+
+  if ((length = string_lines(mf, NULL)) == STRING_EOF) {
+    log("SYSERR: fread_string: format error at or near %s", error);
+    exit(1);
+  } else if (length == STRING_TOO_LONG) {
+    log("SYSERR: fread_string: string too large (db.c)");
+    log("%s", error);
+    exit(1);
+  }
+
+  if (length == 0)
+    return (NULL);
+
+  CREATE(str, char, length + 1);
+  mf->pos = start;
+  string_lines(mf, str);
+  parse_at(str);
+  return (str);
+}
+
+/** Returns the next character that is not a space. */
+char mf_fread_letter(struct map_file *mf)
+{
+  char c;
+
+  if (mf->fl) {
+    do {
+      c = getc(mf->fl);
+    } while (isspace(c));
+    return (c);
+  }
+
+  while (mf->pos < mf->end && isspace((unsigned char) *mf->pos))
+    mf->pos++;
+  return (mf->pos < mf->end ? *mf->pos++ : (char) EOF);
+}
+
+/** Puts back the character just read, as ungetc() does. */
+void mf_ungetc(char c, struct map_file *mf)
+{
+  if (mf->fl)
+    ungetc(c, mf->fl);
+  else if (mf->base && mf->pos > mf->base && mf->pos[-1] == c)
+    mf->pos--;
+}
+
+/** Same as count_hash_records(). */
+int mf_count_hash_records(struct map_file *mf)
+{
+  const char *line;
+  size_t len;
+  int count = 0;
+
+  if (mf->fl)
+    return count_hash_records(mf->fl);
+
+  while ((line = next_piece(mf, 127, &len)))
+    if (*line == '#')
+      count++;
+
+  return (count);
+}
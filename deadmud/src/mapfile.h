@@ -0,0 +1,34 @@
+/**
+* @file mapfile.h
+* Memory mapped reading of the world and player files, with the same results
+* and error handling as get_line(), fread_string() and friends on stdio.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*/
+#ifndef _MAPFILE_H_
+#define _MAPFILE_H_
+
+/** A file being read. It is held in memory where that works, mapped or read
+ * whole, and read through stdio otherwise or when stdio_reads is set. */
+struct map_file {
+  FILE *fl;               /**< The stdio stream, NULL when in memory. */
+  char *base;             /**< The file's text, not NUL terminated. */
+  size_t len;             /**< Its length. */
+  int mapped;             /**< TRUE if base is a mapping, else from malloc(). */
+  const char *pos;        /**< The next character to read. */
+  const char *end;        /**< One past the last one. */
+};
+
+extern int stdio_reads;
+
+struct map_file *mf_open(const char *path);
+void mf_close(struct map_file *mf);
+
+int mf_get_line(struct map_file *mf, char *buf);
+char *mf_fread_string(struct map_file *mf, const char *error);
+char mf_fread_letter(struct map_file *mf);
+void mf_ungetc(char c, struct map_file *mf);
+int mf_count_hash_records(struct map_file *mf);
+
+#endif /* _MAPFILE_H_ */
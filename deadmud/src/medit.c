@@ -5,6 +5,8 @@
 * Copyright 1996 Harvey Gilpin. 1997-2001 George Greer.                   *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -26,6 +28,7 @@
 #include "screen.h"
 #include "fight.h"
 #include "modify.h"      /* for smash_tilde */
+#include "strpool.h"
 
 /* local functions */
 static void medit_setup_new(struct descriptor_data *d);
@@ -263,10 +266,7 @@ void medit_save_internally(struct descriptor_data *d)
   mob_proto[new_rnum].proto_script = OLC_SCRIPT(d);
 
   /* this takes care of the mobs currently in-game */
-  for (mob = character_list; mob; mob = mob->next) {
-    if (GET_MOB_RNUM(mob) != new_rnum)
-      continue;
-
+  for (mob = mob_index[new_rnum].mobs; mob; mob = mob->next_instance) {
     /* remove any old scripts */
     if (SCRIPT(mob))
       extract_script(mob, MOB_TRIGGER);
@@ -846,21 +846,21 @@ void medit_parse(struct descriptor_data *d, char *arg)
   case MEDIT_KEYWORD:
     smash_tilde(arg);
     if (GET_ALIAS(OLC_MOB(d)))
-      free(GET_ALIAS(OLC_MOB(d)));
+      str_release(GET_ALIAS(OLC_MOB(d)));
     GET_ALIAS(OLC_MOB(d)) = str_udup(arg);
     break;
 
   case MEDIT_S_DESC:
     smash_tilde(arg);
     if (GET_SDESC(OLC_MOB(d)))
-      free(GET_SDESC(OLC_MOB(d)));
+      str_release(GET_SDESC(OLC_MOB(d)));
     GET_SDESC(OLC_MOB(d)) = str_udup(arg);
     break;
 
   case MEDIT_L_DESC:
     smash_tilde(arg);
     if (GET_LDESC(OLC_MOB(d)))
-      free(GET_LDESC(OLC_MOB(d)));
+      str_release(GET_LDESC(OLC_MOB(d)));
     if (arg && *arg) {
       char buf[MAX_INPUT_LENGTH];
       snprintf(buf, sizeof(buf), "%s\r\n", arg);
@@ -0,0 +1,217 @@
+/**************************************************************************
+*  File: memacct.c                                         Part of tbaMUD *
+*  Usage: Counting heap memory by the part of the game that holds it.     *
+*                                                                         *
+*  All rights reserved.  See license for complete information.            *
+**************************************************************************/
+
+#define __MEMACCT_C__
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "comm.h"
+#ifdef MEMORY_ACCOUNTING
+#include <malloc.h>
+#endif
+
+/* The process size tells how much memory the game holds, not what holds it.
+ * So malloc(), calloc(), realloc(), free() and strdup() are routed through
+ * here by memacct.h, the same way zmalloc.h does for MEMORY_DEBUG, and with
+ * them CREATE, RECREATE and DISPOSE. Each subsystem keeps a count of its
+ * blocks and of the bytes the C library set aside for them.
+ *
+ * A block is handed out where malloc() put it, one byte longer than asked
+ * for. The last byte the library set aside for it, which malloc_usable_size()
+ * finds again at free() and realloc(), holds the subsystem it was allocated
+ * for; there is usually room for it in the rounding anyway. So a block stays
+ * with its subsystem when it is resized or freed elsewhere, and nothing is
+ * read outside it. A block whose tag makes no sense, which did not come from
+ * here, is counted under Other.
+ *
+ * malloc_usable_size() is a glibc function; other systems keep the C
+ * library's own functions, and "memory" says so.
+ *
+ * Only the main thread counts in mem_stats. Threads that allocate, like the
+ * boot threads of db.c, set mem_stats_hook to keep counts of their own, and
+ * merge them with mem_merge_stats() when done. */
+
+const char *mem_tag_names[] = {
+  "Other",
+  "World text",
+  "Prototypes",
+  "Live mobs/objs",
+  "Scripts",
+  "Output",
+  "Events",
+  "OLC",
+  "Players",
+  "\n"
+};
+
+struct mem_stats mem_stats[NUM_MEM_TAGS];
+int mem_tag = MEM_OTHER;
+struct mem_stats *(*mem_stats_hook)(void) = NULL;
+
+#ifdef MEMORY_ACCOUNTING
+static long mem_untagged = 0;	/* frees and reallocs of blocks without a tag */
+
+static struct mem_stats *mem_table(void)
+{
+  struct mem_stats *table;
+
+  if (mem_stats_hook && (table = mem_stats_hook()) != NULL)
+    return (table);
+  return (mem_stats);
+}
+
+static void mem_count(int tag, long bytes, int blocks)
+{
+  struct mem_stats *s = &mem_table()[tag];
+
+  s->bytes += bytes;
+  s->blocks += blocks;
+  if (blocks > 0)
+    s->allocs++;
+  if (s->bytes > s->peak)
+    s->peak = s->bytes;
+}
+
+/* The tag of a block from here, and its size in *usable. */
+static int mem_block_tag(void *ptr, size_t *usable)
+{
+  int tag;
+
+  *usable = malloc_usable_size(ptr);
+  tag = ((unsigned char *) ptr)[*usable - 1];
+  if (tag >= NUM_MEM_TAGS) {
+    mem_untagged++;
+    tag = MEM_OTHER;
+  }
+  return (tag);
+}
+
+static void *mem_tagged(void *ptr, int tag, long was)
+{
+  size_t usable = malloc_usable_size(ptr);
+
+  ((unsigned char *) ptr)[usable - 1] = tag;
+  mem_count(tag, (long) usable - was, was ? 0 : 1);
+  return (ptr);
+}
+
+void *mem_alloc(int tag, size_t size, int zero)
+{
+  void *ptr;
+
+  if (!(ptr = zero ? calloc(1, size + 1) : malloc(size + 1)))
+    return (NULL);
+
+  return (mem_tagged(ptr, tag, 0));
+}
+
+void *mem_realloc(int tag, void *ptr, size_t size)
+{
+  size_t was;
+  void *moved;
+
+  if (!ptr)
+    return (mem_alloc(tag, size, FALSE));
+
+  tag = mem_block_tag(ptr, &was);
+  if (!(moved = realloc(ptr, size + 1)))
+    return (NULL);
+
+  return (mem_tagged(moved, tag, (long) was));
+}
+
+void mem_free(void *ptr)
+{
+  size_t usable;
+  int tag;
+
+  if (!ptr)
+    return;
+
+  tag = mem_block_tag(ptr, &usable);
+  mem_count(tag, -(long) usable, -1);
+  free(ptr);
+}
+
+char *mem_strdup(int tag, const char *str)
+{
+  size_t len = strlen(str) + 1;
+  char *copy;
+
+  if ((copy = (char *) mem_alloc(tag, len, FALSE)) != NULL)
+    memcpy(copy, str, len);
+
+  return (copy);
+}
+#endif /* MEMORY_ACCOUNTING */
+
+/* Adds what a thread counted on its own to mem_stats. Its peaks are lost, so
+ * the peaks are at least what is held after the merge. */
+void mem_merge_stats(struct mem_stats *from)
+{
+  int i;
+
+  for (i = 0; i < NUM_MEM_TAGS; i++) {
+    mem_stats[i].bytes += from[i].bytes;
+    mem_stats[i].blocks += from[i].blocks;
+    mem_stats[i].allocs += from[i].allocs;
+    if (mem_stats[i].bytes > mem_stats[i].peak)
+      mem_stats[i].peak = mem_stats[i].bytes;
+  }
+}
+
+void show_mem_stats(struct char_data *ch)
+{
+#ifndef MEMORY_ACCOUNTING
+  send_to_char(ch, "Memory is not counted by subsystem in this build.%s\r\n",
+#ifdef MEMORY_DEBUG
+               " Zmalloc keeps track of it."
+#else
+               ""
+#endif
+               );
+#else
+  long bytes = 0, blocks = 0;
+  int i;
+
+  send_to_char(ch, "Subsystem            KB    Blocks  Peak KB     Allocs\r\n"
+                   "-------------- -------- --------- -------- ----------\r\n");
+
+  for (i = 0; i < NUM_MEM_TAGS; i++) {
+    send_to_char(ch, "%-14s %8ld %9ld %8ld %10ld\r\n", mem_tag_names[i],
+                 mem_stats[i].bytes / 1024, mem_stats[i].blocks,
+                 mem_stats[i].peak / 1024, mem_stats[i].allocs);
+    bytes += mem_stats[i].bytes;
+    blocks += mem_stats[i].blocks;
+  }
+
+  send_to_char(ch, "Total: %ldKB in %ld blocks.\r\n", bytes / 1024, blocks);
+  if (mem_untagged)
+    send_to_char(ch, "Blocks freed or resized without a tag: %ld.\r\n", mem_untagged);
+#endif
+}
+
+/* One line for the usage log, see record_usage(). */
+void log_mem_stats(void)
+{
+#ifdef MEMORY_ACCOUNTING
+  char buf[MAX_STRING_LENGTH];
+  size_t len = 0;
+  long bytes = 0;
+  int i;
+
+  for (i = 0; i < NUM_MEM_TAGS; i++) {
+    len += snprintf(buf + len, sizeof(buf) - len, "%s%s %ldK", i ? ", " : "",
+                    mem_tag_names[i], mem_stats[i].bytes / 1024);
+    bytes += mem_stats[i].bytes;
+  }
+
+  log("memory: %ldK total; %s", bytes / 1024, buf);
+#endif
+}
@@ -0,0 +1,68 @@
+/**
+* @file memacct.h
+* Counts the heap memory of each part of the game: every block allocated
+* through CREATE, RECREATE, strdup() and friends is tagged with the subsystem
+* that asked for it.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*/
+#ifndef _MEMACCT_H_
+#define _MEMACCT_H_
+
+/* Subsystems memory is counted against. Keep mem_tag_names in step. */
+#define MEM_OTHER    0  /**< Anything not listed below */
+#define MEM_WORLD    1  /**< Rooms, zones and the shared string pool */
+#define MEM_PROTO    2  /**< Mob and object prototypes, shops and quests */
+#define MEM_LIVE     3  /**< Mobs, objects and affects in the game */
+#define MEM_SCRIPT   4  /**< Triggers, running scripts and their variables */
+#define MEM_OUTPUT   5  /**< Connections and their buffers */
+#define MEM_EVENT    6  /**< Queued events */
+#define MEM_OLC      7  /**< The OLC editors and their copies */
+#define MEM_PLAYER   8  /**< The player index and player files */
+#define NUM_MEM_TAGS 9
+
+/** What one subsystem holds. */
+struct mem_stats {
+  long bytes;    /**< Bytes the C library holds for it now */
+  long blocks;   /**< Blocks held now */
+  long peak;     /**< Highest bytes seen */
+  long allocs;   /**< Blocks allocated since boot */
+};
+
+extern const char *mem_tag_names[];
+extern struct mem_stats mem_stats[NUM_MEM_TAGS];
+extern int mem_tag;
+extern struct mem_stats *(*mem_stats_hook)(void);
+
+void *mem_alloc(int tag, size_t size, int zero);
+void *mem_realloc(int tag, void *ptr, size_t size);
+void mem_free(void *ptr);
+char *mem_strdup(int tag, const char *str);
+void mem_merge_stats(struct mem_stats *from);
+void show_mem_stats(struct char_data *ch);
+void log_mem_stats(void);
+
+/* A file whose allocations all belong to one subsystem defines MEM_TAG before
+ * its includes. The rest count against mem_tag, which the boot sets for each
+ * part of the world it reads. The utilities, MEMORY_DEBUG builds and systems
+ * without glibc's malloc_usable_size() keep the C library's own functions;
+ * zmalloc takes them over with MEMORY_DEBUG. */
+#ifndef MEM_TAG
+#define MEM_TAG mem_tag
+#endif
+
+#if !defined(MEMORY_DEBUG) && !defined(CIRCLE_UTIL) && defined(__GLIBC__)
+#define MEMORY_ACCOUNTING
+#endif
+
+#if defined(MEMORY_ACCOUNTING) && !defined(__MEMACCT_C__)
+#define malloc(x)	mem_alloc(MEM_TAG, (x), FALSE)
+#define calloc(n,x)	mem_alloc(MEM_TAG, (n) * (x), TRUE)
+#define realloc(r,x)	mem_realloc(MEM_TAG, (r), (x))
+#define free(x)		mem_free(x)
+#undef  strdup
+#define strdup(x)	mem_strdup(MEM_TAG, (x))
+#endif
+
+#endif /* _MEMACCT_H_ */
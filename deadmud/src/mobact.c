@@ -30,7 +30,7 @@ void mobile_activity(void)
 {
   struct char_data *ch, *next_ch, *vict;
   struct obj_data *obj, *best_obj;
-  int door, found, max;
+  int door, found, max, occupied;
   memory_rec *names;
 
   for (ch = character_list; ch; ch = next_ch) {
@@ -89,8 +89,12 @@ void mobile_activity(void)
         perform_move(ch, door, 1);
     }
 
+    /* Aggressive mobs and mobs with memory only go after players without
+     * nohassle, so there is nothing for them to find in an empty zone. */
+    occupied = !is_empty(world[IN_ROOM(ch)].zone);
+
     /* Aggressive Mobs */
-     if (!MOB_FLAGGED(ch, MOB_HELPER) && (!AFF_FLAGGED(ch, AFF_BLIND) || !AFF_FLAGGED(ch, AFF_CHARM))) {
+     if (occupied && !MOB_FLAGGED(ch, MOB_HELPER) && (!AFF_FLAGGED(ch, AFF_BLIND) || !AFF_FLAGGED(ch, AFF_CHARM))) {
       found = FALSE;
       for (vict = world[IN_ROOM(ch)].people; vict && !found; vict = vict->next_in_room) {
 	if (IS_NPC(vict) || !CAN_SEE(ch, vict) || PRF_FLAGGED(vict, PRF_NOHASSLE))
@@ -115,7 +119,7 @@ void mobile_activity(void)
     }
 
     /* Mob Memory */
-    if (MOB_FLAGGED(ch, MOB_MEMORY) && MEMORY(ch)) {
+    if (occupied && MOB_FLAGGED(ch, MOB_MEMORY) && MEMORY(ch)) {
       found = FALSE;
       for (vict = world[IN_ROOM(ch)].people; vict && !found; vict = vict->next_in_room) {
 	if (IS_NPC(vict) || !CAN_SEE(ch, vict) || PRF_FLAGGED(vict, PRF_NOHASSLE))
@@ -8,6 +8,8 @@
 *  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -26,6 +28,7 @@
 #include "modify.h"
 #include "quest.h"
 #include "ibt.h"
+#include "strpool.h"
 
 /* local (file scope) function prototpyes  */
 static char *next_page(char *str, struct char_data *ch);
@@ -115,6 +118,8 @@ void string_write(struct descriptor_data *d, char **writeto, size_t len, long ma
   else if (data)
     free(data);
 
+  /* string_add() changes the text in place, so it must not be shared. */
+  *writeto = str_unshare(*writeto);
   d->str = writeto;
   d->max_str = len;
   d->mail_to = mailto;
@@ -5,6 +5,8 @@
 *  By Vatiken. Copyright 2012 by Joseph Arnusch                           *
 **************************************************************************/
 
+#define MEM_TAG MEM_EVENT
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
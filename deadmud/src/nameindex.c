@@ -0,0 +1,497 @@
+/**************************************************************************
+*  File: nameindex.c                                       Part of tbaMUD *
+*  Usage: Finding characters and objects in the world by name.            *
+*                                                                         *
+*  All rights reserved.  See license for complete information.            *
+**************************************************************************/
+
+#define MEM_TAG MEM_PROTO
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "db.h"
+#include "nameindex.h"
+
+/* Looking for a name in the whole world used to mean trying every character
+ * in character_list or every object in object_list. Most of them are
+ * instances that share their prototype's name, though, and the string pool
+ * already splits the names of the prototypes into keywords (see strpool.c).
+ * So the keywords of all mob and of all object prototypes are kept here in a
+ * sorted table each, where a name is looked up as a prefix; the prototypes
+ * found lead to their instances through the lists of mob_index and
+ * obj_index.
+ *
+ * Everything else is kept on the unshared lists and tried one by one:
+ * players, mobs and objects without a prototype, like corpses and money, and
+ * instances that were given a name of their own. Code that renames an
+ * instance must put it there with char_to_unshared() or obj_to_unshared().
+ *
+ * The lookups return their finds in the order of character_list and
+ * object_list, newest first, so that "2.guard" is the same guard it always
+ * was. Characters are ordered by their list_stamp and objects by their id,
+ * which both only grow as things are added to the lists. The instance lists
+ * and the unshared lists are all kept in that order already (see
+ * char_to_instances() in handler.c), so a lookup only has to merge the lists
+ * of the prototypes it found with the unshared list, and never sorts. */
+
+struct char_data *unshared_chars = NULL;
+struct obj_data *unshared_objs = NULL;
+long char_list_stamp = 0;
+
+/* One keyword of a prototype, pointing into its keyword_set. */
+struct name_key {
+  const char *word;
+  int len;
+  IDXTYPE rnum;
+};
+
+#define KEYS_MOB 0
+#define KEYS_OBJ 1
+#define KEY_TABLE(mode) ((mode) == DB_BOOT_MOB ? KEYS_MOB : KEYS_OBJ)
+
+static struct name_key *name_keys[2];
+static int name_key_count[2];
+static int name_keys_stale[2] = { TRUE, TRUE };
+/* For each rnum, the last lookup that found the prototype, so that one with
+ * several matching keywords is only taken once. */
+static int *proto_seen[2];
+static int proto_lookups[2];
+
+/* One list being merged: where it has got to, and the list_stamp or id
+ * there. */
+struct name_src {
+  long order;
+  void *item;
+  int unshared;
+};
+
+/* Scratch space for the lookups. */
+static IDXTYPE *found_protos = NULL;
+static int found_protos_size = 0;
+static struct name_src *merge_srcs = NULL;
+static int merge_srcs_size = 0;
+
+/* What the last lookup found: shared by all callers, and only good until the
+ * next call of the same function. */
+static struct char_data **found_chars = NULL;
+static int found_chars_size = 0;
+static struct obj_data **found_objs = NULL;
+static int found_objs_size = 0;
+
+/** Marks the keyword table of mode (DB_BOOT_MOB or DB_BOOT_OBJ) for a rebuild
+ * before its next use. Call it whenever the names or rnums of the prototypes
+ * change. */
+void name_index_changed(int mode)
+{
+  if (mode == DB_BOOT_MOB || mode == DB_BOOT_OBJ)
+    name_keys_stale[KEY_TABLE(mode)] = TRUE;
+}
+
+void free_name_index(void)
+{
+  int t;
+
+  for (t = 0; t < 2; t++) {
+    if (name_keys[t])
+      free(name_keys[t]);
+    if (proto_seen[t])
+      free(proto_seen[t]);
+    name_keys[t] = NULL;
+    proto_seen[t] = NULL;
+    name_key_count[t] = 0;
+    proto_lookups[t] = 0;
+    name_keys_stale[t] = TRUE;
+  }
+  if (found_protos)
+    free(found_protos);
+  if (merge_srcs)
+    free(merge_srcs);
+  if (found_chars)
+    free(found_chars);
+  if (found_objs)
+    free(found_objs);
+  found_protos = NULL;
+  merge_srcs = NULL;
+  found_chars = NULL;
+  found_objs = NULL;
+  found_protos_size = merge_srcs_size = found_chars_size = found_objs_size = 0;
+}
+
+/* Characters later on character_list have smaller stamps. */
+void char_to_unshared(struct char_data *ch)
+{
+  struct char_data *prev = NULL, *next;
+
+  if (ch->prev_unshared || unshared_chars == ch)
+    return;
+
+  for (next = unshared_chars; next && next->list_stamp > ch->list_stamp; next = next->next_unshared)
+    prev = next;
+
+  ch->prev_unshared = prev;
+  ch->next_unshared = next;
+  if (next)
+    next->prev_unshared = ch;
+  if (prev)
+    prev->next_unshared = ch;
+  else
+    unshared_chars = ch;
+}
+
+void char_from_unshared(struct char_data *ch)
+{
+  if (ch->prev_unshared)
+    ch->prev_unshared->next_unshared = ch->next_unshared;
+  else if (unshared_chars == ch)
+    unshared_chars = ch->next_unshared;
+  else
+    return;
+
+  if (ch->next_unshared)
+    ch->next_unshared->prev_unshared = ch->prev_unshared;
+  ch->next_unshared = ch->prev_unshared = NULL;
+}
+
+/* Objects later on object_list have smaller ids. */
+void obj_to_unshared(struct obj_data *obj)
+{
+  struct obj_data *prev = NULL, *next;
+
+  if (obj->prev_unshared || unshared_objs == obj)
+    return;
+
+  for (next = unshared_objs; next && GET_ID(next) > GET_ID(obj); next = next->next_unshared)
+    prev = next;
+
+  obj->prev_unshared = prev;
+  obj->next_unshared = next;
+  if (next)
+    next->prev_unshared = obj;
+  if (prev)
+    prev->next_unshared = obj;
+  else
+    unshared_objs = obj;
+}
+
+void obj_from_unshared(struct obj_data *obj)
+{
+  if (obj->prev_unshared)
+    obj->prev_unshared->next_unshared = obj->next_unshared;
+  else if (unshared_objs == obj)
+    unshared_objs = obj->next_unshared;
+  else
+    return;
+
+  if (obj->next_unshared)
+    obj->next_unshared->prev_unshared = obj->prev_unshared;
+  obj->next_unshared = obj->prev_unshared = NULL;
+}
+
+static int name_key_cmp(const void *a, const void *b)
+{
+  const struct name_key *ka = (const struct name_key *) a;
+  const struct name_key *kb = (const struct name_key *) b;
+  int cmp = strcmp(ka->word, kb->word);
+
+  return cmp ? cmp : (int) ka->rnum - (int) kb->rnum;
+}
+
+static void build_name_keys(int t)
+{
+  struct index_data *index = t == KEYS_MOB ? mob_index : obj_index;
+  int top = t == KEYS_MOB ? top_of_mobt : top_of_objt;
+  struct keyword_set *kw;
+  int r, i, n = 0;
+
+  for (r = 0; r <= top; r++)
+    if ((kw = index[r].keywords))
+      n += kw->count;
+
+  RECREATE(name_keys[t], struct name_key, MAX(n, 1));
+  n = 0;
+  for (r = 0; r <= top; r++)
+    if ((kw = index[r].keywords))
+      for (i = 0; i < kw->count; i++) {
+        name_keys[t][n].word = kw->words[i].word;
+        name_keys[t][n].len = kw->words[i].len;
+        name_keys[t][n++].rnum = r;
+      }
+
+  qsort(name_keys[t], n, sizeof(struct name_key), name_key_cmp);
+  name_key_count[t] = n;
+
+  /* The rnums may have moved, so no prototype has been seen yet. */
+  if (proto_seen[t])
+    free(proto_seen[t]);
+  CREATE(proto_seen[t], int, top + 1);
+  proto_lookups[t] = 0;
+
+  name_keys_stale[t] = FALSE;
+}
+
+/* Finds the prototypes with a keyword that starts with key, which is
+ * lowercased. Returns how many, each once, in found_protos. */
+static int protos_by_key(int mode, const char *key, int len)
+{
+  int t = KEY_TABLE(mode), lo, hi, mid, n = 0, i;
+  IDXTYPE r;
+
+  if (name_keys_stale[t])
+    build_name_keys(t);
+
+  /* The first keyword not before key; all that start with key follow it. */
+  lo = 0;
+  hi = name_key_count[t];
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (strcmp(name_keys[t][mid].word, key) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  /* A prototype can have more than one such keyword. */
+  if (++proto_lookups[t] <= 0) {
+    memset(proto_seen[t], 0, sizeof(int) * ((t == KEYS_MOB ? top_of_mobt : top_of_objt) + 1));
+    proto_lookups[t] = 1;
+  }
+
+  for (i = lo; i < name_key_count[t] && name_keys[t][i].len >= len &&
+       !strncmp(name_keys[t][i].word, key, len); i++) {
+    r = name_keys[t][i].rnum;
+    if (proto_seen[t][r] == proto_lookups[t])
+      continue;
+    proto_seen[t][r] = proto_lookups[t];
+    if (n >= found_protos_size) {
+      found_protos_size = MAX(64, found_protos_size * 2);
+      RECREATE(found_protos, IDXTYPE, found_protos_size);
+    }
+    found_protos[n++] = r;
+  }
+  return n;
+}
+
+/* TRUE if one of the keywords of namelist starts with key, ignoring case. */
+static int has_key(const char *namelist, const char *key, int len)
+{
+  const char *p;
+  int i;
+
+  if (!namelist)
+    return FALSE;
+
+  for (p = namelist; *p; ) {
+    while (*p == ' ' || *p == '\t')
+      p++;
+    for (i = 0; i < len && p[i] && LOWER(p[i]) == key[i]; i++)
+      ;
+    if (i == len)
+      return TRUE;
+    while (*p && *p != ' ' && *p != '\t')
+      p++;
+  }
+  return FALSE;
+}
+
+/* Lowercases a name into key for the tables. FALSE if it has no use as a
+ * single keyword, like a name with spaces in it, which isname() can still
+ * match against a whole namelist. */
+static int name_key(const char *name, char *key, size_t size)
+{
+  size_t i;
+
+  if (!name || !*name)
+    return FALSE;
+
+  for (i = 0; name[i]; i++) {
+    if (i + 1 >= size || name[i] == ' ' || name[i] == '\t')
+      return FALSE;
+    key[i] = LOWER(name[i]);
+  }
+  key[i] = '\0';
+  return TRUE;
+}
+
+static void found_char(int n, struct char_data *ch)
+{
+  if (n >= found_chars_size) {
+    found_chars_size = MAX(64, found_chars_size * 2);
+    RECREATE(found_chars, struct char_data *, found_chars_size);
+  }
+  found_chars[n] = ch;
+}
+
+static void found_obj(int n, struct obj_data *obj)
+{
+  if (n >= found_objs_size) {
+    found_objs_size = MAX(64, found_objs_size * 2);
+    RECREATE(found_objs, struct obj_data *, found_objs_size);
+  }
+  found_objs[n] = obj;
+}
+
+/* The lists being merged are kept in a heap in merge_srcs, the one with the
+ * newest character or object at the top. */
+static void merge_add(int *n, long order, void *item, int unshared)
+{
+  int i, parent;
+
+  if (*n >= merge_srcs_size) {
+    merge_srcs_size = MAX(64, merge_srcs_size * 2);
+    RECREATE(merge_srcs, struct name_src, merge_srcs_size);
+  }
+
+  for (i = (*n)++; i > 0; i = parent) {
+    parent = (i - 1) / 2;
+    if (merge_srcs[parent].order >= order)
+      break;
+    merge_srcs[i] = merge_srcs[parent];
+  }
+  merge_srcs[i].order = order;
+  merge_srcs[i].item = item;
+  merge_srcs[i].unshared = unshared;
+}
+
+/* Moves the top of the heap, which has moved on in its list, back down to
+ * where it belongs. */
+static void merge_settle(int n)
+{
+  struct name_src top;
+  int i = 0, child;
+
+  if (n <= 1)
+    return;
+
+  top = merge_srcs[0];
+  while ((child = 2 * i + 1) < n) {
+    if (child + 1 < n && merge_srcs[child + 1].order > merge_srcs[child].order)
+      child++;
+    if (merge_srcs[child].order <= top.order)
+      break;
+    merge_srcs[i] = merge_srcs[child];
+    i = child;
+  }
+  merge_srcs[i] = top;
+}
+
+/* From ch on, the first character of its list that a lookup for key takes:
+ * on an instance list, one that still shares its prototype's name; on the
+ * unshared list, one that does not and has a keyword starting with key. */
+static struct char_data *next_char(struct char_data *ch, int unshared, const char *key, int len)
+{
+  mob_rnum r;
+
+  for (; ch; ch = unshared ? ch->next_unshared : ch->next_instance) {
+    r = IS_NPC(ch) ? GET_MOB_RNUM(ch) : NOBODY;
+    if (r != NOBODY && ch->player.name == mob_proto[r].player.name) {
+      if (!unshared)
+        return ch;
+    } else if (unshared && has_key(ch->player.name, key, len))
+      return ch;
+  }
+  return NULL;
+}
+
+/* The same for objects. */
+static struct obj_data *next_obj(struct obj_data *obj, int unshared, const char *key, int len)
+{
+  obj_rnum r;
+
+  for (; obj; obj = unshared ? obj->next_unshared : obj->next_instance) {
+    r = GET_OBJ_RNUM(obj);
+    if (r != NOTHING && obj->name == obj_proto[r].name) {
+      if (!unshared)
+        return obj;
+    } else if (unshared && has_key(obj->name, key, len))
+      return obj;
+  }
+  return NULL;
+}
+
+/** Finds the characters that may answer to name, in character_list order:
+ * all that char_isname() would match and maybe a few more, so the caller
+ * still has to check each of them.
+ * @param name The name to look for, without a "2." in front.
+ * @param found Set to the characters found. The array is shared by every
+ * caller and only good until the next call to chars_by_name(), so a caller
+ * must be done with it before anything it does while walking it could look
+ * up a name again.
+ * @retval int How many were found. */
+int chars_by_name(const char *name, struct char_data ***found)
+{
+  char key[MAX_INPUT_LENGTH];
+  struct char_data *ch;
+  int n = 0, p, protos, srcs = 0, len, unshared;
+
+  if (!name_key(name, key, sizeof(key))) {
+    for (ch = character_list; ch; ch = ch->next)
+      found_char(n++, ch);
+    *found = found_chars;
+    return n;
+  }
+  len = strlen(key);
+
+  protos = protos_by_key(DB_BOOT_MOB, key, len);
+  for (p = 0; p < protos; p++)
+    if ((ch = next_char(mob_index[found_protos[p]].mobs, FALSE, key, len)))
+      merge_add(&srcs, ch->list_stamp, ch, FALSE);
+  if ((ch = next_char(unshared_chars, TRUE, key, len)))
+    merge_add(&srcs, ch->list_stamp, ch, TRUE);
+
+  while (srcs > 0) {
+    ch = (struct char_data *) merge_srcs[0].item;
+    unshared = merge_srcs[0].unshared;
+    found_char(n++, ch);
+    if ((ch = next_char(unshared ? ch->next_unshared : ch->next_instance, unshared, key, len))) {
+      merge_srcs[0].order = ch->list_stamp;
+      merge_srcs[0].item = ch;
+    } else
+      merge_srcs[0] = merge_srcs[--srcs];
+    merge_settle(srcs);
+  }
+
+  *found = found_chars;
+  return n;
+}
+
+/** Finds the objects that may answer to name, in object_list order, as
+ * chars_by_name() does for characters. The array set in found is likewise
+ * only good until the next call to objs_by_name(). */
+int objs_by_name(const char *name, struct obj_data ***found)
+{
+  char key[MAX_INPUT_LENGTH];
+  struct obj_data *obj;
+  int n = 0, p, protos, srcs = 0, len, unshared;
+
+  if (!name_key(name, key, sizeof(key))) {
+    for (obj = object_list; obj; obj = obj->next)
+      found_obj(n++, obj);
+    *found = found_objs;
+    return n;
+  }
+  len = strlen(key);
+
+  protos = protos_by_key(DB_BOOT_OBJ, key, len);
+  for (p = 0; p < protos; p++)
+    if ((obj = next_obj(obj_index[found_protos[p]].objs, FALSE, key, len)))
+      merge_add(&srcs, GET_ID(obj), obj, FALSE);
+  if ((obj = next_obj(unshared_objs, TRUE, key, len)))
+    merge_add(&srcs, GET_ID(obj), obj, TRUE);
+
+  while (srcs > 0) {
+    obj = (struct obj_data *) merge_srcs[0].item;
+    unshared = merge_srcs[0].unshared;
+    found_obj(n++, obj);
+    if ((obj = next_obj(unshared ? obj->next_unshared : obj->next_instance, unshared, key, len))) {
+      merge_srcs[0].order = GET_ID(obj);
+      merge_srcs[0].item = obj;
+    } else
+      merge_srcs[0] = merge_srcs[--srcs];
+    merge_settle(srcs);
+  }
+
+  *found = found_objs;
+  return n;
+}
@@ -0,0 +1,30 @@
+/**
+* @file nameindex.h
+* Finding the characters and objects in the world that answer to a name
+* without walking all of character_list or object_list.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*/
+#ifndef _NAMEINDEX_H_
+#define _NAMEINDEX_H_
+
+/** Characters and objects that do not share their prototype's name. */
+extern struct char_data *unshared_chars;
+extern struct obj_data *unshared_objs;
+/** The list_stamp of the character last added to character_list. */
+extern long char_list_stamp;
+
+void name_index_changed(int mode);
+void free_name_index(void);
+
+void char_to_unshared(struct char_data *ch);
+void char_from_unshared(struct char_data *ch);
+void obj_to_unshared(struct obj_data *obj);
+void obj_from_unshared(struct obj_data *obj);
+
+/** The arrays these hand back are their own, reused by the next call. */
+int chars_by_name(const char *name, struct char_data ***found);
+int objs_by_name(const char *name, struct obj_data ***found);
+
+#endif /* _NAMEINDEX_H_ */
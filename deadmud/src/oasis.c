@@ -5,6 +5,8 @@
 * By Levork. Copyright 1996 Harvey Gilpin. 1997-2001 George Greer.        *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
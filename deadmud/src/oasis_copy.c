@@ -6,6 +6,8 @@
 * 2002 Kip Potter [Mythran].                                              *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -23,6 +25,7 @@
 #include "improved-edit.h"
 #include "constants.h"
 #include "dg_scripts.h"
+#include "strpool.h"
 
 /* Local, filescope function prototypes */
 /* Utility function for buildwalk */
@@ -197,10 +200,8 @@ ACMD(do_dig)
   if (rvnum == NOTHING) {
     if (W_EXIT(IN_ROOM(ch), dir)) {
       /* free the old pointers, if any */
-      if (W_EXIT(IN_ROOM(ch), dir)->general_description)
-        free(W_EXIT(IN_ROOM(ch), dir)->general_description);
-      if (W_EXIT(IN_ROOM(ch), dir)->keyword)
-        free(W_EXIT(IN_ROOM(ch), dir)->keyword);
+      str_release(W_EXIT(IN_ROOM(ch), dir)->general_description);
+      str_release(W_EXIT(IN_ROOM(ch), dir)->keyword);
       free(W_EXIT(IN_ROOM(ch), dir));
       W_EXIT(IN_ROOM(ch), dir) = NULL;
       add_to_save_list(zone_table[world[IN_ROOM(ch)].zone].number, SL_WLD);
@@ -292,19 +293,10 @@ ACMD(do_dig)
 static room_vnum redit_find_new_vnum(zone_rnum zone)
 {
   room_vnum vnum = genolc_zone_bottom(zone);
-  room_rnum rnum = real_room(vnum);
-
-  if (rnum == NOWHERE)
-    return vnum;
 
-  for(;;) {
-    if (vnum > zone_table[zone].top)
+  for (; real_room(vnum) != NOWHERE; vnum++)
+    if (vnum >= zone_table[zone].top)
       return(NOWHERE);
-    if (rnum > top_of_world || world[rnum].number > vnum)
-      break;
-    rnum++;
-    vnum++;
-  }
   return(vnum);
 }
 
@@ -6,6 +6,8 @@
 * 2002 Kip Potter [Mythran].                                              *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -17,6 +19,7 @@
 #include "genolc.h"
 #include "oasis.h"
 #include "improved-edit.h"
+#include "strpool.h"
 
 /* Free's strings from any object, room, mobiles, or player. TRUE if successful,
  * otherwise, it returns FALSE. Type - The OLC type constant relating to the 
@@ -32,11 +35,8 @@ int free_strings(void *data, int type)
       room = (struct room_data *) data;
 
       /* Free Descriptions */
-      if (room->name)
-        free(room->name);
-
-      if (room->description)
-        free(room->description);
+      str_release(room->name);
+      str_release(room->description);
 
       if (room->ex_description)
         free_ex_descriptions(room->ex_description);
@@ -50,11 +50,11 @@ int free_strings(void *data, int type)
       for (i = 0; i < NUM_OF_DIRS; i++) { /* NUM_OF_DIRS, not DIR_COUNT */
         if (room->dir_option[i]) {
           if (room->dir_option[i]->general_description) {
-            free(room->dir_option[i]->general_description);
+            str_release(room->dir_option[i]->general_description);
             room->dir_option[i]->general_description = NULL;
           }
           if (room->dir_option[i]->keyword) {
-            free(room->dir_option[i]->keyword);
+            str_release(room->dir_option[i]->keyword);
             room->dir_option[i]->keyword = NULL;
           }
           free(room->dir_option[i]);
@@ -6,6 +6,8 @@
 * 2002 Kip Potter [Mythran].                                              *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -55,7 +57,7 @@ void perform_mob_flag_list(struct char_data * ch, char *arg)
   len = snprintf(buf, sizeof(buf), "Listing mobiles with %s%s%s flag set.\r\n", QYEL, action_bits[mob_flag], QNRM);
 
   for(num=0;num<=top_of_mobt;num++) {
-    if(IS_SET_AR((mob_proto[num].char_specials.saved.act), mob_flag)) {
+    if(IS_SET_AR(MOB_FLAGS(&mob_proto[num]), mob_flag)) {
 
       if ((mob = read_mobile(num, REAL)) != NULL) {
         char_to_room(mob, 0);
@@ -90,7 +92,7 @@ void perform_mob_level_list(struct char_data * ch, char *arg)
 
   len = snprintf(buf, sizeof(buf), "Listing mobiles of level %s%d%s\r\n", QYEL, mob_level, QNRM);
   for(num=0;num<=top_of_mobt;num++) {
-    if((mob_proto[num].player.level) == mob_level) {
+    if(GET_LEVEL(&mob_proto[num]) == mob_level) {
 
       if ((mob = read_mobile(num, REAL)) != NULL) {
         char_to_room(mob, 0);
@@ -503,7 +505,7 @@ ACMD(do_oasis_links)
   zone_vnum zvnum;
   room_rnum nr, to_room;
   room_vnum first, last;
-  int j;
+  int vnum, j;
   char arg[MAX_INPUT_LENGTH];
 
   skip_spaces(&argument);
@@ -532,8 +534,8 @@ ACMD(do_oasis_links)
   first = zone_table[zrnum].bot;
 
   send_to_char(ch, "Zone %d is linked to the following zones:\r\n", zvnum);
-  for (nr = 0; nr <= top_of_world && (GET_ROOM_VNUM(nr) <= last); nr++) {
-    if (GET_ROOM_VNUM(nr) >= first) {
+  for (vnum = first; vnum <= last; vnum++) {
+    if ((nr = real_room(vnum)) != NOWHERE) {
       for (j = 0; j < DIR_COUNT; j++) {
 	if (world[nr].dir_option[j]) {
 	  to_room = world[nr].dir_option[j]->to_room;
@@ -554,7 +556,7 @@ static void list_rooms(struct char_data *ch, zone_rnum rnum, room_vnum vmin, roo
 {
   room_rnum i;
   room_vnum bottom, top;
-  int j, counter = 0, len;
+  int vnum, j, counter = 0, len;
   char buf[MAX_STRING_LENGTH];
 
   /* Expect a minimum / maximum number if the rnum for the zone is NOWHERE. */
@@ -574,10 +576,10 @@ static void list_rooms(struct char_data *ch, zone_rnum rnum, room_vnum vmin, roo
   if (!top_of_world)
     return;
 
-  for (i = 0; i <= top_of_world; i++) {
+  for (vnum = bottom; vnum <= top; vnum++) {
 
     /** Check to see if this room is one of the ones needed to be listed.    **/
-    if ((world[i].number >= bottom) && (world[i].number <= top)) {
+    if ((i = real_room(vnum)) != NOWHERE) {
       counter++;
 
         len += snprintf(buf + len, sizeof(buf) - len, "%4d) [%s%-5d%s] %s%-*s%s %s",
@@ -641,7 +643,7 @@ static void list_mobiles(struct char_data *ch, zone_rnum rnum, mob_vnum vmin, mo
       len += snprintf(buf + len, sizeof(buf) - len, "%s%4d%s) [%s%-5d%s] %s%-*s %s[%4d]%s%s\r\n",
                    QGRN, counter, QNRM, QGRN, mob_index[i].vnum, QNRM,
                    QCYN, count_color_chars(mob_proto[i].player.short_descr)+44, mob_proto[i].player.short_descr,
-                   QYEL, mob_proto[i].player.level, QNRM,
+                   QYEL, GET_LEVEL(&mob_proto[i]), QNRM,
                    mob_proto[i].proto_script ? " [TRIG]" : ""
                    );
       if (len > sizeof(buf))
@@ -8,6 +8,8 @@
 *  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
 **************************************************************************/
 
+#define MEM_TAG MEM_LIVE
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -22,6 +24,9 @@
 #include "config.h"
 #include "modify.h"
 #include "genolc.h" /* for strip_cr and sprintascii */
+#include "mapfile.h"
+#include "nameindex.h"
+#include "strpool.h"
 
 /* these factors should be unique integers */
 #define RENT_FACTOR    1
@@ -378,7 +383,7 @@ void update_obj_file(void)
 
 void Crash_listrent(struct char_data *ch, char *name)
 {
-  FILE *fl;
+  struct map_file *fl;
   char filename[MAX_INPUT_LENGTH], buf[MAX_STRING_LENGTH], line[READ_SIZE];
   obj_save_data *loaded, *current;
   int rentcode,timed,netcost,gold,account,nitems, numread, len;
@@ -386,18 +391,18 @@ void Crash_listrent(struct char_data *ch, char *name)
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, name))
     return;
 
-  if (!(fl = fopen(filename, "r"))) {
+  if (!(fl = mf_open(filename))) {
     send_to_char(ch, "%s has no rent file.\r\n", name);
     return;
   }
   len = snprintf(buf, sizeof(buf),"%s\r\n", filename);
 
-  numread = get_line(fl, line);
+  numread = mf_get_line(fl, line);
 
   /* Oops, can't get the data, punt. */
   if (numread == FALSE) {
     send_to_char(ch, "Error reading rent information.\r\n");
-    fclose(fl);
+    mf_close(fl);
     return;
   }
 
@@ -440,7 +445,7 @@ void Crash_listrent(struct char_data *ch, char *name)
 	}
 
   page_string(ch->desc,buf,0);
-  fclose(fl);
+  mf_close(fl);
 }
 
 /* Return values:
@@ -977,11 +982,11 @@ void Crash_save_all(void)
 /* Parses the object records stored in fl, and returns the first object in a
  * linked list, which also handles location if worn. This list can then be
  * handled by house code, listrent code, autoeq code, etc. */
-obj_save_data *objsave_parse_objects(FILE *fl)
+obj_save_data *objsave_parse_objects(struct map_file *fl)
 {
   obj_save_data *head, *current, *tempsave;
   char f1[128], f2[128], f3[128], f4[128], line[READ_SIZE];
-  int t[4],i, nr;
+  int t[4],i, nr, edes = FALSE;
   struct obj_data *temp;
 
   CREATE(current, obj_save_data, 1);
@@ -994,7 +999,7 @@ obj_save_data *objsave_parse_objects(FILE *fl)
     int num;
 
     /* if the file is done, wrap it all up */
-    if(get_line(fl, line) == FALSE || (*line == '$' && line[1] == '~')) {
+    if(mf_get_line(fl, line) == FALSE || (*line == '$' && line[1] == '~')) {
       if (temp == NULL && current->obj == NULL) {
         /* Remove current from list. */
         tempsave = head;
@@ -1047,6 +1052,7 @@ obj_save_data *objsave_parse_objects(FILE *fl)
         continue;
         
       /* we have the number, check it, load obj. */
+      edes = FALSE;
       if (nr == NOTHING) {   /* then it is unique */
         temp = create_obj();
         temp->item_number=NOTHING;
@@ -1078,7 +1084,8 @@ obj_save_data *objsave_parse_objects(FILE *fl)
       if (!strcmp(tag, "ADes")) {
         char error[40];
         snprintf(error, sizeof(error)-1, "rent(Ades):%s", temp->name);
-        temp->action_description = fread_string(fl, error);
+        str_release(temp->action_description);
+        temp->action_description = mf_fread_string(fl, error);
       } else if (!strcmp(tag, "Aff ")) {
         sscanf(line, "%d %d %d", &t[0], &t[1], &t[2]);
         if (t[0] < MAX_OBJ_AFFECT) {
@@ -1092,21 +1099,24 @@ obj_save_data *objsave_parse_objects(FILE *fl)
         GET_OBJ_COST(temp) = num;
       break;
     case 'D':
-      if (!strcmp(tag, "Desc"))
+      if (!strcmp(tag, "Desc")) {
+        str_release(temp->description);
         temp->description = strdup(line);
+      }
       break;
     case 'E':
       if(!strcmp(tag, "EDes")) {
         struct extra_descr_data *new_desc;
         char error[40];
         snprintf(error, sizeof(error)-1, "rent(Edes): %s", temp->name);
-        if (temp->item_number != NOTHING && /* Regular object */
-            temp->ex_description &&   /* with ex_desc == prototype */
-            (temp->ex_description == obj_proto[real_object(temp->item_number)].ex_description))
+        if (!edes && temp->ex_description) { /* the prototype's, replaced */
+          free_ex_descriptions(temp->ex_description);
           temp->ex_description = NULL;
+        }
+        edes = TRUE;
         CREATE(new_desc, struct extra_descr_data, 1);
-        new_desc->keyword = fread_string(fl, error);
-        new_desc->description = fread_string(fl, error);
+        new_desc->keyword = mf_fread_string(fl, error);
+        new_desc->description = mf_fread_string(fl, error);
         new_desc->next = temp->ex_description;
         temp->ex_description = new_desc;
       }
@@ -1125,8 +1135,11 @@ obj_save_data *objsave_parse_objects(FILE *fl)
         current->locate = num;
       break;
     case 'N':
-      if (!strcmp(tag, "Name"))
+      if (!strcmp(tag, "Name")) {
+        str_release(temp->name);
         temp->name = strdup(line);
+        obj_to_unshared(temp);
+      }
       break;
     case 'P':
       if (!strcmp(tag, "Perm")) {
@@ -1142,8 +1155,10 @@ obj_save_data *objsave_parse_objects(FILE *fl)
         GET_OBJ_RENT(temp) = num;
       break;
     case 'S':
-      if (!strcmp(tag, "Shrt"))
+      if (!strcmp(tag, "Shrt")) {
+        str_release(temp->short_description);
         temp->short_description = strdup(line);
+      }
       break;
     case 'T':
       if (!strcmp(tag, "Type"))
@@ -1176,7 +1191,7 @@ obj_save_data *objsave_parse_objects(FILE *fl)
 }
 
 static int Crash_load_objs(struct char_data *ch) {
-  FILE *fl;
+  struct map_file *fl;
   char filename[MAX_STRING_LENGTH];
   char line[READ_SIZE];
   char buf[MAX_STRING_LENGTH];
@@ -1193,7 +1208,7 @@ static int Crash_load_objs(struct char_data *ch) {
   for (i = 0; i < MAX_BAG_ROWS; i++)
     cont_row[i] = NULL;
 
-  if (!(fl = fopen(filename, "r"))) {
+  if (!(fl = mf_open(filename))) {
     if (errno != ENOENT) { /* if it fails, NOT because of no file */
       sprintf(buf, "SYSERR: READING OBJECT FILE %s (5)", filename);
       perror(buf);
@@ -1204,7 +1219,7 @@ static int Crash_load_objs(struct char_data *ch) {
     mudlog(NRM, MAX(LVL_IMMORT, GET_INVIS_LEV(ch)), TRUE, "%s entering game with no equipment.", GET_NAME(ch));
     return 1;
   }
-  if (get_line(fl, line))
+  if (mf_get_line(fl, line))
     sscanf(line,"%d %d %d %d %d %d",&rentcode, &timed,
            &netcost,&gold,&account,&nitems);
 
@@ -1213,7 +1228,7 @@ static int Crash_load_objs(struct char_data *ch) {
     num_of_days = (int)((float) (time(0) - timed) / (float)atoi(str));
     cost = (unsigned int) (netcost * num_of_days);
     if (cost > (unsigned int)GET_GOLD(ch) + (unsigned int)GET_BANK_GOLD(ch)) {
-      fclose(fl);
+      mf_close(fl);
       mudlog(BRF, MAX(LVL_IMMORT, GET_INVIS_LEV(ch)), TRUE,
              "%s entering game, rented equipment lost (no $).", GET_NAME(ch));
       Crash_crashsave(ch);
@@ -1265,7 +1280,7 @@ static int Crash_load_objs(struct char_data *ch) {
  mudlog(NRM, MAX(LVL_GOD, GET_INVIS_LEV(ch)), TRUE, "%s (level %d) has %d %s (max %d).",
          GET_NAME(ch), GET_LEVEL(ch), num_objs, num_objs > 1 ? "objects" : "object", CONFIG_MAX_OBJ_SAVE);
 
-  fclose(fl);
+  mf_close(fl);
 
   if ((orig_rent_code == RENT_RENTED) || (orig_rent_code == RENT_CRYO))
     return 0;
@@ -5,6 +5,8 @@
 * By Levork. Copyright 1996 Harvey Gilpin. 1997-2001 George Greer.        *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -24,6 +26,7 @@
 #include "dg_olc.h"
 #include "fight.h"
 #include "modify.h"
+#include "strpool.h"
 
 /* local functions */
 static void oedit_setup_new(struct descriptor_data *d);
@@ -234,9 +237,7 @@ void oedit_save_internally(struct descriptor_data *d)
   obj_proto[robj_num].proto_script = OLC_SCRIPT(d);
 
   /* this takes care of the objects currently in-game */
-  for (obj = object_list; obj; obj = obj->next) {
-    if (obj->item_number != robj_num)
-      continue;
+  for (obj = obj_index[robj_num].objs; obj; obj = obj->next_instance) {
     /* remove any old scripts */
     if (SCRIPT(obj))
       extract_script(obj, OBJ_TRIGGER);
@@ -850,7 +851,7 @@ void oedit_parse(struct descriptor_data *d, char *arg)
     if (!genolc_checkstring(d, arg))
       break;
     if (OLC_OBJ(d)->name)
-      free(OLC_OBJ(d)->name);
+      str_release(OLC_OBJ(d)->name);
     OLC_OBJ(d)->name = str_udup(arg);
     break;
 
@@ -858,7 +859,7 @@ void oedit_parse(struct descriptor_data *d, char *arg)
     if (!genolc_checkstring(d, arg))
       break;
     if (OLC_OBJ(d)->short_description)
-      free(OLC_OBJ(d)->short_description);
+      str_release(OLC_OBJ(d)->short_description);
     OLC_OBJ(d)->short_description = str_udup(arg);
     break;
 
@@ -866,7 +867,7 @@ void oedit_parse(struct descriptor_data *d, char *arg)
     if (!genolc_checkstring(d, arg))
       break;
     if (OLC_OBJ(d)->description)
-      free(OLC_OBJ(d)->description);
+      str_release(OLC_OBJ(d)->description);
     OLC_OBJ(d)->description = str_udup(arg);
     break;
 
@@ -1116,7 +1117,7 @@ void oedit_parse(struct descriptor_data *d, char *arg)
   case OEDIT_EXTRADESC_KEY:
     if (genolc_checkstring(d, arg)) {
       if (OLC_DESC(d)->keyword)
-        free(OLC_DESC(d)->keyword);
+        str_release(OLC_DESC(d)->keyword);
       OLC_DESC(d)->keyword = str_udup(arg);
     }
     oedit_disp_extradesc_menu(d);
@@ -1129,9 +1130,9 @@ void oedit_parse(struct descriptor_data *d, char *arg)
         struct extra_descr_data *temp;
 
 	if (OLC_DESC(d)->keyword)
-	  free(OLC_DESC(d)->keyword);
+	  str_release(OLC_DESC(d)->keyword);
 	if (OLC_DESC(d)->description)
-	  free(OLC_DESC(d)->description);
+	  str_release(OLC_DESC(d)->description);
 
 	/* Clean up pointers */
 	REMOVE_FROM_LIST(OLC_DESC(d), OLC_OBJ(d)->ex_description, next);
@@ -8,6 +8,8 @@
 *  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
 **************************************************************************/
 
+#define MEM_TAG MEM_PLAYER
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -22,6 +24,7 @@
 #include "config.h" /* for pclean_criteria[] */
 #include "dg_scripts.h" /* To enable saving of player variables to disk */
 #include "quest.h"
+#include "mapfile.h"
 
 #define LOAD_HIT	0
 #define LOAD_MANA	1
@@ -34,6 +37,10 @@
 #define PT_FLAGS(i) (player_table[(i)].flags)
 #define PT_LLAST(i) (player_table[(i)].last)
 
+/* A point as saved, without what equipment and affects add to it. */
+#define RAW(ch, point, loc) (point(ch) - (ch)->applies[loc])
+#define RAW_SAVE(ch, i)     (GET_SAVE(ch, i) - (ch)->applies[APPLY_SAVING_PARA + (i)])
+
 /* 'global' vars defined here and used externally */
 /** @deprecated Since this file really is basically a functional extension
  * of the database handling in db.c, until the day that the mud is broken
@@ -46,12 +53,12 @@ long top_idnum = 0;
 */
 
 /* local functions */
-static void load_affects(FILE *fl, struct char_data *ch);
-static void load_skills(FILE *fl, struct char_data *ch);
-static void load_quests(FILE *fl, struct char_data *ch);
+static void load_affects(struct map_file *fl, struct char_data *ch);
+static void load_skills(struct map_file *fl, struct char_data *ch);
+static void load_quests(struct map_file *fl, struct char_data *ch);
 static void load_HMVS(struct char_data *ch, const char *line, int mode);
 static void write_aliases_ascii(FILE *file, struct char_data *ch);
-static void read_aliases_ascii(FILE *file, struct char_data *ch, int count);
+static void read_aliases_ascii(struct map_file *file, struct char_data *ch, int count);
 
 /* New version to build player index for ASCII Player Files. Generate index
  * table for the player file. */
@@ -239,7 +246,7 @@ char *get_name_by_id(long id)
 int load_char(const char *name, struct char_data *ch)
 {
   int id, i;
-  FILE *fl;
+  struct map_file *fl;
   char filename[40];
   char buf[128], buf2[128], line[MAX_INPUT_LENGTH + 1], tag[6];
   char f1[128], f2[128], f3[128], f4[128];
@@ -251,13 +258,15 @@ int load_char(const char *name, struct char_data *ch)
   else {
     if (!get_filename(filename, sizeof(filename), PLR_FILE, player_table[id].name))
       return (-1);
-    if (!(fl = fopen(filename, "r"))) {
+    if (!(fl = mf_open(filename))) {
       mudlog(NRM, LVL_GOD, TRUE, "SYSERR: Couldn't open player file %s", filename);
       return (-1);
     }
 
     /* Character initializations. Necessary to keep some things straight. */
     ch->affected = NULL;
+    memset(ch->applies, 0, sizeof(ch->applies));
+    memset(ch->aff_sources, 0, sizeof(ch->aff_sources));
     for (i = 1; i <= MAX_SKILLS; i++)
       GET_SKILL(ch, i) = 0;
     GET_SEX(ch) = PFDEF_SEX;
@@ -323,7 +332,7 @@ int load_char(const char *name, struct char_data *ch)
     for (i = 0; i < PR_ARRAY_MAX; i++)
       PRF_FLAGS(ch)[i] = PFDEF_PREFFLAGS;
 
-    while (get_line(fl, line)) {
+    while (mf_get_line(fl, line)) {
       tag_argument(line, tag);
 
       switch (*tag) {
@@ -337,6 +346,8 @@ int load_char(const char *name, struct char_data *ch)
           PLR_FLAGS(ch)[3] = asciiflag_conv(f4);
         } else
           PLR_FLAGS(ch)[0] = asciiflag_conv(line);
+        /* Saved while queued for extraction, see extract_char(). */
+        REMOVE_BIT_AR(PLR_FLAGS(ch), PLR_NOTDEADYET);
       } else if (!strcmp(tag, "Aff ")) {
         if (sscanf(line, "%s %s %s %s", f1, f2, f3, f4) == 4) {
           AFF_FLAGS(ch)[0] = asciiflag_conv(f1);
@@ -368,7 +379,7 @@ int load_char(const char *name, struct char_data *ch)
 	break;
 
       case 'D':
-	     if (!strcmp(tag, "Desc"))	ch->player.description	= fread_string(fl, buf2);
+	     if (!strcmp(tag, "Desc"))	ch->player.description	= mf_fread_string(fl, buf2);
 	else if (!strcmp(tag, "Dex "))	ch->real_abils.dex	= atoi(line);
 	else if (!strcmp(tag, "Drnk"))	GET_COND(ch, DRUNK)	= atoi(line);
 	else if (!strcmp(tag, "Drol"))	GET_DAMROLL(ch)		= atoi(line);
@@ -509,7 +520,7 @@ int load_char(const char *name, struct char_data *ch)
     GET_COND(ch, THIRST) = -1;
     GET_COND(ch, DRUNK) = -1;
   }
-  fclose(fl);
+  mf_close(fl);
   return(id);
 }
 
@@ -519,9 +530,8 @@ void save_char(struct char_data * ch)
 {
   FILE *fl;
   char filename[40], buf[MAX_STRING_LENGTH], bits[127], bits2[127], bits3[127], bits4[127];
-  int i, j, id, save_index = FALSE;
-  struct affected_type *aff, tmp_aff[MAX_AFFECT];
-  struct obj_data *char_eq[NUM_WEARS];
+  int i, id, save_index = FALSE, aff_flags[AF_ARRAY_MAX];
+  struct affected_type *aff;
   trig_data *t;
 
   if (IS_NPC(ch) || GET_PFILEPOS(ch) < 0)
@@ -552,42 +562,15 @@ void save_char(struct char_data * ch)
     return;
   }
 
-  /* Unaffect everything a character can be affected by. */
-  for (i = 0; i < NUM_WEARS; i++) {
-    if (GET_EQ(ch, i)) {
-      char_eq[i] = unequip_char(ch, i);
-#ifndef NO_EXTRANEOUS_TRIGGERS
-      remove_otrigger(char_eq[i], ch);
-#endif
-    }
-    else
-      char_eq[i] = NULL;
-  }
-
-  for (aff = ch->affected, i = 0; i < MAX_AFFECT; i++) {
-    if (aff) {
-      tmp_aff[i] = *aff;
-      for (j=0; j<AF_ARRAY_MAX; j++)
-        tmp_aff[i].bitvector[j] = aff->bitvector[j];
-      tmp_aff[i].next = 0;
-      aff = aff->next;
-    } else {
-      new_affect(&(tmp_aff[i]));
-      tmp_aff[i].next = 0;
-    }
-  }
-
-  /* Remove the affections so that the raw values are stored; otherwise the
-   * effects are doubled when the char logs back in. */
-
-  while (ch->affected)
-    affect_remove(ch, ch->affected);
-
-  if ((i >= MAX_AFFECT) && aff && aff->next)
-    log("SYSERR: WARNING: OUT OF STORE ROOM FOR AFFECTED TYPES!!!");
-
-  ch->aff_abils = ch->real_abils;
-  /* end char_to_store code */
+  /* Equipment and affects are left on: what they add is taken back out of
+   * what is written, using the sums affect_modify_ar() keeps, so the raw
+   * values are stored; otherwise the effects are doubled when the char logs
+   * back in. */
+  for (i = 0; i < AF_ARRAY_MAX; i++)
+    aff_flags[i] = AFF_FLAGS(ch)[i];
+  for (i = 0; i < NUM_AFF_FLAGS; i++)
+    if (ch->aff_sources[i])
+      REMOVE_BIT_AR(aff_flags, i);
 
   if (GET_NAME(ch))				fprintf(fl, "Name: %s\n", GET_NAME(ch));
   if (GET_PASSWD(ch))				fprintf(fl, "Pass: %s\n", GET_PASSWD(ch));
@@ -611,7 +594,7 @@ void save_char(struct char_data * ch)
   if (GET_TOT_LEVEL(ch) != PFDEF_TOTLEVEL) fprintf(fl, "Tlvl: %d\n", GET_TOT_LEVEL(ch));
 
   fprintf(fl, "Id  : %ld\n", GET_IDNUM(ch));
-  fprintf(fl, "Brth: %ld\n", (long)ch->player.time.birth);
+  fprintf(fl, "Brth: %ld\n", (long)ch->player.time.birth + ch->applies[APPLY_AGE] * SECS_PER_MUD_YEAR);
   fprintf(fl, "Plyd: %d\n",  ch->player.time.played);
   fprintf(fl, "Last: %ld\n", (long)ch->player.time.logon);
 
@@ -621,8 +604,8 @@ void save_char(struct char_data * ch)
     fprintf(fl, "Lnew: %d\n", (int)GET_LAST_NEWS(ch));
 
   if (GET_HOST(ch))				fprintf(fl, "Host: %s\n", GET_HOST(ch));
-  if (GET_HEIGHT(ch)	   != PFDEF_HEIGHT)	fprintf(fl, "Hite: %d\n", GET_HEIGHT(ch));
-  if (GET_WEIGHT(ch)	   != PFDEF_WEIGHT)	fprintf(fl, "Wate: %d\n", GET_WEIGHT(ch));
+  if (RAW(ch, GET_HEIGHT, APPLY_CHAR_HEIGHT) != PFDEF_HEIGHT) fprintf(fl, "Hite: %d\n", RAW(ch, GET_HEIGHT, APPLY_CHAR_HEIGHT));
+  if (RAW(ch, GET_WEIGHT, APPLY_CHAR_WEIGHT) != PFDEF_WEIGHT) fprintf(fl, "Wate: %d\n", RAW(ch, GET_WEIGHT, APPLY_CHAR_WEIGHT));
   if (GET_ALIGNMENT(ch)  != PFDEF_ALIGNMENT)	fprintf(fl, "Alin: %d\n", GET_ALIGNMENT(ch));
 
 
@@ -632,10 +615,10 @@ void save_char(struct char_data * ch)
   sprintascii(bits4, PLR_FLAGS(ch)[3]);
   fprintf(fl, "Act : %s %s %s %s\n", bits, bits2, bits3, bits4);
 
-  sprintascii(bits,  AFF_FLAGS(ch)[0]);
-  sprintascii(bits2, AFF_FLAGS(ch)[1]);
-  sprintascii(bits3, AFF_FLAGS(ch)[2]);
-  sprintascii(bits4, AFF_FLAGS(ch)[3]);
+  sprintascii(bits,  aff_flags[0]);
+  sprintascii(bits2, aff_flags[1]);
+  sprintascii(bits3, aff_flags[2]);
+  sprintascii(bits4, aff_flags[3]);
   fprintf(fl, "Aff : %s %s %s %s\n", bits, bits2, bits3, bits4);
 
   sprintascii(bits,  PRF_FLAGS(ch)[0]);
@@ -644,11 +627,11 @@ void save_char(struct char_data * ch)
   sprintascii(bits4, PRF_FLAGS(ch)[3]);
   fprintf(fl, "Pref: %s %s %s %s\n", bits, bits2, bits3, bits4);
 
- if (GET_SAVE(ch, 0)	   != PFDEF_SAVETHROW)	fprintf(fl, "Thr1: %d\n", GET_SAVE(ch, 0));
-  if (GET_SAVE(ch, 1)	   != PFDEF_SAVETHROW)	fprintf(fl, "Thr2: %d\n", GET_SAVE(ch, 1));
-  if (GET_SAVE(ch, 2)	   != PFDEF_SAVETHROW)	fprintf(fl, "Thr3: %d\n", GET_SAVE(ch, 2));
-  if (GET_SAVE(ch, 3)	   != PFDEF_SAVETHROW)	fprintf(fl, "Thr4: %d\n", GET_SAVE(ch, 3));
-  if (GET_SAVE(ch, 4)	   != PFDEF_SAVETHROW)	fprintf(fl, "Thr5: %d\n", GET_SAVE(ch, 4));
+ if (RAW_SAVE(ch, 0)	   != PFDEF_SAVETHROW)	fprintf(fl, "Thr1: %d\n", RAW_SAVE(ch, 0));
+  if (RAW_SAVE(ch, 1)	   != PFDEF_SAVETHROW)	fprintf(fl, "Thr2: %d\n", RAW_SAVE(ch, 1));
+  if (RAW_SAVE(ch, 2)	   != PFDEF_SAVETHROW)	fprintf(fl, "Thr3: %d\n", RAW_SAVE(ch, 2));
+  if (RAW_SAVE(ch, 3)	   != PFDEF_SAVETHROW)	fprintf(fl, "Thr4: %d\n", RAW_SAVE(ch, 3));
+  if (RAW_SAVE(ch, 4)	   != PFDEF_SAVETHROW)	fprintf(fl, "Thr5: %d\n", RAW_SAVE(ch, 4));
 
   if (GET_WIMP_LEV(ch)	   != PFDEF_WIMPLEV)	fprintf(fl, "Wimp: %d\n", GET_WIMP_LEV(ch));
   if (GET_FREEZE_LEV(ch)   != PFDEF_FREEZELEV)	fprintf(fl, "Frez: %d\n", GET_FREEZE_LEV(ch));
@@ -662,25 +645,25 @@ void save_char(struct char_data * ch)
   if (GET_COND(ch, THIRST) != PFDEF_THIRST && GET_LEVEL(ch) < LVL_IMMORT) fprintf(fl, "Thir: %d\n", GET_COND(ch, THIRST));
   if (GET_COND(ch, DRUNK)  != PFDEF_DRUNK  && GET_LEVEL(ch) < LVL_IMMORT) fprintf(fl, "Drnk: %d\n", GET_COND(ch, DRUNK));
 
-  if (GET_HIT(ch)	   != PFDEF_HIT  || GET_MAX_HIT(ch)  != PFDEF_MAXHIT)  fprintf(fl, "Hit : %d/%d\n", GET_HIT(ch),  GET_MAX_HIT(ch));
-  if (GET_MANA(ch)	   != PFDEF_MANA || GET_MAX_MANA(ch) != PFDEF_MAXMANA) fprintf(fl, "Mana: %d/%d\n", GET_MANA(ch), GET_MAX_MANA(ch));
-  if (GET_MOVE(ch)	   != PFDEF_MOVE || GET_MAX_MOVE(ch) != PFDEF_MAXMOVE) fprintf(fl, "Move: %d/%d\n", GET_MOVE(ch), GET_MAX_MOVE(ch));
+  if (GET_HIT(ch)	   != PFDEF_HIT  || RAW(ch, GET_MAX_HIT, APPLY_HIT)   != PFDEF_MAXHIT)  fprintf(fl, "Hit : %d/%d\n", GET_HIT(ch),  RAW(ch, GET_MAX_HIT, APPLY_HIT));
+  if (GET_MANA(ch)	   != PFDEF_MANA || RAW(ch, GET_MAX_MANA, APPLY_MANA) != PFDEF_MAXMANA) fprintf(fl, "Mana: %d/%d\n", GET_MANA(ch), RAW(ch, GET_MAX_MANA, APPLY_MANA));
+  if (GET_MOVE(ch)	   != PFDEF_MOVE || RAW(ch, GET_MAX_MOVE, APPLY_MOVE) != PFDEF_MAXMOVE) fprintf(fl, "Move: %d/%d\n", GET_MOVE(ch), RAW(ch, GET_MAX_MOVE, APPLY_MOVE));
 
-  if (GET_STR(ch)	   != PFDEF_STR  || GET_ADD(ch)      != PFDEF_STRADD)  fprintf(fl, "Str : %d/%d\n", GET_STR(ch),  GET_ADD(ch));
+  if (ch->real_abils.str   != PFDEF_STR  || ch->real_abils.str_add != PFDEF_STRADD)  fprintf(fl, "Str : %d/%d\n", ch->real_abils.str,  ch->real_abils.str_add);
 
 
-  if (GET_INT(ch)	   != PFDEF_INT)	fprintf(fl, "Int : %d\n", GET_INT(ch));
-  if (GET_WIS(ch)	   != PFDEF_WIS)	fprintf(fl, "Wis : %d\n", GET_WIS(ch));
-  if (GET_DEX(ch)	   != PFDEF_DEX)	fprintf(fl, "Dex : %d\n", GET_DEX(ch));
-  if (GET_CON(ch)	   != PFDEF_CON)	fprintf(fl, "Con : %d\n", GET_CON(ch));
-  if (GET_CHA(ch)	   != PFDEF_CHA)	fprintf(fl, "Cha : %d\n", GET_CHA(ch));
+  if (ch->real_abils.intel != PFDEF_INT)	fprintf(fl, "Int : %d\n", ch->real_abils.intel);
+  if (ch->real_abils.wis   != PFDEF_WIS)	fprintf(fl, "Wis : %d\n", ch->real_abils.wis);
+  if (ch->real_abils.dex   != PFDEF_DEX)	fprintf(fl, "Dex : %d\n", ch->real_abils.dex);
+  if (ch->real_abils.con   != PFDEF_CON)	fprintf(fl, "Con : %d\n", ch->real_abils.con);
+  if (ch->real_abils.cha   != PFDEF_CHA)	fprintf(fl, "Cha : %d\n", ch->real_abils.cha);
 
-  if (GET_AC(ch)	   != PFDEF_AC)		fprintf(fl, "Ac  : %d\n", GET_AC(ch));
+  if (RAW(ch, GET_AC, APPLY_AC) != PFDEF_AC)	fprintf(fl, "Ac  : %d\n", RAW(ch, GET_AC, APPLY_AC));
   if (GET_GOLD(ch)	   != PFDEF_GOLD)	fprintf(fl, "Gold: %d\n", GET_GOLD(ch));
   if (GET_BANK_GOLD(ch)	   != PFDEF_BANK)	fprintf(fl, "Bank: %d\n", GET_BANK_GOLD(ch));
   if (GET_EXP(ch)	   != PFDEF_EXP)	fprintf(fl, "Exp : %d\n", GET_EXP(ch));
-  if (GET_HITROLL(ch)	   != PFDEF_HITROLL)	fprintf(fl, "Hrol: %d\n", GET_HITROLL(ch));
-  if (GET_DAMROLL(ch)	   != PFDEF_DAMROLL)	fprintf(fl, "Drol: %d\n", GET_DAMROLL(ch));
+  if (RAW(ch, GET_HITROLL, APPLY_HITROLL) != PFDEF_HITROLL)	fprintf(fl, "Hrol: %d\n", RAW(ch, GET_HITROLL, APPLY_HITROLL));
+  if (RAW(ch, GET_DAMROLL, APPLY_DAMROLL) != PFDEF_DAMROLL)	fprintf(fl, "Drol: %d\n", RAW(ch, GET_DAMROLL, APPLY_DAMROLL));
   if (GET_OLC_ZONE(ch)     != PFDEF_OLC)        fprintf(fl, "Olc : %d\n", GET_OLC_ZONE(ch));
   if (GET_PAGE_LENGTH(ch)  != PFDEF_PAGELENGTH) fprintf(fl, "Page: %d\n", GET_PAGE_LENGTH(ch));
   if (GET_SCREEN_WIDTH(ch) != PFDEF_SCREENWIDTH) fprintf(fl, "ScrW: %d\n", GET_SCREEN_WIDTH(ch));
@@ -710,14 +693,14 @@ void save_char(struct char_data * ch)
   }
 
   /* Save affects */
-  if (tmp_aff[0].spell > 0) {
+  if (ch->affected) {
     fprintf(fl, "Affs:\n");
-    for (i = 0; i < MAX_AFFECT; i++) {
-      aff = &tmp_aff[i];
+    for (aff = ch->affected, i = 0; aff && i < MAX_AFFECT; aff = aff->next, i++)
       if (aff->spell)
-		fprintf(fl, "%d %d %d %d %d %d %d %d\n", aff->spell, aff->duration,
-          aff->modifier, aff->location, aff->bitvector[0], aff->bitvector[1], aff->bitvector[2], aff->bitvector[3]);
-    }
+        fprintf(fl, "%d %d %d %d %d %d %d %d\n", aff->spell, affect_duration(aff),
+            aff->modifier, aff->location, aff->bitvector[0], aff->bitvector[1], aff->bitvector[2], aff->bitvector[3]);
+    if (aff)
+      log("SYSERR: WARNING: OUT OF STORE ROOM FOR AFFECTED TYPES!!!");
     fprintf(fl, "0 0 0 0 0 0 0 0\n");
   }
 
@@ -726,25 +709,6 @@ void save_char(struct char_data * ch)
 
   fclose(fl);
 
-  /* More char_to_store code to add spell and eq affections back in. */
-  for (i = 0; i < MAX_AFFECT; i++) {
-    if (tmp_aff[i].spell)
-      affect_to_char(ch, &tmp_aff[i]);
-  }
-
-  for (i = 0; i < NUM_WEARS; i++) {
-    if (char_eq[i])
-#ifndef NO_EXTRANEOUS_TRIGGERS
-        if (wear_otrigger(char_eq[i], ch, i))
-#endif
-    equip_char(ch, char_eq[i], i);
-#ifndef NO_EXTRANEOUS_TRIGGERS
-          else
-          obj_to_char(char_eq[i], ch);
-#endif
-  }
-  /* end char_to_store code */
-
   if ((id = get_ptable_by_name(GET_NAME(ch))) < 0)
     return;
 
@@ -857,7 +821,7 @@ void clean_pfiles(void)
 
 /* load_affects function now handles both 32-bit and
    128-bit affect bitvectors for backward compatibility */
-static void load_affects(FILE *fl, struct char_data *ch)
+static void load_affects(struct map_file *fl, struct char_data *ch)
 {
   int num = 0, num2 = 0, num3 = 0, num4 = 0, num5 = 0, num6 = 0, num7 = 0, num8 = 0, i, n_vars;
   char line[MAX_INPUT_LENGTH + 1];
@@ -866,7 +830,7 @@ static void load_affects(FILE *fl, struct char_data *ch)
   i = 0;
   do {
     new_affect(&af);
-    get_line(fl, line);
+    mf_get_line(fl, line);
     n_vars = sscanf(line, "%d %d %d %d %d %d %d %d", &num, &num2, &num3, &num4, &num5, &num6, &num7, &num8);
     if (num > 0) {
       af.spell = num;
@@ -890,26 +854,26 @@ static void load_affects(FILE *fl, struct char_data *ch)
   } while (num != 0);
 }
 
-static void load_skills(FILE *fl, struct char_data *ch)
+static void load_skills(struct map_file *fl, struct char_data *ch)
 {
   int num = 0, num2 = 0;
   char line[MAX_INPUT_LENGTH + 1];
 
   do {
-    get_line(fl, line);
+    mf_get_line(fl, line);
     sscanf(line, "%d %d", &num, &num2);
       if (num != 0)
 	GET_SKILL(ch, num) = num2;
   } while (num != 0);
 }
 
-void load_quests(FILE *fl, struct char_data *ch)
+void load_quests(struct map_file *fl, struct char_data *ch)
 {
   int num = NOTHING;
   char line[MAX_INPUT_LENGTH + 1];
 
   do {
-    get_line(fl, line);
+    mf_get_line(fl, line);
     sscanf(line, "%d", &num);
     if (num != NOTHING)
       add_completed_quest(ch, num);
@@ -968,7 +932,7 @@ static void write_aliases_ascii(FILE *file, struct char_data *ch)
                   temp->type);
 }
 
-static void read_aliases_ascii(FILE *file, struct char_data *ch, int count)
+static void read_aliases_ascii(struct map_file *file, struct char_data *ch, int count)
 {
   int i;
 
@@ -984,15 +948,15 @@ static void read_aliases_ascii(FILE *file, struct char_data *ch, int count)
     char abuf[MAX_INPUT_LENGTH+1], rbuf[MAX_INPUT_LENGTH+1], tbuf[MAX_INPUT_LENGTH];
 
     /* Read the aliased command. */
-    get_line(file, abuf);
+    mf_get_line(file, abuf);
 
     /* Read the replacement. This needs to have a space prepended before placing in
      * the in-memory struct. The space may be there already, but we can't be certain! */
     rbuf[0] = ' ';
-    get_line(file, rbuf+1);
+    mf_get_line(file, rbuf+1);
 
     /* read the type */
-    get_line(file, tbuf);
+    mf_get_line(file, tbuf);
 
     if (abuf[0] && rbuf[1] && *tbuf) {
       struct alias_data *temp;
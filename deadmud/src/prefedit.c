@@ -9,6 +9,8 @@
 *  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -67,8 +69,10 @@ static void prefedit_save_to_char(struct descriptor_data *d)
 
   if (vict && vict->desc && IS_PLAYING(vict->desc))
   {
+    zone_presence_from(vict);
     for (i=0; i<PR_ARRAY_MAX; i++)
       PRF_FLAGS(vict)[i]  = OLC_PREFS(d)->pref_flags[i];
+    zone_presence_to(vict);
 
     GET_WIMP_LEV(vict)     = OLC_PREFS(d)->wimp_level;
     GET_PAGE_LENGTH(vict)  = OLC_PREFS(d)->page_length;
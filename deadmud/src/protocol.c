@@ -6,6 +6,8 @@
  Header files.
  ******************************************************************************/
 
+#define MEM_TAG MEM_OUTPUT
+
 #include <arpa/telnet.h>
 #include <sys/types.h>
 #include "protocol.h"
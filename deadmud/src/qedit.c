@@ -8,6 +8,8 @@
 * Copyright 1996 Harvey Gilpin.                                          *
 *********************************************************************** */
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 
@@ -9,6 +9,7 @@
 *********************************************************************** */
 
 #define __QUEST_C__
+#define MEM_TAG MEM_PROTO
 
 #include "conf.h"
 #include "sysdep.h"
@@ -22,6 +23,7 @@
 #include "screen.h"
 #include "quest.h"
 #include "act.h" /* for do_tell */
+#include "mapfile.h"
 
 
 /*--------------------------------------------------------------------------
@@ -63,12 +65,7 @@ static const char *quest_imm_usage =
 
 qst_rnum real_quest(qst_vnum vnum)
 {
-  int rnum;
-
-  for (rnum = 0; rnum < total_quests; rnum++)
-    if (QST_NUM(rnum) == vnum)
-      return(rnum);
-  return(NOTHING);
+  return vnum_to_rnum(DB_BOOT_QST, vnum);
 }
 
 int is_complete(struct char_data *ch, qst_vnum vnum)
@@ -128,7 +125,7 @@ int count_quests(qst_vnum low, qst_vnum high)
   return j;
 }
 
-void parse_quest(FILE *quest_f, int nr)
+void parse_quest(struct map_file *quest_f, int nr)
 {
   static char line[256];
   static int i = 0, j;
@@ -156,12 +153,12 @@ void parse_quest(FILE *quest_f, int nr)
   aquest_table[i].obj_reward  = NOTHING;
 
   /* begin to parse the data */
-  aquest_table[i].name = fread_string(quest_f, buf2);
-  aquest_table[i].desc = fread_string(quest_f, buf2);
-  aquest_table[i].info = fread_string(quest_f, buf2);
-  aquest_table[i].done = fread_string(quest_f, buf2);
-  aquest_table[i].quit = fread_string(quest_f, buf2);
-  if (!get_line(quest_f, line) ||
+  aquest_table[i].name = mf_fread_string(quest_f, buf2);
+  aquest_table[i].desc = mf_fread_string(quest_f, buf2);
+  aquest_table[i].info = mf_fread_string(quest_f, buf2);
+  aquest_table[i].done = mf_fread_string(quest_f, buf2);
+  aquest_table[i].quit = mf_fread_string(quest_f, buf2);
+  if (!mf_get_line(quest_f, line) ||
       (retval = sscanf(line, " %d %d %s %d %d %d %d",
              t, t+1, f1, t+2, t+3, t + 4, t + 5)) != 7) {
     log("Format error in numeric line (expected 7, got %d), %s\n",
@@ -175,7 +172,7 @@ void parse_quest(FILE *quest_f, int nr)
   aquest_table[i].prev_quest = (t[3] == -1) ? NOTHING : t[3];
   aquest_table[i].next_quest = (t[4] == -1) ? NOTHING : t[4];
   aquest_table[i].prereq     = (t[5] == -1) ? NOTHING : t[5];
-  if (!get_line(quest_f, line) ||
+  if (!mf_get_line(quest_f, line) ||
       (retval = sscanf(line, " %d %d %d %d %d %d %d",
           t, t+1, t+2, t+3, t+4, t + 5, t + 6)) != 7) {
     log("Format error in numeric line (expected 7, got %d), %s\n",
@@ -185,7 +182,7 @@ void parse_quest(FILE *quest_f, int nr)
   for (j = 0; j < 7; j++)
     aquest_table[i].value[j] = t[j];
 
-  if (!get_line(quest_f, line) ||
+  if (!mf_get_line(quest_f, line) ||
       (retval = sscanf(line, " %d %d %d",
              t, t+1, t+2)) != 3) {
     log("Format error in numeric (rewards) line (expected 3, got %d), %s\n",
@@ -198,7 +195,7 @@ void parse_quest(FILE *quest_f, int nr)
   aquest_table[i].obj_reward  = (t[2] == -1) ? NOTHING : t[2];
 
   for (;;) {
-    if (!get_line(quest_f, line)) {
+    if (!mf_get_line(quest_f, line)) {
       log("Format error in %s\n", line);
       exit(1);
     }
@@ -10,6 +10,7 @@
 **************************************************************************/
 
 #define __SHOP_C__
+#define MEM_TAG MEM_PROTO
 
 #include "conf.h"
 #include "sysdep.h"
@@ -258,7 +259,7 @@ static int evaluate_expression(struct obj_data *obj, char *expr)
 	    break;
 	  }
 	if (*extra_bits[eindex] == '\n')
-	  push(&vals, isname(name, obj->name));
+	  push(&vals, obj_isname(name, obj));
       } else {
 	if (temp != OPER_OPEN_PAREN)
 	  while (top(&ops) > temp)
@@ -392,7 +393,7 @@ static struct obj_data *get_slide_obj_vis(struct char_data *ch, char *name, stru
     return (NULL);
 
   for (i = list, j = 1; i && (j <= number); i = i->next_content)
-    if (isname(tmp, i->name))
+    if (obj_isname(tmp, i))
       if (CAN_SEE_OBJ(ch, i) && !same_obj(last_match, i)) {
 	if (j == number)
 	  return (i);
@@ -917,7 +918,7 @@ static void shopping_list(char *arg, struct char_data *ch, struct char_data *kee
 	  cnt++;
 	else {
 	  lindex++;
-	  if (!*name || isname(name, last_obj->name)) {
+	  if (!*name || obj_isname(name, last_obj)) {
 	    strncat(buf, list_object(last_obj, cnt, lindex, shop_nr, keeper, ch), sizeof(buf) - len - 1);	/* strncat: OK */
             len = strlen(buf);
             if (len + 1 >= sizeof(buf))
@@ -936,7 +937,7 @@ static void shopping_list(char *arg, struct char_data *ch, struct char_data *kee
   else if (*name && !found)	/* nothing the char was looking for was found */
     send_to_char(ch, "Presently, none of those are for sale.\r\n");
   else {
-    if (!*name || isname(name, last_obj->name))	/* show last obj */
+    if (!*name || obj_isname(name, last_obj))	/* show last obj */
       if (len < sizeof(buf))
         strncat(buf, list_object(last_obj, cnt, lindex, shop_nr, keeper, ch), sizeof(buf) - len - 1);	/* strncat: OK */
     page_string(ch->desc, buf, TRUE);
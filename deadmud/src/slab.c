@@ -0,0 +1,225 @@
+/**************************************************************************
+*  File: slab.c                                            Part of tbaMUD *
+*  Usage: Fixed size pools for characters, objects and other churn.       *
+*                                                                         *
+*  All rights reserved.  See license for complete information.            *
+**************************************************************************/
+
+#define MEM_TAG MEM_LIVE
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "comm.h"
+#include "slab.h"
+
+/* Zone resets, corpses, spells and players typing all create and free the
+ * same few structures over and over. Given to malloc() one at a time they
+ * end up scattered among the long lived strings, and over weeks of uptime
+ * the heap fragments. Instead, each of these structures comes from its own
+ * pool here: elements are carved out of slabs of about SLAB_BYTES, and a
+ * freed element goes onto its pool's free list, to be handed out again
+ * before anything new is carved. Slabs are never given back while the game
+ * runs.
+ *
+ * slab_alloc() returns zeroed memory, like CREATE. Every element must be
+ * given back to the pool it came from with slab_free(), never free().
+ *
+ * With slab_poison set (memory poison), freed elements are filled with
+ * SLAB_POISON, and slab_alloc() checks the fill is still there before handing
+ * an element out again; anything that wrote through a stale pointer in the
+ * meantime is logged.
+ *
+ * When built with MEMORY_DEBUG the pools pass everything on to calloc() and
+ * free(), so that zmalloc sees each element.
+ *
+ * Only the main thread may use the pools. */
+
+#define SLAB_BYTES  (64 * 1024)
+#define SLAB_MIN    8
+#define SLAB_POISON 0x6b
+
+/* Elements are at least a pointer in size, to hold the free list link.
+ * Elements of a cache line or more start on a line of their own, so the
+ * fields a structure keeps together at its front share as few lines as they
+ * can; see char_data. */
+#define SLAB_ALIGN  sizeof(void *)
+#define SLAB_LINE   64
+#define ELEM_ALIGN(pool) ((pool)->size >= SLAB_LINE ? SLAB_LINE : SLAB_ALIGN)
+
+#define SLAB_POOL(name, type) { name, sizeof(type), 0, NULL, NULL, 0, 0, 0, 0, 0 }
+
+struct slab_pool char_slab = SLAB_POOL("char_data", struct char_data);
+struct slab_pool obj_slab = SLAB_POOL("obj_data", struct obj_data);
+struct slab_pool affect_slab = SLAB_POOL("affected_type", struct affected_type);
+struct slab_pool follow_slab = SLAB_POOL("follow_type", struct follow_type);
+struct slab_pool txt_slab = SLAB_POOL("txt_block", struct txt_block);
+
+static struct slab_pool *slab_pools[] = {
+  &char_slab, &obj_slab, &affect_slab, &follow_slab, &txt_slab, NULL
+};
+
+int slab_poison = FALSE;
+
+#define NEXT_FREE(ptr) (*(void **) (ptr))
+
+/* The slab header holds the link to the next slab, kept aligned for any
+ * element type. */
+#define SLAB_HEADER ((sizeof(char *) + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN)
+
+static void slab_grow(struct slab_pool *pool)
+{
+  char *slab, *first, *elem;
+  size_t align = ELEM_ALIGN(pool);
+  int i;
+
+  if (!pool->per_slab) {
+    pool->size = (pool->size + align - 1) / align * align;
+    pool->per_slab = MAX(SLAB_MIN, (int) ((SLAB_BYTES - SLAB_HEADER - align) / pool->size));
+  }
+
+  CREATE(slab, char, SLAB_HEADER + align + pool->size * pool->per_slab);
+  *(char **) slab = pool->slabs;
+  pool->slabs = slab;
+  pool->slab_count++;
+
+  first = slab + SLAB_HEADER;
+  first += (align - (size_t) first % align) % align;
+
+  /* Thread the new elements onto the free list in address order. */
+  for (i = pool->per_slab - 1; i >= 0; i--) {
+    elem = first + pool->size * i;
+    if (slab_poison)
+      memset(elem, SLAB_POISON, pool->size);
+    NEXT_FREE(elem) = pool->free_list;
+    pool->free_list = elem;
+  }
+}
+
+/* Check that nothing wrote to a freed element while it sat on the free list. */
+static void slab_check_poison(struct slab_pool *pool, void *ptr)
+{
+  unsigned char *p = (unsigned char *) ptr;
+  size_t i;
+
+  for (i = sizeof(void *); i < pool->size; i++)
+    if (p[i] != SLAB_POISON)
+      break;
+
+  if (i < pool->size) {
+    pool->poisoned++;
+    log("SYSERR: slab %s: freed element %p was written to at offset %d.",
+        pool->name, ptr, (int) i);
+  }
+}
+
+void *slab_alloc(struct slab_pool *pool)
+{
+  void *ptr;
+
+#ifdef MEMORY_DEBUG
+  CREATE(ptr, char, pool->size);
+#else
+  if (!pool->free_list)
+    slab_grow(pool);
+
+  ptr = pool->free_list;
+  pool->free_list = NEXT_FREE(ptr);
+
+  if (slab_poison)
+    slab_check_poison(pool, ptr);
+  memset(ptr, 0, pool->size);
+#endif
+
+  pool->allocs++;
+  if (++pool->in_use > pool->peak)
+    pool->peak = pool->in_use;
+
+  return (ptr);
+}
+
+void slab_free(struct slab_pool *pool, void *ptr)
+{
+  if (!ptr)
+    return;
+
+  pool->in_use--;
+
+#ifdef MEMORY_DEBUG
+  free(ptr);
+#else
+  if (slab_poison)
+    memset(ptr, SLAB_POISON, pool->size);
+  NEXT_FREE(ptr) = pool->free_list;
+  pool->free_list = ptr;
+#endif
+}
+
+/* Turning poisoning on fills what is already free, so the first checks do not
+ * mistake old contents for stray writes. */
+void set_slab_poison(int on)
+{
+  struct slab_pool **pool;
+  void *ptr;
+
+  if (on && !slab_poison)
+    for (pool = slab_pools; *pool; pool++)
+      for (ptr = (*pool)->free_list; ptr; ptr = NEXT_FREE(ptr)) {
+        void *next = NEXT_FREE(ptr);
+
+        memset(ptr, SLAB_POISON, (*pool)->size);
+        NEXT_FREE(ptr) = next;
+      }
+
+  slab_poison = on;
+}
+
+/* Only for shutdown, once every character and object is gone. */
+void free_slab_pools(void)
+{
+  struct slab_pool **pool;
+  char *slab;
+
+  for (pool = slab_pools; *pool; pool++) {
+    while ((slab = (*pool)->slabs) != NULL) {
+      (*pool)->slabs = *(char **) slab;
+      free(slab);
+    }
+    (*pool)->free_list = NULL;
+    (*pool)->slab_count = 0;
+  }
+}
+
+void show_slab_pools(struct char_data *ch)
+{
+  struct slab_pool **pool;
+  long free_count, bytes, total = 0;
+
+  send_to_char(ch, "Pool           Size  In use    Peak    Free Slabs      KB     Allocs\r\n"
+                   "-------------- ---- ------- ------- ------- ----- ------- ----------\r\n");
+
+  for (pool = slab_pools; *pool; pool++) {
+    free_count = (*pool)->slab_count * (*pool)->per_slab - (*pool)->in_use;
+    if (free_count < 0)
+      free_count = 0;
+    bytes = (*pool)->slab_count * (SLAB_HEADER + ELEM_ALIGN(*pool) + (*pool)->size * (*pool)->per_slab);
+    total += bytes;
+    send_to_char(ch, "%-14s %4d %7ld %7ld %7ld %5ld %7ld %10ld\r\n",
+                 (*pool)->name, (int) (*pool)->size, (*pool)->in_use, (*pool)->peak,
+                 free_count, (*pool)->slab_count, bytes / 1024, (*pool)->allocs);
+  }
+
+  send_to_char(ch, "Total slab memory: %ldKB. Poisoning is %s", total / 1024,
+               slab_poison ? "on" : "off");
+  for (pool = slab_pools; *pool; pool++)
+    if ((*pool)->poisoned)
+      break;
+  if (*pool) {
+    send_to_char(ch, "; stray writes found:");
+    for (pool = slab_pools; *pool; pool++)
+      if ((*pool)->poisoned)
+        send_to_char(ch, " %s %ld", (*pool)->name, (*pool)->poisoned);
+  }
+  send_to_char(ch, ".\r\n");
+}
@@ -0,0 +1,44 @@
+/**
+* @file slab.h
+* Fixed size pools for the structures the game makes and throws away all the
+* time: characters, objects, affects, followers and input queue blocks.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*/
+#ifndef _SLAB_H_
+#define _SLAB_H_
+
+/** A pool of elements of one size, carved out of large slabs. */
+struct slab_pool {
+  const char *name;   /**< Name shown by memory */
+  size_t size;        /**< Size of one element */
+  int per_slab;       /**< Elements carved out of each slab */
+  char *slabs;        /**< Slabs allocated so far, linked through their first word */
+  void *free_list;    /**< Freed elements, linked through their first word */
+  long in_use;        /**< Elements handed out and not yet freed */
+  long peak;          /**< Highest in_use seen */
+  long allocs;        /**< Elements handed out since boot */
+  long slab_count;    /**< Slabs allocated so far */
+  long poisoned;      /**< Free elements found written to after being freed */
+};
+
+extern struct slab_pool char_slab;
+extern struct slab_pool obj_slab;
+extern struct slab_pool affect_slab;
+extern struct slab_pool follow_slab;
+extern struct slab_pool txt_slab;
+
+extern int slab_poison;
+
+void *slab_alloc(struct slab_pool *pool);
+void slab_free(struct slab_pool *pool, void *ptr);
+void set_slab_poison(int on);
+void free_slab_pools(void);
+void show_slab_pools(struct char_data *ch);
+
+/** Allocate one zeroed element from a pool, the slab pool version of CREATE. */
+#define SLAB_CREATE(result, type, pool) \
+  ((result) = (type *) slab_alloc(&(pool)))
+
+#endif /* _SLAB_H_ */
@@ -26,6 +26,8 @@
 #include "class.h"
 #include "fight.h"
 #include "modify.h"
+#include "nameindex.h"
+#include "strpool.h"
 
 
 /* locally defined functions of local (file) scope */
@@ -629,12 +631,13 @@ SPECIAL(pet_shops)
 
     if (*pet_name) {
       snprintf(buf, sizeof(buf), "%s %s", pet->player.name, pet_name);
-      /* free(pet->player.name); don't free the prototype! */
+      str_release(pet->player.name);
       pet->player.name = strdup(buf);
+      char_to_unshared(pet);
 
       snprintf(buf, sizeof(buf), "%sA small sign on a chain around the neck says 'My name is %s'\r\n",
 	      pet->player.description, pet_name);
-      /* free(pet->player.description); don't free the prototype! */
+      str_release(pet->player.description);
       pet->player.description = strdup(buf);
     }
     char_to_room(pet, IN_ROOM(ch));
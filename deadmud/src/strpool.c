@@ -0,0 +1,313 @@
+/**************************************************************************
+*  File: strpool.c                                         Part of tbaMUD *
+*  Usage: Shared, reference counted text for the world and prototypes.    *
+*                                                                         *
+*  All rights reserved.  See license for complete information.            *
+**************************************************************************/
+
+#define MEM_TAG MEM_WORLD
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "db.h"
+#include "strpool.h"
+#include "descstore.h"
+#include "handler.h"
+#include "nameindex.h"
+#include <stddef.h>
+
+/* Much of the world's text repeats: exit keywords like "door" or "gate", the
+ * descriptions of cloned rooms and the keywords and descriptions of stock mobs
+ * and objects. Once loaded, the strings of rooms and prototypes are moved into
+ * this pool, where each distinct text is kept once with a count of the places
+ * that point to it.
+ *
+ * Pooled strings must be given back with str_release() instead of free(). It
+ * takes plain strings from malloc() as well, so the code that frees world and
+ * prototype text uses it for both. Mob and object instances, and the copies
+ * OLC edits, take references of their own with str_ref(), so each of them
+ * gives its strings back the same way whatever their prototype did since.
+ * Code that changes a string in place, like the string editor, first makes
+ * it plain with str_unshare(); the save functions pool the result again.
+ *
+ * Text in the room description store (see descstore.c) is left where it is
+ * by both str_pool() and str_release().
+ *
+ * The names of mob and object prototypes are also split into their keywords
+ * here, once, for char_isname() and obj_isname(). The keyword set belongs to
+ * the pooled name and goes when it does; the prototype's index entry points
+ * at it, and is pointed again whenever the prototype is pooled.
+ *
+ * Only the main thread may use the pool. */
+
+struct pool_str {
+  struct pool_str *next;
+  struct keyword_set *keywords;  /* split on demand by str_keywords() */
+  unsigned int hash;
+  unsigned int refs;
+  char text[1];
+};
+
+#define POOL_HDR         offsetof(struct pool_str, text)
+#define POOL_MIN_BUCKETS 4096
+
+static struct pool_str **pool_table = NULL;
+static int pool_buckets = 0;
+static int pool_strings = 0;
+static long pool_refs = 0;
+static long pool_bytes = 0;   /* held by the pool, headers included */
+static long pool_saved = 0;   /* that the extra references would have taken */
+
+static unsigned int pool_hash(const char *str, size_t *len)
+{
+  unsigned int hash = 2166136261U;
+  const char *p;
+
+  for (p = str; *p; p++)
+    hash = (hash ^ (unsigned char)*p) * 16777619U;
+  *len = p - str;
+  return hash;
+}
+
+static void pool_grow(void)
+{
+  struct pool_str **old = pool_table, *e, *next;
+  int i, old_buckets = pool_buckets;
+
+  pool_buckets = pool_buckets ? pool_buckets * 2 : POOL_MIN_BUCKETS;
+  CREATE(pool_table, struct pool_str *, pool_buckets);
+
+  for (i = 0; i < old_buckets; i++)
+    for (e = old[i]; e; e = next) {
+      next = e->next;
+      e->next = pool_table[e->hash & (pool_buckets - 1)];
+      pool_table[e->hash & (pool_buckets - 1)] = e;
+    }
+  if (old)
+    free(old);
+}
+
+/** Moves a string from malloc() into the pool.
+ * @param str The string, which the pool takes over. Passing a pooled string
+ * returns it unchanged.
+ * @retval char * The pooled string with the same text, or NULL for NULL. */
+char *str_pool(char *str)
+{
+  struct pool_str *e;
+  unsigned int hash;
+  size_t len;
+
+  if (!str || desc_store_has(str))
+    return str;
+
+  hash = pool_hash(str, &len);
+
+  if (pool_buckets)
+    for (e = pool_table[hash & (pool_buckets - 1)]; e; e = e->next)
+      if (e->hash == hash && !strcmp(e->text, str)) {
+        if (e->text == str)
+          return str;
+        e->refs++;
+        pool_refs++;
+        pool_saved += len + 1;
+        free(str);
+        return e->text;
+      }
+
+  if (pool_strings >= pool_buckets)
+    pool_grow();
+
+  if (!(e = (struct pool_str *) malloc(POOL_HDR + len + 1))) {
+    perror("SYSERR: malloc failure");
+    abort();
+  }
+  memcpy(e->text, str, len + 1);
+  e->keywords = NULL;
+  e->hash = hash;
+  e->refs = 1;
+  e->next = pool_table[hash & (pool_buckets - 1)];
+  pool_table[hash & (pool_buckets - 1)] = e;
+
+  pool_strings++;
+  pool_refs++;
+  pool_bytes += POOL_HDR + len + 1;
+
+  free(str);
+  return e->text;
+}
+
+/* Finds the entry holding str itself, not just the same text. */
+static struct pool_str **pool_find(const char *str, size_t *len)
+{
+  struct pool_str **prev;
+  unsigned int hash;
+
+  if (!pool_buckets)
+    return NULL;
+
+  hash = pool_hash(str, len);
+  for (prev = &pool_table[hash & (pool_buckets - 1)]; *prev; prev = &(*prev)->next)
+    if ((*prev)->text == str)
+      return prev;
+  return NULL;
+}
+
+/** Drops one reference to a pooled string, or frees a plain one. */
+void str_release(char *str)
+{
+  struct pool_str **prev, *e;
+  size_t len;
+
+  if (!str || desc_store_has(str))
+    return;
+
+  if (!(prev = pool_find(str, &len))) {
+    free(str);
+    return;
+  }
+
+  e = *prev;
+  pool_refs--;
+  if (--e->refs > 0) {
+    pool_saved -= len + 1;
+    return;
+  }
+  *prev = e->next;
+  pool_strings--;
+  pool_bytes -= POOL_HDR + len + 1;
+  if (e->keywords)
+    free(e->keywords);
+  free(e);
+}
+
+/** Takes another reference to a string, to be given back with str_release().
+ * @param str The string to share.
+ * @retval char * str itself if it is pooled or in the description store, a
+ * copy from strdup() of a plain string, or NULL for NULL. */
+char *str_ref(char *str)
+{
+  struct pool_str **prev;
+  size_t len;
+
+  if (!str || desc_store_has(str))
+    return str;
+
+  if (!(prev = pool_find(str, &len)))
+    return strdup(str);
+
+  (*prev)->refs++;
+  pool_refs++;
+  pool_saved += len + 1;
+  return str;
+}
+
+/** Swaps a reference for a plain string from malloc(), which the caller may
+ * change or reallocate in place.
+ * @param str A reference, or a plain string, which is returned unchanged.
+ * @retval char * The plain string, or NULL for NULL. */
+char *str_unshare(char *str)
+{
+  char *copy;
+  size_t len;
+
+  if (!str || (!desc_store_has(str) && !pool_find(str, &len)))
+    return str;
+
+  copy = strdup(str);
+  str_release(str);
+  return copy;
+}
+
+/* The keywords of a pooled string, split the first time they are asked for.
+ * NULL for strings not in the pool. */
+static struct keyword_set *str_keywords(char *str)
+{
+  struct pool_str **prev;
+  size_t len;
+
+  if (!str || !(prev = pool_find(str, &len)))
+    return NULL;
+  if (!(*prev)->keywords)
+    (*prev)->keywords = build_keyword_set((*prev)->text);
+  return (*prev)->keywords;
+}
+
+static void pool_ex_descriptions(struct extra_descr_data *ex)
+{
+  for (; ex; ex = ex->next) {
+    ex->keyword = str_pool(ex->keyword);
+    ex->description = str_pool(ex->description);
+  }
+}
+
+void pool_room_strings(struct room_data *room)
+{
+  int dir;
+
+  room->name = str_pool(room->name);
+  room->description = str_pool(room->description);
+  pool_ex_descriptions(room->ex_description);
+
+  for (dir = 0; dir < NUM_OF_DIRS; dir++)
+    if (room->dir_option[dir]) {
+      room->dir_option[dir]->general_description = str_pool(room->dir_option[dir]->general_description);
+      room->dir_option[dir]->keyword = str_pool(room->dir_option[dir]->keyword);
+    }
+}
+
+void pool_mobile_strings(mob_rnum rnum)
+{
+  struct char_data *mob = &mob_proto[rnum];
+
+  mob->player.name = str_pool(mob->player.name);
+  mob->player.title = str_pool(mob->player.title);
+  mob->player.short_descr = str_pool(mob->player.short_descr);
+  mob->player.long_descr = str_pool(mob->player.long_descr);
+  mob->player.description = str_pool(mob->player.description);
+  mob_index[rnum].keywords = str_keywords(mob->player.name);
+  name_index_changed(DB_BOOT_MOB);
+}
+
+void pool_object_strings(obj_rnum rnum)
+{
+  struct obj_data *obj = &obj_proto[rnum];
+
+  obj->name = str_pool(obj->name);
+  obj->description = str_pool(obj->description);
+  obj->short_description = str_pool(obj->short_description);
+  obj->action_description = str_pool(obj->action_description);
+  pool_ex_descriptions(obj->ex_description);
+  obj_index[rnum].keywords = str_keywords(obj->name);
+  name_index_changed(DB_BOOT_OBJ);
+}
+
+/** Pools the strings of every room, mob or object prototype after a boot. */
+void pool_world_strings(int mode)
+{
+  int i;
+
+  switch (mode) {
+  case DB_BOOT_WLD:
+    for (i = 0; i <= top_of_world; i++)
+      pool_room_strings(&world[i]);
+    break;
+  case DB_BOOT_MOB:
+    for (i = 0; i <= top_of_mobt; i++)
+      pool_mobile_strings(i);
+    break;
+  case DB_BOOT_OBJ:
+    for (i = 0; i <= top_of_objt; i++)
+      pool_object_strings(i);
+    break;
+  }
+}
+
+void str_pool_stats(int *strings, long *refs, long *bytes, long *saved)
+{
+  *strings = pool_strings;
+  *refs = pool_refs;
+  *bytes = pool_bytes;
+  *saved = pool_saved;
+}
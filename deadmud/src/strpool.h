@@ -0,0 +1,24 @@
+/**
+* @file strpool.h
+* Pool of shared, reference counted strings for the text of the world and the
+* prototypes, so that identical text is kept in memory only once.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*/
+#ifndef _STRPOOL_H_
+#define _STRPOOL_H_
+
+char *str_pool(char *str);
+void str_release(char *str);
+char *str_ref(char *str);
+char *str_unshare(char *str);
+
+void pool_room_strings(struct room_data *room);
+void pool_mobile_strings(mob_rnum rnum);
+void pool_object_strings(obj_rnum rnum);
+void pool_world_strings(int mode);
+
+void str_pool_stats(int *strings, long *refs, long *bytes, long *saved);
+
+#endif /* _STRPOOL_H_ */
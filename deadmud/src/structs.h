@@ -587,6 +587,9 @@
 
 /** Controls when a zone update will occur. */
 #define PULSE_ZONE      (10 RL_SEC)
+/** How long zone resets may run each pulse, in microseconds. A reset that
+ * takes longer is finished on the following pulses. */
+#define ZONE_RESET_USECS 10000
 /** Controls when mobile (NPC) actions and updates will occur. */
 #define PULSE_MOBILE    (10 RL_SEC)
 /** Controls the time between turns of combat. */
@@ -603,6 +606,8 @@
  * Currently set for 5 minutes.
  */
 #define PULSE_USAGE     (5 * 60 RL_SEC)
+/** How often output buffers that sat unused are given back. */
+#define PULSE_BUFTRIM   (60 RL_SEC)
 /** Controls when to save the current ingame MUD time to disk.
  * This should be set >= SECS_PER_MUD_HOUR */
 #define PULSE_TIMESAVE	(30 * 60 RL_SEC)
@@ -745,6 +750,14 @@ struct obj_data
 
   struct obj_data *next_content;  /**< For 'contains' lists   */
   struct obj_data *next;          /**< For the object list */
+  struct obj_data *prev;          /**< For the object list */
+  struct obj_data *next_instance; /**< For the prototype's instance list */
+  struct obj_data *prev_instance; /**< For the prototype's instance list */
+  struct obj_data *next_unshared; /**< Next object with a name of its own */
+  struct obj_data *prev_unshared; /**< Previous object with a name of its own */
+  long timer_expires;             /**< point_update() pass the timer runs out in, 0 if none; see handler.c */
+  struct obj_data *next_due;      /**< Next object in the same timer wheel slot */
+  struct obj_data *prev_due;      /**< Previous object in the same timer wheel slot */
   struct char_data *sitting_here; /**< For furniture, who is sitting in it */
   
   struct list_data *events;      /**< Used for object events */
@@ -827,6 +840,10 @@ struct room_data
   struct char_data *people;   /**< List of NPCs / PCs in room */
   
   struct list_data * events;  
+
+  long mob_listeners;         /**< Cached trigger types of the mobs here */
+  long obj_listeners;         /**< Cached trigger types of the objs here */
+  bool listeners_valid;       /**< FALSE if the two caches need a rebuild */
 };
 
 /* char-related structures */
@@ -891,7 +908,6 @@ struct char_player_data
   byte class_2;                /**< Second PC Class */
   byte class_3;                /**< Third PC Class */
   byte class_4;                /**< Fourth PC Class */
-  byte level;                    /**< PC / NPC level */
   struct time_data time;         /**< PC AGE in days */
   ubyte weight;                  /**< PC / NPC weight */
   ubyte height;                  /**< PC / NPC height */
@@ -942,21 +958,16 @@ struct char_special_data_saved
 {
   int alignment;         /**< -1000 (evil) to 1000 (good) range. */
   long idnum;            /**< PC's idnum; -1 for mobiles. */
-  int act[PM_ARRAY_MAX]; /**< act flags for NPC's; player flag for PC's */
-  int affected_by[AF_ARRAY_MAX]; /**< Bitvector for spells/skills affected by */
   sh_int apply_saving_throw[5];  /**< Saving throw (Bonuses)		*/
 };
 
 /** Special playing constants shared by PCs and NPCs which aren't in pfile */
 struct char_special_data
 {
-  struct char_data *fighting;  /**< Target of fight; else NULL */
-  struct char_data *hunting;   /**< Target of NPC hunt; else NULL */
+  bool hunted;                 /**< Has ever been the target of a hunt */
   struct obj_data *furniture;  /**< Object being sat on/in; else NULL */
   struct char_data *next_in_furniture; /**< Next person sitting, else NULL */
 
-  byte position; /**< Standing, fighting, sleeping, etc. */
-
   int carry_weight; /**< Carried weight */
   byte carry_items; /**< Number of items carried */
   int timer;        /**< Timer for update */
@@ -1030,6 +1041,13 @@ struct affected_type
   int bitvector[AF_ARRAY_MAX]; /**< Tells which bits to set (AFF_XXX). */
 
   struct affected_type *next; /**< The next affect in the list of affects. */
+
+  /* Set by affect_to_char() while the character is in the game; see the
+   * affect wheel in handler.c. */
+  struct char_data *owner;          /**< Character it is scheduled for, or NULL */
+  long expires;                     /**< affect_update() pass it wears off in */
+  struct affected_type *next_due;   /**< Next affect in the same wheel slot */
+  struct affected_type *prev_due;   /**< Previous affect in the same wheel slot */
 };
 
 /** The list element that makes up a list of characters following this
@@ -1040,28 +1058,52 @@ struct follow_type
   struct follow_type *next;   /**< Next character following. */
 };
 
+/** The state of a character that the passes over every character each
+ * pulse (point_update, affect_update, mobile_activity, perform_violence) look
+ * at. It is kept at the front of char_data with the other fields those passes
+ * read, so a pass touches a few cache lines of each character instead of
+ * most of them. Use the macros in utils.h to get at it. */
+struct char_hot_data
+{
+  int act[PM_ARRAY_MAX];         /**< act flags for NPC's; player flag for PC's */
+  int affected_by[AF_ARRAY_MAX]; /**< Bitvector for spells/skills affected by */
+  struct char_data *fighting;    /**< Target of fight; else NULL */
+  struct char_data *hunting;     /**< Target of NPC hunt; else NULL */
+  byte position;                 /**< Standing, fighting, sleeping, etc. */
+  byte level;                    /**< PC / NPC level */
+};
+
 /** Master structure for PCs and NPCs. */
 struct char_data
 {
-  int pfilepos; /**< PC playerfile pos and id number */
+  /* Read by the passes over every character each pulse, in the first two
+   * cache lines of the character (see char_slab in slab.c). */
+  struct char_data *next;          /**< Next char_data on character_list */
+  struct char_hot_data hot;        /**< Flags, position, fighting, level */
   mob_rnum nr;  /**< NPC real instance number */
   room_rnum in_room;     /**< Current location (real room number) */
-  room_rnum was_in_room; /**< Previous location for linkdead people  */
   int wait;              /**< wait for how many loops before taking action. */
+  struct char_point_data points;        /**< Point/statistics */
+  struct affected_type *affected;        /**< affected by what spells    */
+  struct char_data *master;      /**< List of character being followed */
+  struct descriptor_data *desc; /**< Descriptor/connection info; NPCs = NULL */
+  struct player_special_data *player_specials; /**< PC specials		  */
+  struct char_data *next_fighting; /**< Next in line to fight */
+
+  int pfilepos; /**< PC playerfile pos and id number */
+  room_rnum was_in_room; /**< Previous location for linkdead people  */
 
   struct char_player_data player;       /**< General PC/NPC data */
   struct char_ability_data real_abils;  /**< Abilities without modifiers */
   struct char_ability_data aff_abils;   /**< Abilities with modifiers */
-  struct char_point_data points;        /**< Point/statistics */
+  int applies[NUM_APPLIES];             /**< Sums of equipment and affect modifiers, by APPLY_XXX */
+  sh_int aff_sources[NUM_AFF_FLAGS];    /**< Modifiers setting each AFF_XXX, see affect_modify_ar() */
   struct char_special_data char_specials; /**< PC/NPC specials	  */
-  struct player_special_data *player_specials; /**< PC specials		  */
   struct mob_special_data mob_specials; /**< NPC specials		  */
 
-  struct affected_type *affected;        /**< affected by what spells    */
   struct obj_data *equipment[NUM_WEARS]; /**< Equipment array            */
 
   struct obj_data *carrying;    /**< List head for objects in inventory */
-  struct descriptor_data *desc; /**< Descriptor/connection info; NPCs = NULL */
 
   long id; /**< used by DG triggers - unique id */
   struct trig_proto_list *proto_script; /**< list of default triggers */
@@ -1069,11 +1111,16 @@ struct char_data
   struct script_memory *memory;         /**< for mob memory triggers */
 
   struct char_data *next_in_room;  /**< Next PC in the room */
-  struct char_data *next;          /**< Next char_data in the room */
-  struct char_data *next_fighting; /**< Next in line to fight */
+  struct char_data *prev;          /**< Previous char_data on character_list */
+  struct char_data *next_instance; /**< Next instance of the same mob */
+  struct char_data *prev_instance; /**< Previous instance of the same mob */
+  struct char_data *next_unshared; /**< Next char with a name of its own */
+  struct char_data *prev_unshared; /**< Previous char with a name of its own */
+  long list_stamp; /**< Order it joined character_list in, newest highest */
+  struct char_data *prev_fighting; /**< Previous in line to fight */
+  struct char_data *next_extract;  /**< Next on the queue of chars to extract */
 
   struct follow_type *followers; /**< List of characters following */
-  struct char_data *master;      /**< List of character being followed */
 
   struct group_data *group;      /**< Character's Group */
 
@@ -1127,6 +1174,7 @@ struct descriptor_data
   int bufptr;               /**< ptr to end of current output		*/
   int bufspace;             /**< space left in the output buffer	*/
   struct txt_block *large_outbuf; /**< ptr to large buffer, if we need it */
+  int outbuf_class;         /**< size class of large_outbuf, see comm.c */
   struct txt_q input;       /**< q of unprocessed input		*/
   struct char_data *character; /**< linked to char			*/
   struct char_data *original;  /**< original char if switched		*/
@@ -1265,6 +1313,23 @@ struct weather_data
   int sunlight; /**< And how much sun? */
 };
 
+/** One keyword of a keyword_set. */
+struct keyword
+{
+  char *word; /**< The keyword, lowercased. */
+  int len;    /**< Its length. */
+};
+
+/** The keywords of a namelist, split once so that isname() need not split
+ * the namelist again on every call. */
+struct keyword_set
+{
+  const char *text;        /**< The namelist the keywords were split from. */
+  int count;               /**< Number of keywords. */
+  unsigned int first;      /**< Bit (c & 31) set for each first letter c. */
+  struct keyword words[1]; /**< The keywords, count of them. */
+};
+
 /** Element in monster and object index-tables.
  NOTE: Assumes sizeof(mob_vnum) >= sizeof(obj_vnum) */
 struct index_data
@@ -1278,6 +1343,9 @@ struct index_data
 
   char *farg; /**< String argument for special function. */
   struct trig_data *proto; /**< Points to the trigger prototype. */
+  struct char_data *mobs; /**< Live instances of a mob, newest first */
+  struct obj_data *objs;  /**< Live instances of an object, newest first */
+  struct keyword_set *keywords; /**< Split name of the mob/obj prototype */
 };
 
 /** Master linked list for the mob/object prototype trigger lists. */
@@ -1431,5 +1499,6 @@ struct config_data
 #ifdef MEMORY_DEBUG
 #include "zmalloc.h"
 #endif
+#include "memacct.h"
 
 #endif /* _STRUCTS_H_ */
@@ -5,6 +5,8 @@
 * By Michael Scott [Manx].                                                *
 **************************************************************************/
 
+#define MEM_TAG MEM_OLC
+
 #include "conf.h"
 #include "sysdep.h"
 #include "structs.h"
@@ -0,0 +1,378 @@
+/* ************************************************************************
+*  File: dglint.c                                          Part of tbaMUD *
+*  Usage: Check the DG scripts in world/trg for errors without booting    *
+*         the mud.                                                        *
+*  All Rights Reserved                                                    *
+************************************************************************* */
+
+/*
+ * Run from the lib directory (or give it with -d), like the mud itself:
+ *
+ *   dglint [-d <lib dir>] [-q]
+ *
+ * Every trigger listed in world/trg/index is read the way the mud reads it
+ * and checked for the mistakes script_driver() would otherwise only report
+ * at run time: unbalanced if/else/end and while/switch/done blocks, script
+ * commands missing their arguments, unknown object and room commands, and
+ * unknown fields on %actor%, %victim% and %self%. Fields that name a global
+ * or remote variable set by any trigger are accepted, as the mud does.
+ * Mob triggers can run any player command or social, so their commands are
+ * not checked.
+ *
+ * -q leaves out the warnings.
+ */
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "dg_scripts.h"
+#include "dg_check.h"
+
+#define TRG_DIR      "world/trg/"
+#define TRG_INDEX    TRG_DIR "index"
+#define LINE_SIZE    512
+
+struct lint_trig {
+  int vnum;
+  char *file;
+  int line;                /* line of the #vnum */
+  char *name;
+  int attach_type;
+  long trigger_type;
+  int narg;
+  char *arglist;
+  char *cmds;              /* as read, lines separated by \r\n */
+  int cmd_line;            /* file line of the first command */
+};
+
+static struct lint_trig *trigs = NULL;
+static int num_trigs = 0, max_trigs = 0;
+static int num_errors = 0, num_warnings = 0, quiet = 0;
+
+/* Names made global or remote by any trigger, valid as %actor.name% etc. */
+static char **globals = NULL;
+static int num_globals = 0, max_globals = 0;
+
+static void report(int error, const struct lint_trig *t, int line,
+    const char *fmt, ...) __attribute__ ((format (printf, 4, 5)));
+
+static void report(int error, const struct lint_trig *t, int line,
+    const char *fmt, ...)
+{
+  va_list args;
+
+  if (error)
+    num_errors++;
+  else {
+    num_warnings++;
+    if (quiet)
+      return;
+  }
+
+  printf("%s:%d: #%d (%s): %s: ", t->file, line, t->vnum,
+      t->name ? t->name : "unnamed", error ? "error" : "warning");
+  va_start(args, fmt);
+  vprintf(fmt, args);
+  va_end(args);
+  putchar('\n');
+}
+
+/* What dg_check.c finds goes through report() as well. */
+static void check_report(struct dg_check *chk, int error, int line,
+    const char *msg)
+{
+  report(error, (const struct lint_trig *) chk->data, line, "%s", msg);
+}
+
+static void add_global(const char *name, size_t len, void *data)
+{
+  int i;
+
+  for (i = 0; i < num_globals; i++)
+    if (strlen(globals[i]) == len && !strn_cmp(globals[i], name, len))
+      return;
+
+  if (num_globals == max_globals) {
+    max_globals = max_globals ? max_globals * 2 : 64;
+    if (!(globals = realloc(globals, max_globals * sizeof(char *)))) {
+      perror("dglint: realloc");
+      exit(1);
+    }
+  }
+  if (!(globals[num_globals] = malloc(len + 1))) {
+    perror("dglint: malloc");
+    exit(1);
+  }
+  memcpy(globals[num_globals], name, len);
+  globals[num_globals++][len] = '\0';
+}
+
+static int is_global(const char *name, size_t len, void *data)
+{
+  int i;
+
+  for (i = 0; i < num_globals; i++)
+    if (strlen(globals[i]) == len && !strn_cmp(globals[i], name, len))
+      return 1;
+  return 0;
+}
+
+/* Same as asciiflag_conv() in db.c */
+static long flag_conv(const char *flag)
+{
+  long flags = 0;
+  int is_num = 1;
+  const char *p;
+
+  for (p = flag; *p; p++) {
+    if (islower((unsigned char)*p))
+      flags |= 1 << (*p - 'a');
+    else if (isupper((unsigned char)*p))
+      flags |= 1 << (26 + (*p - 'A'));
+
+    if (!isdigit((unsigned char)*p) && (*p != '-' || p != flag))
+      is_num = 0;
+  }
+
+  if (is_num)
+    flags = atol(flag);
+
+  return flags;
+}
+
+/* Reads a '~' terminated string the way fread_string() does, without the
+ * '@' colour conversion. Returns NULL on end of file, "" for an empty one. */
+static char *read_string(FILE *fl, int *line)
+{
+  char tmp[LINE_SIZE + 3], *buf = NULL, *point;
+  size_t length = 0, templength;
+  int done = 0;
+
+  do {
+    if (!fgets(tmp, LINE_SIZE, fl)) {
+      free(buf);
+      return NULL;
+    }
+    (*line)++;
+
+    point = strchr(tmp, '\0');
+    for (point--; point >= tmp && (*point == '\r' || *point == '\n'); point--);
+    if (point >= tmp && *point == '~') {
+      *point = '\0';
+      done = 1;
+    } else {
+      *(++point) = '\r';
+      *(++point) = '\n';
+      *(++point) = '\0';
+    }
+
+    templength = point - tmp;
+    if (!(buf = realloc(buf, length + templength + 1))) {
+      perror("dglint: realloc");
+      exit(1);
+    }
+    memcpy(buf + length, tmp, templength + 1);
+    length += templength;
+  } while (!done);
+
+  return buf;
+}
+
+/* Reads the next line that is not blank or a '*' comment, like get_line(). */
+static int next_line(FILE *fl, char *buf, int *line)
+{
+  size_t len;
+
+  do {
+    if (!fgets(buf, LINE_SIZE, fl))
+      return 0;
+    (*line)++;
+  } while (*buf == '*' || *buf == '\n' || *buf == '\r');
+
+  len = strlen(buf);
+  while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == '\r'))
+    buf[--len] = '\0';
+
+  return 1;
+}
+
+static struct lint_trig *new_trig(void)
+{
+  if (num_trigs == max_trigs) {
+    max_trigs = max_trigs ? max_trigs * 2 : 1024;
+    if (!(trigs = realloc(trigs, max_trigs * sizeof(struct lint_trig)))) {
+      perror("dglint: realloc");
+      exit(1);
+    }
+  }
+  memset(&trigs[num_trigs], 0, sizeof(struct lint_trig));
+  return &trigs[num_trigs++];
+}
+
+/* Reads all triggers of one .trg file, as discrete_load() and
+ * parse_trigger() do. */
+static void read_trg_file(const char *fname)
+{
+  struct lint_trig *t, bad;
+  char buf[LINE_SIZE + 1], flags[LINE_SIZE + 1];
+  int line = 0, nr, k, t0, attach;
+  FILE *fl;
+
+  if (!(fl = fopen(fname, "r"))) {
+    printf("%s: error: %s\n", fname, strerror(errno));
+    num_errors++;
+    return;
+  }
+
+  memset(&bad, 0, sizeof(bad));
+  bad.file = (char *)fname;
+
+  for (;;) {
+    if (!next_line(fl, buf, &line)) {
+      bad.vnum = num_trigs ? trigs[num_trigs - 1].vnum : -1;
+      report(1, &bad, line, "file ended without a '$' line");
+      break;
+    }
+    if (*buf == '$')
+      break;
+
+    if (*buf != '#' || sscanf(buf, "#%d", &nr) != 1) {
+      report(1, &bad, line, "format error, expected '#<vnum>' but got '%s'", buf);
+      break;
+    }
+    if (nr >= 99999)
+      break;
+
+    t = new_trig();
+    t->vnum = nr;
+    t->file = (char *)fname;
+    t->line = line;
+    if (!(t->name = read_string(fl, &line)))
+      goto eof;
+    if (!*t->name) {
+      free(t->name);
+      t->name = NULL;
+    }
+
+    if (!next_line(fl, buf, &line))
+      goto eof;
+    k = sscanf(buf, "%d %s %d", &attach, flags, &t0);
+    if (k < 2) {
+      report(1, t, line, "bad trigger type line '%s'", buf);
+      *flags = '\0';
+    }
+    t->attach_type = (k >= 1) ? attach : -1;
+    t->trigger_type = flag_conv(flags);
+    t->narg = (k == 3) ? t0 : 0;
+
+    if (!(t->arglist = read_string(fl, &line)))
+      goto eof;
+    t->cmd_line = line + 1;
+    if (!(t->cmds = read_string(fl, &line)))
+      goto eof;
+  }
+
+  fclose(fl);
+  return;
+
+eof:
+  report(1, &trigs[num_trigs - 1], line, "file ended inside the trigger");
+  num_trigs--;
+  fclose(fl);
+}
+
+/* Collects the variable names other scripts may read as fields. */
+static void scan_globals(const struct lint_trig *t)
+{
+  char cmd[LINE_SIZE * 2];
+  const char *s, *e;
+  size_t len;
+
+  for (s = t->cmds; s && *s; s = e) {
+    for (e = s; *e && *e != '\r' && *e != '\n'; e++);
+    if ((len = e - s) >= sizeof(cmd))
+      len = sizeof(cmd) - 1;
+    memcpy(cmd, s, len);
+    cmd[len] = '\0';
+    while (*e == '\r' || *e == '\n')
+      e++;
+
+    dg_global_names(cmd, add_global, NULL);
+  }
+}
+
+/* Checks one trigger with the rules of dg_check.c. */
+static void check_trigger(const struct lint_trig *t)
+{
+  struct dg_check chk;
+
+  dg_check_start(&chk, t->attach_type);
+  chk.is_global = is_global;
+  chk.report = check_report;
+  chk.data = (void *) t;
+
+  dg_check_header(&chk, t->line, t->trigger_type, t->narg, t->arglist);
+  if (!t->cmds || !*t->cmds) {
+    report(0, t, t->cmd_line, "has no script");
+    return;
+  }
+
+  dg_check_text(&chk, t->cmd_line, t->cmds);
+  dg_check_end(&chk);
+}
+
+int main(int argc, char **argv)
+{
+  char file[LINE_SIZE + 1], *fname;
+  int i, files = 0;
+  FILE *index;
+
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-q"))
+      quiet = 1;
+    else if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+      if (chdir(argv[++i]) < 0) {
+        perror(argv[i]);
+        exit(1);
+      }
+    } else {
+      fprintf(stderr, "Usage: %s [-d <lib dir>] [-q]\n", argv[0]);
+      exit(1);
+    }
+  }
+
+  if (!(index = fopen(TRG_INDEX, "r"))) {
+    perror(TRG_INDEX);
+    exit(1);
+  }
+  while (fscanf(index, "%s\n", file) == 1 && *file != '$') {
+    if (!(fname = malloc(strlen(TRG_DIR) + strlen(file) + 1))) {
+      perror("dglint: malloc");
+      exit(1);
+    }
+    sprintf(fname, "%s%s", TRG_DIR, file);
+    read_trg_file(fname);
+    files++;
+  }
+  fclose(index);
+
+  for (i = 0; i < num_trigs; i++)
+    scan_globals(&trigs[i]);
+
+  for (i = 0; i < num_trigs; i++) {
+    if (i && trigs[i].vnum == trigs[i - 1].vnum)
+      report(1, &trigs[i], trigs[i].line, "duplicate vnum, also in %s:%d",
+          trigs[i - 1].file, trigs[i - 1].line);
+    else if (i && trigs[i].vnum < trigs[i - 1].vnum)
+      report(1, &trigs[i], trigs[i].line, "out of order after #%d, the mud will not find it",
+          trigs[i - 1].vnum);
+    check_trigger(&trigs[i]);
+  }
+
+  printf("%d triggers in %d files: %d error%s, %d warning%s.\n", num_trigs,
+      files, num_errors, num_errors == 1 ? "" : "s", num_warnings,
+      num_warnings == 1 ? "" : "s");
+
+  return num_errors ? 1 : 0;
+}
@@ -23,6 +23,7 @@
 #include "interpreter.h"
 #include "class.h"
 #include "race.h"
+#include "slab.h"
 
 
 /** Aportable random number function.
@@ -187,6 +188,11 @@ int strn_cmp(const char *arg1, const char *arg2, int n)
 }
 #endif
 
+/** If set, basic_mud_vlog() offers each message to it first, and leaves the
+ * message alone if it returns TRUE. The world file readers in db.c use it to
+ * keep the messages of their threads in file order. */
+int (*log_hook)(const char *format, va_list args) = NULL;
+
 /** New variable argument log() function; logs messages to disk.
  * Works the same as the old for previously written code but is very nice
  * if new code wishes to implment printf style log messages without the need
@@ -196,17 +202,23 @@ int strn_cmp(const char *arg1, const char *arg2, int n)
  * @param args The comma delimited, variable substitutions to make in str. */
 void basic_mud_vlog(const char *format, va_list args)
 {
-  time_t ct = time(0);
-  char *time_s = asctime(localtime(&ct));
+  time_t ct;
+  char *time_s;
+
+  if (format == NULL)
+    format = "SYSERR: log() received a NULL format.";
+
+  if (log_hook && log_hook(format, args))
+    return;
+
+  ct = time(0);
+  time_s = asctime(localtime(&ct));
 
   if (logfile == NULL) {
     puts("SYSERR: Using log() before stream was initialized!");
     return;
   }
 
-  if (format == NULL)
-    format = "SYSERR: log() received a NULL format.";
-
   time_s[strlen(time_s) - 1] = '\0';
 
   fprintf(logfile, "%-15.15s :: ", time_s + 4);
@@ -563,13 +575,13 @@ void stop_follower(struct char_data *ch)
   if (ch->master->followers->follower == ch) {	/* Head of follower-list? */
     k = ch->master->followers;
     ch->master->followers = k->next;
-    free(k);
+    slab_free(&follow_slab, k);
   } else {			/* locate follower who is not head of list */
     for (k = ch->master->followers; k->next->follower != ch; k = k->next);
 
     j = k->next;
     k->next = j->next;
-    free(j);
+    slab_free(&follow_slab, j);
   }
 
   ch->master = NULL;
@@ -629,7 +641,7 @@ void add_follower(struct char_data *ch, struct char_data *leader)
 
   ch->master = leader;
 
-  CREATE(k, struct follow_type, 1);
+  SLAB_CREATE(k, struct follow_type, follow_slab);
 
   k->follower = ch;
   k->next = leader->followers;
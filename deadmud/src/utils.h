@@ -38,6 +38,7 @@
  * are made available with the function definition. */
 void basic_mud_log(const char *format, ...) __attribute__ ((format (printf, 1, 2)));
 void basic_mud_vlog(const char *format, va_list args);
+extern int (*log_hook)(const char *format, va_list args);
 int touch(const char *path);
 void mudlog(int type, int level, int file, const char *str, ...) __attribute__ ((format (printf, 4, 5)));
 int	rand_number(int from, int to);
@@ -130,6 +131,7 @@ void	gain_exp(struct char_data *ch, int gain);
 void	gain_exp_regardless(struct char_data *ch, int gain);
 void	gain_condition(struct char_data *ch, int condition, int value);
 void	point_update(void);
+void	show_tick_passes(struct char_data *ch);
 void	update_pos(struct char_data *victim);
 void run_autowiz(void);
 int increase_gold(struct char_data *ch, int amt);
@@ -362,13 +364,13 @@ do                                                              \
 #endif
 
 /** The act flags on a mob. Synonomous with PLR_FLAGS. */
-#define MOB_FLAGS(ch)	((ch)->char_specials.saved.act)
+#define MOB_FLAGS(ch)	((ch)->hot.act)
 /** Player flags on a PC. Synonomous with MOB_FLAGS. */
-#define PLR_FLAGS(ch)	((ch)->char_specials.saved.act)
+#define PLR_FLAGS(ch)	((ch)->hot.act)
 /** Preference flags on a player (not to be used on mobs). */
 #define PRF_FLAGS(ch) CHECK_PLAYER_SPECIAL((ch), ((ch)->player_specials->saved.pref))
 /** Affect flags on the NPC or PC. */
-#define AFF_FLAGS(ch)	((ch)->char_specials.saved.affected_by)
+#define AFF_FLAGS(ch)	((ch)->hot.affected_by)
 /** Room flags.
  * @param loc The real room number. */
 #define ROOM_FLAGS(loc)	(world[(loc)].room_flags)
@@ -462,7 +464,7 @@ do                                                              \
 #define IS_LIGHT(room)  (!IS_DARK(room))
 
 /** 1 if this is a valid room number, 0 if not. */
-#define VALID_ROOM_RNUM(rnum)	((rnum) != NOWHERE && (rnum) <= top_of_world)
+#define VALID_ROOM_RNUM(rnum)	((rnum) != NOWHERE && (rnum) <= top_of_world && world[(rnum)].number != NOWHERE)
 /** The room number if this is a valid room, NOWHERE if it is not */
 #define GET_ROOM_VNUM(rnum) \
 	((room_vnum)(VALID_ROOM_RNUM(rnum) ? world[(rnum)].number : NOWHERE))
@@ -486,7 +488,7 @@ do                                                              \
 /** Title of PC */
 #define GET_TITLE(ch)   ((ch)->player.title)
 /** Level of PC or NPC. */
-#define GET_LEVEL(ch)   ((ch)->player.level)
+#define GET_LEVEL(ch)   ((ch)->hot.level)
 /** Total Level of PC, for use with Multiclassing */
 #define GET_TOT_LEVEL(ch) ((ch)->player_specials->saved.total_level)
 /** Password of PC. */
@@ -552,7 +554,7 @@ do                                                              \
 #define GET_DAMROLL(ch)   ((ch)->points.damroll)
 
 /** Current position (standing, sitting) of ch. */
-#define GET_POS(ch)	  ((ch)->char_specials.position)
+#define GET_POS(ch)	  ((ch)->hot.position)
 /** Unique ID of ch. */
 #define GET_IDNUM(ch)	  ((ch)->char_specials.saved.idnum)
 /** Returns contents of id field from x. */
@@ -562,9 +564,9 @@ do                                                              \
 /** Number of items carried by ch. */
 #define IS_CARRYING_N(ch) ((ch)->char_specials.carry_items)
 /** Who or what ch is fighting. */
-#define FIGHTING(ch)	  ((ch)->char_specials.fighting)
+#define FIGHTING(ch)	  ((ch)->hot.fighting)
 /** Who or what the ch is hunting. */
-#define HUNTING(ch)	  ((ch)->char_specials.hunting)
+#define HUNTING(ch)	  ((ch)->hot.hunting)
 /** Saving throw i for character ch. */
 #define GET_SAVE(ch, i)	  ((ch)->char_specials.saved.apply_saving_throw[i])
 /** Alignment value for ch. */
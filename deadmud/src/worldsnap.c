@@ -0,0 +1,806 @@
+/**************************************************************************
+*  File: worldsnap.c                                       Part of tbaMUD *
+*  Usage: Binary snapshot of the booted world, for faster reboots.        *
+*                                                                         *
+*  All rights reserved.  See license for complete information.            *
+**************************************************************************/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "db.h"
+#include "comm.h"
+#include "dg_scripts.h"
+#include "shop.h"
+#include "quest.h"
+#include "worldsnap.h"
+#include "strpool.h"
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+
+/* The snapshot holds what boot_world() builds from the world files, after
+ * renumbering: zones and their command tables, trigger prototypes, rooms, mob
+ * and object prototypes, shops and quests. It is written after each boot from
+ * the world files, and read instead of them as long as it is newer than every
+ * file a text boot would read. The world files stay the source of truth: OLC
+ * saves them, which leaves the snapshot stale until the next boot rewrites it.
+ *
+ * Every structure is written as it is in memory with its pointers cleared,
+ * followed by the strings and lists it owns. A string is an int length, -1 for
+ * NULL, and that many bytes. Sizes and byte order are those of the binary that
+ * wrote it; the structure sizes in the header catch most layout changes, bump
+ * WORLD_SNAP_VERSION for the rest. */
+
+#define SNAP_NUM_SIZES 10
+
+struct snap_header {
+  char magic[WORLD_SNAP_MAGICLEN];
+  int version;
+  unsigned int checksum;       /* of everything after the header */
+  int sizes[SNAP_NUM_SIZES];   /* see snap_sizes() */
+  int zones, triggers, rooms, mobs, objs, shops, quests;
+};
+
+/* Directories whose index and files a text boot reads. */
+static const char *snap_prefixes[] = {
+  ZON_PREFIX, TRG_PREFIX, WLD_PREFIX, MOB_PREFIX, OBJ_PREFIX, SHP_PREFIX,
+  QST_PREFIX, NULL
+};
+
+/* writing */
+static FILE *snap_fl;
+static unsigned int snap_sum;
+
+/* reading */
+static const char *snap_buf;
+static size_t snap_size, snap_pos;
+
+static void snap_sizes(int *sizes)
+{
+  sizes[0] = sizeof(struct zone_data);
+  sizes[1] = sizeof(struct reset_com);
+  sizes[2] = sizeof(struct room_data);
+  sizes[3] = sizeof(struct room_direction_data);
+  sizes[4] = sizeof(struct char_data);
+  sizes[5] = sizeof(struct obj_data);
+  sizes[6] = sizeof(struct index_data);
+  sizes[7] = sizeof(struct shop_data);
+  sizes[8] = sizeof(struct aq_data);
+  sizes[9] = NUM_OF_DIRS;
+}
+
+/* FNV-1a, enough to notice a truncated or scribbled file. */
+static unsigned int snap_checksum(unsigned int sum, const void *data, size_t len)
+{
+  const unsigned char *p = data;
+
+  while (len--)
+    sum = (sum ^ *p++) * 16777619U;
+
+  return sum;
+}
+
+static long snap_msecs(struct timeval *start)
+{
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+  return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_usec - start->tv_usec) / 1000;
+}
+
+/* Returns TRUE if no file a text boot would read is newer than when. */
+static int snap_is_current(time_t when)
+{
+  char fname[PATH_MAX], name[MAX_INPUT_LENGTH];
+  struct stat st;
+  FILE *index;
+  int i, current = TRUE;
+
+  for (i = 0; snap_prefixes[i] && current; i++) {
+    snprintf(fname, sizeof(fname), "%s%s", snap_prefixes[i], INDEX_FILE);
+    if (stat(fname, &st) < 0 || st.st_mtime >= when || !(index = fopen(fname, "r")))
+      break;
+
+    while (fscanf(index, "%511s\n", name) == 1 && *name != '$') {
+      snprintf(fname, sizeof(fname), "%s%s", snap_prefixes[i], name);
+      if (stat(fname, &st) < 0 || st.st_mtime >= when) {
+        current = FALSE;
+        break;
+      }
+    }
+    fclose(index);
+  }
+
+  if (snap_prefixes[i] || !current) {
+    log("%s is newer than the world snapshot, reading the world files.", fname);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static void snap_write(const void *data, size_t len)
+{
+  fwrite(data, 1, len, snap_fl);
+  snap_sum = snap_checksum(snap_sum, data, len);
+}
+
+static void snap_write_int(int n)
+{
+  snap_write(&n, sizeof(int));
+}
+
+static void snap_write_str(const char *str)
+{
+  int len = str ? strlen(str) : -1;
+
+  snap_write_int(len);
+  if (len > 0)
+    snap_write(str, len);
+}
+
+static void snap_write_exdesc(struct extra_descr_data *ed)
+{
+  struct extra_descr_data *d;
+  int n;
+
+  for (n = 0, d = ed; d; d = d->next)
+    n++;
+  snap_write_int(n);
+
+  for (d = ed; d; d = d->next) {
+    snap_write_str(d->keyword);
+    snap_write_str(d->description);
+  }
+}
+
+static void snap_write_protos(struct trig_proto_list *list)
+{
+  struct trig_proto_list *p;
+  int n;
+
+  for (n = 0, p = list; p; p = p->next)
+    n++;
+  snap_write_int(n);
+
+  for (p = list; p; p = p->next)
+    snap_write_int(p->vnum);
+}
+
+static void snap_write_index(struct index_data *index)
+{
+  struct index_data i;
+
+  memcpy(&i, index, sizeof(i));
+  i.func = NULL;
+  i.farg = NULL;
+  i.proto = NULL;
+  i.mobs = NULL;
+  i.objs = NULL;
+  i.keywords = NULL;
+  snap_write(&i, sizeof(i));
+}
+
+static void snap_write_zone(struct zone_data *zone)
+{
+  struct zone_data z;
+  struct reset_com c;
+  int n, i;
+
+  memcpy(&z, zone, sizeof(z));
+  z.name = z.builders = NULL;
+  z.cmd = NULL;
+  z.resets = z.reset_pulses = z.players = 0;
+  z.reset_usecs = z.reset_max_usecs = 0;
+  snap_write(&z, sizeof(z));
+  snap_write_str(zone->name);
+  snap_write_str(zone->builders);
+
+  for (n = 0; zone->cmd && zone->cmd[n].command != 'S'; n++);
+  snap_write_int(zone->cmd ? n + 1 : 0);
+
+  for (i = 0; zone->cmd && i <= n; i++) {
+    memcpy(&c, &zone->cmd[i], sizeof(c));
+    c.sarg1 = c.sarg2 = NULL;
+    snap_write(&c, sizeof(c));
+    snap_write_str(zone->cmd[i].sarg1);
+    snap_write_str(zone->cmd[i].sarg2);
+  }
+}
+
+static void snap_write_trigger(struct trig_data *trig)
+{
+  struct cmdlist_element *cl;
+  int n;
+
+  snap_write_int(GET_TRIG_VNUM(trig));
+  snap_write_int(trig->attach_type);
+  snap_write(&trig->trigger_type, sizeof(long));
+  snap_write_int(trig->narg);
+  snap_write_str(trig->name);
+  snap_write_str(trig->arglist);
+
+  /* The command list as it is, so the loader need not split it again. */
+  for (n = 0, cl = trig->cmdlist; cl; cl = cl->next)
+    n++;
+  snap_write_int(n);
+  for (cl = trig->cmdlist; cl; cl = cl->next)
+    snap_write_str(cl->cmd);
+}
+
+static void snap_write_room(struct room_data *room)
+{
+  struct room_data r;
+  struct room_direction_data d;
+  int dir;
+
+  memcpy(&r, room, sizeof(r));
+  r.name = r.description = NULL;
+  r.ex_description = NULL;
+  for (dir = 0; dir < NUM_OF_DIRS; dir++)
+    r.dir_option[dir] = NULL;
+  r.func = NULL;
+  r.proto_script = NULL;
+  r.script = NULL;
+  r.contents = NULL;
+  r.people = NULL;
+  r.events = NULL;
+  r.light = 0;
+  r.mob_listeners = r.obj_listeners = 0;
+  r.listeners_valid = FALSE;
+  snap_write(&r, sizeof(r));
+
+  snap_write_str(room->name);
+  snap_write_str(room->description);
+  snap_write_exdesc(room->ex_description);
+
+  for (dir = 0; dir < NUM_OF_DIRS; dir++) {
+    snap_write_int(room->dir_option[dir] != NULL);
+    if (!room->dir_option[dir])
+      continue;
+    memcpy(&d, room->dir_option[dir], sizeof(d));
+    d.general_description = d.keyword = NULL;
+    snap_write(&d, sizeof(d));
+    snap_write_str(room->dir_option[dir]->general_description);
+    snap_write_str(room->dir_option[dir]->keyword);
+  }
+
+  snap_write_protos(room->proto_script);
+}
+
+static void snap_write_mobile(struct char_data *mob)
+{
+  struct char_data m;
+  int i;
+
+  memcpy(&m, mob, sizeof(m));
+  m.player.name = m.player.short_descr = m.player.long_descr = NULL;
+  m.player.description = m.player.title = NULL;
+  FIGHTING(&m) = HUNTING(&m) = NULL;
+  m.char_specials.furniture = NULL;
+  m.char_specials.next_in_furniture = NULL;
+  m.player_specials = NULL;
+  m.mob_specials.memory = NULL;
+  m.affected = NULL;
+  for (i = 0; i < NUM_WEARS; i++)
+    m.equipment[i] = NULL;
+  m.carrying = NULL;
+  m.desc = NULL;
+  m.proto_script = NULL;
+  m.script = NULL;
+  m.memory = NULL;
+  m.next_in_room = m.next = m.prev = NULL;
+  m.next_instance = m.prev_instance = NULL;
+  m.next_unshared = m.prev_unshared = NULL;
+  m.list_stamp = 0;
+  m.next_fighting = m.prev_fighting = m.next_extract = NULL;
+  m.followers = NULL;
+  m.master = NULL;
+  m.group = NULL;
+  m.events = NULL;
+  snap_write(&m, sizeof(m));
+
+  snap_write_str(mob->player.name);
+  snap_write_str(mob->player.short_descr);
+  snap_write_str(mob->player.long_descr);
+  snap_write_str(mob->player.description);
+  snap_write_str(mob->player.title);
+  snap_write_protos(mob->proto_script);
+}
+
+static void snap_write_object(struct obj_data *obj)
+{
+  struct obj_data o;
+
+  memcpy(&o, obj, sizeof(o));
+  o.name = o.description = o.short_description = o.action_description = NULL;
+  o.ex_description = NULL;
+  o.carried_by = o.worn_by = NULL;
+  o.in_obj = o.contains = NULL;
+  o.proto_script = NULL;
+  o.script = NULL;
+  o.next_content = o.next = o.prev = NULL;
+  o.next_instance = o.prev_instance = NULL;
+  o.next_unshared = o.prev_unshared = NULL;
+  o.next_due = o.prev_due = NULL;
+  o.timer_expires = 0;
+  o.sitting_here = NULL;
+  o.events = NULL;
+  snap_write(&o, sizeof(o));
+
+  snap_write_str(obj->name);
+  snap_write_str(obj->description);
+  snap_write_str(obj->short_description);
+  snap_write_str(obj->action_description);
+  snap_write_exdesc(obj->ex_description);
+  snap_write_protos(obj->proto_script);
+}
+
+static void snap_write_shop(struct shop_data *shop)
+{
+  struct shop_data s;
+  int n;
+
+  memcpy(&s, shop, sizeof(s));
+  s.producing = NULL;
+  s.type = NULL;
+  s.no_such_item1 = s.no_such_item2 = NULL;
+  s.missing_cash1 = s.missing_cash2 = NULL;
+  s.do_not_buy = s.message_buy = s.message_sell = NULL;
+  s.in_room = NULL;
+  s.func = NULL;
+  snap_write(&s, sizeof(s));
+
+  /* The lists all end with, and include, a NOTHING or NOWHERE entry. */
+  for (n = 0; shop->producing && shop->producing[n] != NOTHING; n++);
+  snap_write_int(shop->producing ? n + 1 : 0);
+  if (shop->producing)
+    snap_write(shop->producing, (n + 1) * sizeof(obj_vnum));
+
+  for (n = 0; shop->type && BUY_TYPE(shop->type[n]) != NOTHING; n++);
+  snap_write_int(shop->type ? n + 1 : 0);
+  for (n = 0; shop->type && (!n || BUY_TYPE(shop->type[n - 1]) != NOTHING); n++) {
+    snap_write_int(BUY_TYPE(shop->type[n]));
+    snap_write_str(BUY_WORD(shop->type[n]));
+  }
+
+  snap_write_str(shop->no_such_item1);
+  snap_write_str(shop->no_such_item2);
+  snap_write_str(shop->missing_cash1);
+  snap_write_str(shop->missing_cash2);
+  snap_write_str(shop->do_not_buy);
+  snap_write_str(shop->message_buy);
+  snap_write_str(shop->message_sell);
+
+  for (n = 0; shop->in_room && shop->in_room[n] != NOWHERE; n++);
+  snap_write_int(shop->in_room ? n + 1 : 0);
+  if (shop->in_room)
+    snap_write(shop->in_room, (n + 1) * sizeof(room_vnum));
+}
+
+static void snap_write_quest(struct aq_data *quest)
+{
+  struct aq_data q;
+
+  memcpy(&q, quest, sizeof(q));
+  q.name = q.desc = q.info = q.done = q.quit = NULL;
+  q.func = NULL;
+  snap_write(&q, sizeof(q));
+
+  snap_write_str(quest->name);
+  snap_write_str(quest->desc);
+  snap_write_str(quest->info);
+  snap_write_str(quest->done);
+  snap_write_str(quest->quit);
+}
+
+/* Writes the world as boot_world() left it. Must be called before anything
+ * is loaded into the world, and not after OLC changes: those are only in the
+ * snapshot once they are saved and the mud reboots from the world files. */
+void save_world_snapshot(void)
+{
+  struct snap_header hdr;
+  struct timeval start;
+  char tmpname[PATH_MAX];
+  long size;
+  int i;
+
+  /* Those boots leave out part of the world. */
+  if (mini_mud || no_specials)
+    return;
+
+  gettimeofday(&start, NULL);
+
+  snprintf(tmpname, sizeof(tmpname), "%s.tmp", WORLD_SNAPSHOT);
+  if (!(snap_fl = fopen(tmpname, "wb"))) {
+    log("SYSERR: Could not write world snapshot %s: %s", tmpname, strerror(errno));
+    return;
+  }
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, WORLD_SNAP_MAGIC, WORLD_SNAP_MAGICLEN);
+  hdr.version = WORLD_SNAP_VERSION;
+  snap_sizes(hdr.sizes);
+  hdr.zones = top_of_zone_table + 1;
+  hdr.triggers = top_of_trigt;
+  hdr.rooms = top_of_world + 1;
+  hdr.mobs = top_of_mobt + 1;
+  hdr.objs = top_of_objt + 1;
+  hdr.shops = top_shop + 1;
+  hdr.quests = total_quests;
+
+  /* The header is written again with the checksum once the rest is done. */
+  fwrite(&hdr, sizeof(hdr), 1, snap_fl);
+  snap_sum = 2166136261U;
+
+  for (i = 0; i < hdr.zones; i++)
+    snap_write_zone(&zone_table[i]);
+  for (i = 0; i < hdr.triggers; i++)
+    snap_write_trigger(trig_index[i]->proto);
+  for (i = 0; i < hdr.rooms; i++)
+    snap_write_room(&world[i]);
+  for (i = 0; i < hdr.mobs; i++) {
+    snap_write_index(&mob_index[i]);
+    snap_write_mobile(&mob_proto[i]);
+  }
+  for (i = 0; i < hdr.objs; i++) {
+    snap_write_index(&obj_index[i]);
+    snap_write_object(&obj_proto[i]);
+  }
+  for (i = 0; i < hdr.shops; i++)
+    snap_write_shop(&shop_index[i]);
+  for (i = 0; i < hdr.quests; i++)
+    snap_write_quest(&aquest_table[i]);
+
+  hdr.checksum = snap_sum;
+  size = ftell(snap_fl);
+  rewind(snap_fl);
+  fwrite(&hdr, sizeof(hdr), 1, snap_fl);
+
+  if (ferror(snap_fl) | fclose(snap_fl) || rename(tmpname, WORLD_SNAPSHOT) < 0) {
+    log("SYSERR: Could not write world snapshot %s: %s", WORLD_SNAPSHOT, strerror(errno));
+    remove(tmpname);
+    return;
+  }
+
+  /* The counts of the text boot above are of '#' lines, estimates. */
+  log("World snapshot written to %s, %ld bytes in %ld ms.", WORLD_SNAPSHOT,
+      size, snap_msecs(&start));
+  log("   %d zones, %d triggers, %d rooms, %d mobs, %d objs, %d shops and %d quests.",
+      hdr.zones, hdr.triggers, hdr.rooms, hdr.mobs, hdr.objs, hdr.shops, hdr.quests);
+}
+
+/* OLC saved a world file. snap_is_current() would notice by its time, but
+ * that is only as good as the clock and the file times, so drop the
+ * snapshot and let the next boot read the files and write a new one. */
+void remove_world_snapshot(void)
+{
+  if (remove(WORLD_SNAPSHOT) == 0)
+    log("World snapshot %s removed, the world files changed.", WORLD_SNAPSHOT);
+  else if (errno != ENOENT)
+    log("SYSERR: Could not remove world snapshot %s: %s", WORLD_SNAPSHOT, strerror(errno));
+}
+
+/* The checksum was good, so running out of file means a bug here. */
+static void snap_read(void *out, size_t len)
+{
+  if (snap_pos + len > snap_size) {
+    log("SYSERR: World snapshot %s ends early, delete it and reboot.", WORLD_SNAPSHOT);
+    exit(1);
+  }
+  memcpy(out, snap_buf + snap_pos, len);
+  snap_pos += len;
+}
+
+static int snap_read_int(void)
+{
+  int n;
+
+  snap_read(&n, sizeof(int));
+  return n;
+}
+
+static char *snap_read_str(void)
+{
+  char *str;
+  int len = snap_read_int();
+
+  if (len < 0)
+    return NULL;
+
+  CREATE(str, char, len + 1);
+  snap_read(str, len);
+  str[len] = '\0';
+  return str;
+}
+
+static struct extra_descr_data *snap_read_exdesc(void)
+{
+  struct extra_descr_data *list = NULL, **tail = &list;
+  int n = snap_read_int();
+
+  while (n-- > 0) {
+    CREATE(*tail, struct extra_descr_data, 1);
+    (*tail)->keyword = snap_read_str();
+    (*tail)->description = snap_read_str();
+    tail = &(*tail)->next;
+  }
+  return list;
+}
+
+static struct trig_proto_list *snap_read_protos(void)
+{
+  struct trig_proto_list *list = NULL, **tail = &list;
+  int n = snap_read_int();
+
+  while (n-- > 0) {
+    CREATE(*tail, struct trig_proto_list, 1);
+    (*tail)->vnum = snap_read_int();
+    tail = &(*tail)->next;
+  }
+  return list;
+}
+
+static void snap_read_zone(struct zone_data *zone)
+{
+  int n, i;
+
+  snap_read(zone, sizeof(*zone));
+  zone->name = snap_read_str();
+  zone->builders = snap_read_str();
+
+  if ((n = snap_read_int()) > 0)
+    CREATE(zone->cmd, struct reset_com, n);
+  for (i = 0; i < n; i++) {
+    snap_read(&zone->cmd[i], sizeof(struct reset_com));
+    zone->cmd[i].sarg1 = snap_read_str();
+    zone->cmd[i].sarg2 = snap_read_str();
+  }
+}
+
+static void snap_read_trigger(void)
+{
+  struct cmdlist_element *cmdlist = NULL, **cle = &cmdlist;
+  int vnum, attach_type, narg, n;
+  long trigger_type;
+  char *name, *arglist;
+
+  vnum = snap_read_int();
+  attach_type = snap_read_int();
+  snap_read(&trigger_type, sizeof(long));
+  narg = snap_read_int();
+  name = snap_read_str();
+  arglist = snap_read_str();
+
+  for (n = snap_read_int(); n > 0; n--) {
+    CREATE(*cle, struct cmdlist_element, 1);
+    (*cle)->cmd = snap_read_str();
+    cle = &(*cle)->next;
+  }
+
+  add_trigger_proto(vnum, name, attach_type, trigger_type, narg, arglist,
+      cmdlist);
+}
+
+static void snap_read_room(struct room_data *room)
+{
+  int dir;
+
+  snap_read(room, sizeof(*room));
+  room->name = snap_read_str();
+  room->description = snap_read_str();
+  room->ex_description = snap_read_exdesc();
+
+  for (dir = 0; dir < NUM_OF_DIRS; dir++) {
+    if (!snap_read_int())
+      continue;
+    CREATE(room->dir_option[dir], struct room_direction_data, 1);
+    snap_read(room->dir_option[dir], sizeof(struct room_direction_data));
+    room->dir_option[dir]->general_description = snap_read_str();
+    room->dir_option[dir]->keyword = snap_read_str();
+  }
+
+  /* Room scripts are attached at boot, as index_boot() does. */
+  room->proto_script = snap_read_protos();
+  assign_triggers(room, WLD_TRIGGER);
+}
+
+static void snap_read_mobile(struct char_data *mob)
+{
+  snap_read(mob, sizeof(*mob));
+  mob->player.name = snap_read_str();
+  mob->player.short_descr = snap_read_str();
+  mob->player.long_descr = snap_read_str();
+  mob->player.description = snap_read_str();
+  mob->player.title = snap_read_str();
+  mob->proto_script = snap_read_protos();
+  mob->player_specials = &dummy_mob;
+}
+
+static void snap_read_object(struct obj_data *obj)
+{
+  snap_read(obj, sizeof(*obj));
+  obj->name = snap_read_str();
+  obj->description = snap_read_str();
+  obj->short_description = snap_read_str();
+  obj->action_description = snap_read_str();
+  obj->ex_description = snap_read_exdesc();
+  obj->proto_script = snap_read_protos();
+}
+
+static void snap_read_shop(struct shop_data *shop)
+{
+  int n, i;
+
+  snap_read(shop, sizeof(*shop));
+
+  if ((n = snap_read_int()) > 0) {
+    CREATE(shop->producing, obj_vnum, n);
+    snap_read(shop->producing, n * sizeof(obj_vnum));
+  }
+
+  if ((n = snap_read_int()) > 0)
+    CREATE(shop->type, struct shop_buy_data, n);
+  for (i = 0; i < n; i++) {
+    BUY_TYPE(shop->type[i]) = snap_read_int();
+    BUY_WORD(shop->type[i]) = snap_read_str();
+  }
+
+  shop->no_such_item1 = snap_read_str();
+  shop->no_such_item2 = snap_read_str();
+  shop->missing_cash1 = snap_read_str();
+  shop->missing_cash2 = snap_read_str();
+  shop->do_not_buy = snap_read_str();
+  shop->message_buy = snap_read_str();
+  shop->message_sell = snap_read_str();
+
+  if ((n = snap_read_int()) > 0) {
+    CREATE(shop->in_room, room_vnum, n);
+    snap_read(shop->in_room, n * sizeof(room_vnum));
+  }
+}
+
+static void snap_read_quest(struct aq_data *quest)
+{
+  snap_read(quest, sizeof(*quest));
+  quest->name = snap_read_str();
+  quest->desc = snap_read_str();
+  quest->info = snap_read_str();
+  quest->done = snap_read_str();
+  quest->quit = snap_read_str();
+}
+
+/* Checks the header and checksum of the mapped snapshot. */
+static int snap_valid(struct snap_header *hdr)
+{
+  int sizes[SNAP_NUM_SIZES];
+
+  if (snap_size < sizeof(*hdr))
+    return FALSE;
+
+  memcpy(hdr, snap_buf, sizeof(*hdr));
+  snap_sizes(sizes);
+
+  if (memcmp(hdr->magic, WORLD_SNAP_MAGIC, WORLD_SNAP_MAGICLEN) ||
+      hdr->version != WORLD_SNAP_VERSION || memcmp(hdr->sizes, sizes, sizeof(sizes))) {
+    log("World snapshot %s was written by another version, reading the world files.",
+        WORLD_SNAPSHOT);
+    return FALSE;
+  }
+
+  if (snap_checksum(2166136261U, snap_buf + sizeof(*hdr), snap_size - sizeof(*hdr)) !=
+      hdr->checksum || hdr->zones <= 0 || hdr->rooms <= 0 || hdr->mobs <= 0 ||
+      hdr->objs <= 0) {
+    log("SYSERR: World snapshot %s is damaged, reading the world files.", WORLD_SNAPSHOT);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Loads the world from the snapshot instead of the world files, if it is up
+ * to date. Returns FALSE, with nothing loaded, if the files must be read. */
+int load_world_snapshot(void)
+{
+  struct snap_header hdr;
+  struct timeval start;
+  struct stat st;
+  void *map;
+  int fd, i, old_tag;
+
+  /* Syntax checks are for the world files, and the other two boots leave out
+   * part of the world. */
+  if (scheck || mini_mud || no_specials)
+    return FALSE;
+
+  if (stat(WORLD_SNAPSHOT, &st) < 0 || !snap_is_current(st.st_mtime))
+    return FALSE;
+
+  gettimeofday(&start, NULL);
+  log("Loading world snapshot %s.", WORLD_SNAPSHOT);
+
+  if ((fd = open(WORLD_SNAPSHOT, O_RDONLY)) < 0 ||
+      (map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+    log("SYSERR: Could not map world snapshot %s: %s", WORLD_SNAPSHOT, strerror(errno));
+    if (fd >= 0)
+      close(fd);
+    return FALSE;
+  }
+  close(fd);
+
+  snap_buf = map;
+  snap_size = st.st_size;
+
+  if (!snap_valid(&hdr)) {
+    munmap(map, st.st_size);
+    return FALSE;
+  }
+  snap_pos = sizeof(hdr);
+  old_tag = mem_tag;
+
+  mem_tag = MEM_WORLD;
+  CREATE(zone_table, struct zone_data, hdr.zones);
+  for (i = 0; i < hdr.zones; i++)
+    snap_read_zone(&zone_table[i]);
+  top_of_zone_table = hdr.zones - 1;
+  index_vnums(DB_BOOT_ZON, 0);
+
+  mem_tag = MEM_SCRIPT;
+  top_of_trigt = 0;
+  if (hdr.triggers > 0)
+    CREATE(trig_index, struct index_data *, hdr.triggers);
+  for (i = 0; i < hdr.triggers; i++)
+    snap_read_trigger();
+
+  mem_tag = MEM_WORLD;
+  CREATE(world, struct room_data, hdr.rooms);
+  top_of_world = hdr.rooms - 1;
+  for (i = 0; i < hdr.rooms; i++)
+    snap_read_room(&world[i]);
+  index_vnums(DB_BOOT_WLD, 0);
+  pool_world_strings(DB_BOOT_WLD);
+
+  mem_tag = MEM_PROTO;
+  CREATE(mob_proto, struct char_data, hdr.mobs);
+  CREATE(mob_index, struct index_data, hdr.mobs);
+  for (i = 0; i < hdr.mobs; i++) {
+    snap_read(&mob_index[i], sizeof(struct index_data));
+    snap_read_mobile(&mob_proto[i]);
+  }
+  top_of_mobt = hdr.mobs - 1;
+  index_vnums(DB_BOOT_MOB, 0);
+  pool_world_strings(DB_BOOT_MOB);
+
+  CREATE(obj_proto, struct obj_data, hdr.objs);
+  CREATE(obj_index, struct index_data, hdr.objs);
+  for (i = 0; i < hdr.objs; i++) {
+    snap_read(&obj_index[i], sizeof(struct index_data));
+    snap_read_object(&obj_proto[i]);
+  }
+  top_of_objt = hdr.objs - 1;
+  index_vnums(DB_BOOT_OBJ, 0);
+  pool_world_strings(DB_BOOT_OBJ);
+
+  if (hdr.shops > 0)
+    CREATE(shop_index, struct shop_data, hdr.shops);
+  for (i = 0; i < hdr.shops; i++)
+    snap_read_shop(&shop_index[i]);
+  top_shop = hdr.shops - 1;
+
+  if (hdr.quests > 0)
+    CREATE(aquest_table, struct aq_data, hdr.quests);
+  for (i = 0; i < hdr.quests; i++)
+    snap_read_quest(&aquest_table[i]);
+  total_quests = hdr.quests;
+  if (total_quests > 0)
+    index_vnums(DB_BOOT_QST, 0);
+
+  mem_tag = old_tag;
+  munmap(map, st.st_size);
+
+  log("   %d zones, %d triggers, %d rooms, %d mobs, %d objs, %d shops and %d quests in %ld ms.",
+      hdr.zones, hdr.triggers, hdr.rooms, hdr.mobs, hdr.objs, hdr.shops,
+      hdr.quests, snap_msecs(&start));
+  return TRUE;
+}
@@ -0,0 +1,22 @@
+/**
+* @file worldsnap.h
+* Binary snapshot of the booted world tables, used to skip parsing the world
+* files when none of them changed since the last boot.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*/
+#ifndef _WORLDSNAP_H_
+#define _WORLDSNAP_H_
+
+/** First bytes of the snapshot file, not NUL terminated. */
+#define WORLD_SNAP_MAGIC    "TBAWORLD"
+#define WORLD_SNAP_MAGICLEN 8
+/** Bump whenever the layout written by save_world_snapshot() changes. */
+#define WORLD_SNAP_VERSION  3
+
+int load_world_snapshot(void);
+void save_world_snapshot(void);
+void remove_world_snapshot(void);
+
+#endif /* _WORLDSNAP_H_ */